@@ -0,0 +1,188 @@
+/*
+ * aislamiento.c
+ * -----------------------------------------
+ * Implementación del modo de poco ruido declarado en aislamiento.h.
+ */
+
+#define _GNU_SOURCE
+
+#include "aislamiento.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/* Prototipos de funciones internas */
+static int  probar_tiempo_real(int prioridad);
+static void elegir_cpus(Aislamiento *a);
+static long tam_pagina(void);
+
+int ai_preparar(Aislamiento *a, int numero_hilos)
+{
+    memset(a, 0, sizeof(*a));
+    a->numero_hilos  = numero_hilos;
+    a->cpu_principal = -1;
+    a->prioridad     = sched_get_priority_min(SCHED_FIFO);
+
+    /* Primero el bloqueo, para que MCL_FUTURE cubra las pilas */
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+        a->memoria_bloqueada = 1;
+    } else {
+        a->errno_bloqueo = errno;
+    }
+
+    a->pilas         = (void **)calloc((size_t)numero_hilos, sizeof(void *));
+    a->involuntarios = (long *)calloc((size_t)numero_hilos, sizeof(long));
+    a->cpus_trabajo  = (int *)calloc(CPU_SETSIZE, sizeof(int));
+    if (a->pilas == NULL || a->involuntarios == NULL || a->cpus_trabajo == NULL) {
+        ai_liberar(a);
+        return -1;
+    }
+
+    size_t pagina = (size_t)tam_pagina();
+    for (int h = 0; h < numero_hilos; ++h) {
+        void *region = mmap(NULL, AI_TAM_PILA + pagina, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+        if (region == MAP_FAILED) {
+            ai_liberar(a);
+            return -1;
+        }
+        /* La pila crece hacia abajo: la guarda va al comienzo */
+        mprotect(region, pagina, PROT_NONE);
+        memset((char *)region + pagina, 0, AI_TAM_PILA);
+        a->pilas[h] = region;
+    }
+
+    a->tiempo_real = probar_tiempo_real(a->prioridad);
+    elegir_cpus(a);
+    return 0;
+}
+
+void ai_liberar(Aislamiento *a)
+{
+    if (a->pilas != NULL) {
+        size_t pagina = (size_t)tam_pagina();
+        for (int h = 0; h < a->numero_hilos; ++h) {
+            if (a->pilas[h] != NULL) {
+                munmap(a->pilas[h], AI_TAM_PILA + pagina);
+            }
+        }
+    }
+    free(a->pilas);
+    free(a->involuntarios);
+    free(a->cpus_trabajo);
+    a->pilas         = NULL;
+    a->involuntarios = NULL;
+    a->cpus_trabajo  = NULL;
+    if (a->memoria_bloqueada) {
+        munlockall();
+        a->memoria_bloqueada = 0;
+    }
+}
+
+int ai_atributos(const Aislamiento *a, int hilo, pthread_attr_t *atributos)
+{
+    size_t pagina = (size_t)tam_pagina();
+
+    if (pthread_attr_init(atributos) != 0) {
+        return -1;
+    }
+    pthread_attr_setstack(atributos, (char *)a->pilas[hilo] + pagina,
+                          AI_TAM_PILA);
+
+    if (a->num_cpus_trabajo > 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(a->cpus_trabajo[hilo % a->num_cpus_trabajo], &cpus);
+        pthread_attr_setaffinity_np(atributos, sizeof(cpus), &cpus);
+    }
+
+    if (a->tiempo_real) {
+        struct sched_param parametro = { .sched_priority = a->prioridad };
+        pthread_attr_setinheritsched(atributos, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(atributos, SCHED_FIFO);
+        pthread_attr_setschedparam(atributos, &parametro);
+    }
+    return 0;
+}
+
+long ai_involuntarios_hilo(void)
+{
+    struct rusage uso;
+
+    return (getrusage(RUSAGE_THREAD, &uso) == 0) ? uso.ru_nivcsw : 0;
+}
+
+long ai_involuntarios_proceso(void)
+{
+    struct rusage uso;
+
+    return (getrusage(RUSAGE_SELF, &uso) == 0) ? uso.ru_nivcsw : 0;
+}
+
+/*
+ * probar_tiempo_real
+ * -----------------------------------------
+ * Intenta pasar el hilo que llama a SCHED_FIFO y lo devuelve a su
+ * política original. Retorna 1 si el sistema lo permitió.
+ */
+static int probar_tiempo_real(int prioridad)
+{
+    struct sched_param original, fifo = { .sched_priority = prioridad };
+    int politica;
+
+    if (pthread_getschedparam(pthread_self(), &politica, &original) != 0 ||
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &fifo) != 0) {
+        return 0;
+    }
+    pthread_setschedparam(pthread_self(), politica, &original);
+    return 1;
+}
+
+/*
+ * elegir_cpus
+ * -----------------------------------------
+ * De las CPUs en las que el proceso puede correr, la primera queda
+ * para el hilo principal (que se fija en ella) y el resto para los
+ * trabajadores. Con una sola CPU no hay separación posible: los
+ * trabajadores no se fijan y el principal tampoco.
+ */
+static void elegir_cpus(Aislamiento *a)
+{
+    cpu_set_t permitidas;
+
+    a->num_cpus_trabajo = 0;
+    if (sched_getaffinity(0, sizeof(permitidas), &permitidas) != 0 ||
+        CPU_COUNT(&permitidas) < 2) {
+        return;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &permitidas)) {
+            continue;
+        }
+        if (a->cpu_principal < 0) {
+            a->cpu_principal = cpu;
+        } else {
+            a->cpus_trabajo[a->num_cpus_trabajo++] = cpu;
+        }
+    }
+
+    cpu_set_t principal;
+    CPU_ZERO(&principal);
+    CPU_SET(a->cpu_principal, &principal);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(principal), &principal) != 0) {
+        a->cpu_principal    = -1;
+        a->num_cpus_trabajo = 0;
+    }
+}
+
+static long tam_pagina(void)
+{
+    long pagina = sysconf(_SC_PAGESIZE);
+
+    return (pagina > 0) ? pagina : 4096;
+}
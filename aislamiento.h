@@ -0,0 +1,63 @@
+/*
+ * aislamiento.h
+ * -----------------------------------------
+ * Modo de medición con poco ruido (jitter) para pi_p: reduce lo que
+ * puede interrumpir a los hilos trabajadores mientras calculan.
+ *
+ *  - mlockall(MCL_CURRENT | MCL_FUTURE): ninguna página del proceso
+ *    sale de memoria ni se carga por primera vez a mitad del cálculo.
+ *  - Pilas propias de AI_TAM_PILA bytes (más una página de guarda),
+ *    escritas completas antes de crear los hilos.
+ *  - Los trabajadores, si el sistema lo permite (root o
+ *    CAP_SYS_NICE), con SCHED_FIFO: solo otra tarea de tiempo real
+ *    puede desalojarlos.
+ *  - Con al menos 2 CPUs disponibles, el hilo principal queda fijo en
+ *    la primera y los trabajadores en las demás (por turnos), así el
+ *    principal no compite con ellos mientras espera en los join.
+ *
+ * Cada trabajador cuenta sus cambios de contexto involuntarios
+ * (getrusage con RUSAGE_THREAD): los que quedan después de todo lo
+ * anterior indican interrupciones que el modo no pudo evitar.
+ */
+
+#ifndef AISLAMIENTO_H
+#define AISLAMIENTO_H
+
+#include <pthread.h>
+
+#define AI_TAM_PILA (256 * 1024)
+
+typedef struct {
+    int    numero_hilos;
+    int    memoria_bloqueada;     /* mlockall tuvo éxito */
+    int    errno_bloqueo;         /* si no: el error */
+    int    tiempo_real;           /* SCHED_FIFO permitido */
+    int    prioridad;             /* prioridad SCHED_FIFO */
+    int    cpu_principal;         /* -1 si no se fijó */
+    int    num_cpus_trabajo;
+    int   *cpus_trabajo;          /* CPUs de los trabajadores */
+    void **pilas;                 /* una por hilo, con página de guarda */
+    long  *involuntarios;         /* por trabajador, de su última vida */
+} Aislamiento;
+
+/*
+ * ai_preparar: bloquea la memoria, reserva y pre-toca las pilas,
+ * prueba SCHED_FIFO y fija el hilo que llama (el principal). Lo que
+ * el sistema no permita queda anotado y se sigue sin ello. Retorna
+ * 0, o -1 si faltó memoria para las pilas.
+ */
+int  ai_preparar(Aislamiento *a, int numero_hilos);
+void ai_liberar(Aislamiento *a);
+
+/* Atributos para crear el trabajador 'hilo' (pila, CPU y política);
+ * se destruyen con pthread_attr_destroy */
+int  ai_atributos(const Aislamiento *a, int hilo, pthread_attr_t *atributos);
+
+/* Cambios de contexto involuntarios del hilo que llama, desde que
+ * empezó */
+long ai_involuntarios_hilo(void);
+
+/* Ídem, de todo el proceso (incluye hilos ya terminados) */
+long ai_involuntarios_proceso(void);
+
+#endif /* AISLAMIENTO_H */
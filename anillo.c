@@ -0,0 +1,490 @@
+/*
+ * anillo.c
+ * -----------------------------------------
+ * Implementación de la escritura con io_uring declarada en
+ * anillo.h.
+ *
+ * Las colas de envío (SQ) y de completados (CQ) son memoria
+ * compartida con el kernel: el programa escribe entradas en la SQ y
+ * avanza su cola; el kernel avanza la cola de la CQ y el programa
+ * su cabeza. Solo las colas que escribe el otro lado se leen con
+ * orden de adquisición, y las propias se publican con liberación.
+ */
+
+#define _GNU_SOURCE
+
+#include "anillo.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define MAX_BUFERES_ANILLO 32
+
+/* Alineación exigida por O_DIRECT (bloque lógico típico) */
+#define ALINEACION_DIRECTA 4096
+
+struct AnilloEscritura {
+    int       descriptor;
+    int       anillo;               /* descriptor de io_uring */
+    int       descriptor_directo;   /* propio, con O_DIRECT; -1 si no hay */
+    int       directo;              /* se escribe por descriptor_directo */
+    int       registrados;          /* búferes registrados: WRITE_FIXED */
+    int       error;
+    off_t     desplazamiento;       /* próximo byte a escribir */
+    size_t    tam_bufer;
+    int       num_buferes;
+    char     *memoria;              /* num_buferes * tam_bufer */
+    int       ocupado[MAX_BUFERES_ANILLO];   /* entregado o en vuelo */
+    size_t    longitudes[MAX_BUFERES_ANILLO];
+    size_t    escritos[MAX_BUFERES_ANILLO];  /* tras escrituras cortas */
+    off_t     destinos[MAX_BUFERES_ANILLO];
+    int       en_vuelo;
+    size_t    enviadas;
+    size_t    esperas;
+
+    /* Cola de envíos */
+    void                *sq_mapa;
+    size_t               sq_tam;
+    unsigned            *sq_cola;
+    unsigned            *sq_mascara;
+    unsigned            *sq_arreglo;
+    struct io_uring_sqe *sqes;
+    size_t               sqes_tam;
+
+    /* Cola de completados (puede compartir el mapeo de la SQ) */
+    void                *cq_mapa;
+    size_t               cq_tam;
+    unsigned            *cq_cabeza;
+    unsigned            *cq_cola;
+    unsigned            *cq_mascara;
+    struct io_uring_cqe *cqes;
+};
+
+/* Prototipos de funciones internas */
+static int  preparar_colas(AnilloEscritura *a, unsigned entradas);
+static int  encolar_escritura(AnilloEscritura *a, int b);
+static void liberar_anillo(AnilloEscritura *a);
+static int  procesar_completados(AnilloEscritura *a);
+static int  esperar_completado(AnilloEscritura *a);
+static int  esperar_todo(AnilloEscritura *a);
+static int  escribir_en(int descriptor, const char *datos, size_t longitud,
+                        off_t desplazamiento);
+static int  abrir_directo(int descriptor, int flags);
+
+AnilloEscritura *anillo_crear(int descriptor, size_t tam_bufer,
+                              int num_buferes, int directo)
+{
+    size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    int    flags  = fcntl(descriptor, F_GETFL);
+    off_t  inicio = lseek(descriptor, 0, SEEK_CUR);
+
+    /* Con O_APPEND el kernel ignora los desplazamientos */
+    if (flags < 0 || inicio < 0 || (flags & O_APPEND) || tam_bufer == 0) {
+        return NULL;
+    }
+
+    AnilloEscritura *a = (AnilloEscritura *)calloc(1, sizeof(AnilloEscritura));
+    if (a == NULL) {
+        return NULL;
+    }
+    a->descriptor         = descriptor;
+    a->descriptor_directo = -1;
+    a->anillo             = -1;
+    a->desplazamiento     = inicio;
+    a->tam_bufer        = (tam_bufer + pagina - 1) / pagina * pagina;
+    a->num_buferes      = (num_buferes < 2) ? 2
+                        : (num_buferes > MAX_BUFERES_ANILLO) ? MAX_BUFERES_ANILLO
+                        : num_buferes;
+
+    if (preparar_colas(a, (unsigned)a->num_buferes) != 0) {
+        liberar_anillo(a);
+        return NULL;
+    }
+
+    void *memoria = mmap(NULL, a->tam_bufer * (size_t)a->num_buferes,
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memoria == MAP_FAILED) {
+        liberar_anillo(a);
+        return NULL;
+    }
+    a->memoria = (char *)memoria;
+
+    struct iovec vectores[MAX_BUFERES_ANILLO];
+    for (int b = 0; b < a->num_buferes; ++b) {
+        vectores[b].iov_base = a->memoria + (size_t)b * a->tam_bufer;
+        vectores[b].iov_len  = a->tam_bufer;
+    }
+    a->registrados = (syscall(__NR_io_uring_register, a->anillo,
+                              IORING_REGISTER_BUFFERS, vectores,
+                              a->num_buferes) == 0);
+
+    /* O_DIRECT solo si el inicio está alineado y el archivo lo admite */
+    if (directo && inicio % ALINEACION_DIRECTA == 0 &&
+        a->tam_bufer % ALINEACION_DIRECTA == 0) {
+        a->descriptor_directo = abrir_directo(descriptor, flags);
+        a->directo            = (a->descriptor_directo >= 0);
+    }
+    return a;
+}
+
+int anillo_destruir(AnilloEscritura *a)
+{
+    int codigo = (esperar_todo(a) == 0 && !a->error) ? 0 : -1;
+
+    if (lseek(a->descriptor, a->desplazamiento, SEEK_SET) < 0) {
+        codigo = -1;
+    }
+    liberar_anillo(a);
+    return codigo;
+}
+
+/*
+ * anillo_obtener
+ * -----------------------------------------
+ * Primero recoge los completados sin bloquear; solo si todos los
+ * búferes siguen ocupados espera al kernel.
+ */
+char *anillo_obtener(AnilloEscritura *a)
+{
+    for (;;) {
+        if (procesar_completados(a) != 0) {
+            return NULL;
+        }
+        for (int b = 0; b < a->num_buferes; ++b) {
+            if (!a->ocupado[b]) {
+                a->ocupado[b] = 1;
+                return a->memoria + (size_t)b * a->tam_bufer;
+            }
+        }
+        if (a->en_vuelo == 0) {
+            return NULL;    /* todos obtenidos y ninguno enviado */
+        }
+        a->esperas++;
+        if (esperar_completado(a) != 0 || a->error) {
+            return NULL;
+        }
+    }
+}
+
+int anillo_enviar(AnilloEscritura *a, char *bufer, size_t longitud)
+{
+    int b = (int)((size_t)(bufer - a->memoria) / a->tam_bufer);
+
+    if (a->error) {
+        return -1;
+    }
+    if (longitud == 0) {
+        a->ocupado[b] = 0;
+        return 0;
+    }
+    if (a->directo && longitud % ALINEACION_DIRECTA != 0) {
+        int codigo = anillo_escribir(a, bufer, longitud);
+        a->ocupado[b] = 0;
+        return codigo;
+    }
+
+    a->longitudes[b] = longitud;
+    a->escritos[b]   = 0;
+    a->destinos[b]   = a->desplazamiento;
+    if (encolar_escritura(a, b) != 0) {
+        a->error = 1;
+        return -1;
+    }
+
+    a->desplazamiento += (off_t)longitud;
+    a->en_vuelo++;
+    return 0;
+}
+
+/*
+ * anillo_escribir
+ * -----------------------------------------
+ * Tras una escritura de longitud arbitraria los desplazamientos
+ * dejan de estar alineados, así que se deja O_DIRECT y se vuelve al
+ * descriptor del llamador. También si 'datos' no está alineado:
+ * O_DIRECT lo exige a la dirección.
+ */
+int anillo_escribir(AnilloEscritura *a, const char *datos, size_t longitud)
+{
+    if (esperar_todo(a) != 0 || a->error) {
+        return -1;
+    }
+    if (a->directo && (longitud % ALINEACION_DIRECTA != 0 ||
+                       (uintptr_t)datos % ALINEACION_DIRECTA != 0)) {
+        a->directo = 0;
+    }
+    int descriptor = a->directo ? a->descriptor_directo : a->descriptor;
+    if (escribir_en(descriptor, datos, longitud, a->desplazamiento) != 0) {
+        a->error = 1;
+        return -1;
+    }
+    a->desplazamiento += (off_t)longitud;
+    return 0;
+}
+
+void anillo_estadisticas(const AnilloEscritura *a, size_t *enviadas,
+                         size_t *esperas)
+{
+    *enviadas = a->enviadas;
+    *esperas  = a->esperas;
+}
+
+/*
+ * preparar_colas
+ * -----------------------------------------
+ * io_uring_setup y los tres mapeos: anillo de la SQ, anillo de la
+ * CQ (el mismo si el kernel ofrece IORING_FEAT_SINGLE_MMAP) y el
+ * arreglo de entradas de envío.
+ */
+static int preparar_colas(AnilloEscritura *a, unsigned entradas)
+{
+    struct io_uring_params parametros;
+    memset(&parametros, 0, sizeof(parametros));
+
+    long anillo = syscall(__NR_io_uring_setup, entradas, &parametros);
+    if (anillo < 0) {
+        return -1;
+    }
+    a->anillo = (int)anillo;
+
+    a->sq_tam = parametros.sq_off.array + parametros.sq_entries * sizeof(unsigned);
+    a->cq_tam = parametros.cq_off.cqes +
+                parametros.cq_entries * sizeof(struct io_uring_cqe);
+    int unico = (parametros.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (unico && a->cq_tam > a->sq_tam) {
+        a->sq_tam = a->cq_tam;
+    }
+
+    a->sq_mapa = mmap(NULL, a->sq_tam, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, a->anillo, IORING_OFF_SQ_RING);
+    if (a->sq_mapa == MAP_FAILED) {
+        a->sq_mapa = NULL;
+        return -1;
+    }
+    if (unico) {
+        a->cq_mapa = a->sq_mapa;
+    } else {
+        a->cq_mapa = mmap(NULL, a->cq_tam, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, a->anillo,
+                          IORING_OFF_CQ_RING);
+        if (a->cq_mapa == MAP_FAILED) {
+            a->cq_mapa = NULL;
+            return -1;
+        }
+    }
+
+    a->sqes_tam = parametros.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(NULL, a->sqes_tam, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, a->anillo, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return -1;
+    }
+    a->sqes = (struct io_uring_sqe *)sqes;
+
+    char *sq = (char *)a->sq_mapa;
+    char *cq = (char *)a->cq_mapa;
+    a->sq_cola    = (unsigned *)(sq + parametros.sq_off.tail);
+    a->sq_mascara = (unsigned *)(sq + parametros.sq_off.ring_mask);
+    a->sq_arreglo = (unsigned *)(sq + parametros.sq_off.array);
+    a->cq_cabeza  = (unsigned *)(cq + parametros.cq_off.head);
+    a->cq_cola    = (unsigned *)(cq + parametros.cq_off.tail);
+    a->cq_mascara = (unsigned *)(cq + parametros.cq_off.ring_mask);
+    a->cqes       = (struct io_uring_cqe *)(cq + parametros.cq_off.cqes);
+    return 0;
+}
+
+/*
+ * liberar_anillo
+ * -----------------------------------------
+ * Cerrar el descriptor de io_uring anula también el registro. Si
+ * quedan escrituras en vuelo (esperar_todo falló porque
+ * io_uring_enter dejó de responder), el kernel todavía puede leer
+ * de los búferes: el anillo se cierra primero y la memoria de los
+ * búferes no se desproyecta, para que nunca se lea memoria ya
+ * liberada o reutilizada. Es una fuga acotada y solo ante ese error.
+ */
+static void liberar_anillo(AnilloEscritura *a)
+{
+    if (a->anillo >= 0) {
+        close(a->anillo);
+    }
+    if (a->memoria != NULL && a->en_vuelo == 0) {
+        munmap(a->memoria, a->tam_bufer * (size_t)a->num_buferes);
+    }
+    if (a->descriptor_directo >= 0) {
+        close(a->descriptor_directo);
+    }
+    if (a->sqes != NULL) {
+        munmap(a->sqes, a->sqes_tam);
+    }
+    if (a->cq_mapa != NULL && a->cq_mapa != a->sq_mapa) {
+        munmap(a->cq_mapa, a->cq_tam);
+    }
+    if (a->sq_mapa != NULL) {
+        munmap(a->sq_mapa, a->sq_tam);
+    }
+    free(a);
+}
+
+/*
+ * encolar_escritura
+ * -----------------------------------------
+ * Envía al anillo lo que falta escribir del búfer 'b': desde
+ * escritos[b] hasta longitudes[b], en destinos[b] + escritos[b].
+ * WRITE_FIXED admite cualquier tramo dentro del búfer registrado.
+ *
+ * Retorna 0 si el kernel aceptó la entrada, -1 si no.
+ */
+static int encolar_escritura(AnilloEscritura *a, int b)
+{
+    unsigned cola = *a->sq_cola;
+    unsigned i    = cola & *a->sq_mascara;
+    struct io_uring_sqe *sqe = &a->sqes[i];
+    char *datos = a->memoria + (size_t)b * a->tam_bufer + a->escritos[b];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode    = a->registrados ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd        = a->directo ? a->descriptor_directo : a->descriptor;
+    sqe->addr      = (uint64_t)(uintptr_t)datos;
+    sqe->len       = (uint32_t)(a->longitudes[b] - a->escritos[b]);
+    sqe->off       = (uint64_t)(a->destinos[b] + (off_t)a->escritos[b]);
+    sqe->buf_index = a->registrados ? (uint16_t)b : 0;
+    sqe->user_data = (uint64_t)b;
+    a->sq_arreglo[i] = i;
+    __atomic_store_n(a->sq_cola, cola + 1, __ATOMIC_RELEASE);
+
+    long enviados;
+    do {
+        enviados = syscall(__NR_io_uring_enter, a->anillo, 1, 0, 0, NULL, 0);
+    } while (enviados < 0 && errno == EINTR);
+    return (enviados == 1) ? 0 : -1;
+}
+
+/*
+ * procesar_completados
+ * -----------------------------------------
+ * Libera los búferes cuyas escrituras terminaron. El resto de una
+ * escritura corta (poco común en archivos) vuelve al anillo y el
+ * búfer sigue en vuelo. Con O_DIRECT el resto solo es válido si la
+ * parte escrita es múltiplo del bloque; si no, se reenvía (y con él
+ * lo que siga) por el descriptor del llamador, sin O_DIRECT, en
+ * lugar de usar un desplazamiento que el kernel rechazaría (EINVAL).
+ */
+static int procesar_completados(AnilloEscritura *a)
+{
+    unsigned cabeza = *a->cq_cabeza;
+    unsigned cola   = __atomic_load_n(a->cq_cola, __ATOMIC_ACQUIRE);
+
+    for (; cabeza != cola; ++cabeza) {
+        struct io_uring_cqe *cqe = &a->cqes[cabeza & *a->cq_mascara];
+        int b = (int)cqe->user_data;
+
+        if (cqe->res < 0) {
+            errno    = -cqe->res;
+            a->error = 1;
+        } else if (cqe->res == 0 && a->escritos[b] < a->longitudes[b]) {
+            errno    = EIO;     /* sin avance: no reintentar sin fin */
+            a->error = 1;
+        } else if ((size_t)cqe->res < a->longitudes[b] - a->escritos[b]) {
+            a->escritos[b] += (size_t)cqe->res;
+            if (a->directo && a->escritos[b] % ALINEACION_DIRECTA != 0) {
+                a->directo = 0;
+            }
+            if (encolar_escritura(a, b) == 0) {
+                continue;       /* el búfer sigue en vuelo */
+            }
+            a->error = 1;
+        }
+        a->ocupado[b] = 0;
+        a->en_vuelo--;
+        a->enviadas++;
+    }
+    __atomic_store_n(a->cq_cabeza, cabeza, __ATOMIC_RELEASE);
+
+    return a->error ? -1 : 0;
+}
+
+/*
+ * esperar_completado
+ * -----------------------------------------
+ * Bloquea hasta que termine al menos una escritura. Retorna -1 solo
+ * si io_uring_enter falla; los errores de escritura quedan en
+ * a->error.
+ */
+static int esperar_completado(AnilloEscritura *a)
+{
+    long codigo;
+
+    do {
+        codigo = syscall(__NR_io_uring_enter, a->anillo, 0, 1,
+                         IORING_ENTER_GETEVENTS, NULL, 0);
+    } while (codigo < 0 && errno == EINTR);
+    if (codigo < 0) {
+        a->error = 1;
+        return -1;
+    }
+    procesar_completados(a);
+    return 0;
+}
+
+/* Aun después de un error se esperan todas: el kernel sigue leyendo
+ * de los búferes hasta completarlas */
+static int esperar_todo(AnilloEscritura *a)
+{
+    while (a->en_vuelo > 0) {
+        if (esperar_completado(a) != 0) {
+            return -1;
+        }
+    }
+    procesar_completados(a);
+    return a->error ? -1 : 0;
+}
+
+/* pwrite(2) hasta entregar todo */
+static int escribir_en(int descriptor, const char *datos, size_t longitud,
+                       off_t desplazamiento)
+{
+    while (longitud > 0) {
+        ssize_t escritos = pwrite(descriptor, datos, longitud, desplazamiento);
+        if (escritos < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        datos          += escritos;
+        longitud       -= (size_t)escritos;
+        desplazamiento += escritos;
+    }
+    return 0;
+}
+
+/*
+ * abrir_directo
+ * -----------------------------------------
+ * Abre el mismo archivo en una descripción de archivo abierto nueva
+ * (por /proc/self/fd, que apunta al archivo abierto y no a una
+ * ruta) con O_DIRECT. Activarlo con F_SETFL sobre
+ * 'descriptor' cambiaría también la descripción que el llamador
+ * comparte con otros procesos (por ejemplo, una salida estándar
+ * heredada). Retorna el descriptor, o -1 si /proc no está
+ * disponible o el sistema de archivos no admite O_DIRECT.
+ */
+static int abrir_directo(int descriptor, int flags)
+{
+    char ruta[32];
+    int  acceso = ((flags & O_ACCMODE) == O_RDWR) ? O_RDWR : O_WRONLY;
+
+    snprintf(ruta, sizeof(ruta), "/proc/self/fd/%d", descriptor);
+    return open(ruta, acceso | O_DIRECT | O_CLOEXEC);
+}
@@ -0,0 +1,70 @@
+/*
+ * anillo.h
+ * -----------------------------------------
+ * Escritura asíncrona a archivos con io_uring.
+ *
+ * Un AnilloEscritura administra un conjunto de búferes alineados a
+ * página. Mientras uno se llena, los ya entregados se escriben en
+ * segundo plano, cada uno en su desplazamiento fijo del archivo, así
+ * que el formateo y la E/S de disco se solapan y el productor solo
+ * espera si todos los búferes están en vuelo.
+ *
+ * Se usan las llamadas al sistema directamente (io_uring_setup,
+ * io_uring_enter, io_uring_register), sin liburing. Los búferes se
+ * registran en el kernel (IORING_REGISTER_BUFFERS) para usar
+ * IORING_OP_WRITE_FIXED; si el registro falla, por ejemplo por el
+ * límite de memoria bloqueada, se usa IORING_OP_WRITE.
+ *
+ * Con 'directo' el archivo se escribe con O_DIRECT, sin pasar por
+ * la caché de páginas, a través de un descriptor propio reabierto
+ * desde /proc/self/fd: los flags del descriptor del llamador (cuya
+ * descripción de archivo abierto puede compartir, como una salida
+ * estándar heredada) nunca se modifican. O_DIRECT requiere
+ * desplazamientos y longitudes múltiplos del bloque: los envíos
+ * completos lo son, y la escritura final (o cualquier escritura
+ * síncrona de tamaño o dirección no alineados) se hace por el
+ * descriptor del llamador. El resto de una escritura corta se
+ * vuelve a enviar por el anillo; si ya no está alineado, también
+ * por el descriptor del llamador.
+ */
+
+#ifndef ANILLO_H
+#define ANILLO_H
+
+#include <stddef.h>
+
+typedef struct AnilloEscritura AnilloEscritura;
+
+/*
+ * anillo_crear: 'num_buferes' búferes de 'tam_bufer' bytes (múltiplo
+ * de la página) para escribir en 'descriptor' a partir de su
+ * posición actual. Retorna NULL si io_uring no está disponible o el
+ * descriptor no admite escrituras en desplazamientos fijos (no es
+ * posicionable o tiene O_APPEND); el llamador debe seguir con
+ * escrituras bloqueantes. Si se pidió 'directo' pero el archivo no
+ * admite O_DIRECT, no puede reabrirse o su posición no está
+ * alineada, se escribe sin O_DIRECT.
+ * anillo_destruir: espera las escrituras pendientes, deja la
+ * posición del descriptor al final de lo escrito y libera todo.
+ */
+AnilloEscritura *anillo_crear(int descriptor, size_t tam_bufer,
+                              int num_buferes, int directo);
+int              anillo_destruir(AnilloEscritura *a);
+
+/* Búfer libre para llenar (espera una escritura si hace falta);
+ * NULL si una escritura anterior falló */
+char *anillo_obtener(AnilloEscritura *a);
+
+/* Escribe 'longitud' bytes de un búfer obtenido con anillo_obtener
+ * a continuación de lo anterior, sin esperar */
+int   anillo_enviar(AnilloEscritura *a, char *bufer, size_t longitud);
+
+/* Espera lo pendiente y escribe 'datos' de forma bloqueante */
+int   anillo_escribir(AnilloEscritura *a, const char *datos, size_t longitud);
+
+/* Escrituras asíncronas completadas y veces que hubo que esperar un
+ * búfer libre */
+void  anillo_estadisticas(const AnilloEscritura *a, size_t *enviadas,
+                          size_t *esperas);
+
+#endif /* ANILLO_H */
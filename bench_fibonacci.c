@@ -0,0 +1,1520 @@
+/*
+ * bench_fibonacci.c
+ * -----------------------------------------
+ * Mediciones de rendimiento para las rutinas de Fibonacci.
+ *
+ * Cada subcomando mide una parte del camino de cálculo o de
+ * salida y muestra una tabla por la salida estándar.
+ *
+ * Uso:
+ *      ./bench_fibonacci decimal [digitos_max] [hilos]
+ *      ./bench_fibonacci multiplicacion [palabras_max] [hilos]
+ *      ./bench_fibonacci dispersa [N] [consultas] [hilos]
+ *      ./bench_fibonacci formato [valores]
+ *      ./bench_fibonacci tuberia [MiB]
+ *      ./bench_fibonacci archivo [MiB] [ruta]
+ *      ./bench_fibonacci suite [csv|json] [escala]
+ *
+ * Subcomandos:
+ *  - decimal: velocidad (dígitos/s) de la conversión a decimal de
+ *    F(k) para tamaños crecientes hasta 'digitos_max' (por defecto
+ *    1 000 000), comparando divisiones repetidas (ingenua) con
+ *    divide y vencerás en 1 y en 'hilos' hilos (por defecto 4).
+ *  - multiplicacion: tiempo de cada algoritmo de multiplicación
+ *    (escolar, Karatsuba, Toom-3, NTT con 'hilos' hilos) para
+ *    operandos de igual tamaño hasta 'palabras_max' palabras (por
+ *    defecto 65 536) y umbrales sugeridos para esta máquina, en el
+ *    formato de ENTERO_GRANDE_UMBRALES.
+ *  - dispersa: compromiso memoria/cómputo del almacenamiento con
+ *    puntos de control (dispersa.h) para F(0)..F(N-1) (por defecto
+ *    N = 20 000) y pasos K = 1, 4, 16, ...: memoria ocupada, tiempo
+ *    de construcción, latencia de 'consultas' accesos aleatorios
+ *    repartidos en 'hilos' hilos (por defecto 20 000 y 4) y costo
+ *    por término de un recorrido secuencial.
+ *  - formato: velocidad (valores/s y MB/s) al formatear 'valores'
+ *    enteros de 64 bits (por defecto 1 000 000) separados por
+ *    espacios con sprintf, con la tabla de pares escalar y con los
+ *    formateadores SSE2 y AVX2 de formato_decimal.c, para términos
+ *    de Fibonacci mod 2^64 y para longitudes mezcladas.
+ *  - tuberia: GB/s al escribir 'MiB' MiB (por defecto 4096) de
+ *    términos ya formateados por una tubería hacia un proceso hijo,
+ *    con write(2) y con vmsplice(2) (ver salida.h). El hijo pasa lo
+ *    recibido con splice(2) a una segunda tubería, como pv, y lo
+ *    compara con lo escrito; si difiere, el modo se informa como
+ *    erróneo.
+ *  - archivo: GB/s al escribir 'MiB' MiB (por defecto 1024) de
+ *    términos formateados al archivo 'ruta' (por defecto
+ *    bench_salida.tmp, que se borra al final) con write(2), con
+ *    io_uring y con io_uring + O_DIRECT, incluyendo el fsync final
+ *    para que la caché de páginas no oculte la escritura a disco.
+ *  - suite: batería completa en formato CSV (por defecto) o JSON,
+ *    pensada para cargarse en analisis.ipynb. Un registro por
+ *    medición (grupo, caso, n, métrica, valor):
+ *      - calculo: términos/s al generar la sucesión completa en cada
+ *        representación: u64 (módulo 2^64, rec_llenar), u128,
+ *        modular (módulo 10^9 + 7, rec_llenar) y grande
+ *        (EnteroGrande, como trabajador_fibonacci).
+ *      - salida: términos/s y MB/s al imprimir términos de 64 bits
+ *        por una tubería con fprintf, con Salida y write(2) y con
+ *        Salida y vmsplice(2).
+ *      - memoria: bytes ocupados por la sucesión completa en cada
+ *        representación y con puntos de control (dispersa.h, K = 64).
+ *      - consulta: latencia de un único término F(N): completo
+ *        (eg_fibonacci), completo y en decimal, y módulo 10^9 + 7
+ *        (rec_termino).
+ *    'escala' (por defecto 1) multiplica los N de calculo y salida.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dispersa.h"
+#include "entero_grande.h"
+#include "formato_decimal.h"
+#include "recurrencia.h"
+#include "salida.h"
+
+/* Tiempo mínimo acumulado por medición, en segundos */
+static const double TIEMPO_MINIMO_MEDICION = 0.2;
+
+/* Por encima de este tamaño la conversión ingenua tarda demasiado */
+static const size_t LIMITE_DIGITOS_INGENUO = 1000000;
+
+/* Ídem para la multiplicación escolar, en palabras */
+static const size_t LIMITE_PALABRAS_ESCOLAR = 8192;
+
+#define NUM_ALGORITMOS 4
+
+static const AlgoritmoMultiplicacion ALGORITMOS[NUM_ALGORITMOS] = {
+    EG_MUL_ESCOLAR, EG_MUL_KARATSUBA, EG_MUL_TOOM3, EG_MUL_NTT
+};
+static const char *const NOMBRES_ALGORITMOS[NUM_ALGORITMOS] = {
+    "escolar", "karatsuba", "toom3", "ntt"
+};
+
+/* Módulo del caso "modular" de la suite */
+#define MODULO_SUITE 1000000007ULL
+
+/* Destino de los resultados de la suite, para que no se descarten */
+static volatile uint64_t sumidero;
+
+/* Registros que puede acumular la suite */
+#define MAX_REGISTROS_SUITE 128
+
+/*
+ * RegistroSuite
+ * -----------------------------------------
+ * Una medición de la suite. La unidad va en el nombre de la métrica
+ * (terminos_por_s, mb_por_s, bytes, segundos).
+ */
+typedef struct {
+    const char *grupo;
+    const char *caso;
+    uint64_t    n;
+    const char *metrica;
+    double      valor;
+} RegistroSuite;
+
+/* Pasos K medidos en el subcomando dispersa */
+#define NUM_PASOS_DISPERSA 7
+
+static const uint64_t PASOS_DISPERSA[NUM_PASOS_DISPERSA] = {
+    1, 4, 16, 64, 256, 1024, 4096
+};
+
+/*
+ * ConsultasDispersa
+ * -----------------------------------------
+ * Trabajo de un hilo del subcomando dispersa: 'cantidad' accesos
+ * aleatorios (semilla propia) sobre 'secuencia'.
+ */
+typedef struct {
+    const SecuenciaDispersa *secuencia;
+    uint64_t                 cantidad;
+    uint64_t                 semilla;
+    int                      error;
+} ConsultasDispersa;
+
+/* Prototipos de funciones internas */
+static int    bench_decimal(int argc, char **argv);
+static int    bench_multiplicacion(int argc, char **argv);
+static int    bench_dispersa(int argc, char **argv);
+static void  *consultar_dispersa(void *argumento);
+static int    bench_formato(int argc, char **argv);
+static size_t formatear_sprintf(const uint64_t *valores, size_t cantidad,
+                                char *destino);
+static int    bench_tuberia(int argc, char **argv);
+static double medir_tuberia(ModoSalida modo, const char *texto, size_t tam,
+                            size_t total, const char **nombre);
+static int    bench_archivo(int argc, char **argv);
+static double medir_archivo(ModoSalida modo, const char *ruta,
+                            const char *texto, size_t tam, size_t total,
+                            const char **nombre);
+static char  *texto_de_prueba(size_t *tam);
+static int    bench_suite(int argc, char **argv);
+static double medir_calculo(const char *caso, uint64_t n, size_t *bytes);
+static double medir_salida(const char *caso, const uint64_t *valores,
+                           size_t cantidad, size_t *bytes);
+static double medir_consulta(const char *caso, uint64_t n);
+static pid_t  lanzar_lector(int *escritura);
+static pid_t  lanzar_verificador(int *escritura, const char *texto,
+                                 size_t tam, size_t total);
+static void   agregar_registro(RegistroSuite *registros, int *num,
+                               const char *grupo, const char *caso,
+                               uint64_t n, const char *metrica, double valor);
+static void   mostrar_registros(const RegistroSuite *registros, int num,
+                                int json);
+static double medir_conversion(const EnteroGrande *x, char *destino,
+                               int hilos, int ingenuo, size_t *digitos);
+static double medir_producto(EnteroGrande *r, const EnteroGrande *a,
+                             const EnteroGrande *b,
+                             AlgoritmoMultiplicacion algoritmo);
+static size_t cruce(const size_t *tamanos, const double *lento,
+                    const double *rapido, int num_tamanos);
+static void   llenar_aleatorio(EnteroGrande *x, size_t palabras,
+                               uint64_t *estado);
+static double obtener_tiempo(void);
+static void   mostrar_uso(const char *nombre_programa);
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "decimal") == 0) {
+        return bench_decimal(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "multiplicacion") == 0) {
+        return bench_multiplicacion(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "dispersa") == 0) {
+        return bench_dispersa(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "formato") == 0) {
+        return bench_formato(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "tuberia") == 0) {
+        return bench_tuberia(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "archivo") == 0) {
+        return bench_archivo(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "suite") == 0) {
+        return bench_suite(argc - 2, argv + 2);
+    }
+
+    mostrar_uso(argv[0]);
+    return EXIT_FAILURE;
+}
+
+/*
+ * mostrar_uso
+ * -----------------------------------------
+ * Muestra un mensaje de ayuda con el formato de uso del programa.
+ */
+static void mostrar_uso(const char *nombre_programa)
+{
+    fprintf(stderr,
+            "Uso:\n"
+            "  %s decimal [digitos_max] [hilos]\n"
+            "  %s multiplicacion [palabras_max] [hilos]\n"
+            "  %s dispersa [N] [consultas] [hilos]\n"
+            "  %s formato [valores]\n"
+            "  %s tuberia [MiB]\n"
+            "  %s archivo [MiB] [ruta]\n"
+            "  %s suite [csv|json] [escala]\n",
+            nombre_programa, nombre_programa, nombre_programa,
+            nombre_programa, nombre_programa, nombre_programa,
+            nombre_programa);
+}
+
+/*
+ * bench_decimal
+ * -----------------------------------------
+ * Convierte F(k) con k tal que F(k) tenga ~10^3, ~3*10^3, ... dígitos
+ * y reporta dígitos/s para cada método. Verifica además que todos
+ * los métodos produzcan el mismo texto.
+ */
+static int bench_decimal(int argc, char **argv)
+{
+    size_t digitos_max = 1000000;
+    int    hilos       = 4;
+
+    if (argc >= 1) {
+        digitos_max = (size_t)atoll(argv[0]);
+    }
+    if (argc >= 2) {
+        hilos = atoi(argv[1]);
+    }
+    if (digitos_max < 1000 || hilos <= 0) {
+        fprintf(stderr, "Error: se requiere digitos_max >= 1000 y hilos > 0.\n");
+        return EXIT_FAILURE;
+    }
+
+    /* F(k) tiene aproximadamente k * log10(phi) dígitos */
+    const double log10_phi = log10((1.0 + sqrt(5.0)) / 2.0);
+
+    printf("%12s %16s %16s %16s %10s\n",
+           "digitos", "ingenuo (d/s)", "dyv 1 hilo", "dyv hilos", "mejora");
+
+    for (double objetivo = 1000.0; objetivo <= (double)digitos_max * 1.0001;
+         objetivo *= sqrt(10.0)) {
+        uint64_t k = (uint64_t)(objetivo / log10_phi);
+
+        EnteroGrande x, siguiente;
+        eg_iniciar(&x);
+        eg_iniciar(&siguiente);
+        if (eg_fibonacci(k, &x, &siguiente) != 0) {
+            fprintf(stderr, "Error: memoria insuficiente para F(%llu).\n",
+                    (unsigned long long)k);
+            return EXIT_FAILURE;
+        }
+        eg_liberar(&siguiente);
+
+        size_t tam = eg_digitos_maximos(&x);
+        char *referencia = (char *)malloc(tam);
+        char *texto      = (char *)malloc(tam);
+        if (referencia == NULL || texto == NULL) {
+            perror("Error en malloc para la conversión");
+            return EXIT_FAILURE;
+        }
+
+        size_t digitos = 0, digitos_texto = 0;
+        double t_dyv_1 = medir_conversion(&x, referencia, 1, 0, &digitos);
+        double t_dyv_h = medir_conversion(&x, texto, hilos, 0, &digitos_texto);
+        int coinciden = (digitos == digitos_texto &&
+                         memcmp(referencia, texto, digitos) == 0);
+
+        double t_ingenuo = -1.0;
+        if (digitos <= LIMITE_DIGITOS_INGENUO) {
+            t_ingenuo = medir_conversion(&x, texto, 1, 1, &digitos_texto);
+            coinciden = coinciden && digitos == digitos_texto &&
+                        memcmp(referencia, texto, digitos) == 0;
+        }
+
+        if (!coinciden) {
+            fprintf(stderr, "Error: los métodos difieren para F(%llu).\n",
+                    (unsigned long long)k);
+            return EXIT_FAILURE;
+        }
+
+        if (t_ingenuo > 0.0) {
+            printf("%12zu %16.3e %16.3e %16.3e %9.2fx\n",
+                   digitos, (double)digitos / t_ingenuo,
+                   (double)digitos / t_dyv_1, (double)digitos / t_dyv_h,
+                   t_ingenuo / t_dyv_h);
+        } else {
+            printf("%12zu %16s %16.3e %16.3e %10s\n",
+                   digitos, "-",
+                   (double)digitos / t_dyv_1, (double)digitos / t_dyv_h, "-");
+        }
+        fflush(stdout);
+
+        free(referencia);
+        free(texto);
+        eg_liberar(&x);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * bench_multiplicacion
+ * -----------------------------------------
+ * Multiplica operandos aleatorios de 8, 16, ..., palabras_max
+ * palabras con cada algoritmo forzado, verifica que coincidan y
+ * muestra el tiempo por producto. Al final sugiere cada umbral como
+ * el menor tamaño desde el cual el algoritmo más rápido gana en
+ * todas las mediciones mayores.
+ */
+static int bench_multiplicacion(int argc, char **argv)
+{
+    size_t palabras_max = 65536;
+    int    hilos        = 4;
+
+    if (argc >= 1) {
+        palabras_max = (size_t)atoll(argv[0]);
+    }
+    if (argc >= 2) {
+        hilos = atoi(argv[1]);
+    }
+    if (palabras_max < 8 || hilos <= 0) {
+        fprintf(stderr, "Error: se requiere palabras_max >= 8 y hilos > 0.\n");
+        return EXIT_FAILURE;
+    }
+    eg_configurar_hilos(hilos);
+
+    enum { MAX_TAMANOS = 64 };
+    size_t tamanos[MAX_TAMANOS];
+    double tiempos[NUM_ALGORITMOS][MAX_TAMANOS];
+    int    num_tamanos = 0;
+    uint64_t estado = 0x9E3779B97F4A7C15ULL;
+
+    printf("%10s", "palabras");
+    for (int j = 0; j < NUM_ALGORITMOS; ++j) {
+        printf(" %14s", NOMBRES_ALGORITMOS[j]);
+    }
+    printf("   (segundos por producto)\n");
+
+    for (size_t n = 8; n <= palabras_max && num_tamanos < MAX_TAMANOS; n *= 2) {
+        EnteroGrande a, b, r, referencia;
+        eg_iniciar(&a);
+        eg_iniciar(&b);
+        eg_iniciar(&r);
+        eg_iniciar(&referencia);
+        llenar_aleatorio(&a, n, &estado);
+        llenar_aleatorio(&b, n, &estado);
+
+        printf("%10zu", n);
+        for (int j = 0; j < NUM_ALGORITMOS; ++j) {
+            tiempos[j][num_tamanos] = -1.0;
+            if (ALGORITMOS[j] == EG_MUL_ESCOLAR && n > LIMITE_PALABRAS_ESCOLAR) {
+                printf(" %14s", "-");
+                continue;
+            }
+
+            tiempos[j][num_tamanos] = medir_producto(&r, &a, &b, ALGORITMOS[j]);
+            if (referencia.longitud == 0) {
+                eg_copiar(&referencia, &r);
+            } else if (eg_comparar(&referencia, &r) != 0) {
+                fprintf(stderr, "\nError: %s difiere con %zu palabras.\n",
+                        NOMBRES_ALGORITMOS[j], n);
+                return EXIT_FAILURE;
+            }
+            printf(" %14.3e", tiempos[j][num_tamanos]);
+            fflush(stdout);
+        }
+        printf("\n");
+        tamanos[num_tamanos++] = n;
+
+        eg_liberar(&a);
+        eg_liberar(&b);
+        eg_liberar(&r);
+        eg_liberar(&referencia);
+    }
+
+    /* Cada algoritmo compite contra el anterior en la cadena */
+    size_t karatsuba = cruce(tamanos, tiempos[0], tiempos[1], num_tamanos);
+    size_t toom3     = cruce(tamanos, tiempos[1], tiempos[2], num_tamanos);
+    size_t ntt       = cruce(tamanos, tiempos[2], tiempos[3], num_tamanos);
+
+    UmbralesMultiplicacion actuales;
+    eg_obtener_umbrales(&actuales);
+
+    printf("\nUmbrales actuales : karatsuba=%zu toom3=%zu ntt=%zu\n",
+           actuales.karatsuba, actuales.toom3, actuales.ntt);
+    printf("Umbrales sugeridos: karatsuba=%zu toom3=%zu ntt=%zu\n",
+           karatsuba, toom3, ntt);
+    printf("ENTERO_GRANDE_UMBRALES=%zu,%zu,%zu\n", karatsuba, toom3, ntt);
+    return EXIT_SUCCESS;
+}
+
+/*
+ * bench_dispersa
+ * -----------------------------------------
+ * Para cada paso K construye la secuencia dispersa, verifica una
+ * muestra de términos contra eg_fibonacci y mide:
+ *  - memoria de los puntos de control (K = 1 equivale al arreglo
+ *    completo),
+ *  - latencia media de un acceso aleatorio con 'hilos' hilos, cada
+ *    uno con su caché LRU,
+ *  - costo por término de recorrer F(0)..F(N-1) en orden, donde la
+ *    caché convierte cada acceso en una sola suma.
+ */
+static int bench_dispersa(int argc, char **argv)
+{
+    uint64_t cantidad  = 20000;
+    uint64_t consultas = 20000;
+    int      hilos     = 4;
+
+    if (argc >= 1) {
+        cantidad = (uint64_t)atoll(argv[0]);
+    }
+    if (argc >= 2) {
+        consultas = (uint64_t)atoll(argv[1]);
+    }
+    if (argc >= 3) {
+        hilos = atoi(argv[2]);
+    }
+    if (cantidad < 2 || consultas == 0 || hilos <= 0 || hilos > 64) {
+        fprintf(stderr, "Error: se requiere N >= 2, consultas > 0 "
+                        "y 0 < hilos <= 64.\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%8s %14s %14s %16s %16s\n", "paso", "memoria (MiB)",
+           "construir (s)", "aleatorio (us)", "secuencial (us)");
+
+    for (int p = 0; p < NUM_PASOS_DISPERSA; ++p) {
+        uint64_t paso = PASOS_DISPERSA[p];
+        if (paso > cantidad) {
+            break;
+        }
+
+        SecuenciaDispersa secuencia;
+        double inicio = obtener_tiempo();
+        if (sd_construir(&secuencia, cantidad, paso) != 0) {
+            fprintf(stderr, "Error: memoria insuficiente para N = %llu.\n",
+                    (unsigned long long)cantidad);
+            return EXIT_FAILURE;
+        }
+        double t_construir = obtener_tiempo() - inicio;
+
+        /* Verificación: extremos, un punto de control y su vecino */
+        uint64_t muestra[4] = { 0, cantidad - 1, cantidad / 2,
+                                (cantidad / 2 / paso) * paso + paso / 2 };
+        EnteroGrande obtenido, esperado, siguiente;
+        eg_iniciar(&obtenido);
+        eg_iniciar(&esperado);
+        eg_iniciar(&siguiente);
+        for (int m = 0; m < 4; ++m) {
+            if (sd_obtener(&secuencia, muestra[m], &obtenido) != 0 ||
+                eg_fibonacci(muestra[m], &esperado, &siguiente) != 0 ||
+                eg_comparar(&obtenido, &esperado) != 0) {
+                fprintf(stderr, "Error: F(%llu) difiere con paso %llu.\n",
+                        (unsigned long long)muestra[m],
+                        (unsigned long long)paso);
+                return EXIT_FAILURE;
+            }
+        }
+        eg_liberar(&esperado);
+        eg_liberar(&siguiente);
+
+        /* Accesos aleatorios repartidos entre los hilos */
+        pthread_t         ids[64];
+        ConsultasDispersa trabajos[64];
+        inicio = obtener_tiempo();
+        for (int h = 0; h < hilos; ++h) {
+            trabajos[h].secuencia = &secuencia;
+            trabajos[h].cantidad  = consultas / (uint64_t)hilos +
+                                    ((uint64_t)h < consultas % (uint64_t)hilos);
+            trabajos[h].semilla   = 0x9E3779B97F4A7C15ULL * (uint64_t)(h + 1);
+            trabajos[h].error     = 0;
+            if (pthread_create(&ids[h], NULL, consultar_dispersa,
+                               &trabajos[h]) != 0) {
+                fprintf(stderr, "Error al crear el hilo %d.\n", h);
+                return EXIT_FAILURE;
+            }
+        }
+        int fallo = 0;
+        for (int h = 0; h < hilos; ++h) {
+            pthread_join(ids[h], NULL);
+            fallo |= trabajos[h].error;
+        }
+        double t_aleatorio = obtener_tiempo() - inicio;
+
+        /* Recorrido secuencial en el hilo principal */
+        inicio = obtener_tiempo();
+        for (uint64_t i = 0; i < cantidad && !fallo; ++i) {
+            fallo = (sd_obtener(&secuencia, i, &obtenido) != 0);
+        }
+        double t_secuencial = obtener_tiempo() - inicio;
+
+        if (fallo) {
+            fprintf(stderr, "Error: memoria insuficiente en las consultas.\n");
+            return EXIT_FAILURE;
+        }
+
+        printf("%8llu %14.2f %14.3f %16.2f %16.3f\n",
+               (unsigned long long)paso,
+               (double)sd_bytes(&secuencia) / (1024.0 * 1024.0),
+               t_construir, t_aleatorio * 1e6 / (double)consultas,
+               t_secuencial * 1e6 / (double)cantidad);
+        fflush(stdout);
+
+        eg_liberar(&obtenido);
+        sd_liberar(&secuencia);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * consultar_dispersa
+ * -----------------------------------------
+ * Hilo del subcomando dispersa: accesos a índices uniformes en
+ * [0, N) generados con xorshift64.
+ */
+static void *consultar_dispersa(void *argumento)
+{
+    ConsultasDispersa *trabajo = (ConsultasDispersa *)argumento;
+    uint64_t estado = trabajo->semilla;
+    EnteroGrande termino;
+    eg_iniciar(&termino);
+
+    for (uint64_t c = 0; c < trabajo->cantidad; ++c) {
+        estado ^= estado << 13;
+        estado ^= estado >> 7;
+        estado ^= estado << 17;
+        if (sd_obtener(trabajo->secuencia,
+                       estado % trabajo->secuencia->cantidad, &termino) != 0) {
+            trabajo->error = 1;
+            break;
+        }
+    }
+
+    eg_liberar(&termino);
+    return NULL;
+}
+
+/*
+ * bench_formato
+ * -----------------------------------------
+ * Dos conjuntos de datos: F(0..n-1) mod 2^64 (casi todos de 19 o
+ * 20 dígitos, como en --flujo) y valores de 1 a 20 dígitos al azar.
+ * Cada implementación debe producir exactamente el texto de
+ * sprintf; se reporta el mejor de varios recorridos completos.
+ */
+static int bench_formato(int argc, char **argv)
+{
+    size_t cantidad = 1000000;
+
+    if (argc >= 1) {
+        cantidad = (size_t)atoll(argv[0]);
+    }
+    if (cantidad == 0) {
+        fprintf(stderr, "Error: se requiere valores > 0.\n");
+        return EXIT_FAILURE;
+    }
+
+    uint64_t *valores    = (uint64_t *)malloc(sizeof(uint64_t) * cantidad);
+    char     *referencia = (char *)malloc(cantidad * (FD_MAX_DIGITOS_U64 + 1));
+    char     *texto      = (char *)malloc(cantidad * (FD_MAX_DIGITOS_U64 + 1));
+    if (valores == NULL || referencia == NULL || texto == NULL) {
+        perror("Error en malloc para los valores");
+        return EXIT_FAILURE;
+    }
+
+    static const char *const CONJUNTOS[2] = { "fibonacci", "mezcla" };
+    static const ImplementacionFormato IMPLEMENTACIONES[3] = {
+        FD_ESCALAR, FD_SSE2, FD_AVX2
+    };
+
+    printf("Implementación automática: %s\n\n",
+           fd_nombre_implementacion(FD_AUTOMATICA));
+    printf("%10s %10s %16s %12s %10s\n",
+           "datos", "metodo", "valores/s", "MB/s", "mejora");
+
+    for (int c = 0; c < 2; ++c) {
+        uint64_t actual = 0, siguiente = 1, estado = 88172645463325252ULL;
+        for (size_t i = 0; i < cantidad; ++i) {
+            if (c == 0) {
+                valores[i] = actual;
+                uint64_t nuevo = actual + siguiente;
+                actual    = siguiente;
+                siguiente = nuevo;
+            } else {
+                estado ^= estado << 13;
+                estado ^= estado >> 7;
+                estado ^= estado << 17;
+                int digitos = (int)(estado % FD_MAX_DIGITOS_U64) + 1;
+                valores[i] = (digitos == FD_MAX_DIGITOS_U64)
+                                 ? estado
+                                 : estado % (uint64_t)pow(10.0, digitos);
+            }
+        }
+
+        /* sprintf: referencia de corrección y de velocidad */
+        size_t bytes = 0;
+        double t_sprintf = 1e30;
+        for (double total = 0.0; total < TIEMPO_MINIMO_MEDICION;) {
+            double inicio = obtener_tiempo();
+            bytes = formatear_sprintf(valores, cantidad, referencia);
+            double t = obtener_tiempo() - inicio;
+            total += t;
+            t_sprintf = (t < t_sprintf) ? t : t_sprintf;
+        }
+        printf("%10s %10s %16.3e %12.1f %10s\n", CONJUNTOS[c], "sprintf",
+               (double)cantidad / t_sprintf, (double)bytes / t_sprintf / 1e6,
+               "1.00x");
+
+        for (int m = 0; m < 3; ++m) {
+            ImplementacionFormato impl = IMPLEMENTACIONES[m];
+            if (!fd_implementacion_disponible(impl)) {
+                printf("%10s %10s %16s %12s %10s\n", CONJUNTOS[c],
+                       fd_nombre_implementacion(impl), "-", "-", "-");
+                continue;
+            }
+
+            size_t escritos = 0;
+            double mejor = 1e30;
+            for (double total = 0.0; total < TIEMPO_MINIMO_MEDICION;) {
+                double inicio = obtener_tiempo();
+                escritos = fd_lote_u64_con(valores, cantidad, ' ', texto, impl);
+                double t = obtener_tiempo() - inicio;
+                total += t;
+                mejor = (t < mejor) ? t : mejor;
+            }
+
+            if (escritos != bytes || memcmp(referencia, texto, bytes) != 0) {
+                fprintf(stderr, "Error: %s difiere de sprintf.\n",
+                        fd_nombre_implementacion(impl));
+                return EXIT_FAILURE;
+            }
+            printf("%10s %10s %16.3e %12.1f %9.2fx\n", CONJUNTOS[c],
+                   fd_nombre_implementacion(impl), (double)cantidad / mejor,
+                   (double)bytes / mejor / 1e6, t_sprintf / mejor);
+        }
+        fflush(stdout);
+    }
+
+    free(valores);
+    free(referencia);
+    free(texto);
+    return EXIT_SUCCESS;
+}
+
+/* El camino genérico de stdio, valor por valor */
+static size_t formatear_sprintf(const uint64_t *valores, size_t cantidad,
+                                char *destino)
+{
+    char *p = destino;
+
+    for (size_t i = 0; i < cantidad; ++i) {
+        p += sprintf(p, (i > 0) ? " %llu" : "%llu",
+                     (unsigned long long)valores[i]);
+    }
+    return (size_t)(p - destino);
+}
+
+/*
+ * bench_tuberia
+ * -----------------------------------------
+ * El texto (términos de Fibonacci mod 2^64 formateados una sola
+ * vez) se copia una y otra vez al búfer de Salida, como lo haría el
+ * formateador, así que se mide solo el camino de salida.
+ */
+static int bench_tuberia(int argc, char **argv)
+{
+    size_t mib = 4096;
+
+    if (argc >= 1) {
+        mib = (size_t)atoll(argv[0]);
+    }
+    if (mib == 0) {
+        fprintf(stderr, "Error: se requiere MiB > 0.\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t tam   = 0;
+    char  *texto = texto_de_prueba(&tam);
+    if (texto == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    static const ModoSalida MODOS[2] = { SALIDA_WRITE, SALIDA_VMSPLICE };
+    printf("%10s %12s %10s\n", "modo", "segundos", "GB/s");
+    signal(SIGPIPE, SIG_IGN);   /* un verificador que aborta da EPIPE */
+
+    for (int m = 0; m < 2; ++m) {
+        const char *nombre = NULL;
+        double t = medir_tuberia(MODOS[m], texto, tam, mib << 20, &nombre);
+        if (t < 0.0) {
+            free(texto);
+            return EXIT_FAILURE;
+        }
+        printf("%10s %12.3f %10.2f\n", nombre, t,
+               (double)(mib << 20) / t / 1e9);
+        fflush(stdout);
+    }
+
+    free(texto);
+    return EXIT_SUCCESS;
+}
+
+/*
+ * medir_tuberia
+ * -----------------------------------------
+ * Escribe 'total' bytes en modo 'modo' hacia un verificador (ver
+ * lanzar_verificador) y retorna el tiempo hasta que terminó de leer
+ * (-1 ante un error o si recibió otros bytes). En 'nombre' queda el
+ * modo realmente usado.
+ */
+static double medir_tuberia(ModoSalida modo, const char *texto, size_t tam,
+                            size_t total, const char **nombre)
+{
+    int   escritura = -1;
+    pid_t hijo      = lanzar_verificador(&escritura, texto, tam, total);
+    if (hijo < 0) {
+        return -1.0;
+    }
+
+    double inicio = obtener_tiempo();
+    Salida salida;
+    int    codigo = salida_abrir_con(&salida, escritura, SALIDA_TAM_BUFER,
+                                     modo);
+    *nombre = salida_nombre_modo(&salida);
+
+    for (size_t escritos = 0; codigo == 0 && escritos < total;) {
+        size_t n = (total - escritos < tam) ? total - escritos : tam;
+        char  *p = salida_reservar(&salida, n);
+        if (p == NULL) {
+            codigo = -1;
+            break;
+        }
+        memcpy(p, texto, n);
+        salida_confirmar(&salida, n);
+        escritos += n;
+    }
+    if (salida_cerrar(&salida) != 0) {
+        codigo = -1;
+    }
+    close(escritura);
+    int estado = 0;
+    waitpid(hijo, &estado, 0);
+    double transcurrido = obtener_tiempo() - inicio;
+
+    /* Si el verificador encontró una diferencia, dejó de leer y la
+     * escritura falló con EPIPE: se informa la causa */
+    if (!WIFEXITED(estado) || WEXITSTATUS(estado) != EXIT_SUCCESS) {
+        fprintf(stderr, "Error: en modo %s el lector recibió bytes "
+                        "distintos de los escritos.\n", *nombre);
+        return -1.0;
+    }
+    if (codigo != 0) {
+        perror("Error al escribir en la tubería");
+        return -1.0;
+    }
+    return transcurrido;
+}
+
+/*
+ * bench_archivo
+ * -----------------------------------------
+ * Como bench_tuberia, pero hacia un archivo regular.
+ */
+static int bench_archivo(int argc, char **argv)
+{
+    size_t      mib  = 1024;
+    const char *ruta = "bench_salida.tmp";
+
+    if (argc >= 1) {
+        mib = (size_t)atoll(argv[0]);
+    }
+    if (argc >= 2) {
+        ruta = argv[1];
+    }
+    if (mib == 0) {
+        fprintf(stderr, "Error: se requiere MiB > 0.\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t tam   = 0;
+    char  *texto = texto_de_prueba(&tam);
+    if (texto == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    static const ModoSalida MODOS[3] = {
+        SALIDA_WRITE, SALIDA_IO_URING, SALIDA_IO_URING_DIRECTO
+    };
+    printf("%10s %12s %10s\n", "modo", "segundos", "GB/s");
+
+    int codigo = EXIT_SUCCESS;
+    for (int m = 0; m < 3; ++m) {
+        const char *nombre = NULL;
+        double t = medir_archivo(MODOS[m], ruta, texto, tam, mib << 20,
+                                 &nombre);
+        if (t < 0.0) {
+            codigo = EXIT_FAILURE;
+            break;
+        }
+        printf("%10s %12.3f %10.2f\n", nombre, t,
+               (double)(mib << 20) / t / 1e9);
+        fflush(stdout);
+    }
+
+    unlink(ruta);
+    free(texto);
+    return codigo;
+}
+
+/*
+ * medir_archivo
+ * -----------------------------------------
+ * Escribe 'total' bytes en 'ruta' (truncada) en modo 'modo' y
+ * retorna el tiempo hasta que fsync terminó (-1 ante un error). En
+ * 'nombre' queda el modo realmente usado.
+ */
+static double medir_archivo(ModoSalida modo, const char *ruta,
+                            const char *texto, size_t tam, size_t total,
+                            const char **nombre)
+{
+    int descriptor = open(ruta, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        perror("Error al abrir el archivo de prueba");
+        return -1.0;
+    }
+
+    double inicio = obtener_tiempo();
+    Salida salida;
+    int    codigo = salida_abrir_con(&salida, descriptor, SALIDA_TAM_BUFER,
+                                     modo);
+    *nombre = salida_nombre_modo(&salida);
+
+    for (size_t escritos = 0; codigo == 0 && escritos < total;) {
+        size_t n = (total - escritos < tam) ? total - escritos : tam;
+        char  *p = salida_reservar(&salida, n);
+        if (p == NULL) {
+            codigo = -1;
+            break;
+        }
+        memcpy(p, texto, n);
+        salida_confirmar(&salida, n);
+        escritos += n;
+    }
+    if (salida_cerrar(&salida) != 0 || fsync(descriptor) != 0) {
+        codigo = -1;
+    }
+    double transcurrido = obtener_tiempo() - inicio;
+    close(descriptor);
+
+    if (codigo != 0) {
+        perror("Error al escribir el archivo de prueba");
+        return -1.0;
+    }
+    return transcurrido;
+}
+
+/*
+ * texto_de_prueba
+ * -----------------------------------------
+ * Términos de Fibonacci mod 2^64 formateados una sola vez y
+ * terminados en espacio, para repetirlos como bloque de salida.
+ * NULL si falta memoria.
+ */
+static char *texto_de_prueba(size_t *tam)
+{
+    enum { VALORES_TEXTO = 4096 };
+    uint64_t valores[VALORES_TEXTO];
+    uint64_t actual = 0, siguiente = 1;
+    for (size_t i = 0; i < VALORES_TEXTO; ++i) {
+        valores[i] = actual;
+        uint64_t nuevo = actual + siguiente;
+        actual    = siguiente;
+        siguiente = nuevo;
+    }
+
+    char *texto = (char *)malloc(VALORES_TEXTO * (FD_MAX_DIGITOS_U64 + 1) + 1);
+    if (texto == NULL) {
+        perror("Error en malloc para el texto");
+        return NULL;
+    }
+    *tam = fd_lote_u64(valores, VALORES_TEXTO, ' ', texto);
+    texto[(*tam)++] = ' ';
+    return texto;
+}
+
+/*
+ * lanzar_lector
+ * -----------------------------------------
+ * Crea una tubería y un hijo que la vacía con read(2) en bloques de
+ * 64 KiB y descarta lo leído. Deja en 'escritura' el extremo de
+ * escritura y retorna el pid del hijo (-1 ante un error).
+ */
+static pid_t lanzar_lector(int *escritura)
+{
+    int extremos[2];
+    if (pipe(extremos) != 0) {
+        perror("Error en pipe");
+        return -1;
+    }
+
+    pid_t hijo = fork();
+    if (hijo < 0) {
+        perror("Error en fork");
+        close(extremos[0]);
+        close(extremos[1]);
+        return -1;
+    }
+    if (hijo == 0) {
+        static char bloque[1 << 16];
+        close(extremos[1]);
+        while (read(extremos[0], bloque, sizeof(bloque)) > 0) {
+        }
+        _exit(EXIT_SUCCESS);
+    }
+    close(extremos[0]);
+    *escritura = extremos[1];
+    return hijo;
+}
+
+/*
+ * lanzar_verificador
+ * -----------------------------------------
+ * Como lanzar_lector, pero el hijo comprueba lo que recibe: debe ser
+ * 'texto' repetido hasta completar 'total' bytes. Antes de leerlo lo
+ * pasa con splice(2) a una segunda tubería y solo la vacía cuando
+ * acumula media capacidad, como un relevo con búfer (pv): así las
+ * páginas entregadas con vmsplice siguen referenciadas un rato
+ * después de salir de la primera tubería, y si el escritor las
+ * reutilizara se leería texto alterado. Sin splice se lee
+ * directamente. El hijo termina con EXIT_FAILURE si algo difiere.
+ */
+static pid_t lanzar_verificador(int *escritura, const char *texto,
+                                size_t tam, size_t total)
+{
+    enum { TAM_RELEVO = 1 << 20 };
+    int extremos[2];
+    if (pipe(extremos) != 0) {
+        perror("Error en pipe");
+        return -1;
+    }
+
+    pid_t hijo = fork();
+    if (hijo < 0) {
+        perror("Error en fork");
+        close(extremos[0]);
+        close(extremos[1]);
+        return -1;
+    }
+    if (hijo == 0) {
+        static char bloque[1 << 16];
+        int    relevo[2];
+        int    con_relevo = (pipe(relevo) == 0);
+        size_t posicion   = 0;      /* dentro de 'texto' */
+        size_t recibidos  = 0;
+        size_t pendientes = 0;      /* bytes en el relevo */
+        size_t umbral     = 0;
+        int    correcto   = 1;
+        int    fin        = 0;
+
+        close(extremos[1]);
+        if (con_relevo) {
+            fcntl(relevo[1], F_SETPIPE_SZ, TAM_RELEVO);
+            int capacidad = fcntl(relevo[1], F_GETPIPE_SZ);
+            umbral = (capacidad > 0) ? (size_t)capacidad / 2 : 0;
+        }
+        while (!fin && correcto) {
+            if (con_relevo && !fin && pendientes < umbral) {
+                ssize_t n = splice(extremos[0], NULL, relevo[1], NULL,
+                                   umbral - pendientes, SPLICE_F_MOVE);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n < 0 && pendientes == 0 && recibidos == 0) {
+                    con_relevo = 0;     /* splice no disponible */
+                    continue;
+                }
+                if (n > 0) {
+                    pendientes += (size_t)n;
+                    continue;
+                }
+                fin = 1;                /* EOF: vaciar el relevo */
+            }
+
+            int     origen  = con_relevo ? relevo[0] : extremos[0];
+            size_t  pedidos = con_relevo ? pendientes : sizeof(bloque);
+            while (pedidos > 0 && correcto) {
+                size_t  trozo = (pedidos < sizeof(bloque)) ? pedidos
+                                                           : sizeof(bloque);
+                ssize_t n = read(origen, bloque, trozo);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    fin = 1;
+                    break;
+                }
+                for (size_t hecho = 0; hecho < (size_t)n && correcto;) {
+                    size_t parte = (size_t)n - hecho;
+                    if (parte > tam - posicion) {
+                        parte = tam - posicion;
+                    }
+                    correcto = (memcmp(bloque + hecho, texto + posicion,
+                                       parte) == 0);
+                    hecho    += parte;
+                    posicion  = (posicion + parte) % tam;
+                }
+                recibidos += (size_t)n;
+                if (con_relevo) {
+                    pedidos    -= (size_t)n;
+                    pendientes -= (size_t)n;
+                } else {
+                    break;
+                }
+            }
+        }
+        _exit((correcto && recibidos == total) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    close(extremos[0]);
+    *escritura = extremos[1];
+    return hijo;
+}
+
+/*
+ * bench_suite
+ * -----------------------------------------
+ * Ejecuta todos los grupos, informa el avance por stderr y escribe
+ * los registros al final, por la salida estándar.
+ */
+static int bench_suite(int argc, char **argv)
+{
+    int      json   = 0;
+    uint64_t escala = 1;
+
+    if (argc >= 1) {
+        if (strcmp(argv[0], "json") == 0) {
+            json = 1;
+        } else if (strcmp(argv[0], "csv") != 0) {
+            mostrar_uso("bench_fibonacci");
+            return EXIT_FAILURE;
+        }
+    }
+    if (argc >= 2) {
+        escala = (uint64_t)atoll(argv[1]);
+    }
+    if (escala == 0) {
+        fprintf(stderr, "Error: se requiere escala > 0.\n");
+        return EXIT_FAILURE;
+    }
+
+    static RegistroSuite registros[MAX_REGISTROS_SUITE];
+    int num = 0;
+
+    /* calculo y memoria */
+    static const char *const CASOS_CALCULO[4] = {
+        "u64", "u128", "modular", "grande"
+    };
+    static const uint64_t N_CALCULO[4][2] = {
+        { 1000000, 10000000 }, { 1000000, 10000000 },
+        { 1000000, 10000000 }, { 10000, 30000 }
+    };
+    for (int c = 0; c < 4; ++c) {
+        for (int k = 0; k < 2; ++k) {
+            uint64_t n = N_CALCULO[c][k] * escala;
+            size_t   bytes = 0;
+            fprintf(stderr, "calculo %s N=%llu\n", CASOS_CALCULO[c],
+                    (unsigned long long)n);
+            double t = medir_calculo(CASOS_CALCULO[c], n, &bytes);
+            if (t < 0.0) {
+                return EXIT_FAILURE;
+            }
+            agregar_registro(registros, &num, "calculo", CASOS_CALCULO[c], n,
+                             "terminos_por_s", (double)n / t);
+            agregar_registro(registros, &num, "memoria", CASOS_CALCULO[c], n,
+                             "bytes", (double)bytes);
+        }
+    }
+
+    SecuenciaDispersa dispersa;
+    uint64_t n_dispersa = N_CALCULO[3][1] * escala;
+    if (sd_construir(&dispersa, n_dispersa, 64) != 0) {
+        fprintf(stderr, "Error: memoria insuficiente para la secuencia.\n");
+        return EXIT_FAILURE;
+    }
+    agregar_registro(registros, &num, "memoria", "dispersa_k64", n_dispersa,
+                     "bytes", (double)sd_bytes(&dispersa));
+    sd_liberar(&dispersa);
+
+    /* salida */
+    static const char *const CASOS_SALIDA[3] = { "printf", "bufer", "vmsplice" };
+    size_t    cantidad = (size_t)(10000000 * escala);
+    uint64_t *valores  = (uint64_t *)malloc(sizeof(uint64_t) * cantidad);
+    Recurrencia fibonacci;
+    if (valores == NULL) {
+        perror("Error en malloc para los valores");
+        return EXIT_FAILURE;
+    }
+    rec_predefinida(&fibonacci, "fibonacci", 0);
+    rec_llenar(&fibonacci, 0, valores, cantidad);
+    for (int c = 0; c < 3; ++c) {
+        size_t bytes = 0;
+        fprintf(stderr, "salida %s N=%zu\n", CASOS_SALIDA[c], cantidad);
+        double t = medir_salida(CASOS_SALIDA[c], valores, cantidad, &bytes);
+        if (t < 0.0) {
+            free(valores);
+            return EXIT_FAILURE;
+        }
+        agregar_registro(registros, &num, "salida", CASOS_SALIDA[c], cantidad,
+                         "terminos_por_s", (double)cantidad / t);
+        agregar_registro(registros, &num, "salida", CASOS_SALIDA[c], cantidad,
+                         "mb_por_s", (double)bytes / t / 1e6);
+    }
+    free(valores);
+
+    /* consulta */
+    static const char *const CASOS_CONSULTA[3] = {
+        "termino", "termino_decimal", "modular"
+    };
+    static const uint64_t N_CONSULTA[3][4] = {
+        { 1000, 100000, 1000000, 10000000 },
+        { 1000, 100000, 1000000, 10000000 },
+        { 1000000, 1000000000000ULL, 1000000000000000000ULL, UINT64_MAX }
+    };
+    for (int c = 0; c < 3; ++c) {
+        for (int k = 0; k < 4; ++k) {
+            uint64_t n = N_CONSULTA[c][k];
+            fprintf(stderr, "consulta %s N=%llu\n", CASOS_CONSULTA[c],
+                    (unsigned long long)n);
+            double t = medir_consulta(CASOS_CONSULTA[c], n);
+            if (t < 0.0) {
+                return EXIT_FAILURE;
+            }
+            agregar_registro(registros, &num, "consulta", CASOS_CONSULTA[c], n,
+                             "segundos", t);
+        }
+    }
+
+    mostrar_registros(registros, num, json);
+    return EXIT_SUCCESS;
+}
+
+/*
+ * medir_calculo
+ * -----------------------------------------
+ * Mejor tiempo para generar F(0)..F(n-1) completa en la
+ * representación 'caso', guardando todos los términos; en 'bytes'
+ * queda la memoria que ocupan. -1 si faltó memoria.
+ */
+static double medir_calculo(const char *caso, uint64_t n, size_t *bytes)
+{
+    double mejor = 1e30;
+
+    for (double total = 0.0; total < TIEMPO_MINIMO_MEDICION;) {
+        double t = 0.0;
+
+        if (strcmp(caso, "u128") == 0) {
+            unsigned __int128 *arreglo =
+                (unsigned __int128 *)malloc(sizeof(unsigned __int128) * n);
+            if (arreglo == NULL) {
+                return -1.0;
+            }
+            double inicio = obtener_tiempo();
+            arreglo[0] = 0;
+            arreglo[1] = 1;
+            for (uint64_t i = 2; i < n; ++i) {
+                arreglo[i] = arreglo[i - 1] + arreglo[i - 2];
+            }
+            t = obtener_tiempo() - inicio;
+            sumidero = (uint64_t)arreglo[n - 1];
+            *bytes   = sizeof(unsigned __int128) * n;
+            free(arreglo);
+        } else if (strcmp(caso, "grande") == 0) {
+            EnteroGrande *arreglo = (EnteroGrande *)calloc(n, sizeof(EnteroGrande));
+            if (arreglo == NULL) {
+                return -1.0;
+            }
+            double inicio = obtener_tiempo();
+            int    error  = (eg_asignar_u64(&arreglo[0], 0) != 0 ||
+                             eg_asignar_u64(&arreglo[1], 1) != 0);
+            for (uint64_t i = 2; i < n && !error; ++i) {
+                error = (eg_sumar(&arreglo[i], &arreglo[i - 1],
+                                  &arreglo[i - 2]) != 0);
+            }
+            t = obtener_tiempo() - inicio;
+            *bytes = sizeof(EnteroGrande) * n;
+            for (uint64_t i = 0; i < n; ++i) {
+                *bytes += sizeof(uint64_t) * arreglo[i].capacidad;
+                eg_liberar(&arreglo[i]);
+            }
+            free(arreglo);
+            if (error) {
+                return -1.0;
+            }
+        } else {
+            Recurrencia fibonacci;
+            rec_predefinida(&fibonacci, "fibonacci",
+                            (strcmp(caso, "modular") == 0) ? MODULO_SUITE : 0);
+            uint64_t *arreglo = (uint64_t *)malloc(sizeof(uint64_t) * n);
+            if (arreglo == NULL) {
+                return -1.0;
+            }
+            double inicio = obtener_tiempo();
+            rec_llenar(&fibonacci, 0, arreglo, n);
+            t = obtener_tiempo() - inicio;
+            sumidero = arreglo[n - 1];
+            *bytes   = sizeof(uint64_t) * n;
+            free(arreglo);
+        }
+
+        total += t;
+        mejor = (t < mejor) ? t : mejor;
+    }
+    return mejor;
+}
+
+/*
+ * medir_salida
+ * -----------------------------------------
+ * Tiempo para imprimir los valores separados por espacios hacia un
+ * lector (ver lanzar_lector), hasta que terminó de leer; en 'bytes'
+ * queda el tamaño del texto. Se mide una sola vez: con N grande el
+ * tiempo ya supera con holgura al mínimo.
+ */
+static double medir_salida(const char *caso, const uint64_t *valores,
+                           size_t cantidad, size_t *bytes)
+{
+    enum { TERMINOS_POR_LOTE = 4096 };
+    int   escritura = -1;
+    pid_t hijo      = lanzar_lector(&escritura);
+    if (hijo < 0) {
+        return -1.0;
+    }
+
+    double inicio = obtener_tiempo();
+    int    codigo = 0;
+    *bytes = 0;
+
+    if (strcmp(caso, "printf") == 0) {
+        FILE *flujo = fdopen(escritura, "w");
+        if (flujo == NULL) {
+            codigo = -1;
+        }
+        for (size_t i = 0; codigo == 0 && i < cantidad; ++i) {
+            int n = fprintf(flujo, (i > 0) ? " %llu" : "%llu",
+                            (unsigned long long)valores[i]);
+            codigo = (n < 0) ? -1 : 0;
+            *bytes += (size_t)n;
+        }
+        if (flujo != NULL && fclose(flujo) != 0) {
+            codigo = -1;
+        }
+        escritura = -1;
+    } else {
+        Salida salida;
+        codigo = salida_abrir_con(&salida, escritura, SALIDA_TAM_BUFER,
+                                  (strcmp(caso, "vmsplice") == 0)
+                                      ? SALIDA_VMSPLICE : SALIDA_WRITE);
+        for (size_t i = 0; codigo == 0 && i < cantidad; i += TERMINOS_POR_LOTE) {
+            size_t n = (cantidad - i < TERMINOS_POR_LOTE) ? cantidad - i
+                                                          : TERMINOS_POR_LOTE;
+            char *p = salida_reservar(&salida,
+                                      n * (FD_MAX_DIGITOS_U64 + 1));
+            if (p == NULL) {
+                codigo = -1;
+                break;
+            }
+            size_t escritos = 0;
+            if (i > 0) {
+                p[escritos++] = ' ';
+            }
+            escritos += fd_lote_u64(valores + i, n, ' ', p + escritos);
+            salida_confirmar(&salida, escritos);
+            *bytes += escritos;
+        }
+        if (salida_cerrar(&salida) != 0) {
+            codigo = -1;
+        }
+    }
+
+    if (escritura >= 0) {
+        close(escritura);
+    }
+    waitpid(hijo, NULL, 0);
+    double transcurrido = obtener_tiempo() - inicio;
+
+    if (codigo != 0) {
+        perror("Error al escribir en la tubería");
+        return -1.0;
+    }
+    return transcurrido;
+}
+
+/*
+ * medir_consulta
+ * -----------------------------------------
+ * Mejor tiempo para obtener F(n) solo: completo, completo y en
+ * decimal, o módulo MODULO_SUITE. -1 si faltó memoria.
+ */
+static double medir_consulta(const char *caso, uint64_t n)
+{
+    double mejor = 1e30;
+
+    for (double total = 0.0; total < TIEMPO_MINIMO_MEDICION;) {
+        double t = 0.0;
+
+        if (strcmp(caso, "modular") == 0) {
+            Recurrencia fibonacci;
+            rec_predefinida(&fibonacci, "fibonacci", MODULO_SUITE);
+            double inicio = obtener_tiempo();
+            sumidero = rec_termino(&fibonacci, n);
+            t = obtener_tiempo() - inicio;
+        } else {
+            EnteroGrande fk, fk1;
+            eg_iniciar(&fk);
+            eg_iniciar(&fk1);
+            double inicio = obtener_tiempo();
+            int    error  = (eg_fibonacci(n, &fk, &fk1) != 0);
+            if (!error && strcmp(caso, "termino_decimal") == 0) {
+                char *texto = (char *)malloc(eg_digitos_maximos(&fk) + 1);
+                error = (texto == NULL || eg_a_decimal(&fk, texto) == 0);
+                free(texto);
+            }
+            t = obtener_tiempo() - inicio;
+            eg_liberar(&fk);
+            eg_liberar(&fk1);
+            if (error) {
+                return -1.0;
+            }
+        }
+
+        total += t;
+        mejor = (t < mejor) ? t : mejor;
+    }
+    return mejor;
+}
+
+static void agregar_registro(RegistroSuite *registros, int *num,
+                             const char *grupo, const char *caso,
+                             uint64_t n, const char *metrica, double valor)
+{
+    if (*num >= MAX_REGISTROS_SUITE) {
+        return;
+    }
+    registros[*num].grupo   = grupo;
+    registros[*num].caso    = caso;
+    registros[*num].n       = n;
+    registros[*num].metrica = metrica;
+    registros[*num].valor   = valor;
+    (*num)++;
+}
+
+/*
+ * mostrar_registros
+ * -----------------------------------------
+ * CSV con encabezado, o un objeto JSON {"suite": ..., "resultados":
+ * [...]} con un objeto por registro.
+ */
+static void mostrar_registros(const RegistroSuite *registros, int num,
+                              int json)
+{
+    if (!json) {
+        printf("grupo,caso,n,metrica,valor\n");
+        for (int r = 0; r < num; ++r) {
+            printf("%s,%s,%llu,%s,%.6g\n", registros[r].grupo,
+                   registros[r].caso, (unsigned long long)registros[r].n,
+                   registros[r].metrica, registros[r].valor);
+        }
+        return;
+    }
+
+    printf("{\n  \"suite\": \"fibonacci\",\n  \"resultados\": [\n");
+    for (int r = 0; r < num; ++r) {
+        printf("    {\"grupo\": \"%s\", \"caso\": \"%s\", \"n\": %llu, "
+               "\"metrica\": \"%s\", \"valor\": %.6g}%s\n",
+               registros[r].grupo, registros[r].caso,
+               (unsigned long long)registros[r].n, registros[r].metrica,
+               registros[r].valor, (r + 1 < num) ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+/*
+ * cruce
+ * -----------------------------------------
+ * Menor tamaño desde el cual 'rapido' supera a 'lento' en todas las
+ * mediciones siguientes (se ignoran las que no se tomaron). Si nunca
+ * lo supera, retorna el doble del mayor tamaño medido.
+ */
+static size_t cruce(const size_t *tamanos, const double *lento,
+                    const double *rapido, int num_tamanos)
+{
+    size_t umbral = 2 * tamanos[num_tamanos - 1];
+
+    for (int i = num_tamanos - 1; i >= 0; --i) {
+        if (lento[i] < 0.0 || rapido[i] < 0.0) {
+            continue;
+        }
+        if (rapido[i] >= lento[i]) {
+            break;
+        }
+        umbral = tamanos[i];
+    }
+    return umbral;
+}
+
+/*
+ * medir_producto
+ * -----------------------------------------
+ * Repite r = a * b hasta acumular TIEMPO_MINIMO_MEDICION y retorna
+ * el tiempo promedio por producto, en segundos.
+ */
+static double medir_producto(EnteroGrande *r, const EnteroGrande *a,
+                             const EnteroGrande *b,
+                             AlgoritmoMultiplicacion algoritmo)
+{
+    int    repeticiones = 0;
+    double inicio       = obtener_tiempo();
+    double transcurrido = 0.0;
+
+    do {
+        if (eg_multiplicar_con(r, a, b, algoritmo) != 0) {
+            fprintf(stderr, "Error: memoria insuficiente en el producto.\n");
+            exit(EXIT_FAILURE);
+        }
+        repeticiones++;
+        transcurrido = obtener_tiempo() - inicio;
+    } while (transcurrido < TIEMPO_MINIMO_MEDICION);
+
+    return transcurrido / repeticiones;
+}
+
+/*
+ * llenar_aleatorio
+ * -----------------------------------------
+ * Asigna a x un valor de exactamente 'palabras' palabras generadas
+ * con xorshift64 (reproducible entre ejecuciones).
+ */
+static void llenar_aleatorio(EnteroGrande *x, size_t palabras,
+                             uint64_t *estado)
+{
+    if (eg_reservar(x, palabras) != 0) {
+        perror("Error en malloc para el operando");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < palabras; ++i) {
+        *estado ^= *estado << 13;
+        *estado ^= *estado >> 7;
+        *estado ^= *estado << 17;
+        x->palabras[i] = *estado;
+    }
+    x->palabras[palabras - 1] |= 1ULL << 63;
+    x->longitud = palabras;
+}
+
+/*
+ * medir_conversion
+ * -----------------------------------------
+ * Repite la conversión hasta acumular TIEMPO_MINIMO_MEDICION y
+ * retorna el tiempo promedio por conversión, en segundos.
+ */
+static double medir_conversion(const EnteroGrande *x, char *destino,
+                               int hilos, int ingenuo, size_t *digitos)
+{
+    int    repeticiones = 0;
+    double inicio       = obtener_tiempo();
+    double transcurrido = 0.0;
+
+    do {
+        *digitos = ingenuo ? eg_a_decimal_ingenuo(x, destino)
+                           : eg_a_decimal_hilos(x, destino, hilos);
+        repeticiones++;
+        transcurrido = obtener_tiempo() - inicio;
+    } while (transcurrido < TIEMPO_MINIMO_MEDICION);
+
+    return transcurrido / repeticiones;
+}
+
+/*
+ * obtener_tiempo
+ * -----------------------------------------
+ * Retorna un timestamp en segundos, usando un reloj
+ * de alta resolución (CLOCK_MONOTONIC).
+ */
+static double obtener_tiempo(void)
+{
+    struct timespec instante;
+
+    clock_gettime(CLOCK_MONOTONIC, &instante);
+
+    return (double)instante.tv_sec + (double)instante.tv_nsec * 1e-9;
+}
@@ -0,0 +1,890 @@
+/*
+ * bench_pi.c
+ * -----------------------------------------
+ * Líneas base de rendimiento para ./pi_p, para saber si un cambio de
+ * banderas de compilación o del núcleo lo hizo más lento o si solo
+ * fue ruido de la máquina.
+ *
+ * Uso:
+ *      ./bench_pi guardar RUTA [muestras] [n] [binario]
+ *      ./bench_pi comparar RUTA [umbral] [binario]
+ *      ./bench_pi ab "COMANDO_A" "COMANDO_B" [ensayos] [semilla]
+ *
+ * Subcomandos:
+ *  - guardar: ejecuta 'binario' (por defecto ./pi_p) con H = 1, 2,
+ *    4, ... hasta el doble de las CPUs en línea (al menos hasta 8) y
+ *    'n' subintervalos (por defecto 200 000 000), 'muestras' veces
+ *    cada configuración (por defecto 10), y escribe en RUTA un JSON
+ *    con los tiempos de cada muestra, la huella de la máquina (modelo
+ *    de CPU, CPUs en línea, núcleos físicos, hilos por núcleo,
+ *    kernel, nombre) y el compilador del binario. Las banderas de
+ *    compilación se toman de la variable BANDERAS. analisis.ipynb
+ *    carga estos archivos para comparar máquinas.
+ *  - comparar: vuelve a ejecutar las configuraciones de RUTA con el
+ *    mismo número de muestras y compara cada una con su línea base
+ *    mediante la prueba U de Mann-Whitney (ver estadistica.h). Una
+ *    configuración es una regresión si la mediana empeoró más de
+ *    'umbral' por ciento (por defecto 5) y la prueba la declara
+ *    significativa (p < 0.05); simétricamente, una mejora. Si la
+ *    huella de la máquina difiere, se advierte. Termina con
+ *    EXIT_FAILURE si hubo alguna regresión, para usarlo en scripts.
+ *  - ab: compara dos comandos (dos binarios, como "./pi_s 200000000"
+ *    y "./pi_p 4 200000000", o dos modos del mismo) en 'ensayos'
+ *    ensayos (por defecto 30). Cada ensayo ejecuta ambos en orden
+ *    aleatorio (xorshift64 desde 'semilla'; por defecto, la hora), de
+ *    modo que el estado térmico y la carga de fondo afecten a los dos
+ *    por igual. Informa mediana, media y desviación de cada lado, y
+ *    sobre los pares: el speedup de B respecto de A como media
+ *    geométrica de las razones T_A / T_B de cada ensayo, su intervalo
+ *    de confianza del 95 % (bootstrap) y la prueba de rangos con
+ *    signo de Wilcoxon. Los comandos se separan por espacios, sin
+ *    comillas ni escapes.
+ *
+ * Cada ejecución es un proceso aparte (fork + exec) y el tiempo es
+ * el "Tiempo ... (s)" que imprime el binario. Antes de medir se
+ * hace una ejecución de calentamiento por configuración, y las
+ * muestras se toman por rondas (todas las configuraciones, una vez
+ * cada una, y de nuevo), para que una racha de ruido no caiga entera
+ * sobre una sola configuración. La variable TRAZA no se pasa a los
+ * hijos.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "estadistica.h"
+
+/* 'guardar' recorre H = 1, 2, 4, ... hasta 2 * CPUs en línea, y al
+ * menos hasta este valor */
+static const int HILOS_MINIMO_BARRIDO = 8;
+
+static const int    MUESTRAS_POR_DEFECTO = 10;
+static const int    N_POR_DEFECTO        = 200000000;
+static const double UMBRAL_POR_DEFECTO   = 5.0;     /* por ciento */
+static const double ALFA                 = 0.05;
+
+#define BINARIO_POR_DEFECTO "./pi_p"
+#define MAX_MUESTRAS        1000
+#define MAX_CONFIGURACIONES 32
+#define MAX_SALIDA_HIJO     8192
+#define MAX_ARGUMENTOS      32
+#define MAX_CPUS_HUELLA     4096
+
+static const int    ENSAYOS_POR_DEFECTO  = 30;
+static const int    REMUESTREOS          = 10000;
+static const double CONFIANZA            = 0.95;
+
+/*
+ * HuellaMaquina
+ * -----------------------------------------
+ * Lo que identifica a la máquina en la que se midió: si cambia, las
+ * diferencias de tiempo no se pueden atribuir al binario. 'nucleos'
+ * son los núcleos físicos y 'smt' los hilos de hardware por núcleo.
+ */
+typedef struct {
+    char cpu[128];
+    int  cpus;
+    int  nucleos;
+    int  smt;
+    char kernel[128];
+    char nodo[128];
+} HuellaMaquina;
+
+typedef struct {
+    int    hilos;
+    int    n;
+    int    num_muestras;
+    double muestras[MAX_MUESTRAS];   /* segundos */
+} ConfiguracionBench;
+
+typedef struct {
+    HuellaMaquina      huella;
+    char               binario[256];
+    char               compilador[128];  /* del binario, o "desconocido" */
+    char               banderas[256];    /* variable BANDERAS, o "" */
+    int                num_configuraciones;
+    ConfiguracionBench configuraciones[MAX_CONFIGURACIONES];
+} LineaBase;
+
+/* Prototipos de funciones internas */
+static int    bench_guardar(int argc, char **argv);
+static int    bench_comparar(int argc, char **argv);
+static int    bench_ab(int argc, char **argv);
+static void   mostrar_lado(const char *nombre, const double *tiempos,
+                           int ensayos);
+static int    medir_configuraciones(const char *binario,
+                                    ConfiguracionBench *configuraciones,
+                                    int num, int muestras);
+static int    ejecutar_pi_p(const char *binario, int hilos, int n,
+                            double *segundos);
+static int    ejecutar_comando(char *const argumentos[], double *segundos);
+static int    separar_comando(char *comando, char **argumentos, int maximo);
+static void   obtener_huella(HuellaMaquina *huella);
+static void   obtener_compilador(const char *binario, char *texto,
+                                 size_t tam);
+static int    misma_maquina(const HuellaMaquina *a, const HuellaMaquina *b);
+static int    escribir_linea_base(const char *ruta, const LineaBase *base);
+static int    leer_linea_base(const char *ruta, LineaBase *base);
+static char  *leer_archivo(const char *ruta);
+static void   escribir_texto_json(FILE *archivo, const char *texto);
+static int    leer_texto_json(const char *json, const char *clave,
+                              char *texto, size_t tam);
+static void   mostrar_uso(const char *nombre_programa);
+
+static LineaBase base_guardada, base_actual;
+
+int main(int argc, char **argv)
+{
+    if (argc >= 3 && strcmp(argv[1], "guardar") == 0) {
+        return bench_guardar(argc - 2, argv + 2);
+    }
+    if (argc >= 3 && strcmp(argv[1], "comparar") == 0) {
+        return bench_comparar(argc - 2, argv + 2);
+    }
+    if (argc >= 4 && strcmp(argv[1], "ab") == 0) {
+        return bench_ab(argc - 2, argv + 2);
+    }
+
+    mostrar_uso(argv[0]);
+    return EXIT_FAILURE;
+}
+
+/*
+ * mostrar_uso
+ * -----------------------------------------
+ * Muestra un mensaje de ayuda con el formato de uso del programa.
+ */
+static void mostrar_uso(const char *nombre_programa)
+{
+    fprintf(stderr,
+            "Uso:\n"
+            "  %s guardar RUTA [muestras] [n] [binario]\n"
+            "  %s comparar RUTA [umbral] [binario]\n"
+            "  %s ab \"COMANDO_A\" \"COMANDO_B\" [ensayos] [semilla]\n",
+            nombre_programa, nombre_programa, nombre_programa);
+}
+
+/*
+ * bench_guardar
+ * -----------------------------------------
+ * Mide todas las configuraciones y escribe la línea base en argv[0].
+ */
+static int bench_guardar(int argc, char **argv)
+{
+    const char *ruta     = argv[0];
+    int         muestras = (argc > 1) ? atoi(argv[1]) : MUESTRAS_POR_DEFECTO;
+    int         n        = (argc > 2) ? atoi(argv[2]) : N_POR_DEFECTO;
+    const char *binario  = (argc > 3) ? argv[3] : BINARIO_POR_DEFECTO;
+
+    if (muestras < 1 || muestras > MAX_MUESTRAS || n < 1) {
+        fprintf(stderr, "Error: muestras debe estar entre 1 y %d y n ser "
+                "positivo.\n", MAX_MUESTRAS);
+        return EXIT_FAILURE;
+    }
+
+    LineaBase  *base     = &base_guardada;
+    const char *banderas = getenv("BANDERAS");
+    memset(base, 0, sizeof(*base));
+    obtener_huella(&base->huella);
+    snprintf(base->binario, sizeof(base->binario), "%.*s",
+             (int)sizeof(base->binario) - 1, binario);
+    obtener_compilador(binario, base->compilador, sizeof(base->compilador));
+    snprintf(base->banderas, sizeof(base->banderas), "%.*s",
+             (int)sizeof(base->banderas) - 1,
+             (banderas != NULL) ? banderas : "");
+
+    int hilos_maximo = 2 * base->huella.cpus;
+    if (hilos_maximo < HILOS_MINIMO_BARRIDO) {
+        hilos_maximo = HILOS_MINIMO_BARRIDO;
+    }
+    for (int hilos = 1; hilos <= hilos_maximo &&
+         base->num_configuraciones < MAX_CONFIGURACIONES; hilos *= 2) {
+        ConfiguracionBench *conf =
+            &base->configuraciones[base->num_configuraciones++];
+        conf->hilos = hilos;
+        conf->n     = n;
+    }
+
+    if (medir_configuraciones(binario, base->configuraciones,
+                              base->num_configuraciones, muestras) != 0 ||
+        escribir_linea_base(ruta, base) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("%6s %12s %14s\n", "H", "n", "mediana (s)");
+    for (int c = 0; c < base->num_configuraciones; ++c) {
+        const ConfiguracionBench *conf = &base->configuraciones[c];
+        printf("%6d %12d %14.6f\n", conf->hilos, conf->n,
+               est_mediana(conf->muestras, (size_t)conf->num_muestras));
+    }
+    printf("Línea base escrita en %s (%d muestras por configuración)\n",
+           ruta, muestras);
+    return EXIT_SUCCESS;
+}
+
+/*
+ * bench_comparar
+ * -----------------------------------------
+ * Repite las configuraciones de la línea base argv[0] y muestra, para
+ * cada una, el cambio de la mediana, el valor p de la prueba en la
+ * dirección del cambio y el veredicto.
+ */
+static int bench_comparar(int argc, char **argv)
+{
+    const char *ruta   = argv[0];
+    double      umbral = (argc > 1) ? atof(argv[1]) : UMBRAL_POR_DEFECTO;
+
+    LineaBase *base   = &base_guardada;
+    LineaBase *actual = &base_actual;
+    if (leer_linea_base(ruta, base) != 0) {
+        return EXIT_FAILURE;
+    }
+    const char *binario = (argc > 2) ? argv[2] : base->binario;
+
+    memset(actual, 0, sizeof(*actual));
+    obtener_huella(&actual->huella);
+    snprintf(actual->binario, sizeof(actual->binario), "%.*s",
+             (int)sizeof(actual->binario) - 1, binario);
+    actual->num_configuraciones = base->num_configuraciones;
+    for (int c = 0; c < base->num_configuraciones; ++c) {
+        actual->configuraciones[c].hilos = base->configuraciones[c].hilos;
+        actual->configuraciones[c].n     = base->configuraciones[c].n;
+    }
+    if (medir_configuraciones(binario, actual->configuraciones,
+                              actual->num_configuraciones,
+                              base->configuraciones[0].num_muestras) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("Línea base: %s (%s)\n", ruta, base->binario);
+    printf("  máquina base   : %s, %d CPUs, kernel %s, %s\n",
+           base->huella.cpu, base->huella.cpus, base->huella.kernel,
+           base->huella.nodo);
+    printf("  máquina actual : %s, %d CPUs, kernel %s, %s\n",
+           actual->huella.cpu, actual->huella.cpus, actual->huella.kernel,
+           actual->huella.nodo);
+    if (!misma_maquina(&base->huella, &actual->huella)) {
+        printf("  Advertencia: la máquina no es la de la línea base; las "
+               "diferencias pueden no deberse al binario.\n");
+    }
+    printf("  umbral         : %.1f %%, alfa = %.2f\n\n", umbral, ALFA);
+
+    printf("%6s %12s %12s %12s %9s %9s  %s\n", "H", "n", "base (s)",
+           "actual (s)", "cambio", "valor p", "veredicto");
+
+    int regresiones = 0;
+    for (int c = 0; c < base->num_configuraciones; ++c) {
+        const ConfiguracionBench *antes   = &base->configuraciones[c];
+        const ConfiguracionBench *despues = &actual->configuraciones[c];
+        double mediana_antes   = est_mediana(antes->muestras,
+                                             (size_t)antes->num_muestras);
+        double mediana_despues = est_mediana(despues->muestras,
+                                             (size_t)despues->num_muestras);
+        double cambio = 100.0 * (mediana_despues - mediana_antes) /
+                        mediana_antes;
+        double p_mas_lento  = est_mann_whitney_mayor(
+            antes->muestras, (size_t)antes->num_muestras,
+            despues->muestras, (size_t)despues->num_muestras);
+        double p_mas_rapido = est_mann_whitney_mayor(
+            despues->muestras, (size_t)despues->num_muestras,
+            antes->muestras, (size_t)antes->num_muestras);
+        double      p         = (cambio >= 0.0) ? p_mas_lento : p_mas_rapido;
+        const char *veredicto = "sin cambio";
+
+        if (cambio > umbral && p_mas_lento < ALFA) {
+            veredicto = "REGRESIÓN";
+            regresiones++;
+        } else if (cambio < -umbral && p_mas_rapido < ALFA) {
+            veredicto = "mejora";
+        }
+        printf("%6d %12d %12.6f %12.6f %+8.2f%% %9.4f  %s\n",
+               antes->hilos, antes->n, mediana_antes, mediana_despues,
+               cambio, p, veredicto);
+    }
+
+    printf("\n%d regresión(es) de %d configuraciones\n", regresiones,
+           base->num_configuraciones);
+    return (regresiones == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * bench_ab
+ * -----------------------------------------
+ * Una ejecución de calentamiento de cada comando y luego los ensayos
+ * pareados. Las estadísticas pareadas se calculan sobre ln(T_A / T_B),
+ * que es simétrico: el intervalo de la media se exponencia para dar
+ * el del speedup.
+ */
+static int bench_ab(int argc, char **argv)
+{
+    char    *comandos[2];
+    char    *argumentos[2][MAX_ARGUMENTOS + 1];
+    int      ensayos = (argc > 2) ? atoi(argv[2]) : ENSAYOS_POR_DEFECTO;
+    uint64_t semilla = (argc > 3) ? strtoull(argv[3], NULL, 10)
+                                  : (uint64_t)time(NULL);
+    double   descarte;
+
+    if (ensayos < 2 || ensayos > MAX_MUESTRAS) {
+        fprintf(stderr, "Error: ensayos debe estar entre 2 y %d.\n",
+                MAX_MUESTRAS);
+        return EXIT_FAILURE;
+    }
+    for (int lado = 0; lado < 2; ++lado) {
+        comandos[lado] = strdup(argv[lado]);
+        if (comandos[lado] == NULL ||
+            separar_comando(comandos[lado], argumentos[lado],
+                            MAX_ARGUMENTOS) == 0) {
+            fprintf(stderr, "Error: comando vacío o inválido.\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    double *tiempos = (double *)malloc(3 * (size_t)ensayos * sizeof(double));
+    if (tiempos == NULL) {
+        fprintf(stderr, "Error: fallo al reservar memoria.\n");
+        return EXIT_FAILURE;
+    }
+    double *tiempos_a = tiempos;
+    double *tiempos_b = tiempos + ensayos;
+    double *log_razon = tiempos + 2 * ensayos;
+
+    int      b_primero = 0, b_mas_rapido = 0;
+    uint64_t estado = (semilla != 0) ? semilla : 0x9e3779b97f4a7c15ULL;
+    int      error = ejecutar_comando(argumentos[0], &descarte) != 0 ||
+                     ejecutar_comando(argumentos[1], &descarte) != 0;
+
+    for (int e = 0; e < ensayos && !error; ++e) {
+        estado ^= estado << 13;
+        estado ^= estado >> 7;
+        estado ^= estado << 17;
+        int primero = (int)(estado >> 63);
+
+        fprintf(stderr, "\rensayo %d de %d", e + 1, ensayos);
+        double *destino[2] = { &tiempos_a[e], &tiempos_b[e] };
+        error = ejecutar_comando(argumentos[primero], destino[primero]) != 0 ||
+                ejecutar_comando(argumentos[1 - primero],
+                                 destino[1 - primero]) != 0;
+        b_primero    += primero;
+        b_mas_rapido += tiempos_b[e] < tiempos_a[e];
+        log_razon[e]  = log(tiempos_a[e] / tiempos_b[e]);
+    }
+    fprintf(stderr, "\n");
+
+    if (!error) {
+        double media_log = 0.0, inferior = 0.0, superior = 0.0;
+        for (int e = 0; e < ensayos; ++e) {
+            media_log += log_razon[e];
+        }
+        media_log /= ensayos;
+        est_bootstrap_media(log_razon, (size_t)ensayos, REMUESTREOS,
+                            CONFIANZA, semilla, &inferior, &superior);
+
+        printf("A: %s\n", argv[0]);
+        printf("B: %s\n", argv[1]);
+        printf("%d ensayos en orden aleatorio (semilla %llu; B primero en "
+               "%d)\n\n", ensayos, (unsigned long long)semilla, b_primero);
+        printf("%6s %12s %12s %12s\n", "", "mediana (s)", "media (s)",
+               "desv. (s)");
+        mostrar_lado("A", tiempos_a, ensayos);
+        mostrar_lado("B", tiempos_b, ensayos);
+
+        printf("\nPareado (speedup = T_A / T_B; > 1: B más rápido):\n");
+        printf("  speedup (media geométrica) = %.4f\n", exp(media_log));
+        printf("  IC %.0f %% (bootstrap)        = [%.4f, %.4f]\n",
+               100.0 * CONFIANZA, exp(inferior), exp(superior));
+        printf("  speedup de las medianas    = %.4f\n",
+               est_mediana(tiempos_a, (size_t)ensayos) /
+               est_mediana(tiempos_b, (size_t)ensayos));
+        printf("  ensayos con B más rápido   = %d de %d\n", b_mas_rapido,
+               ensayos);
+        printf("  Wilcoxon (bilateral)       = p %.4f\n",
+               est_wilcoxon_pareado(log_razon, (size_t)ensayos));
+    }
+
+    free(tiempos);
+    free(comandos[0]);
+    free(comandos[1]);
+    return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* Mediana, media y desviación estándar muestral de un lado */
+static void mostrar_lado(const char *nombre, const double *tiempos,
+                         int ensayos)
+{
+    double media = 0.0, cuadrados = 0.0;
+
+    for (int e = 0; e < ensayos; ++e) {
+        media += tiempos[e];
+    }
+    media /= ensayos;
+    for (int e = 0; e < ensayos; ++e) {
+        cuadrados += (tiempos[e] - media) * (tiempos[e] - media);
+    }
+    printf("%6s %12.6f %12.6f %12.6f\n", nombre,
+           est_mediana(tiempos, (size_t)ensayos), media,
+           sqrt(cuadrados / (ensayos - 1)));
+}
+
+/*
+ * medir_configuraciones
+ * -----------------------------------------
+ * Una ejecución de calentamiento por configuración y luego
+ * 'muestras' rondas sobre todas ellas. Informa el avance por stderr.
+ */
+static int medir_configuraciones(const char *binario,
+                                 ConfiguracionBench *configuraciones,
+                                 int num, int muestras)
+{
+    double descarte;
+
+    for (int c = 0; c < num; ++c) {
+        configuraciones[c].num_muestras = 0;
+        if (ejecutar_pi_p(binario, configuraciones[c].hilos,
+                          configuraciones[c].n, &descarte) != 0) {
+            return -1;
+        }
+    }
+    for (int ronda = 0; ronda < muestras; ++ronda) {
+        fprintf(stderr, "\rronda %d de %d", ronda + 1, muestras);
+        for (int c = 0; c < num; ++c) {
+            ConfiguracionBench *conf = &configuraciones[c];
+            if (ejecutar_pi_p(binario, conf->hilos, conf->n,
+                              &conf->muestras[conf->num_muestras]) != 0) {
+                fprintf(stderr, "\n");
+                return -1;
+            }
+            conf->num_muestras++;
+        }
+    }
+    fprintf(stderr, "\n");
+    return 0;
+}
+
+/*
+ * ejecutar_pi_p
+ * -----------------------------------------
+ * Ejecuta 'binario H n' y deja en 'segundos' el tiempo que imprime.
+ */
+static int ejecutar_pi_p(const char *binario, int hilos, int n,
+                         double *segundos)
+{
+    char  texto_hilos[16], texto_n[16];
+    char *argumentos[4];
+
+    snprintf(texto_hilos, sizeof(texto_hilos), "%d", hilos);
+    snprintf(texto_n, sizeof(texto_n), "%d", n);
+    argumentos[0] = (char *)binario;
+    argumentos[1] = texto_hilos;
+    argumentos[2] = texto_n;
+    argumentos[3] = NULL;
+    return ejecutar_comando(argumentos, segundos);
+}
+
+/*
+ * ejecutar_comando
+ * -----------------------------------------
+ * Ejecuta 'argumentos' (terminado en NULL) con la salida estándar en
+ * una tubería y deja en 'segundos' el tiempo de la primera línea
+ * "Tiempo ... (s) = valor" que imprime: el paralelo de pi_p o el
+ * secuencial de pi_s. Retorna 0, o -1 si no se pudo ejecutar,
+ * terminó con error o no imprimió el tiempo.
+ */
+static int ejecutar_comando(char *const argumentos[], double *segundos)
+{
+    int extremos[2];
+    if (pipe(extremos) != 0) {
+        perror("Error en pipe");
+        return -1;
+    }
+
+    pid_t hijo = fork();
+    if (hijo < 0) {
+        perror("Error en fork");
+        close(extremos[0]);
+        close(extremos[1]);
+        return -1;
+    }
+    if (hijo == 0) {
+        close(extremos[0]);
+        dup2(extremos[1], STDOUT_FILENO);
+        close(extremos[1]);
+        unsetenv("TRAZA");
+        execv(argumentos[0], argumentos);
+        perror("Error en exec");
+        _exit(127);
+    }
+    close(extremos[1]);
+
+    /* Lo que no cabe se lee igual y se descarta, para que el hijo no
+     * se bloquee con la tubería llena */
+    char    salida[MAX_SALIDA_HIJO], descarte[4096];
+    size_t  usados = 0;
+    ssize_t leidos;
+    for (;;) {
+        if (usados < sizeof(salida) - 1) {
+            leidos = read(extremos[0], salida + usados,
+                          sizeof(salida) - 1 - usados);
+            usados += (leidos > 0) ? (size_t)leidos : 0;
+        } else {
+            leidos = read(extremos[0], descarte, sizeof(descarte));
+        }
+        if (leidos <= 0) {
+            break;
+        }
+    }
+    salida[usados] = '\0';
+    close(extremos[0]);
+
+    int estado = 0;
+    waitpid(hijo, &estado, 0);
+    if (!WIFEXITED(estado) || WEXITSTATUS(estado) != 0) {
+        fprintf(stderr, "Error: '%s' terminó con error.\n", argumentos[0]);
+        return -1;
+    }
+
+    const char *linea = strstr(salida, "Tiempo ");
+    const char *igual = (linea != NULL) ? strchr(linea, '=') : NULL;
+    if (igual == NULL || strstr(linea, "(s)") > igual ||
+        sscanf(igual + 1, "%lf", segundos) != 1) {
+        fprintf(stderr, "Error: '%s' no imprimió su tiempo.\n",
+                argumentos[0]);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * separar_comando
+ * -----------------------------------------
+ * Parte 'comando' en palabras separadas por espacios o tabuladores
+ * (modificándolo) y deja en 'argumentos' hasta 'maximo' de ellas,
+ * terminadas en NULL. Retorna cuántas hay.
+ */
+static int separar_comando(char *comando, char **argumentos, int maximo)
+{
+    int   cantidad = 0;
+    char *contexto = NULL;
+
+    for (char *palabra = strtok_r(comando, " \t", &contexto);
+         palabra != NULL && cantidad < maximo;
+         palabra = strtok_r(NULL, " \t", &contexto)) {
+        argumentos[cantidad++] = palabra;
+    }
+    argumentos[cantidad] = NULL;
+    return cantidad;
+}
+
+/*
+ * obtener_huella
+ * -----------------------------------------
+ * Modelo de CPU ("model name" de /proc/cpuinfo, o "desconocido"),
+ * CPUs en línea, núcleos físicos (pares distintos de "physical id" y
+ * "core id"; si /proc/cpuinfo no los da, se supone uno por CPU),
+ * versión del kernel y nombre del nodo.
+ */
+static void obtener_huella(HuellaMaquina *huella)
+{
+    struct utsname sistema;
+    char           linea[256];
+    FILE          *cpuinfo = fopen("/proc/cpuinfo", "r");
+
+    static long    pares[MAX_CPUS_HUELLA];   /* (physical id, core id) */
+    int            nucleos = 0;
+    long           fisico  = 0;
+
+    snprintf(huella->cpu, sizeof(huella->cpu), "desconocido");
+    if (cpuinfo != NULL) {
+        while (fgets(linea, sizeof(linea), cpuinfo) != NULL) {
+            char *separador = strchr(linea, ':');
+            if (separador == NULL) {
+                continue;
+            }
+            if (strncmp(linea, "model name", 10) == 0 &&
+                strcmp(huella->cpu, "desconocido") == 0) {
+                separador += strspn(separador + 1, " \t") + 1;
+                separador[strcspn(separador, "\n")] = '\0';
+                snprintf(huella->cpu, sizeof(huella->cpu), "%s", separador);
+            } else if (strncmp(linea, "physical id", 11) == 0) {
+                fisico = atol(separador + 1);
+            } else if (strncmp(linea, "core id", 7) == 0) {
+                long par = fisico * 65536 + atol(separador + 1);
+                int  repetido = 0;
+                for (int i = 0; i < nucleos && !repetido; ++i) {
+                    repetido = (pares[i] == par);
+                }
+                if (!repetido && nucleos < MAX_CPUS_HUELLA) {
+                    pares[nucleos++] = par;
+                }
+            }
+        }
+        fclose(cpuinfo);
+    }
+
+    huella->cpus    = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    huella->nucleos = (nucleos > 0) ? nucleos : huella->cpus;
+    huella->smt     = (huella->nucleos > 0) ? huella->cpus / huella->nucleos : 1;
+    if (uname(&sistema) == 0) {
+        snprintf(huella->kernel, sizeof(huella->kernel), "%s", sistema.release);
+        snprintf(huella->nodo, sizeof(huella->nodo), "%s", sistema.nodename);
+    } else {
+        snprintf(huella->kernel, sizeof(huella->kernel), "desconocido");
+        snprintf(huella->nodo, sizeof(huella->nodo), "desconocido");
+    }
+}
+
+/*
+ * obtener_compilador
+ * -----------------------------------------
+ * Busca en el binario la marca que el compilador deja en la sección
+ * .comment ("GCC: (...) 12.2.0" o "clang version ..."). Las banderas
+ * no quedan registradas (salvo con -frecord-gcc-switches), por eso
+ * se toman de la variable BANDERAS.
+ */
+static void obtener_compilador(const char *binario, char *texto, size_t tam)
+{
+    static const char *const MARCAS[] = { "GCC: (", "clang version " };
+    FILE *archivo = fopen(binario, "rb");
+
+    snprintf(texto, tam, "desconocido");
+    if (archivo == NULL) {
+        return;
+    }
+    fseek(archivo, 0, SEEK_END);
+    long  largo     = ftell(archivo);
+    char *contenido = (largo > 0) ? (char *)malloc((size_t)largo + 1) : NULL;
+    fseek(archivo, 0, SEEK_SET);
+    if (contenido == NULL ||
+        fread(contenido, 1, (size_t)largo, archivo) != (size_t)largo) {
+        free(contenido);
+        fclose(archivo);
+        return;
+    }
+    fclose(archivo);
+    contenido[largo] = '\0';
+
+    /* El binario tiene ceros por todas partes: se busca byte a byte y
+     * la marca termina en el primer cero (fin de la cadena) */
+    for (size_t m = 0; m < sizeof(MARCAS) / sizeof(MARCAS[0]); ++m) {
+        size_t tam_marca = strlen(MARCAS[m]);
+        for (long i = 0; i + (long)tam_marca <= largo; ++i) {
+            if (memcmp(contenido + i, MARCAS[m], tam_marca) == 0) {
+                snprintf(texto, tam, "%.*s", (int)tam - 1, contenido + i);
+                free(contenido);
+                return;
+            }
+        }
+    }
+    free(contenido);
+}
+
+/* El nombre del nodo no cuenta: la misma máquina puede renombrarse */
+static int misma_maquina(const HuellaMaquina *a, const HuellaMaquina *b)
+{
+    return strcmp(a->cpu, b->cpu) == 0 && a->cpus == b->cpus &&
+           strcmp(a->kernel, b->kernel) == 0;
+}
+
+/*
+ * escribir_linea_base
+ * -----------------------------------------
+ * Formato:
+ *   {"maquina": {"cpu": ..., "cpus": ..., "nucleos": ..., "smt": ...,
+ *                "kernel": ..., "nodo": ...},
+ *    "binario": ..., "compilador": ..., "banderas": ...,
+ *    "configuraciones": [{"hilos": H, "n": n, "muestras": [s, ...]}]}
+ */
+static int escribir_linea_base(const char *ruta, const LineaBase *base)
+{
+    FILE *archivo = fopen(ruta, "w");
+    if (archivo == NULL) {
+        perror("Error al crear la línea base");
+        return -1;
+    }
+
+    fprintf(archivo, "{\n  \"maquina\": {\"cpu\": ");
+    escribir_texto_json(archivo, base->huella.cpu);
+    fprintf(archivo, ", \"cpus\": %d, \"nucleos\": %d, \"smt\": %d, "
+            "\"kernel\": ", base->huella.cpus, base->huella.nucleos,
+            base->huella.smt);
+    escribir_texto_json(archivo, base->huella.kernel);
+    fprintf(archivo, ", \"nodo\": ");
+    escribir_texto_json(archivo, base->huella.nodo);
+    fprintf(archivo, "},\n  \"binario\": ");
+    escribir_texto_json(archivo, base->binario);
+    fprintf(archivo, ",\n  \"compilador\": ");
+    escribir_texto_json(archivo, base->compilador);
+    fprintf(archivo, ",\n  \"banderas\": ");
+    escribir_texto_json(archivo, base->banderas);
+    fprintf(archivo, ",\n  \"configuraciones\": [\n");
+    for (int c = 0; c < base->num_configuraciones; ++c) {
+        const ConfiguracionBench *conf = &base->configuraciones[c];
+        fprintf(archivo, "    {\"hilos\": %d, \"n\": %d, \"muestras\": [",
+                conf->hilos, conf->n);
+        for (int m = 0; m < conf->num_muestras; ++m) {
+            fprintf(archivo, "%s%.9g", (m > 0) ? ", " : "", conf->muestras[m]);
+        }
+        fprintf(archivo, "]}%s\n",
+                (c + 1 < base->num_configuraciones) ? "," : "");
+    }
+    fprintf(archivo, "  ]\n}\n");
+
+    if (fclose(archivo) != 0) {
+        perror("Error al escribir la línea base");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * leer_linea_base
+ * -----------------------------------------
+ * Lee el formato que escribe escribir_linea_base (no es un lector de
+ * JSON general): busca las claves por nombre, en orden.
+ */
+static int leer_linea_base(const char *ruta, LineaBase *base)
+{
+    char *json = leer_archivo(ruta);
+    if (json == NULL) {
+        return -1;
+    }
+
+    memset(base, 0, sizeof(*base));
+    leer_texto_json(json, "cpu", base->huella.cpu, sizeof(base->huella.cpu));
+    leer_texto_json(json, "kernel", base->huella.kernel,
+                    sizeof(base->huella.kernel));
+    leer_texto_json(json, "nodo", base->huella.nodo, sizeof(base->huella.nodo));
+    leer_texto_json(json, "binario", base->binario, sizeof(base->binario));
+    leer_texto_json(json, "compilador", base->compilador,
+                    sizeof(base->compilador));
+    leer_texto_json(json, "banderas", base->banderas, sizeof(base->banderas));
+    const char *cpus    = strstr(json, "\"cpus\":");
+    const char *nucleos = strstr(json, "\"nucleos\":");
+    const char *smt     = strstr(json, "\"smt\":");
+    base->huella.cpus    = (cpus != NULL) ? atoi(cpus + 7) : 0;
+    base->huella.nucleos = (nucleos != NULL) ? atoi(nucleos + 10)
+                                             : base->huella.cpus;
+    base->huella.smt     = (smt != NULL) ? atoi(smt + 6) : 1;
+
+    const char *cursor = strstr(json, "\"configuraciones\"");
+    while (cursor != NULL &&
+           (cursor = strstr(cursor, "\"hilos\":")) != NULL &&
+           base->num_configuraciones < MAX_CONFIGURACIONES) {
+        ConfiguracionBench *conf =
+            &base->configuraciones[base->num_configuraciones];
+        const char *n        = strstr(cursor, "\"n\":");
+        const char *muestras = strstr(cursor, "\"muestras\": [");
+        if (n == NULL || muestras == NULL) {
+            break;
+        }
+        conf->hilos = atoi(cursor + 8);
+        conf->n     = atoi(n + 4);
+
+        char *fin = (char *)muestras + 13;
+        while (*fin != ']' && conf->num_muestras < MAX_MUESTRAS) {
+            char  *siguiente;
+            double valor = strtod(fin, &siguiente);
+            if (siguiente == fin) {
+                break;
+            }
+            conf->muestras[conf->num_muestras++] = valor;
+            fin = siguiente + strspn(siguiente, ", \t\n");
+        }
+        if (conf->hilos > 0 && conf->n > 0 && conf->num_muestras > 0) {
+            base->num_configuraciones++;
+        }
+        cursor = fin;
+    }
+    free(json);
+
+    if (base->num_configuraciones == 0 || base->binario[0] == '\0') {
+        fprintf(stderr, "Error: %s no es una línea base de bench_pi.\n", ruta);
+        return -1;
+    }
+    return 0;
+}
+
+/* Contenido completo de 'ruta' terminado en '\0', o NULL */
+static char *leer_archivo(const char *ruta)
+{
+    FILE *archivo = fopen(ruta, "r");
+    if (archivo == NULL) {
+        perror("Error al abrir la línea base");
+        return NULL;
+    }
+
+    size_t capacidad = 1 << 16, usados = 0, leidos;
+    char  *texto = (char *)malloc(capacidad);
+    while (texto != NULL &&
+           (leidos = fread(texto + usados, 1, capacidad - 1 - usados,
+                           archivo)) > 0) {
+        usados += leidos;
+        if (usados == capacidad - 1) {
+            char *mayor = (char *)realloc(texto, capacidad * 2);
+            if (mayor == NULL) {
+                free(texto);
+                texto = NULL;
+                break;
+            }
+            texto      = mayor;
+            capacidad *= 2;
+        }
+    }
+    fclose(archivo);
+    if (texto == NULL) {
+        fprintf(stderr, "Error: fallo al reservar memoria.\n");
+        return NULL;
+    }
+    texto[usados] = '\0';
+    return texto;
+}
+
+/* Texto entre comillas, escapando comillas y barras invertidas */
+static void escribir_texto_json(FILE *archivo, const char *texto)
+{
+    fputc('"', archivo);
+    for (const char *c = texto; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', archivo);
+        }
+        fputc(*c, archivo);
+    }
+    fputc('"', archivo);
+}
+
+/*
+ * leer_texto_json
+ * -----------------------------------------
+ * Valor de texto de la primera aparición de "clave": "...", sin los
+ * escapes. Retorna 0, o -1 si no está (deja 'texto' vacío).
+ */
+static int leer_texto_json(const char *json, const char *clave,
+                           char *texto, size_t tam)
+{
+    char patron[64];
+    snprintf(patron, sizeof(patron), "\"%s\": \"", clave);
+
+    texto[0] = '\0';
+    const char *inicio = strstr(json, patron);
+    if (inicio == NULL) {
+        return -1;
+    }
+    size_t usados = 0;
+    for (const char *c = inicio + strlen(patron);
+         *c != '\0' && *c != '"' && usados + 1 < tam; ++c) {
+        if (*c == '\\' && c[1] != '\0') {
+            ++c;
+        }
+        texto[usados++] = *c;
+    }
+    texto[usados] = '\0';
+    return 0;
+}
@@ -0,0 +1,322 @@
+/*
+ * cache_pi.c
+ * -----------------------------------------
+ * Implementación de la caché persistente de sumas parciales
+ * descrita en cache_pi.h.
+ *
+ * Formato del archivo:
+ *
+ *   [CabeceraCache][EntradaCache x NUM_RANURAS]
+ *
+ * La tabla usa sondeo lineal. Las entradas nunca se borran, por lo
+ * que una ranura ENTRADA_LIBRE marca el final de una cadena de
+ * sondeo y el lector puede detenerse ahí.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "cache_pi.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAGIA_CACHE     "PICACHE1"
+#define VERSION_CACHE   2u      /* 2: bloques sumados por subbloques */
+#define NUM_RANURAS     (1u << 16)
+#define MAX_OCUPADAS    (NUM_RANURAS / 4u * 3u)
+
+/* Estados posibles de una ranura */
+#define ENTRADA_LIBRE 0u
+#define ENTRADA_LISTA 1u
+
+typedef struct {
+    char     magia[8];
+    uint32_t version;
+    uint32_t num_ranuras;
+    uint64_t ocupadas;
+} CabeceraCache;
+
+typedef struct {
+    uint32_t   estado;
+    ClaveCache clave;
+    double     valor;
+} EntradaCache;
+
+/* Prototipos de funciones internas */
+static uint64_t      hash_clave(const ClaveCache *clave);
+static int           claves_iguales(const ClaveCache *a, const ClaveCache *b);
+static EntradaCache *entradas_de(const CachePi *cache);
+
+/*
+ * cache_pi_abrir
+ * -----------------------------------------
+ * Abre (o crea e inicializa) el archivo de caché en 'ruta' y lo
+ * proyecta en memoria compartida.
+ *
+ * Retorna:
+ *  - 0 si la caché quedó lista para usarse.
+ *  - -1 en caso de error (se informa por stderr).
+ */
+int cache_pi_abrir(CachePi *cache, const char *ruta)
+{
+    const size_t tam = sizeof(CabeceraCache) +
+                       sizeof(EntradaCache) * (size_t)NUM_RANURAS;
+
+    cache->descriptor = -1;
+    cache->base       = NULL;
+    cache->tam_mapeo  = 0;
+
+    int fd = open(ruta, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        perror("Error al abrir el archivo de caché");
+        return -1;
+    }
+
+    /* La inicialización se hace bajo bloqueo para que dos procesos
+     * que crean la caché a la vez no la inicialicen dos veces. */
+    if (flock(fd, LOCK_EX) != 0) {
+        perror("Error en flock sobre la caché");
+        close(fd);
+        return -1;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        perror("Error en fstat sobre la caché");
+        flock(fd, LOCK_UN);
+        close(fd);
+        return -1;
+    }
+
+    int nueva = (info.st_size == 0);
+    if (nueva && ftruncate(fd, (off_t)tam) != 0) {
+        perror("Error al dimensionar la caché");
+        flock(fd, LOCK_UN);
+        close(fd);
+        return -1;
+    }
+    if (!nueva && (size_t)info.st_size != tam) {
+        fprintf(stderr,
+                "Error: '%s' no es una caché válida (tamaño %lld).\n",
+                ruta, (long long)info.st_size);
+        flock(fd, LOCK_UN);
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, tam, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        perror("Error en mmap de la caché");
+        flock(fd, LOCK_UN);
+        close(fd);
+        return -1;
+    }
+
+    CabeceraCache *cabecera = (CabeceraCache *)base;
+    if (nueva) {
+        /* ftruncate deja el archivo en ceros: todas las ranuras libres */
+        memcpy(cabecera->magia, MAGIA_CACHE, sizeof(cabecera->magia));
+        cabecera->version     = VERSION_CACHE;
+        cabecera->num_ranuras = NUM_RANURAS;
+        cabecera->ocupadas    = 0;
+    } else if (memcmp(cabecera->magia, MAGIA_CACHE,
+                      sizeof(cabecera->magia)) != 0 ||
+               cabecera->version != VERSION_CACHE ||
+               cabecera->num_ranuras != NUM_RANURAS) {
+        fprintf(stderr, "Error: '%s' no es una caché compatible.\n", ruta);
+        munmap(base, tam);
+        flock(fd, LOCK_UN);
+        close(fd);
+        return -1;
+    }
+
+    flock(fd, LOCK_UN);
+
+    cache->descriptor = fd;
+    cache->base       = base;
+    cache->tam_mapeo  = tam;
+    return 0;
+}
+
+/*
+ * cache_pi_cerrar
+ * -----------------------------------------
+ * Libera la proyección y el descriptor de la caché.
+ */
+void cache_pi_cerrar(CachePi *cache)
+{
+    if (cache->base != NULL) {
+        munmap(cache->base, cache->tam_mapeo);
+    }
+    if (cache->descriptor >= 0) {
+        close(cache->descriptor);
+    }
+    cache->descriptor = -1;
+    cache->base       = NULL;
+    cache->tam_mapeo  = 0;
+}
+
+/*
+ * cache_pi_buscar
+ * -----------------------------------------
+ * Busca la suma asociada a 'clave' sin tomar bloqueos.
+ *
+ * Retorna:
+ *  - 1 si la entrada existe (y deja la suma en *valor).
+ *  - 0 si no existe.
+ */
+int cache_pi_buscar(const CachePi *cache, const ClaveCache *clave,
+                    double *valor)
+{
+    EntradaCache *entradas = entradas_de(cache);
+    uint32_t indice = (uint32_t)hash_clave(clave) & (NUM_RANURAS - 1u);
+
+    for (uint32_t sondeo = 0; sondeo < NUM_RANURAS; ++sondeo) {
+        EntradaCache *entrada = &entradas[indice];
+        uint32_t estado = __atomic_load_n(&entrada->estado, __ATOMIC_ACQUIRE);
+
+        if (estado == ENTRADA_LIBRE) {
+            return 0;
+        }
+        if (claves_iguales(&entrada->clave, clave)) {
+            *valor = entrada->valor;
+            return 1;
+        }
+        indice = (indice + 1u) & (NUM_RANURAS - 1u);
+    }
+
+    return 0;
+}
+
+/*
+ * cache_pi_guardar
+ * -----------------------------------------
+ * Inserta la suma asociada a 'clave'. Si otro proceso ya la
+ * insertó, no hace nada.
+ *
+ * Retorna:
+ *  - 0 si la entrada quedó almacenada (por este u otro proceso).
+ *  - -1 si la tabla está llena o no se pudo tomar el bloqueo.
+ */
+int cache_pi_guardar(CachePi *cache, const ClaveCache *clave, double valor)
+{
+    CabeceraCache *cabecera = (CabeceraCache *)cache->base;
+    EntradaCache  *entradas = entradas_de(cache);
+
+    if (flock(cache->descriptor, LOCK_EX) != 0) {
+        return -1;
+    }
+
+    int resultado = -1;
+    uint32_t indice = (uint32_t)hash_clave(clave) & (NUM_RANURAS - 1u);
+
+    for (uint32_t sondeo = 0; sondeo < NUM_RANURAS; ++sondeo) {
+        EntradaCache *entrada = &entradas[indice];
+
+        if (entrada->estado == ENTRADA_LIBRE) {
+            if (cabecera->ocupadas >= MAX_OCUPADAS) {
+                break;
+            }
+            entrada->clave = *clave;
+            entrada->valor = valor;
+            /* Publicamos la entrada solo cuando ya está completa */
+            __atomic_store_n(&entrada->estado, ENTRADA_LISTA,
+                             __ATOMIC_RELEASE);
+            cabecera->ocupadas++;
+            resultado = 0;
+            break;
+        }
+        if (claves_iguales(&entrada->clave, clave)) {
+            resultado = 0;
+            break;
+        }
+        indice = (indice + 1u) & (NUM_RANURAS - 1u);
+    }
+
+    flock(cache->descriptor, LOCK_UN);
+    return resultado;
+}
+
+/*
+ * cache_pi_num_bloques
+ * -----------------------------------------
+ * Número de bloques de la rejilla común para n subintervalos.
+ */
+int64_t cache_pi_num_bloques(int64_t n)
+{
+    return (n + TAM_BLOQUE_CACHE - 1) / TAM_BLOQUE_CACHE;
+}
+
+/*
+ * cache_pi_clave_bloque
+ * -----------------------------------------
+ * Construye la clave del bloque número 'bloque' de la rejilla
+ * común para la integral de 4 / (1 + x^2) con la regla del punto
+ * medio en doble precisión. El último bloque puede ser más corto.
+ */
+ClaveCache cache_pi_clave_bloque(int64_t n, int64_t bloque)
+{
+    ClaveCache clave;
+
+    memset(&clave, 0, sizeof(clave));
+    clave.integrando = INTEGRANDO_CUATRO_SOBRE_UNO_MAS_X2;
+    clave.regla      = REGLA_PUNTO_MEDIO;
+    clave.precision  = PRECISION_DOBLE;
+    clave.n          = n;
+    clave.inicio     = bloque * TAM_BLOQUE_CACHE;
+    clave.fin        = clave.inicio + TAM_BLOQUE_CACHE;
+    if (clave.fin > n) {
+        clave.fin = n;
+    }
+
+    return clave;
+}
+
+/*
+ * hash_clave
+ * -----------------------------------------
+ * Mezcla los campos de la clave (finalizador de splitmix64).
+ */
+static uint64_t hash_clave(const ClaveCache *clave)
+{
+    uint64_t campos[4] = {
+        ((uint64_t)clave->integrando << 40) ^
+            ((uint64_t)clave->regla << 20) ^ clave->precision,
+        (uint64_t)clave->n,
+        (uint64_t)clave->inicio,
+        (uint64_t)clave->fin
+    };
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+
+    for (int i = 0; i < 4; ++i) {
+        h ^= campos[i];
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+    }
+
+    return h;
+}
+
+static int claves_iguales(const ClaveCache *a, const ClaveCache *b)
+{
+    return a->integrando == b->integrando &&
+           a->regla      == b->regla &&
+           a->precision  == b->precision &&
+           a->n          == b->n &&
+           a->inicio     == b->inicio &&
+           a->fin        == b->fin;
+}
+
+static EntradaCache *entradas_de(const CachePi *cache)
+{
+    return (EntradaCache *)((char *)cache->base + sizeof(CabeceraCache));
+}
@@ -0,0 +1,85 @@
+/*
+ * cache_pi.h
+ * -----------------------------------------
+ * Caché persistente de resultados de integración, compartida
+ * entre pi.c y pi_p.c.
+ *
+ * La caché es un archivo proyectado en memoria (mmap) con una
+ * tabla hash de direccionamiento abierto. Cada entrada guarda la
+ * suma de f(x_i) sobre un rango de índices [inicio, fin) para una
+ * combinación (integrando, n, regla, precisión).
+ *
+ * El rango [0, n) se recorre en bloques de tamaño fijo
+ * (TAM_BLOQUE_CACHE) para que ambas versiones, con cualquier
+ * número de hilos, produzcan y reutilicen exactamente las mismas
+ * sumas parciales. La suma de un bloque es, por definición, la suma
+ * en orden de las sumas de sus subbloques (TAM_SUBBLOQUE_CACHE):
+ * así varios hilos pueden repartirse un mismo bloque y obtener el
+ * mismo valor que el recorrido secuencial.
+ *
+ * Concurrencia entre procesos:
+ *  - Las lecturas no toman bloqueos: una entrada solo es visible
+ *    cuando su campo 'estado' pasa a ENTRADA_LISTA (release/acquire).
+ *  - Las inserciones se serializan con flock(LOCK_EX) sobre el
+ *    archivo, de modo que dos procesos nunca ocupan la misma ranura.
+ */
+
+#ifndef CACHE_PI_H
+#define CACHE_PI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Identificadores de los parámetros que forman parte de la clave */
+#define INTEGRANDO_CUATRO_SOBRE_UNO_MAS_X2 1u
+#define REGLA_PUNTO_MEDIO                  1u
+#define PRECISION_DOBLE                    ((uint32_t)sizeof(double))
+
+/* Número de iteraciones por bloque de la rejilla común */
+#define TAM_BLOQUE_CACHE (1 << 24)
+
+/* Iteraciones por subbloque; TAM_BLOQUE_CACHE es múltiplo */
+#define TAM_SUBBLOQUE_CACHE   (1 << 20)
+#define SUBBLOQUES_POR_BLOQUE (TAM_BLOQUE_CACHE / TAM_SUBBLOQUE_CACHE)
+
+/*
+ * ClaveCache
+ * -----------------------------------------
+ * Identifica una suma parcial almacenada:
+ *  - integrando, regla, precision: qué se integró y cómo.
+ *  - n     : número total de subintervalos (define h = 1/n).
+ *  - inicio: primer índice del rango (inclusive).
+ *  - fin   : último índice del rango (exclusive).
+ */
+typedef struct {
+    uint32_t integrando;
+    uint32_t regla;
+    uint32_t precision;
+    int64_t  n;
+    int64_t  inicio;
+    int64_t  fin;
+} ClaveCache;
+
+/*
+ * CachePi
+ * -----------------------------------------
+ * Descriptor de una caché abierta. Sus campos son internos.
+ */
+typedef struct {
+    int    descriptor;
+    void  *base;
+    size_t tam_mapeo;
+} CachePi;
+
+int  cache_pi_abrir(CachePi *cache, const char *ruta);
+void cache_pi_cerrar(CachePi *cache);
+int  cache_pi_buscar(const CachePi *cache, const ClaveCache *clave,
+                     double *valor);
+int  cache_pi_guardar(CachePi *cache, const ClaveCache *clave,
+                      double valor);
+
+/* Clave del bloque 'bloque' de la rejilla común para un n dado */
+ClaveCache cache_pi_clave_bloque(int64_t n, int64_t bloque);
+int64_t    cache_pi_num_bloques(int64_t n);
+
+#endif /* CACHE_PI_H */
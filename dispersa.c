@@ -0,0 +1,270 @@
+/*
+ * dispersa.c
+ * -----------------------------------------
+ * Implementación del almacenamiento disperso declarado en
+ * dispersa.h.
+ *
+ * La caché de cada hilo se guarda en una clave de pthread (con
+ * destructor), asociada a la última SecuenciaDispersa consultada:
+ * si el hilo pasa a consultar otra, la caché se invalida.
+ */
+
+#include "dispersa.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_CURSORES 64
+
+/*
+ * Cursor
+ * -----------------------------------------
+ * Par (F(indice), F(indice + 1)) reconstruido recientemente.
+ * 'ultimo_uso' ordena los cursores para el reemplazo LRU.
+ */
+typedef struct {
+    uint64_t     indice;
+    EnteroGrande fk;
+    EnteroGrande fk1;
+    uint64_t     ultimo_uso;
+    int          valido;
+} Cursor;
+
+/*
+ * CacheHilo
+ * -----------------------------------------
+ * Caché LRU de un hilo para la secuencia 'duena'.
+ */
+typedef struct {
+    const SecuenciaDispersa *duena;
+    int                      num_cursores;
+    uint64_t                 reloj;
+    Cursor                   cursores[MAX_CURSORES];
+} CacheHilo;
+
+static pthread_key_t  clave_cache;
+static pthread_once_t clave_creada = PTHREAD_ONCE_INIT;
+static int            cursores_por_hilo = SD_CURSORES_POR_DEFECTO;
+
+/* Prototipos de funciones internas */
+static void       crear_clave(void);
+static void       destruir_cache(void *argumento);
+static CacheHilo *cache_del_hilo(const SecuenciaDispersa *s);
+static int        avanzar(Cursor *c, uint64_t destino);
+static int        retroceder(Cursor *c, uint64_t destino);
+
+int sd_construir(SecuenciaDispersa *s, uint64_t cantidad, uint64_t paso)
+{
+    s->cantidad   = cantidad;
+    s->paso       = (paso > 0) ? paso : 1;
+    s->num_puntos = (size_t)((cantidad + s->paso - 1) / s->paso);
+    s->puntos     = (EnteroGrande *)calloc(2 * s->num_puntos + 1,
+                                           sizeof(EnteroGrande));
+    if (s->puntos == NULL) {
+        return -1;
+    }
+
+    EnteroGrande actual, siguiente;
+    eg_iniciar(&actual);
+    eg_iniciar(&siguiente);
+    int codigo = (eg_asignar_u64(&actual, 0) != 0 ||
+                  eg_asignar_u64(&siguiente, 1) != 0) ? -1 : 0;
+
+    for (uint64_t i = 0; i < cantidad && codigo == 0; ++i) {
+        if (i % s->paso == 0) {
+            size_t j = (size_t)(i / s->paso);
+            if (eg_copiar(&s->puntos[2 * j], &actual) != 0 ||
+                eg_copiar(&s->puntos[2 * j + 1], &siguiente) != 0) {
+                codigo = -1;
+                break;
+            }
+        }
+
+        /* (F(i), F(i+1)) -> (F(i+1), F(i+2)) */
+        if (eg_sumar(&actual, &actual, &siguiente) != 0) {
+            codigo = -1;
+        }
+        EnteroGrande tmp = actual;
+        actual    = siguiente;
+        siguiente = tmp;
+    }
+
+    eg_liberar(&actual);
+    eg_liberar(&siguiente);
+    if (codigo != 0) {
+        sd_liberar(s);
+    }
+    return codigo;
+}
+
+void sd_liberar(SecuenciaDispersa *s)
+{
+    if (s->puntos != NULL) {
+        for (size_t j = 0; j < 2 * s->num_puntos; ++j) {
+            eg_liberar(&s->puntos[j]);
+        }
+    }
+    free(s->puntos);
+    s->puntos     = NULL;
+    s->num_puntos = 0;
+}
+
+size_t sd_bytes(const SecuenciaDispersa *s)
+{
+    size_t bytes = sizeof(EnteroGrande) * 2 * s->num_puntos;
+
+    for (size_t j = 0; j < 2 * s->num_puntos; ++j) {
+        bytes += sizeof(uint64_t) * s->puntos[j].capacidad;
+    }
+    return bytes;
+}
+
+void sd_configurar_cursores(int cursores)
+{
+    if (cursores < 1) {
+        cursores = 1;
+    }
+    cursores_por_hilo = (cursores > MAX_CURSORES) ? MAX_CURSORES : cursores;
+}
+
+/*
+ * sd_obtener
+ * -----------------------------------------
+ * Elige el punto de partida más barato entre:
+ *  - un cursor de la caché con indice <= i (avanzar i - indice),
+ *  - el punto de control anterior (avanzar) o el siguiente
+ *    (retroceder),
+ * y deja el cursor usado en i. Si se parte de un punto de control,
+ * el cursor ocupa la entrada menos usada recientemente.
+ */
+int sd_obtener(const SecuenciaDispersa *s, uint64_t i, EnteroGrande *resultado)
+{
+    CacheHilo *cache = cache_del_hilo(s);
+    if (cache == NULL) {
+        return -1;
+    }
+
+    Cursor  *elegido = NULL;
+    uint64_t costo   = UINT64_MAX;
+
+    for (int c = 0; c < cache->num_cursores; ++c) {
+        Cursor *cursor = &cache->cursores[c];
+        if (cursor->valido && cursor->indice <= i &&
+            i - cursor->indice < costo) {
+            elegido = cursor;
+            costo   = i - cursor->indice;
+        }
+    }
+
+    uint64_t anterior  = (i / s->paso) * s->paso;
+    uint64_t posterior = anterior + s->paso;
+    int hacia_atras = (posterior < s->cantidad && posterior - i < i - anterior);
+    uint64_t costo_punto = hacia_atras ? posterior - i : i - anterior;
+
+    if (elegido == NULL || costo_punto < costo) {
+        /* Reemplazo LRU */
+        elegido = &cache->cursores[0];
+        for (int c = 1; c < cache->num_cursores; ++c) {
+            Cursor *cursor = &cache->cursores[c];
+            if (!cursor->valido ||
+                (elegido->valido && cursor->ultimo_uso < elegido->ultimo_uso)) {
+                elegido = cursor;
+            }
+        }
+
+        uint64_t punto = hacia_atras ? posterior : anterior;
+        size_t   j     = (size_t)(punto / s->paso);
+        elegido->valido = 0;
+        if (eg_copiar(&elegido->fk, &s->puntos[2 * j]) != 0 ||
+            eg_copiar(&elegido->fk1, &s->puntos[2 * j + 1]) != 0) {
+            return -1;
+        }
+        elegido->indice = punto;
+        elegido->valido = 1;
+    }
+
+    int codigo = (elegido->indice > i) ? retroceder(elegido, i)
+                                       : avanzar(elegido, i);
+    if (codigo != 0) {
+        elegido->valido = 0;
+        return -1;
+    }
+
+    elegido->ultimo_uso = ++cache->reloj;
+    return eg_copiar(resultado, &elegido->fk);
+}
+
+static void crear_clave(void)
+{
+    pthread_key_create(&clave_cache, destruir_cache);
+}
+
+static void destruir_cache(void *argumento)
+{
+    CacheHilo *cache = (CacheHilo *)argumento;
+
+    for (int c = 0; c < MAX_CURSORES; ++c) {
+        eg_liberar(&cache->cursores[c].fk);
+        eg_liberar(&cache->cursores[c].fk1);
+    }
+    free(cache);
+}
+
+/*
+ * cache_del_hilo
+ * -----------------------------------------
+ * Caché del hilo actual, creada en el primer uso e invalidada si la
+ * secuencia consultada cambió.
+ */
+static CacheHilo *cache_del_hilo(const SecuenciaDispersa *s)
+{
+    pthread_once(&clave_creada, crear_clave);
+
+    CacheHilo *cache = (CacheHilo *)pthread_getspecific(clave_cache);
+    if (cache == NULL) {
+        cache = (CacheHilo *)calloc(1, sizeof(CacheHilo));
+        if (cache == NULL || pthread_setspecific(clave_cache, cache) != 0) {
+            free(cache);
+            return NULL;
+        }
+        cache->num_cursores = cursores_por_hilo;
+    }
+
+    if (cache->duena != s) {
+        for (int c = 0; c < MAX_CURSORES; ++c) {
+            cache->cursores[c].valido = 0;
+        }
+        cache->duena = s;
+    }
+    return cache;
+}
+
+/* (F(k), F(k+1)) -> (F(destino), F(destino+1)) con sumas */
+static int avanzar(Cursor *c, uint64_t destino)
+{
+    for (; c->indice < destino; c->indice++) {
+        if (eg_sumar(&c->fk, &c->fk, &c->fk1) != 0) {
+            return -1;
+        }
+        EnteroGrande tmp = c->fk;
+        c->fk  = c->fk1;
+        c->fk1 = tmp;
+    }
+    return 0;
+}
+
+/* (F(k), F(k+1)) -> (F(destino), F(destino+1)) con restas */
+static int retroceder(Cursor *c, uint64_t destino)
+{
+    for (; c->indice > destino; c->indice--) {
+        /* F(k-1) = F(k+1) - F(k), que pasa a ser el nuevo fk */
+        if (eg_restar(&c->fk1, &c->fk1, &c->fk) != 0) {
+            return -1;
+        }
+        EnteroGrande tmp = c->fk;
+        c->fk  = c->fk1;
+        c->fk1 = tmp;
+    }
+    return 0;
+}
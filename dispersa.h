@@ -0,0 +1,63 @@
+/*
+ * dispersa.h
+ * -----------------------------------------
+ * Almacenamiento disperso de F(0) .. F(N-1) con puntos de control.
+ *
+ * Guardar todos los términos grandes cuesta O(N^2) bits. Aquí solo
+ * se guarda un par consecutivo (F(jK), F(jK + 1)) cada K términos,
+ * y cualquier otro F(i) se reconstruye al pedirlo:
+ *  - hacia adelante con sumas desde el punto anterior, o
+ *  - hacia atrás con restas, F(i-1) = F(i+1) - F(i), desde el
+ *    siguiente,
+ * lo que esté más cerca (a lo sumo K / 2 pasos).
+ *
+ * Cada hilo tiene además una pequeña caché LRU de cursores
+ * (i, F(i), F(i+1)); un acceso cercano a uno anterior, en particular
+ * un recorrido secuencial, avanza desde el cursor en lugar de volver
+ * al punto de control.
+ *
+ * K regula el compromiso: la memoria es ~1/K de la del arreglo
+ * completo y el costo por acceso aleatorio crece como K.
+ */
+
+#ifndef DISPERSA_H
+#define DISPERSA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "entero_grande.h"
+
+typedef struct {
+    uint64_t      cantidad;     /* términos F(0) .. F(cantidad - 1) */
+    uint64_t      paso;         /* K */
+    size_t        num_puntos;
+    EnteroGrande *puntos;       /* 2 * num_puntos: F(jK), F(jK + 1) */
+} SecuenciaDispersa;
+
+/* Cursores por hilo en la caché LRU (por defecto 4) */
+#define SD_CURSORES_POR_DEFECTO 4
+
+/*
+ * sd_construir: recorre la sucesión una vez guardando los puntos de
+ * control. Retorna 0 si tuvo éxito, -1 si faltó memoria.
+ * sd_liberar: libera los puntos de control (las cachés de los hilos
+ * se liberan al terminar cada hilo).
+ */
+int  sd_construir(SecuenciaDispersa *s, uint64_t cantidad, uint64_t paso);
+void sd_liberar(SecuenciaDispersa *s);
+
+/* Bytes ocupados por los puntos de control */
+size_t sd_bytes(const SecuenciaDispersa *s);
+
+/*
+ * sd_obtener: resultado = F(i), con i < cantidad. Puede llamarse
+ * desde varios hilos a la vez. Retorna 0 si tuvo éxito, -1 si faltó
+ * memoria.
+ * sd_configurar_cursores: tamaño de la caché LRU de los hilos que
+ * aún no la han creado (1 a 64).
+ */
+int  sd_obtener(const SecuenciaDispersa *s, uint64_t i, EnteroGrande *resultado);
+void sd_configurar_cursores(int cursores);
+
+#endif /* DISPERSA_H */
@@ -0,0 +1,1484 @@
+/*
+ * entero_grande.c
+ * -----------------------------------------
+ * Implementación de la aritmética de precisión arbitraria
+ * declarada en entero_grande.h.
+ *
+ * Las rutinas internas (prefijo pal_) operan sobre arreglos de
+ * palabras con longitud explícita; las públicas (prefijo eg_) se
+ * encargan de la memoria de los EnteroGrande.
+ *
+ * Los productos y divisiones de una palabra usan unsigned __int128
+ * (extensión de GCC/Clang) como acumulador de doble ancho.
+ *
+ * Los productos grandes se delegan en ntt.c.
+ */
+
+#include "entero_grande.h"
+#include "ntt.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 10^19: mayor potencia de 10 que cabe en una palabra */
+#define BASE_DECIMAL       10000000000000000000ULL
+#define DIGITOS_POR_BLOQUE 19
+
+/* Umbrales por defecto (en palabras); ver UmbralesMultiplicacion */
+#define UMBRAL_KARATSUBA 32
+#define UMBRAL_TOOM3     256
+#define UMBRAL_NTT       8192
+
+/* Máximo de hilos que aprovecha una NTT (dos por primo) */
+#define MAX_HILOS_NTT 6
+
+/* Por debajo de este tamaño la conversión decimal es la ingenua */
+#define UMBRAL_DECIMAL_DYV 40
+
+/* Ramas más pequeñas que esto no compensan crear un hilo */
+#define UMBRAL_DECIMAL_HILOS 2048
+
+/* Niveles de potencias 10^(19*2^i) que pueden guardarse en caché */
+#define MAX_NIVELES_DECIMAL 48
+
+typedef unsigned __int128 u128;
+
+/*
+ * ConfigMultiplicacion
+ * -----------------------------------------
+ * Umbrales e hilos con que se resuelve un producto; se propaga por
+ * toda la recursión para que un algoritmo forzado se respete en los
+ * subproductos.
+ */
+typedef struct {
+    UmbralesMultiplicacion umbrales;
+    int                    hilos;
+} ConfigMultiplicacion;
+
+/*
+ * Firmado
+ * -----------------------------------------
+ * Entero con signo (signo y magnitud) para los valores intermedios
+ * de Toom-3, que pueden ser negativos.
+ */
+typedef struct {
+    uint64_t *palabras;
+    size_t    longitud;
+    int       negativo;
+} Firmado;
+
+/*
+ * NivelDecimal
+ * -----------------------------------------
+ * Datos precalculados para dividir entre 10^(19*2^i):
+ *  - divisor   : la potencia desplazada 'desplazamiento' bits a la
+ *                izquierda para que su palabra alta tenga el bit
+ *                superior encendido (k palabras).
+ *  - reciproco : floor(B^(2k) / divisor), k + 1 palabras.
+ */
+typedef struct {
+    uint64_t *divisor;
+    uint64_t *reciproco;
+    size_t    k;
+    unsigned  desplazamiento;
+} NivelDecimal;
+
+/*
+ * TareaDecimal
+ * -----------------------------------------
+ * Argumentos de una rama de la conversión decimal ejecutada en un
+ * hilo aparte.
+ */
+typedef struct {
+    uint64_t *palabras;
+    size_t    longitud;
+    int       nivel;
+    char     *destino;
+    int       hilos;
+} TareaDecimal;
+
+/* Configuración global de la multiplicación */
+static ConfigMultiplicacion config_global = {
+    { UMBRAL_KARATSUBA, UMBRAL_TOOM3, UMBRAL_NTT }, 1
+};
+static pthread_once_t config_leida = PTHREAD_ONCE_INIT;
+
+/* Caché de niveles, compartida por todos los hilos del proceso */
+static NivelDecimal    niveles_decimales[MAX_NIVELES_DECIMAL];
+static int             niveles_listos = 0;
+static pthread_mutex_t mutex_niveles  = PTHREAD_MUTEX_INITIALIZER;
+
+/* Prototipos de funciones internas */
+static void    *reservar_o_abortar(size_t tam);
+static size_t   pal_normalizar(const uint64_t *a, size_t n);
+static int      pal_comparar(const uint64_t *a, size_t la,
+                             const uint64_t *b, size_t lb);
+static uint64_t pal_sumar_en(uint64_t *r, size_t lr,
+                             const uint64_t *a, size_t la);
+static uint64_t pal_restar_en(uint64_t *r, size_t lr,
+                              const uint64_t *a, size_t la);
+static size_t   pal_sumar_total(uint64_t *r, const uint64_t *a, size_t la,
+                                const uint64_t *b, size_t lb);
+static size_t   pal_restar_total(uint64_t *r, const uint64_t *a, size_t la,
+                                 const uint64_t *b, size_t lb);
+static void     leer_config_entorno(void);
+static const ConfigMultiplicacion *config_actual(void);
+static void     pal_multiplicar(uint64_t *r, const uint64_t *a, size_t la,
+                                const uint64_t *b, size_t lb);
+static void     pal_multiplicar_con(uint64_t *r, const uint64_t *a, size_t la,
+                                    const uint64_t *b, size_t lb,
+                                    const ConfigMultiplicacion *config);
+static void     pal_mul_escolar(uint64_t *r, const uint64_t *a, size_t la,
+                                const uint64_t *b, size_t lb);
+static void     pal_mul_karatsuba(uint64_t *r, const uint64_t *a, size_t la,
+                                  const uint64_t *b, size_t lb,
+                                  const ConfigMultiplicacion *config);
+static void     pal_mul_toom3(uint64_t *r, const uint64_t *a, size_t la,
+                              const uint64_t *b, size_t lb,
+                              const ConfigMultiplicacion *config);
+static void     firmado_combinar(Firmado *r, const Firmado *x,
+                                 const Firmado *y, int restar);
+static void     firmado_multiplicar(Firmado *r, const Firmado *x,
+                                    const Firmado *y,
+                                    const ConfigMultiplicacion *config);
+static void     pal_reciproco(const uint64_t *d, size_t k, uint64_t *r);
+static void     pal_dividir_nivel(const NivelDecimal *nivel,
+                                  const uint64_t *y, size_t ly,
+                                  uint64_t *q, size_t *lq,
+                                  uint64_t *resto, size_t *lresto);
+static int      preparar_niveles(size_t longitud);
+static void     decimal_ancho_fijo(uint64_t *palabras, size_t longitud,
+                                   char *destino, size_t ancho);
+static void     decimal_dyv(uint64_t *palabras, size_t longitud, int nivel,
+                            char *destino, int hilos);
+static void    *hilo_decimal(void *argumento);
+static size_t   escribir_bloques_decimales(uint64_t *palabras, size_t longitud,
+                                           char *destino, size_t tam_destino);
+static void     normalizar(EnteroGrande *x);
+
+void eg_iniciar(EnteroGrande *x)
+{
+    x->palabras  = NULL;
+    x->longitud  = 0;
+    x->capacidad = 0;
+}
+
+void eg_liberar(EnteroGrande *x)
+{
+    if (x->capacidad > 0) {
+        free(x->palabras);
+    }
+    eg_iniciar(x);
+}
+
+/*
+ * eg_reservar
+ * -----------------------------------------
+ * Garantiza espacio para al menos 'capacidad' palabras,
+ * conservando el valor actual.
+ */
+int eg_reservar(EnteroGrande *x, size_t capacidad)
+{
+    if (capacidad <= x->capacidad) {
+        return 0;
+    }
+
+    /* Crecimiento geométrico para amortizar sumas sucesivas */
+    size_t nueva = x->capacidad * 2;
+    if (nueva < capacidad) {
+        nueva = capacidad;
+    }
+
+    uint64_t *palabras = (uint64_t *)realloc(x->palabras,
+                                             sizeof(uint64_t) * nueva);
+    if (palabras == NULL) {
+        return -1;
+    }
+
+    x->palabras  = palabras;
+    x->capacidad = nueva;
+    return 0;
+}
+
+int eg_asignar_u64(EnteroGrande *x, uint64_t valor)
+{
+    if (eg_reservar(x, 1) != 0) {
+        return -1;
+    }
+    x->palabras[0] = valor;
+    x->longitud    = (valor != 0) ? 1 : 0;
+    return 0;
+}
+
+int eg_asignar_u128(EnteroGrande *x, unsigned __int128 valor)
+{
+    if (eg_reservar(x, 2) != 0) {
+        return -1;
+    }
+    x->palabras[0] = (uint64_t)valor;
+    x->palabras[1] = (uint64_t)(valor >> 64);
+    x->longitud    = pal_normalizar(x->palabras, 2);
+    return 0;
+}
+
+int eg_copiar(EnteroGrande *destino, const EnteroGrande *origen)
+{
+    if (destino == origen) {
+        return 0;
+    }
+    if (eg_reservar(destino, origen->longitud) != 0) {
+        return -1;
+    }
+    if (origen->longitud > 0) {
+        memcpy(destino->palabras, origen->palabras,
+               sizeof(uint64_t) * origen->longitud);
+    }
+    destino->longitud = origen->longitud;
+    return 0;
+}
+
+EnteroGrande eg_vista(const uint64_t *palabras, size_t longitud)
+{
+    EnteroGrande vista;
+
+    vista.palabras  = (uint64_t *)palabras;
+    vista.longitud  = longitud;
+    vista.capacidad = 0;
+    normalizar(&vista);
+
+    return vista;
+}
+
+int eg_comparar(const EnteroGrande *a, const EnteroGrande *b)
+{
+    return pal_comparar(a->palabras, a->longitud, b->palabras, b->longitud);
+}
+
+/*
+ * eg_sumar
+ * -----------------------------------------
+ * Suma con propagación de acarreo palabra a palabra.
+ */
+int eg_sumar(EnteroGrande *r, const EnteroGrande *a, const EnteroGrande *b)
+{
+    /* Ordenamos para que 'a' sea el operando más largo */
+    if (a->longitud < b->longitud) {
+        const EnteroGrande *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    size_t la = a->longitud;
+    size_t lb = b->longitud;
+
+    /* Leemos a->palabras después de reservar: si r == a, realloc
+     * pudo moverlas. */
+    if (eg_reservar(r, la + 1) != 0) {
+        return -1;
+    }
+
+    const uint64_t *pa = a->palabras;
+    const uint64_t *pb = b->palabras;
+    uint64_t acarreo = 0;
+    size_t i = 0;
+
+    for (; i < lb; ++i) {
+        u128 s = (u128)pa[i] + pb[i] + acarreo;
+        r->palabras[i] = (uint64_t)s;
+        acarreo        = (uint64_t)(s >> 64);
+    }
+    for (; i < la; ++i) {
+        u128 s = (u128)pa[i] + acarreo;
+        r->palabras[i] = (uint64_t)s;
+        acarreo        = (uint64_t)(s >> 64);
+    }
+
+    r->palabras[la] = acarreo;
+    r->longitud     = la + (acarreo != 0 ? 1 : 0);
+    return 0;
+}
+
+/*
+ * eg_restar
+ * -----------------------------------------
+ * Resta con préstamo palabra a palabra; requiere a >= b.
+ */
+int eg_restar(EnteroGrande *r, const EnteroGrande *a, const EnteroGrande *b)
+{
+    size_t la = a->longitud;
+    size_t lb = b->longitud;
+
+    if (r == b && r != a) {
+        /* a - r: restamos sobre una copia de a */
+        EnteroGrande diferencia;
+        eg_iniciar(&diferencia);
+        if (eg_copiar(&diferencia, a) != 0) {
+            return -1;
+        }
+        pal_restar_en(diferencia.palabras, la, b->palabras, lb);
+        diferencia.longitud = pal_normalizar(diferencia.palabras, la);
+        eg_liberar(r);
+        *r = diferencia;
+        return 0;
+    }
+
+    if (eg_reservar(r, la) != 0) {
+        return -1;
+    }
+    if (r != a && la > 0) {
+        memcpy(r->palabras, a->palabras, sizeof(uint64_t) * la);
+    }
+    pal_restar_en(r->palabras, la, b->palabras, lb);
+    r->longitud = pal_normalizar(r->palabras, la);
+    return 0;
+}
+
+/*
+ * eg_multiplicar
+ * -----------------------------------------
+ * r = a * b. Si r coincide con un operando, el producto se forma
+ * en un arreglo temporal y luego reemplaza al de r.
+ */
+int eg_multiplicar(EnteroGrande *r, const EnteroGrande *a,
+                   const EnteroGrande *b)
+{
+    return eg_multiplicar_con(r, a, b, EG_MUL_AUTOMATICA);
+}
+
+/*
+ * eg_multiplicar_con
+ * -----------------------------------------
+ * Como eg_multiplicar, pero traduce el algoritmo pedido a umbrales
+ * que lo fuerzan en el nivel superior y en la recursión.
+ */
+int eg_multiplicar_con(EnteroGrande *r, const EnteroGrande *a,
+                       const EnteroGrande *b, AlgoritmoMultiplicacion algoritmo)
+{
+    ConfigMultiplicacion config = *config_actual();
+
+    switch (algoritmo) {
+    case EG_MUL_ESCOLAR:
+        config.umbrales.karatsuba = SIZE_MAX;
+        config.umbrales.toom3     = SIZE_MAX;
+        config.umbrales.ntt       = SIZE_MAX;
+        break;
+    case EG_MUL_KARATSUBA:
+        config.umbrales.toom3 = SIZE_MAX;
+        config.umbrales.ntt   = SIZE_MAX;
+        break;
+    case EG_MUL_TOOM3:
+        config.umbrales.toom3 = config.umbrales.karatsuba;
+        config.umbrales.ntt   = SIZE_MAX;
+        break;
+    case EG_MUL_NTT:
+        config.umbrales.ntt = 0;
+        break;
+    case EG_MUL_AUTOMATICA:
+    default:
+        break;
+    }
+
+    size_t la = a->longitud;
+    size_t lb = b->longitud;
+
+    if (la == 0 || lb == 0) {
+        r->longitud = 0;
+        return 0;
+    }
+
+    if (r == a || r == b) {
+        uint64_t *producto = (uint64_t *)malloc(sizeof(uint64_t) * (la + lb));
+        if (producto == NULL) {
+            return -1;
+        }
+        pal_multiplicar_con(producto, a->palabras, la, b->palabras, lb,
+                            &config);
+        if (r->capacidad > 0) {
+            free(r->palabras);
+        }
+        r->palabras  = producto;
+        r->capacidad = la + lb;
+    } else {
+        if (eg_reservar(r, la + lb) != 0) {
+            return -1;
+        }
+        pal_multiplicar_con(r->palabras, a->palabras, la, b->palabras, lb,
+                            &config);
+    }
+
+    r->longitud = pal_normalizar(r->palabras, la + lb);
+    return 0;
+}
+
+void eg_obtener_umbrales(UmbralesMultiplicacion *umbrales)
+{
+    *umbrales = config_actual()->umbrales;
+}
+
+void eg_configurar_umbrales(const UmbralesMultiplicacion *umbrales)
+{
+    pthread_once(&config_leida, leer_config_entorno);
+    config_global.umbrales = *umbrales;
+}
+
+void eg_configurar_hilos(int hilos)
+{
+    pthread_once(&config_leida, leer_config_entorno);
+    if (hilos < 1) {
+        hilos = 1;
+    }
+    config_global.hilos = (hilos > MAX_HILOS_NTT) ? MAX_HILOS_NTT : hilos;
+}
+
+/*
+ * eg_fibonacci
+ * -----------------------------------------
+ * Duplicación rápida desde (F(0), F(1)) sobre todos los bits de k.
+ */
+int eg_fibonacci(uint64_t k, EnteroGrande *fk, EnteroGrande *fk1)
+{
+    if (eg_asignar_u64(fk, 0) != 0 || eg_asignar_u64(fk1, 1) != 0) {
+        return -1;
+    }
+    return eg_fibonacci_desde(k, 64, fk, fk1);
+}
+
+/*
+ * eg_fibonacci_desde
+ * -----------------------------------------
+ * Duplicación rápida recorriendo los 'bits' bits bajos de k de
+ * mayor a menor, partiendo de m = k >> bits:
+ *
+ *   F(2m)     = F(m) * (2 F(m+1) - F(m))
+ *   F(2m + 1) = F(m)^2 + F(m+1)^2
+ *
+ * Requiere O(bits) multiplicaciones.
+ */
+int eg_fibonacci_desde(uint64_t k, int bits, EnteroGrande *fk,
+                       EnteroGrande *fk1)
+{
+    EnteroGrande c, d;
+    int codigo = 0;
+
+    eg_iniciar(&c);
+    eg_iniciar(&d);
+
+    for (int bit = bits - 1; bit >= 0 && codigo == 0; --bit) {
+        if (fk->longitud == 0 && ((k >> bit) & 1u) == 0) {
+            continue; /* aún en (F(0), F(1)) */
+        }
+
+        /* c = F(m) * (2 F(m+1) - F(m)),  d = F(m)^2 + F(m+1)^2 */
+        if (eg_sumar(&c, fk1, fk1) != 0 ||
+            eg_restar(&c, &c, fk) != 0 ||
+            eg_multiplicar(&c, &c, fk) != 0 ||
+            eg_multiplicar(&d, fk, fk) != 0 ||
+            eg_multiplicar(fk, fk1, fk1) != 0 ||
+            eg_sumar(&d, &d, fk) != 0) {
+            codigo = -1;
+            break;
+        }
+
+        if ((k >> bit) & 1u) {
+            /* (F(2m+1), F(2m+2)) = (d, c + d) */
+            if (eg_copiar(fk, &d) != 0 || eg_sumar(fk1, &c, &d) != 0) {
+                codigo = -1;
+            }
+        } else {
+            /* (F(2m), F(2m+1)) = (c, d) */
+            if (eg_copiar(fk, &c) != 0 || eg_copiar(fk1, &d) != 0) {
+                codigo = -1;
+            }
+        }
+    }
+
+    eg_liberar(&c);
+    eg_liberar(&d);
+    return codigo;
+}
+
+/*
+ * eg_digitos_maximos
+ * -----------------------------------------
+ * Cada palabra aporta a lo sumo log10(2^64) < 19.27 dígitos; se
+ * usa 20 por palabra como cota simple.
+ */
+size_t eg_digitos_maximos(const EnteroGrande *x)
+{
+    return (x->longitud == 0) ? 1 : x->longitud * 20;
+}
+
+size_t eg_a_decimal(const EnteroGrande *x, char *destino)
+{
+    return eg_a_decimal_hilos(x, destino, 1);
+}
+
+/*
+ * eg_a_decimal_hilos
+ * -----------------------------------------
+ * Conversión divide y vencerás: si x < P_i^2 con P_i = 10^(19*2^i),
+ * entonces x = q * P_i + r y tanto q como r tienen exactamente
+ * 19*2^i dígitos (con ceros a la izquierda). Cada mitad se
+ * convierte recursivamente en su propia porción del buffer, lo que
+ * permite procesar las dos ramas en hilos distintos.
+ *
+ * Con división por recíproco (Newton) y multiplicación Karatsuba
+ * el costo es O(M(n) log n) en lugar de O(n^2).
+ */
+size_t eg_a_decimal_hilos(const EnteroGrande *x, char *destino, int hilos)
+{
+    size_t longitud = x->longitud;
+
+    if (longitud <= UMBRAL_DECIMAL_DYV) {
+        return eg_a_decimal_ingenuo(x, destino);
+    }
+    if (hilos < 1) {
+        hilos = 1;
+    }
+
+    int nivel = preparar_niveles(longitud);
+    if (nivel < 0) {
+        return 0;
+    }
+
+    size_t ancho = (size_t)2 * DIGITOS_POR_BLOQUE << nivel;
+    char *texto = (char *)malloc(ancho);
+    uint64_t *copia = (uint64_t *)malloc(sizeof(uint64_t) * longitud);
+    if (texto == NULL || copia == NULL) {
+        free(texto);
+        free(copia);
+        return 0;
+    }
+    memcpy(copia, x->palabras, sizeof(uint64_t) * longitud);
+
+    decimal_dyv(copia, longitud, nivel, texto, hilos);
+
+    size_t inicio = 0;
+    while (inicio + 1 < ancho && texto[inicio] == '0') {
+        inicio++;
+    }
+    size_t escritos = ancho - inicio;
+    memcpy(destino, texto + inicio, escritos);
+
+    free(copia);
+    free(texto);
+    return escritos;
+}
+
+/*
+ * eg_a_decimal_ingenuo
+ * -----------------------------------------
+ * Conversión por divisiones repetidas entre 10^19 (cuadrática en
+ * el número de palabras).
+ */
+size_t eg_a_decimal_ingenuo(const EnteroGrande *x, char *destino)
+{
+    if (x->longitud == 0) {
+        destino[0] = '0';
+        return 1;
+    }
+
+    uint64_t *copia = (uint64_t *)malloc(sizeof(uint64_t) * x->longitud);
+    if (copia == NULL) {
+        return 0;
+    }
+    memcpy(copia, x->palabras, sizeof(uint64_t) * x->longitud);
+
+    size_t escritos = escribir_bloques_decimales(copia, x->longitud, destino,
+                                                 eg_digitos_maximos(x));
+    free(copia);
+    return escritos;
+}
+
+/*
+ * reservar_o_abortar
+ * -----------------------------------------
+ * malloc para temporales internos: la falta de memoria en medio de
+ * una multiplicación o conversión se trata como error grave.
+ */
+static void *reservar_o_abortar(size_t tam)
+{
+    void *p = malloc(tam > 0 ? tam : 1);
+    if (p == NULL) {
+        fprintf(stderr, "Error: memoria insuficiente en entero_grande.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static size_t pal_normalizar(const uint64_t *a, size_t n)
+{
+    while (n > 0 && a[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+static int pal_comparar(const uint64_t *a, size_t la,
+                        const uint64_t *b, size_t lb)
+{
+    la = pal_normalizar(a, la);
+    lb = pal_normalizar(b, lb);
+
+    if (la != lb) {
+        return (la < lb) ? -1 : 1;
+    }
+    for (size_t i = la; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return (a[i] < b[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * pal_sumar_en
+ * -----------------------------------------
+ * r[0..lr) += a[0..la), con la <= lr. Retorna el acarreo final.
+ */
+static uint64_t pal_sumar_en(uint64_t *r, size_t lr,
+                             const uint64_t *a, size_t la)
+{
+    uint64_t acarreo = 0;
+    size_t i = 0;
+
+    for (; i < la; ++i) {
+        u128 s = (u128)r[i] + a[i] + acarreo;
+        r[i]    = (uint64_t)s;
+        acarreo = (uint64_t)(s >> 64);
+    }
+    for (; acarreo != 0 && i < lr; ++i) {
+        r[i]++;
+        acarreo = (r[i] == 0);
+    }
+    return acarreo;
+}
+
+/*
+ * pal_restar_en
+ * -----------------------------------------
+ * r[0..lr) -= a[0..la), con la <= lr. Retorna el préstamo final.
+ */
+static uint64_t pal_restar_en(uint64_t *r, size_t lr,
+                              const uint64_t *a, size_t la)
+{
+    uint64_t prestamo = 0;
+    size_t i = 0;
+
+    for (; i < la; ++i) {
+        u128 d = (u128)r[i] - a[i] - prestamo;
+        r[i]     = (uint64_t)d;
+        prestamo = (uint64_t)(d >> 64) & 1u;
+    }
+    for (; prestamo != 0 && i < lr; ++i) {
+        prestamo = (r[i] == 0);
+        r[i]--;
+    }
+    return prestamo;
+}
+
+/*
+ * pal_sumar_total / pal_restar_total
+ * -----------------------------------------
+ * r = a + b y r = a - b (con a >= b), recorriendo ambos operandos
+ * posición por posición, por lo que 'r' puede coincidir con a o
+ * con b. Retornan la longitud normalizada del resultado; la suma
+ * puede ocupar max(la, lb) + 1 palabras.
+ */
+static size_t pal_sumar_total(uint64_t *r, const uint64_t *a, size_t la,
+                              const uint64_t *b, size_t lb)
+{
+    if (la < lb) {
+        const uint64_t *tmp = a;
+        size_t ltmp = la;
+        a  = b;
+        la = lb;
+        b  = tmp;
+        lb = ltmp;
+    }
+
+    uint64_t acarreo = 0;
+    size_t i = 0;
+    for (; i < lb; ++i) {
+        u128 s = (u128)a[i] + b[i] + acarreo;
+        r[i]    = (uint64_t)s;
+        acarreo = (uint64_t)(s >> 64);
+    }
+    for (; i < la; ++i) {
+        u128 s = (u128)a[i] + acarreo;
+        r[i]    = (uint64_t)s;
+        acarreo = (uint64_t)(s >> 64);
+    }
+    r[la] = acarreo;
+    return pal_normalizar(r, la + 1);
+}
+
+static size_t pal_restar_total(uint64_t *r, const uint64_t *a, size_t la,
+                               const uint64_t *b, size_t lb)
+{
+    uint64_t prestamo = 0;
+    size_t i = 0;
+    for (; i < lb; ++i) {
+        u128 d = (u128)a[i] - b[i] - prestamo;
+        r[i]     = (uint64_t)d;
+        prestamo = (uint64_t)(d >> 64) & 1u;
+    }
+    for (; i < la; ++i) {
+        u128 d = (u128)a[i] - prestamo;
+        r[i]     = (uint64_t)d;
+        prestamo = (uint64_t)(d >> 64) & 1u;
+    }
+    return pal_normalizar(r, la);
+}
+
+/*
+ * leer_config_entorno
+ * -----------------------------------------
+ * Aplica ENTERO_GRANDE_UMBRALES="karatsuba,toom3,ntt" si existe y
+ * tiene tres números; en otro caso se conservan los valores por
+ * defecto.
+ */
+static void leer_config_entorno(void)
+{
+    const char *texto = getenv("ENTERO_GRANDE_UMBRALES");
+    unsigned long long k, t, n;
+
+    if (texto == NULL) {
+        return;
+    }
+    if (sscanf(texto, "%llu,%llu,%llu", &k, &t, &n) != 3 || k < 2) {
+        fprintf(stderr, "Aviso: ENTERO_GRANDE_UMBRALES inválido, se ignora.\n");
+        return;
+    }
+    config_global.umbrales.karatsuba = (size_t)k;
+    config_global.umbrales.toom3     = (size_t)t;
+    config_global.umbrales.ntt       = (size_t)n;
+}
+
+static const ConfigMultiplicacion *config_actual(void)
+{
+    pthread_once(&config_leida, leer_config_entorno);
+    return &config_global;
+}
+
+/*
+ * pal_multiplicar
+ * -----------------------------------------
+ * r[0..la+lb) = a * b con la configuración global. 'r' no puede
+ * solaparse con a ni con b.
+ */
+static void pal_multiplicar(uint64_t *r, const uint64_t *a, size_t la,
+                            const uint64_t *b, size_t lb)
+{
+    pal_multiplicar_con(r, a, la, b, lb, config_actual());
+}
+
+/*
+ * pal_multiplicar_con
+ * -----------------------------------------
+ * Selección del algoritmo según el operando corto (lb):
+ *  - lb >= umbral ntt y el producto cabe en ntt_max_palabras(): NTT.
+ *  - lb por debajo del umbral de Karatsuba: escolar.
+ *  - Operandos muy desbalanceados: el largo se parte en trozos del
+ *    tamaño del corto y se acumulan los productos parciales.
+ *  - lb >= umbral toom3 y b llega al tercer trozo de a: Toom-3.
+ *  - En otro caso: Karatsuba.
+ */
+static void pal_multiplicar_con(uint64_t *r, const uint64_t *a, size_t la,
+                                const uint64_t *b, size_t lb,
+                                const ConfigMultiplicacion *config)
+{
+    if (la < lb) {
+        const uint64_t *tmp = a;
+        size_t ltmp = la;
+        a  = b;
+        la = lb;
+        b  = tmp;
+        lb = ltmp;
+    }
+
+    if (lb == 0) {
+        memset(r, 0, sizeof(uint64_t) * la);
+        return;
+    }
+    if (lb >= config->umbrales.ntt && la + lb <= ntt_max_palabras() &&
+        ntt_multiplicar(r, a, la, b, lb, config->hilos) == 0) {
+        return;
+    }
+    if (lb < config->umbrales.karatsuba) {
+        pal_mul_escolar(r, a, la, b, lb);
+        return;
+    }
+
+    size_t mitad = (la + 1) / 2;
+    size_t tercio = (la + 2) / 3;
+    if (lb >= config->umbrales.toom3 && lb > 2 * tercio) {
+        pal_mul_toom3(r, a, la, b, lb, config);
+        return;
+    }
+    if (lb > mitad) {
+        pal_mul_karatsuba(r, a, la, b, lb, config);
+        return;
+    }
+
+    /* Desbalanceado: a = sum a_j B^(j*lb) */
+    uint64_t *parcial = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * 2 * lb);
+
+    memset(r, 0, sizeof(uint64_t) * (la + lb));
+    for (size_t inicio = 0; inicio < la; inicio += lb) {
+        size_t largo = (la - inicio < lb) ? la - inicio : lb;
+        pal_multiplicar_con(parcial, a + inicio, largo, b, lb, config);
+        pal_sumar_en(r + inicio, la + lb - inicio, parcial, largo + lb);
+    }
+
+    free(parcial);
+}
+
+/*
+ * pal_mul_escolar
+ * -----------------------------------------
+ * Producto O(la * lb) fila por fila.
+ */
+static void pal_mul_escolar(uint64_t *r, const uint64_t *a, size_t la,
+                            const uint64_t *b, size_t lb)
+{
+    memset(r, 0, sizeof(uint64_t) * la);
+
+    for (size_t j = 0; j < lb; ++j) {
+        uint64_t acarreo = 0;
+        uint64_t bj = b[j];
+
+        for (size_t i = 0; i < la; ++i) {
+            u128 t = (u128)a[i] * bj + r[i + j] + acarreo;
+            r[i + j] = (uint64_t)t;
+            acarreo  = (uint64_t)(t >> 64);
+        }
+        r[j + la] = acarreo;
+    }
+}
+
+/*
+ * pal_mul_karatsuba
+ * -----------------------------------------
+ * Con a = a1 B^h + a0 y b = b1 B^h + b0 (h = ceil(la / 2)):
+ *
+ *   a * b = z2 B^(2h) + (z1 - z2 - z0) B^h + z0
+ *   z0 = a0 b0,  z2 = a1 b1,  z1 = (a0 + a1)(b0 + b1)
+ *
+ * Requiere lb > h para que b1 no sea vacío.
+ */
+static void pal_mul_karatsuba(uint64_t *r, const uint64_t *a, size_t la,
+                              const uint64_t *b, size_t lb,
+                              const ConfigMultiplicacion *config)
+{
+    const size_t h  = (la + 1) / 2;
+    const size_t l1 = la - h;
+    const size_t m1 = lb - h;
+
+    /* z0 y z2 se forman directamente en su lugar dentro de r */
+    pal_multiplicar_con(r, a, h, b, h, config);
+    pal_multiplicar_con(r + 2 * h, a + h, l1, b + h, m1, config);
+
+    uint64_t *suma_a = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * (h + 1));
+    uint64_t *suma_b = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * (h + 1));
+    uint64_t *z1     = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * (2 * h + 2));
+
+    memcpy(suma_a, a, sizeof(uint64_t) * h);
+    suma_a[h] = pal_sumar_en(suma_a, h, a + h, l1);
+    memcpy(suma_b, b, sizeof(uint64_t) * h);
+    suma_b[h] = pal_sumar_en(suma_b, h, b + h, m1);
+
+    pal_multiplicar_con(z1, suma_a, h + 1, suma_b, h + 1, config);
+    pal_restar_en(z1, 2 * h + 2, r, 2 * h);
+    pal_restar_en(z1, 2 * h + 2, r + 2 * h, l1 + m1);
+
+    pal_sumar_en(r + h, la + lb - h, z1,
+                 pal_normalizar(z1, 2 * h + 2));
+
+    free(suma_a);
+    free(suma_b);
+    free(z1);
+}
+
+/*
+ * pal_mul_toom3
+ * -----------------------------------------
+ * Con a = a2 B^(2h) + a1 B^h + a0 (h = ceil(la / 3)) y b análogo,
+ * evalúa en 0, 1, -1, -2 e infinito:
+ *
+ *   A(1)  = a0 + a1 + a2      A(-1) = a0 - a1 + a2
+ *   A(-2) = 2 (A(-1) + a2) - a0
+ *
+ * multiplica punto a punto (cinco productos de ~la/3 palabras) e
+ * interpola con la secuencia de Bodrato:
+ *
+ *   r3 = (r(-2) - r(1)) / 3      r1 = (r(1) - r(-1)) / 2
+ *   r2 = r(-1) - r(0)            r3 = (r2 - r3) / 2 + 2 r(inf)
+ *   r2 = r2 + r1 - r(inf)        r1 = r1 - r3
+ *
+ * Requiere lb > 2h para que b2 no sea vacío.
+ */
+static void pal_mul_toom3(uint64_t *r, const uint64_t *a, size_t la,
+                          const uint64_t *b, size_t lb,
+                          const ConfigMultiplicacion *config)
+{
+    const size_t h  = (la + 2) / 3;
+    const size_t l2 = la - 2 * h;
+    const size_t m2 = lb - 2 * h;
+    const int cuadrado = (a == b && la == lb);
+
+    /* Evaluaciones: h + 2 palabras; productos e interpolación: 2h + 6 */
+    const size_t te = h + 2;
+    const size_t tp = 2 * h + 6;
+    uint64_t *memoria = (uint64_t *)reservar_o_abortar(
+        sizeof(uint64_t) * (6 * te + 4 * tp));
+    uint64_t *siguiente = memoria;
+
+    Firmado a0 = { (uint64_t *)a,         pal_normalizar(a, h),         0 };
+    Firmado a1 = { (uint64_t *)a + h,     pal_normalizar(a + h, h),     0 };
+    Firmado a2 = { (uint64_t *)a + 2 * h, pal_normalizar(a + 2 * h, l2), 0 };
+    Firmado b0 = { (uint64_t *)b,         pal_normalizar(b, h),         0 };
+    Firmado b1 = { (uint64_t *)b + h,     pal_normalizar(b + h, h),     0 };
+    Firmado b2 = { (uint64_t *)b + 2 * h, pal_normalizar(b + 2 * h, m2), 0 };
+
+    Firmado ev[6];
+    for (int i = 0; i < 6; ++i) {
+        ev[i].palabras = siguiente;
+        ev[i].longitud = 0;
+        ev[i].negativo = 0;
+        siguiente += te;
+    }
+    Firmado *a_1 = &ev[0], *a_m1 = &ev[1], *a_m2 = &ev[2];
+    Firmado *b_1 = &ev[3], *b_m1 = &ev[4], *b_m2 = &ev[5];
+
+    Firmado *operandos[2][3] = { { a_1, a_m1, a_m2 }, { b_1, b_m1, b_m2 } };
+    const Firmado *trozos[2][3] = { { &a0, &a1, &a2 }, { &b0, &b1, &b2 } };
+
+    for (int lado = 0; lado < (cuadrado ? 1 : 2); ++lado) {
+        Firmado *v1  = operandos[lado][0];
+        Firmado *vm1 = operandos[lado][1];
+        Firmado *vm2 = operandos[lado][2];
+        const Firmado *x0 = trozos[lado][0];
+        const Firmado *x1 = trozos[lado][1];
+        const Firmado *x2 = trozos[lado][2];
+
+        Firmado suma02 = *vm1;
+        firmado_combinar(&suma02, x0, x2, 0);       /* x0 + x2 */
+        firmado_combinar(v1, &suma02, x1, 0);       /* x(1) */
+        firmado_combinar(vm1, &suma02, x1, 1);      /* x(-1) */
+
+        firmado_combinar(vm2, vm1, x2, 0);          /* x(-1) + x2 */
+        uint64_t alto = 0;
+        for (size_t i = 0; i < vm2->longitud; ++i) {
+            uint64_t w = vm2->palabras[i];
+            vm2->palabras[i] = (w << 1) | alto;
+            alto = w >> 63;
+        }
+        if (alto != 0) {
+            vm2->palabras[vm2->longitud++] = alto;
+        }
+        firmado_combinar(vm2, vm2, x0, 1);          /* x(-2) */
+    }
+    if (cuadrado) {
+        b_1  = a_1;
+        b_m1 = a_m1;
+        b_m2 = a_m2;
+    }
+
+    Firmado r1  = { siguiente,          0, 0 };
+    Firmado rm1 = { siguiente + tp,     0, 0 };
+    Firmado rm2 = { siguiente + 2 * tp, 0, 0 };
+    Firmado r3  = { siguiente + 3 * tp, 0, 0 };
+
+    /* r(0) y r(inf) se forman directamente en su lugar dentro de r */
+    memset(r, 0, sizeof(uint64_t) * (la + lb));
+    pal_multiplicar_con(r, a, h, b, h, config);
+    pal_multiplicar_con(r + 4 * h, a + 2 * h, l2, b + 2 * h, m2, config);
+    Firmado r0   = { r,         pal_normalizar(r, 2 * h),          0 };
+    Firmado rinf = { r + 4 * h, pal_normalizar(r + 4 * h, l2 + m2), 0 };
+
+    firmado_multiplicar(&r1, a_1, b_1, config);
+    firmado_multiplicar(&rm1, a_m1, b_m1, config);
+    firmado_multiplicar(&rm2, a_m2, b_m2, config);
+
+    /* r3 = (r(-2) - r(1)) / 3, división exacta */
+    firmado_combinar(&r3, &rm2, &r1, 1);
+    u128 resto = 0;
+    for (size_t i = r3.longitud; i-- > 0;) {
+        u128 actual = (resto << 64) | r3.palabras[i];
+        r3.palabras[i] = (uint64_t)(actual / 3);
+        resto = actual % 3;
+    }
+    r3.longitud = pal_normalizar(r3.palabras, r3.longitud);
+
+    /* r1 = (r(1) - r(-1)) / 2 */
+    firmado_combinar(&r1, &r1, &rm1, 1);
+    for (size_t i = 0; i < r1.longitud; ++i) {
+        uint64_t sig = (i + 1 < r1.longitud) ? r1.palabras[i + 1] : 0;
+        r1.palabras[i] = (r1.palabras[i] >> 1) | (sig << 63);
+    }
+    r1.longitud = pal_normalizar(r1.palabras, r1.longitud);
+
+    /* r2 = r(-1) - r(0), en el espacio de r(-1) */
+    Firmado r2 = rm1;
+    firmado_combinar(&r2, &rm1, &r0, 1);
+
+    /* r3 = (r2 - r3) / 2 + 2 r(inf) */
+    firmado_combinar(&r3, &r3, &r2, 1);
+    r3.negativo = !r3.negativo && r3.longitud > 0;
+    for (size_t i = 0; i < r3.longitud; ++i) {
+        uint64_t sig = (i + 1 < r3.longitud) ? r3.palabras[i + 1] : 0;
+        r3.palabras[i] = (r3.palabras[i] >> 1) | (sig << 63);
+    }
+    r3.longitud = pal_normalizar(r3.palabras, r3.longitud);
+    firmado_combinar(&r3, &r3, &rinf, 0);
+    firmado_combinar(&r3, &r3, &rinf, 0);
+
+    /* r2 = r2 + r1 - r(inf) */
+    firmado_combinar(&r2, &r2, &r1, 0);
+    firmado_combinar(&r2, &r2, &rinf, 1);
+
+    /* r1 = r1 - r3 */
+    firmado_combinar(&r1, &r1, &r3, 1);
+
+    /* Los coeficientes finales son no negativos */
+    pal_sumar_en(r + h, la + lb - h, r1.palabras, r1.longitud);
+    pal_sumar_en(r + 2 * h, la + lb - 2 * h, r2.palabras, r2.longitud);
+    pal_sumar_en(r + 3 * h, la + lb - 3 * h, r3.palabras, r3.longitud);
+
+    free(memoria);
+}
+
+/*
+ * firmado_combinar
+ * -----------------------------------------
+ * r = x + y (o x - y si 'restar'). 'r' puede compartir memoria con
+ * x o con y y debe tener espacio para la mayor longitud más uno.
+ */
+static void firmado_combinar(Firmado *r, const Firmado *x,
+                             const Firmado *y, int restar)
+{
+    int signo_y = y->negativo ^ (restar != 0);
+    int signo;
+
+    if (x->negativo == signo_y) {
+        signo = x->negativo;
+        r->longitud = pal_sumar_total(r->palabras, x->palabras, x->longitud,
+                                      y->palabras, y->longitud);
+    } else if (pal_comparar(x->palabras, x->longitud,
+                            y->palabras, y->longitud) >= 0) {
+        signo = x->negativo;
+        r->longitud = pal_restar_total(r->palabras, x->palabras, x->longitud,
+                                       y->palabras, y->longitud);
+    } else {
+        signo = signo_y;
+        r->longitud = pal_restar_total(r->palabras, y->palabras, y->longitud,
+                                       x->palabras, x->longitud);
+    }
+    r->negativo = (r->longitud > 0) ? signo : 0;
+}
+
+/*
+ * firmado_multiplicar
+ * -----------------------------------------
+ * r = x * y. 'r' no puede compartir memoria con los operandos.
+ */
+static void firmado_multiplicar(Firmado *r, const Firmado *x,
+                                const Firmado *y,
+                                const ConfigMultiplicacion *config)
+{
+    if (x->longitud == 0 || y->longitud == 0) {
+        r->longitud = 0;
+        r->negativo = 0;
+        return;
+    }
+
+    pal_multiplicar_con(r->palabras, x->palabras, x->longitud,
+                        y->palabras, y->longitud, config);
+    r->longitud = pal_normalizar(r->palabras, x->longitud + y->longitud);
+    r->negativo = x->negativo ^ y->negativo;
+}
+
+/*
+ * pal_reciproco
+ * -----------------------------------------
+ * r[0..k] = floor(B^(2k) / d), con d de k palabras normalizado
+ * (bit superior de d[k-1] encendido), por iteración de Newton
+ * sobre la mitad superior de d:
+ *
+ *   x0 = reciproco(d_alto) * B^(k - h)
+ *   x1 = x0 + x0 * (B^(2k) - d * x0) / B^(2k)
+ *
+ * Tras el paso de Newton el error es de unas pocas unidades y se
+ * elimina con una corrección exacta basada en el resto
+ * B^(2k) - d * x1.
+ */
+static void pal_reciproco(const uint64_t *d, size_t k, uint64_t *r)
+{
+    if (k == 1) {
+        /* floor(B^2 / d) = floor((B^2 - 1) / d) salvo si d | B^2 */
+        u128 maximo = ~(u128)0;
+        u128 q = maximo / d[0];
+        if (maximo % d[0] == d[0] - 1) {
+            q++;
+        }
+        r[0] = (uint64_t)q;
+        r[1] = (uint64_t)(q >> 64);
+        return;
+    }
+
+    const size_t h  = (k + 1) / 2;
+    const size_t lx = k + 1;        /* palabras de x0 y x1 */
+    const size_t lt = 2 * k + 2;    /* palabras de d * x */
+
+    uint64_t *x = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * (lx + 1));
+    uint64_t *t = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * (lt + lx + 2));
+    uint64_t *e = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * lt);
+
+    /* x0 = reciproco(d_alto) desplazado k - h palabras */
+    memset(x, 0, sizeof(uint64_t) * (lx + 1));
+    pal_reciproco(d + (k - h), h, x + (k - h));
+
+    /* t = d * x0; e = |B^(2k) - t| */
+    size_t lx0 = pal_normalizar(x, lx + 1);
+    memset(t, 0, sizeof(uint64_t) * (lt + lx + 2));
+    pal_multiplicar(t, d, k, x, lx0);
+
+    memset(e, 0, sizeof(uint64_t) * lt);
+    e[2 * k] = 1;
+    int exceso = (pal_comparar(t, k + lx0, e, lt) > 0);
+    if (exceso) {
+        memcpy(e, t, sizeof(uint64_t) * (k + lx0));
+        memset(e + k + lx0, 0, sizeof(uint64_t) * (lt - k - lx0));
+        e[2 * k] -= 1; /* e = t - B^(2k) */
+    } else {
+        pal_restar_en(e, lt, t, k + lx0);
+    }
+
+    /* correccion = x0 * e / B^(2k) */
+    size_t le = pal_normalizar(e, lt);
+    memset(t, 0, sizeof(uint64_t) * (lt + lx + 2));
+    if (le > 0) {
+        pal_multiplicar(t, x, lx0, e, le);
+    }
+    size_t lc = (lx0 + le > 2 * k) ? lx0 + le - 2 * k : 0;
+    uint64_t *correccion = t + 2 * k;
+
+    if (exceso) {
+        pal_restar_en(x, lx + 1, correccion, lc);
+    } else {
+        pal_sumar_en(x, lx + 1, correccion, lc);
+    }
+
+    /* Corrección exacta: B^(2k) - d * x1 debe quedar en [0, d) */
+    lx0 = pal_normalizar(x, lx + 1);
+    memset(t, 0, sizeof(uint64_t) * (lt + lx + 2));
+    pal_multiplicar(t, d, k, x, lx0);
+
+    memset(e, 0, sizeof(uint64_t) * lt);
+    e[2 * k] = 1;
+    uint64_t uno[1] = { 1 };
+
+    while (pal_comparar(t, k + lx0, e, lt) > 0) {
+        /* d * x > B^(2k): x demasiado grande */
+        pal_restar_en(x, lx + 1, uno, 1);
+        pal_restar_en(t, k + lx0, d, k);
+    }
+    pal_restar_en(e, lt, t, k + lx0);
+    while (pal_comparar(e, lt, d, k) >= 0) {
+        pal_sumar_en(x, lx + 1, uno, 1);
+        pal_restar_en(e, lt, d, k);
+    }
+
+    memcpy(r, x, sizeof(uint64_t) * (k + 1));
+
+    free(x);
+    free(t);
+    free(e);
+}
+
+/*
+ * pal_dividir_nivel
+ * -----------------------------------------
+ * q = floor(y / P), resto = y mod P, para y < P^2 y P la potencia
+ * del nivel. Se trabaja con y y P desplazados por igual (mismo
+ * cociente), se estima q con el recíproco precalculado y se
+ * corrige hacia arriba: la estimación nunca excede el cociente real
+ * y queda a lo sumo dos unidades por debajo.
+ *
+ * q y resto deben tener espacio para k + 2 y k palabras.
+ */
+static void pal_dividir_nivel(const NivelDecimal *nivel,
+                              const uint64_t *y, size_t ly,
+                              uint64_t *q, size_t *lq,
+                              uint64_t *resto, size_t *lresto)
+{
+    const size_t   k  = nivel->k;
+    const unsigned s  = nivel->desplazamiento;
+    const size_t   ln = 2 * k + 1;
+
+    uint64_t *yn = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * ln);
+    uint64_t *t  = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * (ln + k + 1));
+
+    /* yn = y << s */
+    memset(yn, 0, sizeof(uint64_t) * ln);
+    for (size_t i = 0; i < ly; ++i) {
+        yn[i] |= y[i] << s;
+        if (s > 0) {
+            yn[i + 1] = y[i] >> (64 - s);
+        }
+    }
+    size_t lyn = pal_normalizar(yn, ln);
+
+    /* q = floor(yn * reciproco / B^(2k)) */
+    size_t lr = pal_normalizar(nivel->reciproco, k + 1);
+    size_t lp = lyn + lr;
+    memset(t, 0, sizeof(uint64_t) * (ln + k + 1));
+    if (lyn > 0) {
+        pal_multiplicar(t, yn, lyn, nivel->reciproco, lr);
+    }
+    size_t lcoc = (lp > 2 * k) ? lp - 2 * k : 0;
+    memset(q, 0, sizeof(uint64_t) * (k + 2));
+    memcpy(q, t + 2 * k, sizeof(uint64_t) * lcoc);
+    lcoc = pal_normalizar(q, lcoc);
+
+    /* yn -= q * divisor */
+    if (lcoc > 0) {
+        memset(t, 0, sizeof(uint64_t) * (ln + k + 1));
+        pal_multiplicar(t, q, lcoc, nivel->divisor, k);
+        pal_restar_en(yn, ln, t, pal_normalizar(t, lcoc + k));
+    }
+
+    uint64_t uno[1] = { 1 };
+    while (pal_comparar(yn, ln, nivel->divisor, k) >= 0) {
+        pal_restar_en(yn, ln, nivel->divisor, k);
+        pal_sumar_en(q, k + 2, uno, 1);
+    }
+    *lq = pal_normalizar(q, k + 2);
+
+    /* resto = yn >> s (cabe en k palabras) */
+    for (size_t i = 0; i < k; ++i) {
+        resto[i] = yn[i] >> s;
+        if (s > 0) {
+            resto[i] |= yn[i + 1] << (64 - s);
+        }
+    }
+    *lresto = pal_normalizar(resto, k);
+
+    free(yn);
+    free(t);
+}
+
+/*
+ * preparar_niveles
+ * -----------------------------------------
+ * Calcula (una sola vez por proceso) las potencias 10^(19*2^i) con
+ * sus recíprocos hasta el primer nivel i tal que P_i^2 supera a
+ * cualquier número de 'longitud' palabras.
+ *
+ * Retorna ese nivel, o -1 si se excede MAX_NIVELES_DECIMAL.
+ */
+static int preparar_niveles(size_t longitud)
+{
+    pthread_mutex_lock(&mutex_niveles);
+
+    int nivel = 0;
+    for (;; ++nivel) {
+        if (nivel >= MAX_NIVELES_DECIMAL) {
+            pthread_mutex_unlock(&mutex_niveles);
+            return -1;
+        }
+
+        if (nivel >= niveles_listos) {
+            /* P_nivel = P_(nivel-1)^2, reconstruida sin desplazar */
+            uint64_t *potencia;
+            size_t    lp;
+
+            if (nivel == 0) {
+                potencia    = (uint64_t *)reservar_o_abortar(sizeof(uint64_t));
+                potencia[0] = BASE_DECIMAL;
+                lp          = 1;
+            } else {
+                const NivelDecimal *previo = &niveles_decimales[nivel - 1];
+                size_t kp = previo->k;
+                unsigned sp = previo->desplazamiento;
+                uint64_t *base = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * kp);
+                for (size_t i = 0; i < kp; ++i) {
+                    base[i] = previo->divisor[i] >> sp;
+                    if (sp > 0 && i + 1 < kp) {
+                        base[i] |= previo->divisor[i + 1] << (64 - sp);
+                    }
+                }
+                size_t lb = pal_normalizar(base, kp);
+                potencia = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * 2 * lb);
+                pal_multiplicar(potencia, base, lb, base, lb);
+                lp = pal_normalizar(potencia, 2 * lb);
+                free(base);
+            }
+
+            /* Normalización: bit superior encendido */
+            unsigned s = (unsigned)__builtin_clzll(potencia[lp - 1]);
+            NivelDecimal *actual = &niveles_decimales[nivel];
+            actual->k              = lp;
+            actual->desplazamiento = s;
+            actual->divisor = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * lp);
+            for (size_t i = 0; i < lp; ++i) {
+                actual->divisor[i] = potencia[i] << s;
+                if (s > 0 && i > 0) {
+                    actual->divisor[i] |= potencia[i - 1] >> (64 - s);
+                }
+            }
+            actual->reciproco = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * (lp + 1));
+            pal_reciproco(actual->divisor, lp, actual->reciproco);
+            free(potencia);
+
+            niveles_listos = nivel + 1;
+        }
+
+        /* P_nivel >= B^(k-1), así que P_nivel^2 >= B^(2k-2) > x
+         * siempre que x tenga a lo sumo 2k - 2 palabras. */
+        if (2 * (niveles_decimales[nivel].k - 1) >= longitud) {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&mutex_niveles);
+    return nivel;
+}
+
+/*
+ * decimal_dyv
+ * -----------------------------------------
+ * Escribe exactamente 2 * 19 * 2^nivel dígitos (con ceros a la
+ * izquierda) de x < P_nivel^2 en 'destino'. Destruye 'palabras'.
+ *
+ * Con hilos > 1, la mitad alta se convierte en un hilo nuevo con la
+ * mitad de los hilos disponibles mientras este hilo convierte la
+ * mitad baja con el resto.
+ */
+static void decimal_dyv(uint64_t *palabras, size_t longitud, int nivel,
+                        char *destino, int hilos)
+{
+    const size_t ancho = (size_t)2 * DIGITOS_POR_BLOQUE << nivel;
+
+    longitud = pal_normalizar(palabras, longitud);
+    if (nivel == 0 || longitud <= UMBRAL_DECIMAL_DYV) {
+        decimal_ancho_fijo(palabras, longitud, destino, ancho);
+        return;
+    }
+
+    /* x = q * P_nivel + resto, ambos con ancho / 2 dígitos */
+    const NivelDecimal *divisor = &niveles_decimales[nivel];
+    const size_t k = divisor->k;
+
+    uint64_t *q     = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * (k + 2));
+    uint64_t *resto = (uint64_t *)reservar_o_abortar(sizeof(uint64_t) * k);
+    size_t lq, lresto;
+
+    pal_dividir_nivel(divisor, palabras, longitud, q, &lq, resto, &lresto);
+
+    const size_t mitad = ancho / 2;
+    pthread_t hilo;
+    int en_paralelo = 0;
+
+    if (hilos > 1 && longitud >= UMBRAL_DECIMAL_HILOS) {
+        TareaDecimal tarea = { q, lq, nivel - 1, destino, hilos / 2 };
+        if (pthread_create(&hilo, NULL, hilo_decimal, &tarea) == 0) {
+            en_paralelo = 1;
+            decimal_dyv(resto, lresto, nivel - 1, destino + mitad,
+                        hilos - hilos / 2);
+            pthread_join(hilo, NULL);
+        }
+    }
+    if (!en_paralelo) {
+        decimal_dyv(q, lq, nivel - 1, destino, 1);
+        decimal_dyv(resto, lresto, nivel - 1, destino + mitad, 1);
+    }
+
+    free(q);
+    free(resto);
+}
+
+static void *hilo_decimal(void *argumento)
+{
+    TareaDecimal *tarea = (TareaDecimal *)argumento;
+
+    decimal_dyv(tarea->palabras, tarea->longitud, tarea->nivel,
+                tarea->destino, tarea->hilos);
+    return NULL;
+}
+
+/*
+ * decimal_ancho_fijo
+ * -----------------------------------------
+ * Conversión ingenua rellenando con ceros a la izquierda hasta
+ * 'ancho' dígitos (múltiplo de 19). Destruye 'palabras'.
+ */
+static void decimal_ancho_fijo(uint64_t *palabras, size_t longitud,
+                               char *destino, size_t ancho)
+{
+    size_t pos = ancho;
+
+    while (longitud > 0) {
+        u128 resto = 0;
+        for (size_t i = longitud; i-- > 0;) {
+            u128 actual = (resto << 64) | palabras[i];
+            palabras[i] = (uint64_t)(actual / BASE_DECIMAL);
+            resto       = actual % BASE_DECIMAL;
+        }
+        longitud = pal_normalizar(palabras, longitud);
+
+        uint64_t bloque = (uint64_t)resto;
+        for (int d = 0; d < DIGITOS_POR_BLOQUE; ++d) {
+            destino[--pos] = (char)('0' + bloque % 10);
+            bloque /= 10;
+        }
+    }
+
+    memset(destino, '0', pos);
+}
+
+/*
+ * escribir_bloques_decimales
+ * -----------------------------------------
+ * Destruye 'palabras' dividiéndolas entre 10^19 hasta agotarlas.
+ * Los bloques se escriben de derecha a izquierda al final de
+ * 'destino' y al terminar se desplazan al inicio, sin ceros a la
+ * izquierda.
+ */
+static size_t escribir_bloques_decimales(uint64_t *palabras, size_t longitud,
+                                         char *destino, size_t tam_destino)
+{
+    size_t pos = tam_destino;
+
+    while (longitud > 0) {
+        u128 resto = 0;
+        for (size_t i = longitud; i-- > 0;) {
+            u128 actual = (resto << 64) | palabras[i];
+            palabras[i] = (uint64_t)(actual / BASE_DECIMAL);
+            resto       = actual % BASE_DECIMAL;
+        }
+        longitud = pal_normalizar(palabras, longitud);
+
+        uint64_t bloque = (uint64_t)resto;
+        for (int d = 0; d < DIGITOS_POR_BLOQUE; ++d) {
+            destino[--pos] = (char)('0' + bloque % 10);
+            bloque /= 10;
+            if (longitud == 0 && bloque == 0) {
+                break;
+            }
+        }
+    }
+
+    size_t escritos = tam_destino - pos;
+    memmove(destino, destino + pos, escritos);
+    return escritos;
+}
+
+static void normalizar(EnteroGrande *x)
+{
+    x->longitud = pal_normalizar(x->palabras, x->longitud);
+}
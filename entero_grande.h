@@ -0,0 +1,138 @@
+/*
+ * entero_grande.h
+ * -----------------------------------------
+ * Enteros sin signo de precisión arbitraria para los términos de
+ * Fibonacci que no caben en 64 bits.
+ *
+ * Representación:
+ *  - palabras : dígitos en base 2^64, del menos al más significativo.
+ *  - longitud : número de palabras significativas (0 representa el
+ *               valor cero; palabras[longitud - 1] != 0 en otro caso).
+ *  - capacidad: palabras reservadas. Una capacidad 0 con palabras
+ *               no nulo indica una vista de solo lectura sobre
+ *               memoria ajena (p.ej. un archivo proyectado).
+ *
+ * Convención de errores: las funciones que reservan memoria para
+ * el resultado retornan 0 si tuvieron éxito y -1 si malloc/realloc
+ * falló. Los temporales internos de la multiplicación y de la
+ * conversión a decimal se consideran error grave: si no pueden
+ * reservarse, se informa por stderr y el programa termina con
+ * EXIT_FAILURE.
+ */
+
+#ifndef ENTERO_GRANDE_H
+#define ENTERO_GRANDE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t *palabras;
+    size_t    longitud;
+    size_t    capacidad;
+} EnteroGrande;
+
+/*
+ * AlgoritmoMultiplicacion
+ * -----------------------------------------
+ * Algoritmo forzado en eg_multiplicar_con. EG_MUL_AUTOMATICA elige
+ * por umbrales en cada nivel de la recursión; los demás fijan el
+ * algoritmo de más alto nivel permitido (p.ej. EG_MUL_KARATSUBA
+ * recurre con Karatsuba y termina en el escolar, sin Toom-3 ni NTT).
+ */
+typedef enum {
+    EG_MUL_AUTOMATICA,
+    EG_MUL_ESCOLAR,
+    EG_MUL_KARATSUBA,
+    EG_MUL_TOOM3,
+    EG_MUL_NTT
+} AlgoritmoMultiplicacion;
+
+/*
+ * UmbralesMultiplicacion
+ * -----------------------------------------
+ * Tamaño del operando corto (en palabras) a partir del cual se usa
+ * cada algoritmo:
+ *  - karatsuba: por debajo, escolar.
+ *  - toom3    : desde aquí, Toom-3 en lugar de Karatsuba.
+ *  - ntt      : desde aquí, NTT de tres primos (ntt.h).
+ *
+ * Los valores por defecto pueden reemplazarse con la variable de
+ * entorno ENTERO_GRANDE_UMBRALES="karatsuba,toom3,ntt", que
+ * `bench_fibonacci multiplicacion` sugiere para cada máquina.
+ */
+typedef struct {
+    size_t karatsuba;
+    size_t toom3;
+    size_t ntt;
+} UmbralesMultiplicacion;
+
+void eg_iniciar(EnteroGrande *x);
+void eg_liberar(EnteroGrande *x);
+int  eg_reservar(EnteroGrande *x, size_t capacidad);
+int  eg_asignar_u64(EnteroGrande *x, uint64_t valor);
+int  eg_asignar_u128(EnteroGrande *x, unsigned __int128 valor);
+int  eg_copiar(EnteroGrande *destino, const EnteroGrande *origen);
+
+/* Vista de solo lectura sobre 'longitud' palabras ya existentes */
+EnteroGrande eg_vista(const uint64_t *palabras, size_t longitud);
+
+/* Retorna <0, 0 o >0 según a < b, a == b o a > b */
+int eg_comparar(const EnteroGrande *a, const EnteroGrande *b);
+
+/*
+ * Aritmética. El resultado r puede coincidir con cualquiera de
+ * los operandos.
+ *  - eg_sumar          : r = a + b
+ *  - eg_restar         : r = a - b (requiere a >= b)
+ *  - eg_multiplicar    : r = a * b (escolar, Karatsuba, Toom-3 o NTT
+ *                        según los umbrales vigentes)
+ *  - eg_multiplicar_con: r = a * b con el algoritmo indicado
+ */
+int eg_sumar(EnteroGrande *r, const EnteroGrande *a, const EnteroGrande *b);
+int eg_restar(EnteroGrande *r, const EnteroGrande *a, const EnteroGrande *b);
+int eg_multiplicar(EnteroGrande *r, const EnteroGrande *a,
+                   const EnteroGrande *b);
+int eg_multiplicar_con(EnteroGrande *r, const EnteroGrande *a,
+                       const EnteroGrande *b, AlgoritmoMultiplicacion algoritmo);
+
+/*
+ * Configuración de la multiplicación, compartida por todo el
+ * proceso. Debe ajustarse antes de lanzar cálculos concurrentes.
+ *  - eg_obtener_umbrales / eg_configurar_umbrales: umbrales vigentes.
+ *  - eg_configurar_hilos: hilos que puede usar cada NTT (1 a 6;
+ *    por defecto 1).
+ */
+void eg_obtener_umbrales(UmbralesMultiplicacion *umbrales);
+void eg_configurar_umbrales(const UmbralesMultiplicacion *umbrales);
+void eg_configurar_hilos(int hilos);
+
+/* (fk, fk1) = (F(k), F(k + 1)) por duplicación rápida */
+int eg_fibonacci(uint64_t k, EnteroGrande *fk, EnteroGrande *fk1);
+
+/*
+ * Continúa la duplicación: con (fk, fk1) = (F(m), F(m + 1)) y
+ * m = k >> bits (bits <= 64), deja (F(k), F(k + 1)). Permite
+ * reutilizar el par de un prefijo binario común a varios índices.
+ */
+int eg_fibonacci_desde(uint64_t k, int bits, EnteroGrande *fk,
+                       EnteroGrande *fk1);
+
+/*
+ * Conversión a decimal.
+ *  - eg_digitos_maximos: cota superior del número de dígitos.
+ *  - eg_a_decimal: escribe los dígitos (sin '\0') en 'destino', que
+ *    debe tener al menos eg_digitos_maximos(x) bytes, y retorna la
+ *    cantidad escrita, o 0 si no hubo memoria. Los valores grandes
+ *    se convierten por divide y vencerás con potencias 10^(19*2^i).
+ *  - eg_a_decimal_hilos: igual, repartiendo las ramas superiores de
+ *    la recursión entre 'hilos' hilos.
+ *  - eg_a_decimal_ingenuo: divisiones repetidas entre 10^19, con
+ *    costo cuadrático; se conserva como referencia.
+ */
+size_t eg_digitos_maximos(const EnteroGrande *x);
+size_t eg_a_decimal(const EnteroGrande *x, char *destino);
+size_t eg_a_decimal_hilos(const EnteroGrande *x, char *destino, int hilos);
+size_t eg_a_decimal_ingenuo(const EnteroGrande *x, char *destino);
+
+#endif /* ENTERO_GRANDE_H */
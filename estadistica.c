@@ -0,0 +1,214 @@
+/*
+ * estadistica.c
+ * -----------------------------------------
+ * Implementación de las pruebas declaradas en estadistica.h.
+ */
+
+#include "estadistica.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * ValorRango
+ * -----------------------------------------
+ * Una observación de la muestra combinada, con el grupo del que
+ * viene (0: a, 1: b).
+ */
+typedef struct {
+    double valor;
+    int    grupo;
+} ValorRango;
+
+/* Prototipos de funciones internas */
+static int comparar_double(const void *x, const void *y);
+static int comparar_valor_rango(const void *x, const void *y);
+static int comparar_valor_absoluto(const void *x, const void *y);
+
+double est_mediana(const double *x, size_t n)
+{
+    if (n == 0) {
+        return 0.0;
+    }
+    double *copia = (double *)malloc(n * sizeof(double));
+    if (copia == NULL) {
+        return 0.0;
+    }
+    memcpy(copia, x, n * sizeof(double));
+    qsort(copia, n, sizeof(double), comparar_double);
+
+    double mediana = (n % 2 == 1) ? copia[n / 2]
+                                  : 0.5 * (copia[n / 2 - 1] + copia[n / 2]);
+    free(copia);
+    return mediana;
+}
+
+/*
+ * El estadístico es U_b = R_b - nb (nb + 1) / 2, con R_b la suma de
+ * los rangos de 'b' en la muestra combinada (los empates reciben el
+ * rango promedio). Bajo la hipótesis nula, U_b tiene media na nb / 2
+ * y varianza na nb / 12 * (N + 1 - sum(t^3 - t) / (N (N - 1))), con
+ * t el tamaño de cada grupo de empates.
+ */
+double est_mann_whitney_mayor(const double *a, size_t na,
+                              const double *b, size_t nb)
+{
+    size_t total = na + nb;
+
+    if (na == 0 || nb == 0) {
+        return 1.0;
+    }
+    ValorRango *todos = (ValorRango *)malloc(total * sizeof(ValorRango));
+    if (todos == NULL) {
+        return 1.0;
+    }
+    for (size_t i = 0; i < na; ++i) {
+        todos[i].valor = a[i];
+        todos[i].grupo = 0;
+    }
+    for (size_t i = 0; i < nb; ++i) {
+        todos[na + i].valor = b[i];
+        todos[na + i].grupo = 1;
+    }
+    qsort(todos, total, sizeof(ValorRango), comparar_valor_rango);
+
+    double rangos_b = 0.0, empates = 0.0;
+    for (size_t i = 0; i < total; ) {
+        size_t j = i + 1;
+        while (j < total && todos[j].valor == todos[i].valor) {
+            ++j;
+        }
+        /* Rangos i+1 .. j (desde 1): promedio (i + 1 + j) / 2 */
+        double rango = 0.5 * (double)(i + 1 + j);
+        double t     = (double)(j - i);
+        for (size_t k = i; k < j; ++k) {
+            if (todos[k].grupo == 1) {
+                rangos_b += rango;
+            }
+        }
+        empates += t * t * t - t;
+        i = j;
+    }
+    free(todos);
+
+    double n_a = (double)na, n_b = (double)nb, n = (double)total;
+    double u        = rangos_b - n_b * (n_b + 1.0) / 2.0;
+    double media    = n_a * n_b / 2.0;
+    double varianza = n_a * n_b / 12.0 *
+                      ((n + 1.0) - empates / (n * (n - 1.0)));
+    if (varianza <= 0.0) {
+        return 1.0;   /* todas las observaciones iguales */
+    }
+    double z = (u - media - 0.5) / sqrt(varianza);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+/*
+ * Se ordenan las diferencias no nulas por valor absoluto y W+ es la
+ * suma de los rangos de las positivas. Bajo la hipótesis nula tiene
+ * media m (m + 1) / 4 y varianza m (m + 1) (2m + 1) / 24 - sum(t^3 -
+ * t) / 48, con m las diferencias no nulas.
+ */
+double est_wilcoxon_pareado(const double *d, size_t n)
+{
+    double *no_nulas = (double *)malloc((n > 0 ? n : 1) * sizeof(double));
+    size_t  m = 0;
+
+    if (no_nulas == NULL) {
+        return 1.0;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (d[i] != 0.0) {
+            no_nulas[m++] = d[i];
+        }
+    }
+    if (m == 0) {
+        free(no_nulas);
+        return 1.0;
+    }
+    qsort(no_nulas, m, sizeof(double), comparar_valor_absoluto);
+
+    double positivos = 0.0, empates = 0.0;
+    for (size_t i = 0; i < m; ) {
+        size_t j = i + 1;
+        while (j < m && fabs(no_nulas[j]) == fabs(no_nulas[i])) {
+            ++j;
+        }
+        double rango = 0.5 * (double)(i + 1 + j);
+        double t     = (double)(j - i);
+        for (size_t k = i; k < j; ++k) {
+            if (no_nulas[k] > 0.0) {
+                positivos += rango;
+            }
+        }
+        empates += t * t * t - t;
+        i = j;
+    }
+    free(no_nulas);
+
+    double mm       = (double)m;
+    double media    = mm * (mm + 1.0) / 4.0;
+    double varianza = mm * (mm + 1.0) * (2.0 * mm + 1.0) / 24.0 -
+                      empates / 48.0;
+    if (varianza <= 0.0) {
+        return 1.0;
+    }
+    double z = (fabs(positivos - media) - 0.5) / sqrt(varianza);
+    if (z < 0.0) {
+        z = 0.0;
+    }
+    return erfc(z / sqrt(2.0));
+}
+
+int est_bootstrap_media(const double *x, size_t n, int remuestreos,
+                        double confianza, uint64_t semilla,
+                        double *inferior, double *superior)
+{
+    if (n == 0 || remuestreos < 1) {
+        return -1;
+    }
+    double *medias = (double *)malloc((size_t)remuestreos * sizeof(double));
+    if (medias == NULL) {
+        return -1;
+    }
+
+    uint64_t estado = (semilla != 0) ? semilla : 0x9e3779b97f4a7c15ULL;
+    for (int r = 0; r < remuestreos; ++r) {
+        double suma = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            estado ^= estado << 13;
+            estado ^= estado >> 7;
+            estado ^= estado << 17;
+            suma += x[estado % n];
+        }
+        medias[r] = suma / (double)n;
+    }
+    qsort(medias, (size_t)remuestreos, sizeof(double), comparar_double);
+
+    double cola  = 0.5 * (1.0 - confianza);
+    size_t bajo  = (size_t)(cola * (double)(remuestreos - 1));
+    size_t alto  = (size_t)((1.0 - cola) * (double)(remuestreos - 1) + 0.5);
+    *inferior = medias[bajo];
+    *superior = medias[alto];
+    free(medias);
+    return 0;
+}
+
+static int comparar_double(const void *x, const void *y)
+{
+    double a = *(const double *)x, b = *(const double *)y;
+    return (a > b) - (a < b);
+}
+
+static int comparar_valor_rango(const void *x, const void *y)
+{
+    return comparar_double(&((const ValorRango *)x)->valor,
+                           &((const ValorRango *)y)->valor);
+}
+
+static int comparar_valor_absoluto(const void *x, const void *y)
+{
+    double a = fabs(*(const double *)x), b = fabs(*(const double *)y);
+    return (a > b) - (a < b);
+}
@@ -0,0 +1,57 @@
+/*
+ * estadistica.h
+ * -----------------------------------------
+ * Estadística para comparar muestras de tiempos de ejecución.
+ *
+ * Los tiempos de un programa no siguen una normal (tienen cola a la
+ * derecha: interrupciones, migraciones, otra carga), así que las
+ * comparaciones usan pruebas por rangos, que no suponen ninguna
+ * distribución.
+ */
+
+#ifndef ESTADISTICA_H
+#define ESTADISTICA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Mediana de 'x' (no lo modifica); 0 si n = 0 */
+double est_mediana(const double *x, size_t n);
+
+/*
+ * est_mann_whitney_mayor
+ * -----------------------------------------
+ * Prueba U de Mann-Whitney unilateral: valor p de la hipótesis nula
+ * "las muestras de 'b' no tienden a ser mayores que las de 'a'". Un
+ * valor p pequeño indica que 'b' es mayor (más lenta, si son
+ * tiempos). Usa la aproximación normal con corrección por empates y
+ * por continuidad, razonable desde unas 8 muestras por lado.
+ * Retorna 1 si alguna muestra está vacía.
+ */
+double est_mann_whitney_mayor(const double *a, size_t na,
+                              const double *b, size_t nb);
+
+/*
+ * est_wilcoxon_pareado
+ * -----------------------------------------
+ * Prueba de rangos con signo de Wilcoxon, bilateral: valor p de la
+ * hipótesis nula "las diferencias pareadas 'd' son simétricas
+ * alrededor de 0". Las diferencias nulas se descartan; aproximación
+ * normal con corrección por empates. Retorna 1 si no quedan
+ * diferencias.
+ */
+double est_wilcoxon_pareado(const double *d, size_t n);
+
+/*
+ * est_bootstrap_media
+ * -----------------------------------------
+ * Intervalo de confianza por percentiles para la media de 'x', con
+ * 'remuestreos' remuestras con reemplazo (xorshift64 desde
+ * 'semilla', reproducible). 'confianza' en (0, 1), p. ej. 0.95.
+ * Retorna 0, o -1 si n = 0 o falta memoria.
+ */
+int est_bootstrap_media(const double *x, size_t n, int remuestreos,
+                        double confianza, uint64_t semilla,
+                        double *inferior, double *superior);
+
+#endif /* ESTADISTICA_H */
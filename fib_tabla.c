@@ -0,0 +1,619 @@
+/*
+ * fib_tabla.c
+ * -----------------------------------------
+ * Tabla persistente de la sucesión de Fibonacci con acceso
+ * aleatorio O(1) mediante mmap.
+ *
+ * Los valores de F(k) nunca cambian, así que en lugar de
+ * recalcularlos en cada ejecución (como hace fibonacci.c) se
+ * generan una sola vez en un archivo binario que luego se
+ * consulta proyectándolo en memoria, sin cálculo alguno.
+ *
+ * Formato del archivo (todas las secciones alineadas a 8 bytes):
+ *
+ *   [CabeceraTabla]
+ *   [fijos  : uint64_t x num_fijos]        F(0) .. F(num_fijos - 1)
+ *   [indice : uint64_t x (num_variables+1)] desplazamientos, en palabras,
+ *                                          dentro de la sección de datos
+ *   [datos  : palabras de 64 bits]         F(k) para k >= num_fijos,
+ *                                          en base 2^64 little-endian
+ *
+ * El término variable j (k = num_fijos + j) ocupa las palabras
+ * [indice[j], indice[j + 1]) de la sección de datos.
+ *
+ * Uso:
+ *      ./fib_tabla construir ARCHIVO N
+ *      ./fib_tabla consultar ARCHIVO k [k_fin]
+ *      ./fib_tabla consultar --binario ARCHIVO k [k_fin]
+ *
+ * Parámetros:
+ *  - N    : índice del último término almacenado (F(0) .. F(N)).
+ *  - k    : índice del término consultado.
+ *  - k_fin: si se indica, se imprimen F(k) .. F(k_fin), uno por línea.
+ *  - --binario: por cada término escribe su número de palabras
+ *               (uint64_t) seguido de las palabras tal como están
+ *               en el archivo (8 bytes por palabra, little-endian),
+ *               directamente desde la proyección y sin copias
+ *               intermedias.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "entero_grande.h"
+
+#define MAGIA_TABLA   "FIBTAB01"
+#define VERSION_TABLA 1u
+
+/* F(93) es el último término que cabe en 64 bits sin signo */
+#define MAX_INDICE_FIJO 93
+
+/*
+ * Mayor N aceptado por construir: con él, N + 1 no vuelve a 0 y el
+ * tamaño en bytes del índice (y de la cabecera y los fijos que lo
+ * preceden) cabe en size_t sin desbordar.
+ */
+#define MAX_INDICE_TABLA ((uint64_t)(SIZE_MAX / sizeof(uint64_t) / 2))
+
+/* Términos por llamada a writev en --binario (dos iovec por término) */
+#define TERMINOS_POR_LOTE 256
+
+/*
+ * CabeceraTabla
+ * -----------------------------------------
+ * Describe la disposición del archivo:
+ *  - cantidad      : número de términos almacenados (N + 1).
+ *  - num_fijos     : términos de ancho fijo (uint64_t).
+ *  - offset_*      : posición en bytes de cada sección.
+ *  - palabras_datos: tamaño de la sección de datos en palabras.
+ */
+typedef struct {
+    char     magia[8];
+    uint32_t version;
+    uint32_t tam_palabra;
+    uint64_t cantidad;
+    uint64_t num_fijos;
+    uint64_t offset_fijos;
+    uint64_t offset_indice;
+    uint64_t offset_datos;
+    uint64_t palabras_datos;
+} CabeceraTabla;
+
+/*
+ * TablaProyectada
+ * -----------------------------------------
+ * Tabla abierta en modo lectura.
+ */
+typedef struct {
+    const CabeceraTabla *cabecera;
+    const uint64_t      *fijos;
+    const uint64_t      *indice;
+    const uint64_t      *datos;
+    void                *base;
+    size_t               tam;
+} TablaProyectada;
+
+/* Prototipos de funciones internas */
+static int  construir_tabla(const char *ruta, uint64_t ultimo_indice);
+static int  abrir_tabla(const char *ruta, TablaProyectada *tabla);
+static int  validar_tabla(const CabeceraTabla *cabecera, uint64_t tam);
+static int  consultar(const TablaProyectada *tabla, uint64_t desde,
+                      uint64_t hasta, int binario);
+static int  consultar_binario(const TablaProyectada *tabla, uint64_t desde,
+                              uint64_t hasta);
+static int  escribir_todo(int fd, const void *datos, size_t tam);
+static int  escribir_vector(int fd, struct iovec *vector, int cantidad);
+static int  leer_indice(const char *texto, uint64_t *valor);
+static void mostrar_uso(const char *nombre_programa);
+
+int main(int argc, char **argv)
+{
+    if (argc >= 4 && strcmp(argv[1], "construir") == 0) {
+        uint64_t ultimo;
+        if (leer_indice(argv[3], &ultimo) != 0 || ultimo > MAX_INDICE_TABLA) {
+            fprintf(stderr, "Error: N debe ser un entero entre 0 y %" PRIu64 ".\n",
+                    MAX_INDICE_TABLA);
+            return EXIT_FAILURE;
+        }
+        return (construir_tabla(argv[2], ultimo) == 0) ? EXIT_SUCCESS
+                                                       : EXIT_FAILURE;
+    }
+
+    if (argc >= 4 && strcmp(argv[1], "consultar") == 0) {
+        int binario = (strcmp(argv[2], "--binario") == 0);
+        int base    = binario ? 3 : 2;
+
+        if (argc < base + 2) {
+            mostrar_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        uint64_t desde, hasta;
+        if (leer_indice(argv[base + 1], &desde) != 0) {
+            fprintf(stderr, "Error: k debe ser un entero mayor o igual a 0.\n");
+            return EXIT_FAILURE;
+        }
+        hasta = desde;
+        if (argc > base + 2 && (leer_indice(argv[base + 2], &hasta) != 0 ||
+                                hasta < desde)) {
+            fprintf(stderr, "Error: k_fin debe ser mayor o igual a k.\n");
+            return EXIT_FAILURE;
+        }
+
+        TablaProyectada tabla;
+        if (abrir_tabla(argv[base], &tabla) != 0) {
+            return EXIT_FAILURE;
+        }
+
+        int codigo = consultar(&tabla, desde, hasta, binario);
+        munmap(tabla.base, tabla.tam);
+        return (codigo == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    mostrar_uso(argv[0]);
+    return EXIT_FAILURE;
+}
+
+/*
+ * mostrar_uso
+ * -----------------------------------------
+ * Muestra un mensaje de ayuda con el formato de uso del programa.
+ */
+static void mostrar_uso(const char *nombre_programa)
+{
+    fprintf(stderr,
+            "Uso:\n"
+            "  %s construir ARCHIVO N\n"
+            "  %s consultar [--binario] ARCHIVO k [k_fin]\n",
+            nombre_programa, nombre_programa);
+}
+
+/*
+ * construir_tabla
+ * -----------------------------------------
+ * Genera F(0) .. F(ultimo_indice) en 'ruta'; ultimo_indice no debe
+ * superar MAX_INDICE_TABLA.
+ *
+ * Solo se mantienen en memoria los dos últimos términos y el
+ * índice de desplazamientos; las palabras de cada término grande
+ * se escriben secuencialmente en la sección de datos.
+ *
+ * Retorna 0 si tuvo éxito, -1 en caso de error.
+ */
+static int construir_tabla(const char *ruta, uint64_t ultimo_indice)
+{
+    const uint64_t cantidad  = ultimo_indice + 1;
+    const uint64_t num_fijos = (cantidad < MAX_INDICE_FIJO + 1)
+                                   ? cantidad : MAX_INDICE_FIJO + 1;
+    const uint64_t num_variables = cantidad - num_fijos;
+
+    CabeceraTabla cabecera;
+    memset(&cabecera, 0, sizeof(cabecera));
+    memcpy(cabecera.magia, MAGIA_TABLA, sizeof(cabecera.magia));
+    cabecera.version       = VERSION_TABLA;
+    cabecera.tam_palabra   = sizeof(uint64_t);
+    cabecera.cantidad      = cantidad;
+    cabecera.num_fijos     = num_fijos;
+    cabecera.offset_fijos  = sizeof(CabeceraTabla);
+    cabecera.offset_indice = cabecera.offset_fijos +
+                             num_fijos * sizeof(uint64_t);
+    cabecera.offset_datos  = cabecera.offset_indice +
+                             (num_variables + 1) * sizeof(uint64_t);
+
+    uint64_t *fijos  = (uint64_t *)malloc(sizeof(uint64_t) * num_fijos);
+    uint64_t *indice = (uint64_t *)malloc(sizeof(uint64_t) * (num_variables + 1));
+    if (fijos == NULL || indice == NULL) {
+        perror("Error en malloc para la tabla");
+        free(fijos);
+        free(indice);
+        return -1;
+    }
+
+    int fd = open(ruta, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("Error al crear el archivo de la tabla");
+        free(fijos);
+        free(indice);
+        return -1;
+    }
+
+    /* Tramo de ancho fijo: aritmética de 64 bits */
+    for (uint64_t k = 0; k < num_fijos; ++k) {
+        fijos[k] = (k < 2) ? k : fijos[k - 1] + fijos[k - 2];
+    }
+
+    /* Tramo variable: los datos se escriben a partir de offset_datos */
+    int codigo = 0;
+    EnteroGrande anterior, actual;
+    eg_iniciar(&anterior);
+    eg_iniciar(&actual);
+
+    if (lseek(fd, (off_t)cabecera.offset_datos, SEEK_SET) < 0) {
+        perror("Error en lseek");
+        codigo = -1;
+    }
+
+    if (codigo == 0 && num_variables > 0) {
+        /* Estado inicial: (F(92), F(93)) */
+        if (eg_asignar_u64(&anterior, fijos[MAX_INDICE_FIJO - 1]) != 0 ||
+            eg_asignar_u64(&actual, fijos[MAX_INDICE_FIJO]) != 0) {
+            codigo = -1;
+        }
+    }
+
+    uint64_t desplazamiento = 0;
+    for (uint64_t j = 0; codigo == 0 && j < num_variables; ++j) {
+        /* anterior <- anterior + actual; luego intercambio */
+        if (eg_sumar(&anterior, &anterior, &actual) != 0) {
+            fprintf(stderr, "Error: memoria insuficiente en el término %" PRIu64 ".\n",
+                    num_fijos + j);
+            codigo = -1;
+            break;
+        }
+        EnteroGrande tmp = anterior;
+        anterior = actual;
+        actual   = tmp;
+
+        indice[j] = desplazamiento;
+        if (escribir_todo(fd, actual.palabras,
+                          sizeof(uint64_t) * actual.longitud) != 0) {
+            perror("Error al escribir los datos de la tabla");
+            codigo = -1;
+            break;
+        }
+        desplazamiento += actual.longitud;
+    }
+    indice[num_variables] = desplazamiento;
+    cabecera.palabras_datos = desplazamiento;
+
+    eg_liberar(&anterior);
+    eg_liberar(&actual);
+
+    /* Cabecera, fijos e índice se escriben al final, ya completos */
+    if (codigo == 0 &&
+        (pwrite(fd, &cabecera, sizeof(cabecera), 0) != (ssize_t)sizeof(cabecera) ||
+         pwrite(fd, fijos, sizeof(uint64_t) * num_fijos,
+                (off_t)cabecera.offset_fijos) !=
+             (ssize_t)(sizeof(uint64_t) * num_fijos) ||
+         pwrite(fd, indice, sizeof(uint64_t) * (num_variables + 1),
+                (off_t)cabecera.offset_indice) !=
+             (ssize_t)(sizeof(uint64_t) * (num_variables + 1)))) {
+        perror("Error al escribir la cabecera de la tabla");
+        codigo = -1;
+    }
+
+    if (close(fd) != 0 && codigo == 0) {
+        perror("Error al cerrar la tabla");
+        codigo = -1;
+    }
+
+    free(fijos);
+    free(indice);
+    return codigo;
+}
+
+/*
+ * abrir_tabla
+ * -----------------------------------------
+ * Proyecta la tabla en memoria (solo lectura) y valida con
+ * validar_tabla que la cabecera y el índice sean coherentes con el
+ * tamaño del archivo antes de usar cualquier desplazamiento.
+ *
+ * Retorna 0 si tuvo éxito, -1 en caso de error.
+ */
+static int abrir_tabla(const char *ruta, TablaProyectada *tabla)
+{
+    int fd = open(ruta, O_RDONLY);
+    if (fd < 0) {
+        perror("Error al abrir la tabla");
+        return -1;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(CabeceraTabla)) {
+        fprintf(stderr, "Error: '%s' no es una tabla válida.\n", ruta);
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("Error en mmap de la tabla");
+        return -1;
+    }
+
+    const CabeceraTabla *cabecera = (const CabeceraTabla *)base;
+    if (validar_tabla(cabecera, (uint64_t)info.st_size) != 0) {
+        fprintf(stderr, "Error: '%s' no es una tabla compatible.\n", ruta);
+        munmap(base, (size_t)info.st_size);
+        return -1;
+    }
+
+    tabla->cabecera = cabecera;
+    tabla->fijos    = (const uint64_t *)((const char *)base + cabecera->offset_fijos);
+    tabla->indice   = (const uint64_t *)((const char *)base + cabecera->offset_indice);
+    tabla->datos    = (const uint64_t *)((const char *)base + cabecera->offset_datos);
+    tabla->base     = base;
+    tabla->tam      = (size_t)info.st_size;
+    return 0;
+}
+
+/*
+ * validar_tabla
+ * -----------------------------------------
+ * Comprueba una tabla proyectada de 'tam' bytes:
+ *  - magia, versión y tamaño de palabra.
+ *  - cantidad >= 1 y num_fijos = min(cantidad, MAX_INDICE_FIJO + 1).
+ *  - las secciones están contiguas, en el orden de construir_tabla,
+ *    y la de datos termina justo al final del archivo.
+ *  - el índice empieza en 0, termina en palabras_datos y cada
+ *    término ocupa al menos una palabra y no menos que el anterior
+ *    (consultar dimensiona el búfer decimal con el último término).
+ *
+ * Todas las comparaciones se hacen contra el espacio restante, sin
+ * multiplicaciones que puedan desbordar.
+ *
+ * Retorna 0 si la tabla es válida, -1 en caso contrario.
+ */
+static int validar_tabla(const CabeceraTabla *cabecera, uint64_t tam)
+{
+    const uint64_t palabra = sizeof(uint64_t);
+
+    if (memcmp(cabecera->magia, MAGIA_TABLA, sizeof(cabecera->magia)) != 0 ||
+        cabecera->version != VERSION_TABLA ||
+        cabecera->tam_palabra != palabra) {
+        return -1;
+    }
+
+    const uint64_t cantidad  = cabecera->cantidad;
+    const uint64_t num_fijos = cabecera->num_fijos;
+    if (cantidad == 0 ||
+        num_fijos != ((cantidad < MAX_INDICE_FIJO + 1) ? cantidad
+                                                       : MAX_INDICE_FIJO + 1)) {
+        return -1;
+    }
+    const uint64_t entradas = cantidad - num_fijos + 1;
+
+    /* Cabecera, fijos, índice y datos, uno tras otro */
+    if (cabecera->offset_fijos != sizeof(CabeceraTabla) ||
+        num_fijos > (tam - cabecera->offset_fijos) / palabra) {
+        return -1;
+    }
+    if (cabecera->offset_indice != cabecera->offset_fijos + num_fijos * palabra ||
+        entradas > (tam - cabecera->offset_indice) / palabra) {
+        return -1;
+    }
+    if (cabecera->offset_datos != cabecera->offset_indice + entradas * palabra ||
+        cabecera->palabras_datos != (tam - cabecera->offset_datos) / palabra ||
+        (tam - cabecera->offset_datos) % palabra != 0) {
+        return -1;
+    }
+
+    /* Cada entrada del índice, dentro de la sección de datos */
+    const uint64_t *indice = (const uint64_t *)
+        ((const char *)cabecera + cabecera->offset_indice);
+    if (indice[0] != 0 || indice[entradas - 1] != cabecera->palabras_datos) {
+        return -1;
+    }
+    uint64_t longitud_previa = 1;
+    for (uint64_t j = 0; j + 1 < entradas; ++j) {
+        if (indice[j + 1] < indice[j] ||
+            indice[j + 1] - indice[j] < longitud_previa) {
+            return -1;
+        }
+        longitud_previa = indice[j + 1] - indice[j];
+    }
+
+    return 0;
+}
+
+/*
+ * consultar
+ * -----------------------------------------
+ * Emite F(desde) .. F(hasta) por la salida estándar.
+ *
+ * El modo binario lo resuelve consultar_binario. En modo decimal
+ * los términos de ancho fijo se formatean con printf y los grandes
+ * se convierten con eg_a_decimal sobre una vista de la proyección.
+ *
+ * Retorna 0 si tuvo éxito, -1 en caso de error.
+ */
+static int consultar(const TablaProyectada *tabla, uint64_t desde,
+                     uint64_t hasta, int binario)
+{
+    const uint64_t cantidad  = tabla->cabecera->cantidad;
+    const uint64_t num_fijos = tabla->cabecera->num_fijos;
+
+    if (hasta >= cantidad) {
+        fprintf(stderr,
+                "Error: la tabla solo contiene F(0) .. F(%" PRIu64 ").\n",
+                cantidad - 1);
+        return -1;
+    }
+    if (binario) {
+        return consultar_binario(tabla, desde, hasta);
+    }
+
+    /* Tramo de ancho fijo */
+    uint64_t k = desde;
+    if (k < num_fijos) {
+        uint64_t fin_fijo = (hasta < num_fijos) ? hasta : num_fijos - 1;
+
+        for (uint64_t i = k; i <= fin_fijo; ++i) {
+            printf("%" PRIu64 "\n", tabla->fijos[i]);
+        }
+        fflush(stdout);
+        k = fin_fijo + 1;
+    }
+
+    if (k > hasta) {
+        return 0;
+    }
+
+    /* Tramo variable */
+    const uint64_t *indice = tabla->indice;
+    uint64_t j_desde = k - num_fijos;
+    uint64_t j_hasta = hasta - num_fijos;
+
+    size_t max_palabras = (size_t)(indice[j_hasta + 1] - indice[j_hasta]);
+    char *texto = (char *)malloc(max_palabras * 20 + 1);
+    if (texto == NULL) {
+        perror("Error en malloc para la conversión decimal");
+        return -1;
+    }
+
+    int codigo = 0;
+    for (uint64_t j = j_desde; j <= j_hasta; ++j) {
+        EnteroGrande termino = eg_vista(tabla->datos + indice[j],
+                                        (size_t)(indice[j + 1] - indice[j]));
+        size_t digitos = eg_a_decimal(&termino, texto);
+        if (digitos == 0) {
+            fprintf(stderr, "Error: memoria insuficiente en la conversión.\n");
+            codigo = -1;
+            break;
+        }
+        texto[digitos] = '\n';
+        if (escribir_todo(STDOUT_FILENO, texto, digitos + 1) != 0) {
+            perror("Error al escribir la salida");
+            codigo = -1;
+            break;
+        }
+    }
+
+    free(texto);
+    return codigo;
+}
+
+/*
+ * consultar_binario
+ * -----------------------------------------
+ * Emite F(desde) .. F(hasta) en binario: por cada término, su número
+ * de palabras como uint64_t y a continuación las palabras. Sin ese
+ * prefijo los términos de longitud variable no podrían separarse.
+ *
+ * Las palabras salen directamente de la proyección: cada término
+ * aporta dos iovec (su longitud, tomada de un arreglo local, y sus
+ * palabras) y se entregan TERMINOS_POR_LOTE términos por writev.
+ *
+ * Retorna 0 si tuvo éxito, -1 en caso de error.
+ */
+static int consultar_binario(const TablaProyectada *tabla, uint64_t desde,
+                             uint64_t hasta)
+{
+    const uint64_t  num_fijos = tabla->cabecera->num_fijos;
+    const uint64_t *indice    = tabla->indice;
+    uint64_t        longitudes[TERMINOS_POR_LOTE];
+    struct iovec    vector[2 * TERMINOS_POR_LOTE];
+    int             en_lote = 0;
+
+    for (uint64_t k = desde; k <= hasta; ++k) {
+        const uint64_t *palabras;
+        if (k < num_fijos) {
+            palabras            = tabla->fijos + k;
+            longitudes[en_lote] = 1;
+        } else {
+            uint64_t j          = k - num_fijos;
+            palabras            = tabla->datos + indice[j];
+            longitudes[en_lote] = indice[j + 1] - indice[j];
+        }
+        vector[2 * en_lote].iov_base     = &longitudes[en_lote];
+        vector[2 * en_lote].iov_len      = sizeof(uint64_t);
+        vector[2 * en_lote + 1].iov_base = (void *)palabras;
+        vector[2 * en_lote + 1].iov_len  =
+            (size_t)longitudes[en_lote] * sizeof(uint64_t);
+        ++en_lote;
+
+        if (en_lote == TERMINOS_POR_LOTE || k == hasta) {
+            if (escribir_vector(STDOUT_FILENO, vector, 2 * en_lote) != 0) {
+                perror("Error al escribir la salida");
+                return -1;
+            }
+            en_lote = 0;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * escribir_vector
+ * -----------------------------------------
+ * writev() que reintenta hasta entregar todos los iovec; tras una
+ * escritura parcial avanza sobre 'vector', que queda modificado.
+ */
+static int escribir_vector(int fd, struct iovec *vector, int cantidad)
+{
+    while (cantidad > 0) {
+        ssize_t escritos = writev(fd, vector, cantidad);
+        if (escritos < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        size_t restantes = (size_t)escritos;
+        while (cantidad > 0 && restantes >= vector->iov_len) {
+            restantes -= vector->iov_len;
+            ++vector;
+            --cantidad;
+        }
+        if (cantidad > 0) {
+            vector->iov_base = (char *)vector->iov_base + restantes;
+            vector->iov_len -= restantes;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * escribir_todo
+ * -----------------------------------------
+ * write() que reintenta hasta entregar 'tam' bytes.
+ */
+static int escribir_todo(int fd, const void *datos, size_t tam)
+{
+    const char *p = (const char *)datos;
+
+    while (tam > 0) {
+        ssize_t escritos = write(fd, p, tam);
+        if (escritos < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p   += escritos;
+        tam -= (size_t)escritos;
+    }
+
+    return 0;
+}
+
+/*
+ * leer_indice
+ * -----------------------------------------
+ * Convierte un texto decimal no negativo a uint64_t.
+ */
+static int leer_indice(const char *texto, uint64_t *valor)
+{
+    char *fin = NULL;
+
+    if (texto[0] == '-' || texto[0] == '\0') {
+        return -1;
+    }
+    errno  = 0;
+    *valor = strtoull(texto, &fin, 10);
+    return (errno != 0 || *fin != '\0') ? -1 : 0;
+}
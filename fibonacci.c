@@ -6,17 +6,26 @@
  *
  * El hilo principal:
  *  - Lee N desde la línea de comandos.
- *  - Reserva un arreglo compartido de tamaño N.
- *  - Empaqueta el puntero al arreglo y el valor N en una
+ *  - Reserva los arreglos compartidos de los niveles de 64 y 128
+ *    bits (ver más abajo), de tamaño fijo y conocido.
+ *  - Empaqueta los punteros a los arreglos y el valor N en una
  *    estructura de argumentos.
  *  - Crea un hilo trabajador, pasándole esa estructura.
  *  - Espera a que el hilo termine (pthread_join).
  *  - Imprime la secuencia resultante.
  *
  * El hilo trabajador:
- *  - Recibe la estructura con el puntero al arreglo y N.
- *  - Rellena el arreglo con los primeros N términos de la
- *    sucesión de Fibonacci.
+ *  - Recibe la estructura con los punteros a los arreglos y N.
+ *  - Rellena los arreglos con los primeros N términos de la
+ *    sucesión de Fibonacci; el nivel de EnteroGrande, cuyo tamaño
+ *    solo se conoce al detectar el último desbordamiento, lo
+ *    reserva él. El hilo principal libera todo.
+ *
+ * Representación por niveles: cada término usa el tipo más pequeño
+ * que lo contiene. F(0)..F(93) caben en uint64_t,
+ * F(94)..F(186) en unsigned __int128 y los siguientes se guardan
+ * como EnteroGrande. El cambio de nivel se decide al detectar el
+ * desbordamiento de la suma, no con índices fijos.
  *
  * Convención usada:
  *  F(0) = 0
@@ -27,41 +36,258 @@
  *
  * Uso:
  *      ./fibonacci N
+ *      ./fibonacci --termino K [--hilos T]
+ *      ./fibonacci --sucesion NOMBRE N [opciones]
+ *      ./fibonacci --recurrencia C1,...,Ck S0,...,S(k-1) N [opciones]
+ *      ./fibonacci --lote [ARCHIVO] [--hilos T] [--modulo M]
+ *      ./fibonacci --flujo N [--modulo M]
+ *      ./fibonacci --dispersa N K
+ *      ./fibonacci --archivo N RUTA [--hilos T]
+ *      ./fibonacci --verificar [ARCHIVO] [opciones]
  *
  * Parámetros:
  *  - N: entero mayor o igual a 0.
+ *  - K: índice de un único término F(K) a imprimir completo, sin
+ *       límite de tamaño (ver entero_grande.h).
+ *  - T: hilos usados para convertir F(K) a decimal y para las
+ *       multiplicaciones por NTT (por defecto 1).
+ *  - NOMBRE: recurrencia predefinida (fibonacci, lucas, pell, ...).
+ *  - C1..Ck, S0..S(k-1): coeficientes y semillas de
+ *       a(i) = C1 a(i-1) + ... + Ck a(i-k) (ver recurrencia.h).
+ *  - opciones: --desde I (primer índice, por defecto 0), --modulo M
+ *       (por defecto 2^64, como tipo_fibonacci) y --hilos T (bloques
+ *       generados en paralelo). Para el arreglo de términos:
+ *       --paginas normales|enormes|hugetlb, --numa local|intercalada
+ *       y --prefallar (ver paginas.h); con --rss se informan además
+ *       los fallos de página al prefallar y al llenar.
+ *  - ARCHIVO: índices k a consultar, separados por espacios o saltos
+ *       de línea (por defecto, la entrada estándar). Se imprime un
+ *       F(k) por línea, en el mismo orden (ver lote.h).
+ *  - --flujo: imprime los N primeros términos módulo M (por defecto
+ *       2^64) con memoria constante: el hilo trabajador entrega
+ *       bloques de términos al hilo principal, que los escribe, y
+ *       al final se informa el pico de memoria residente (RSS).
+ *  - --dispersa: imprime los N primeros términos completos guardando
+ *       solo un par de términos cada K (ver dispersa.h); los demás se
+ *       reconstruyen al imprimirlos. Se informa la memoria de los
+ *       puntos de control y el pico de RSS.
+ *  - --archivo: escribe los N primeros términos completos en RUTA,
+ *       con T hilos formateando en paralelo sobre el archivo
+ *       proyectado en memoria (ver mapeo.h).
+ *  - --verificar: comprueba una sucesión ya impresa (por defecto, la
+ *       entrada estándar) sin regenerarla, con identidades sobre
+ *       ventanas de términos elegidas al azar (ver verificacion.h).
+ *       Opciones: --hilos T, --muestras S (ventanas, por defecto 64),
+ *       --ventana W (términos por ventana, por defecto 16), --primos
+ *       P (1 a 4, por defecto 2), --desde I y --modulo M si los
+ *       valores se imprimieron reducidos (--modulo 0 para 2^64,
+ *       como en --flujo). Las ventanas cambian en cada ejecución;
+ *       el informe muestra la semilla, y --semilla N la repite.
+ *
+ * Con la variable de entorno TRAZA=RUTA, el modo por defecto y
+ * --flujo escriben en RUTA la línea de tiempo de sus hilos en formato
+ * Chrome trace-event (ver traza.h).
+ *
+ * Sondas USDT (proveedor fibonacci, ver sondas.h):
+ *  - hilo_inicio(cantidad), hilo_fin(terminos): vida del hilo
+ *    trabajador, en el modo por defecto y en --flujo.
+ *  - nivel_fin(bits, terminos): fin de un nivel de representación
+ *    (64, 128 o 0 para EnteroGrande); 'terminos' es el total hasta él.
+ *  - bloque_fin(bloque, terminos): un bloque de --flujo generado.
+ * Las entregas de la salida tienen sus propias sondas (salida.c).
  */
 
+#include <errno.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "dispersa.h"
+#include "entero_grande.h"
+#include "formato_decimal.h"
+#include "lote.h"
+#include "mapeo.h"
+#include "paginas.h"
+#include "recurrencia.h"
+#include "salida.h"
+#include "sondas.h"
+#include "traza.h"
+#include "verificacion.h"
+
+/* Tipos de dato para los valores de Fibonacci, por nivel */
+typedef uint64_t           tipo_fibonacci;
+typedef unsigned __int128  tipo_fibonacci_128;
+
+/*
+ * Términos de cada nivel: F(0)..F(93) y F(94)..F(186). El hilo
+ * principal reserva cada nivel con una posición de holgura, de modo
+ * que el trabajador siempre intenta la suma que desborda antes de
+ * agotar el arreglo: el cambio de nivel lo decide la detección.
+ */
+#define TERMINOS_NIVEL_64  94
+#define TERMINOS_NIVEL_128 93
+
+/* Modo de flujo: términos por bloque y bloques en circulación */
+#define TERMINOS_POR_BLOQUE 4096
+#define NUM_BLOQUES_FLUJO   2
+
+/*
+ * BloqueFlujo
+ * -----------------------------------------
+ * Bloque de términos consecutivos que el hilo trabajador entrega al
+ * escritor. 'lleno' indica a quién pertenece: 1 al escritor, 0 al
+ * trabajador.
+ */
+typedef struct {
+    uint64_t valores[TERMINOS_POR_BLOQUE];
+    size_t   cantidad;
+    int      lleno;
+} BloqueFlujo;
 
-/* Tipo de dato para los valores de Fibonacci */
-typedef unsigned long long tipo_fibonacci;
+/*
+ * ArgumentosFlujo
+ * -----------------------------------------
+ * Estado compartido del modo de flujo: los bloques en circulación
+ * (usados de forma circular), su sincronización y la sucesión a
+ * generar (cantidad de términos y módulo; 0 = 2^64).
+ */
+typedef struct {
+    BloqueFlujo     bloques[NUM_BLOQUES_FLUJO];
+    uint64_t        cantidad;
+    uint64_t        modulo;
+    pthread_mutex_t mutex;
+    pthread_cond_t  hay_lleno;
+    pthread_cond_t  hay_vacio;
+} ArgumentosFlujo;
 
 /*
  * ArgumentosFibonacci
  * -----------------------------------------
  * Estructura para pasar múltiples parámetros al hilo:
- *  - arreglo: puntero al arreglo compartido donde se almacenará la secuencia.
+ *  - arreglo: puntero al arreglo compartido donde se almacenará la secuencia
+ *    (nivel de 64 bits).
+ *  - arreglo_128: nivel de 128 bits (NULL si N no llega a él).
+ *  - capacidad_64, capacidad_128: elementos reservados en arreglo y
+ *    arreglo_128 por el hilo principal.
+ *  - arreglo_grande: nivel de precisión arbitraria; lo reserva el
+ *    hilo trabajador con el tamaño exacto que resta.
  *  - cantidad: número de términos a generar (N >= 0).
+ *  - fin_64, fin_128: salida del hilo; primer índice de cada nivel
+ *    que ya no cabe en él.
+ *  - error: salida del hilo; ERROR_MEMORIA si faltó memoria,
+ *    ERROR_CAPACIDAD si un nivel se llenó sin desbordar (no debería
+ *    ocurrir).
  */
 typedef struct {
-    tipo_fibonacci *arreglo;
-    int             cantidad;
+    tipo_fibonacci     *arreglo;
+    tipo_fibonacci_128 *arreglo_128;
+    EnteroGrande       *arreglo_grande;
+    int                 capacidad_64;
+    int                 capacidad_128;
+    int                 cantidad;
+    int                 fin_64;
+    int                 fin_128;
+    int                 error;
 } ArgumentosFibonacci;
 
+#define ERROR_MEMORIA   1
+#define ERROR_CAPACIDAD 2
+
 /* Prototipos de funciones internas */
 static void *trabajador_fibonacci(void *argumento);
+static void  liberar_secuencia(ArgumentosFibonacci *argumentos);
+static int   imprimir_secuencia(const ArgumentosFibonacci *argumentos);
 static void  mostrar_uso(const char *nombre_programa);
+static int   imprimir_termino(uint64_t indice, int hilos);
+static int   modo_recurrencia(int argc, char **argv);
+static int   modo_lote(int argc, char **argv);
+static int   modo_flujo(int argc, char **argv);
+static void *trabajador_flujo(void *argumento);
+static int   modo_dispersa(int argc, char **argv);
+static int   modo_archivo(int argc, char **argv);
+static int   modo_verificar(int argc, char **argv);
+static int   escribir_valores(Salida *salida, const uint64_t *valores,
+                              size_t cantidad, int previos);
+static void  reportar_memoria_pico(void);
+static int   leer_indice(const char *texto, uint64_t *valor);
 
 int main(int argc, char **argv)
 {
+    if (traza_iniciar() != 0) {
+        fprintf(stderr, "Advertencia: no se pudo activar la traza.\n");
+    }
+    traza_nombrar_hilo("principal", -1);
+
     if (argc < 2) {
         mostrar_uso(argv[0]);
         return EXIT_FAILURE;
     }
 
+    /* Modo de término único: F(K) con precisión arbitraria */
+    if (strcmp(argv[1], "--termino") == 0) {
+        char *fin = NULL;
+        int hilos = 1;
+
+        if (argc < 3 || argv[2][0] == '-') {
+            mostrar_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+        errno = 0;
+        uint64_t indice = strtoull(argv[2], &fin, 10);
+        if (errno != 0 || *fin != '\0') {
+            fprintf(stderr,
+                    "Error: K debe ser un entero mayor o igual a 0.\n");
+            return EXIT_FAILURE;
+        }
+        if (argc >= 5 && strcmp(argv[3], "--hilos") == 0) {
+            hilos = atoi(argv[4]);
+        }
+        if (hilos <= 0) {
+            fprintf(stderr,
+                    "Advertencia: número de hilos inválido (%d). Se usará 1 hilo.\n",
+                    hilos);
+            hilos = 1;
+        }
+
+        return (imprimir_termino(indice, hilos) == 0) ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+    }
+
+    /* Modo de recurrencia general (Lucas, Pell, coeficientes propios) */
+    if (strcmp(argv[1], "--sucesion") == 0 ||
+        strcmp(argv[1], "--recurrencia") == 0) {
+        return modo_recurrencia(argc, argv);
+    }
+
+    /* Flujo con memoria constante: solo imprimir, sin guardar */
+    if (strcmp(argv[1], "--flujo") == 0) {
+        return modo_flujo(argc, argv);
+    }
+
+    /* Secuencia completa guardando solo puntos de control */
+    if (strcmp(argv[1], "--dispersa") == 0) {
+        return modo_dispersa(argc, argv);
+    }
+
+    /* Secuencia completa a un archivo, formateada en paralelo */
+    if (strcmp(argv[1], "--archivo") == 0) {
+        return modo_archivo(argc, argv);
+    }
+
+    /* Verificación de una sucesión ya impresa */
+    if (strcmp(argv[1], "--verificar") == 0) {
+        return modo_verificar(argc, argv);
+    }
+
+    /* Consultas por lotes: F(k) para muchos k leídos de un archivo */
+    if (strcmp(argv[1], "--lote") == 0) {
+        return modo_lote(argc, argv);
+    }
+
     int cantidad = atoi(argv[1]);
     if (cantidad < 0) {
         fprintf(stderr,
@@ -74,62 +300,79 @@ int main(int argc, char **argv)
         return EXIT_SUCCESS;
     }
 
-    /* Reserva dinámica para el arreglo de Fibonacci */
-    tipo_fibonacci *secuencia =
-        (tipo_fibonacci *)malloc(sizeof(tipo_fibonacci) * (size_t)cantidad);
-    if (secuencia == NULL) {
-        perror("Error en malloc para secuencia");
-        return EXIT_FAILURE;
-    }
-
     /* Reserva y carga de la estructura de argumentos para el hilo */
     ArgumentosFibonacci *argumentos =
-        (ArgumentosFibonacci *)malloc(sizeof(ArgumentosFibonacci));
+        (ArgumentosFibonacci *)calloc(1, sizeof(ArgumentosFibonacci));
     if (argumentos == NULL) {
         perror("Error en malloc para ArgumentosFibonacci");
-        free(secuencia);
         return EXIT_FAILURE;
     }
-
-    argumentos->arreglo  = secuencia;
     argumentos->cantidad = cantidad;
 
+    /* Niveles de tamaño conocido; el de EnteroGrande lo reserva el
+     * trabajador */
+    int resto = cantidad - TERMINOS_NIVEL_64;
+    argumentos->capacidad_64  = (cantidad < TERMINOS_NIVEL_64 + 1)
+                                    ? cantidad : TERMINOS_NIVEL_64 + 1;
+    argumentos->capacidad_128 = (resto <= 0) ? 0
+                              : (resto < TERMINOS_NIVEL_128 + 1)
+                                    ? resto : TERMINOS_NIVEL_128 + 1;
+    argumentos->arreglo = (tipo_fibonacci *)
+        malloc(sizeof(tipo_fibonacci) * (size_t)argumentos->capacidad_64);
+    if (argumentos->capacidad_128 > 0) {
+        argumentos->arreglo_128 = (tipo_fibonacci_128 *)
+            malloc(sizeof(tipo_fibonacci_128) *
+                   (size_t)argumentos->capacidad_128);
+    }
+    if (argumentos->arreglo == NULL ||
+        (argumentos->capacidad_128 > 0 && argumentos->arreglo_128 == NULL)) {
+        perror("Error en malloc para secuencia");
+        liberar_secuencia(argumentos);
+        return EXIT_FAILURE;
+    }
+
     pthread_t hilo_trabajador;
+    uint64_t marca = traza_ahora();
     int codigo = pthread_create(&hilo_trabajador,
                                 NULL,
                                 trabajador_fibonacci,
                                 (void *)argumentos);
+    traza_completo("crear", marca, "hilo", 0);
     if (codigo != 0) {
         fprintf(stderr,
                 "Error al crear el hilo (código %d).\n", codigo);
-        free(argumentos);
-        free(secuencia);
+        liberar_secuencia(argumentos);
         return EXIT_FAILURE;
     }
 
     /* Esperamos a que el hilo termine antes de acceder al arreglo */
+    marca  = traza_ahora();
     codigo = pthread_join(hilo_trabajador, NULL);
+    traza_completo("join", marca, "hilo", 0);
     if (codigo != 0) {
         fprintf(stderr,
                 "Error en pthread_join (código %d).\n", codigo);
-        free(argumentos);
-        free(secuencia);
+        liberar_secuencia(argumentos);
         return EXIT_FAILURE;
     }
-
-    /* Impresión de la secuencia generada */
-    for (int i = 0; i < cantidad; ++i) {
-        if (i > 0) {
-            printf(" ");
-        }
-        printf("%llu", (unsigned long long)secuencia[i]);
+    if (argumentos->error == ERROR_CAPACIDAD) {
+        fprintf(stderr, "Error: un nivel se llenó sin desbordar.\n");
+        liberar_secuencia(argumentos);
+        return EXIT_FAILURE;
+    }
+    if (argumentos->error) {
+        fprintf(stderr, "Error: memoria insuficiente para la secuencia.\n");
+        liberar_secuencia(argumentos);
+        return EXIT_FAILURE;
     }
-    printf("\n");
 
-    free(argumentos);
-    free(secuencia);
+    /* Impresión de la secuencia generada */
+    marca  = traza_ahora();
+    codigo = imprimir_secuencia(argumentos);
+    traza_completo("imprimir", marca, "terminos", cantidad);
+    liberar_secuencia(argumentos);
 
-    return EXIT_SUCCESS;
+    return (codigo == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 /*
@@ -140,7 +383,705 @@ int main(int argc, char **argv)
 static void mostrar_uso(const char *nombre_programa)
 {
     fprintf(stderr, "Uso: %s N\n", nombre_programa);
+    fprintf(stderr, "     %s --termino K [--hilos T]\n", nombre_programa);
+    fprintf(stderr, "     %s --sucesion NOMBRE N [opciones]\n",
+            nombre_programa);
+    fprintf(stderr, "     %s --recurrencia C1,...,Ck S0,...,S(k-1) N [opciones]\n",
+            nombre_programa);
     fprintf(stderr, "  N: número de términos de Fibonacci (N >= 0).\n");
+    fprintf(stderr, "  K: índice del término F(K) a imprimir (K >= 0).\n");
+    fprintf(stderr, "  T: hilos para la conversión a decimal y la NTT.\n");
+    fprintf(stderr, "     %s --lote [ARCHIVO] [--hilos T] [--modulo M]\n",
+            nombre_programa);
+    fprintf(stderr, "     %s --flujo N [--modulo M]\n", nombre_programa);
+    fprintf(stderr, "     %s --dispersa N K\n", nombre_programa);
+    fprintf(stderr, "     %s --archivo N RUTA [--hilos T]\n", nombre_programa);
+    fprintf(stderr, "     %s --verificar [ARCHIVO] [--hilos T] [--muestras S] [--ventana W]\n"
+                    "                 [--primos P] [--desde I] [--modulo M] [--semilla N]\n",
+            nombre_programa);
+    fprintf(stderr, "  NOMBRE: %s.\n", rec_nombres_predefinidos());
+    fprintf(stderr, "  opciones: --desde I, --modulo M, --hilos T, --rss,\n"
+                    "            --paginas normales|enormes|hugetlb,\n"
+                    "            --numa local|intercalada, --prefallar.\n");
+}
+
+/*
+ * imprimir_termino
+ * -----------------------------------------
+ * Calcula F(indice) por duplicación rápida y lo imprime completo.
+ *
+ * Para términos con millones de dígitos la conversión a decimal
+ * domina el tiempo total; se usa la conversión divide y vencerás
+ * de entero_grande.c, repartida entre 'hilos' hilos. Los mismos
+ * hilos se ofrecen a las multiplicaciones por NTT de la duplicación.
+ *
+ * Retorna 0 si tuvo éxito, -1 en caso de error.
+ */
+static int imprimir_termino(uint64_t indice, int hilos)
+{
+    EnteroGrande termino, siguiente;
+    eg_iniciar(&termino);
+    eg_iniciar(&siguiente);
+    eg_configurar_hilos(hilos);
+
+    if (eg_fibonacci(indice, &termino, &siguiente) != 0) {
+        fprintf(stderr, "Error: memoria insuficiente para F(%llu).\n",
+                (unsigned long long)indice);
+        eg_liberar(&termino);
+        eg_liberar(&siguiente);
+        return -1;
+    }
+    eg_liberar(&siguiente);
+
+    char *texto = (char *)malloc(eg_digitos_maximos(&termino) + 1);
+    if (texto == NULL) {
+        perror("Error en malloc para la conversión decimal");
+        eg_liberar(&termino);
+        return -1;
+    }
+
+    size_t digitos = eg_a_decimal_hilos(&termino, texto, hilos);
+    eg_liberar(&termino);
+    if (digitos == 0) {
+        fprintf(stderr, "Error: memoria insuficiente en la conversión.\n");
+        free(texto);
+        return -1;
+    }
+
+    texto[digitos] = '\n';
+    fwrite(texto, 1, digitos + 1, stdout);
+
+    free(texto);
+    return 0;
+}
+
+/*
+ * modo_recurrencia
+ * -----------------------------------------
+ * Genera N términos a partir de a(I) con el motor de recurrencia.h
+ * y los imprime como la secuencia de Fibonacci. Con --hilos T, cada
+ * hilo salta directamente al inicio de su bloque (Kitamasa) y lo
+ * rellena por su cuenta.
+ */
+static int modo_recurrencia(int argc, char **argv)
+{
+    int predefinida = (strcmp(argv[1], "--sucesion") == 0);
+    int posicional  = predefinida ? 4 : 5;
+
+    if (argc < posicional) {
+        mostrar_uso(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint64_t cantidad = 0, inicio = 0, modulo = 0;
+    int hilos = 1;
+    int mostrar_rss = 0;
+    int prefallar = 0;
+    TipoPaginas  tipo_paginas = PAGINAS_NORMALES;
+    PoliticaNuma numa         = NUMA_PRIMER_TOQUE;
+
+    if (leer_indice(argv[posicional - 1], &cantidad) != 0) {
+        fprintf(stderr, "Error: N debe ser un entero mayor o igual a 0.\n");
+        return EXIT_FAILURE;
+    }
+
+    for (int i = posicional; i < argc; ++i) {
+        if (strcmp(argv[i], "--rss") == 0) {
+            mostrar_rss = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--prefallar") == 0) {
+            prefallar = 1;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            mostrar_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (strcmp(argv[i], "--desde") == 0) {
+            if (leer_indice(argv[++i], &inicio) != 0) {
+                fprintf(stderr, "Error: I debe ser un entero mayor o igual a 0.\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--modulo") == 0) {
+            if (leer_indice(argv[++i], &modulo) != 0 || modulo < 2) {
+                fprintf(stderr, "Error: M debe ser un entero mayor o igual a 2.\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--hilos") == 0) {
+            hilos = atoi(argv[++i]);
+            if (hilos <= 0) {
+                fprintf(stderr,
+                        "Advertencia: número de hilos inválido (%d). Se usará 1 hilo.\n",
+                        hilos);
+                hilos = 1;
+            }
+        } else if (strcmp(argv[i], "--paginas") == 0) {
+            if (pg_leer_tipo(argv[++i], &tipo_paginas) != 0) {
+                fprintf(stderr,
+                        "Error: tipo de páginas desconocido '%s' "
+                        "(opciones: normales enormes hugetlb).\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--numa") == 0) {
+            ++i;
+            if (strcmp(argv[i], "local") == 0) {
+                numa = NUMA_PRIMER_TOQUE;
+            } else if (strcmp(argv[i], "intercalada") == 0) {
+                numa = NUMA_INTERCALADA;
+            } else {
+                fprintf(stderr,
+                        "Error: política NUMA desconocida '%s' "
+                        "(opciones: local intercalada).\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else {
+            mostrar_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Recurrencia recurrencia;
+    if (predefinida) {
+        if (rec_predefinida(&recurrencia, argv[2], modulo) != 0) {
+            fprintf(stderr, "Error: sucesión desconocida '%s' (opciones: %s).\n",
+                    argv[2], rec_nombres_predefinidos());
+            return EXIT_FAILURE;
+        }
+    } else if (rec_definir(&recurrencia, argv[2], argv[3], modulo) != 0) {
+        fprintf(stderr,
+                "Error: se esperaban entre 1 y %d coeficientes y el mismo "
+                "número de semillas, separados por comas.\n",
+                RECURRENCIA_ORDEN_MAX);
+        return EXIT_FAILURE;
+    }
+
+    if (cantidad == 0) {
+        return EXIT_SUCCESS;
+    }
+
+    ReservaPaginas reserva;
+    long fallos[3][2];
+    pg_fallos(&fallos[0][0], &fallos[0][1]);
+    if (pg_reservar(&reserva, sizeof(uint64_t) * (size_t)cantidad,
+                    tipo_paginas, numa) != 0) {
+        perror("Error en mmap para secuencia");
+        return EXIT_FAILURE;
+    }
+    uint64_t *secuencia = (uint64_t *)reserva.datos;
+
+    if (prefallar) {
+        pg_prefallar(&reserva, (size_t)cantidad, sizeof(uint64_t), hilos);
+    }
+    pg_fallos(&fallos[1][0], &fallos[1][1]);
+
+    if (rec_llenar_paralelo(&recurrencia, inicio, secuencia, (size_t)cantidad,
+                            hilos) != 0) {
+        fprintf(stderr, "Error: no se pudieron preparar los hilos.\n");
+        pg_liberar(&reserva);
+        return EXIT_FAILURE;
+    }
+    pg_fallos(&fallos[2][0], &fallos[2][1]);
+
+    Salida salida;
+    if (salida_abrir(&salida, STDOUT_FILENO, SALIDA_TAM_BUFER) != 0) {
+        perror("Error en malloc para el búfer de salida");
+        pg_liberar(&reserva);
+        return EXIT_FAILURE;
+    }
+    int codigo = escribir_valores(&salida, secuencia, (size_t)cantidad, 0);
+    if (codigo == 0) {
+        codigo = salida_escribir(&salida, "\n", 1);
+    }
+    if (salida_cerrar(&salida) != 0 || codigo != 0) {
+        perror("Error al escribir la secuencia");
+        codigo = -1;
+    }
+
+    pg_liberar(&reserva);
+    if (mostrar_rss) {
+        fprintf(stderr,
+                "Páginas: %s, NUMA: %s\n"
+                "Fallos de página al prefallar: %ld menores, %ld mayores\n"
+                "Fallos de página al llenar: %ld menores, %ld mayores\n",
+                pg_nombre_tipo(reserva.tipo),
+                (reserva.nodos > 1) ? "intercalada" : "local",
+                fallos[1][0] - fallos[0][0], fallos[1][1] - fallos[0][1],
+                fallos[2][0] - fallos[1][0], fallos[2][1] - fallos[1][1]);
+        reportar_memoria_pico();
+    }
+    return (codigo == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * modo_flujo
+ * -----------------------------------------
+ * Imprime F(0)..F(N-1) mod M sin guardar la secuencia. El hilo
+ * trabajador mantiene solo los dos últimos términos y llena bloques
+ * de TERMINOS_POR_BLOQUE; el hilo principal los formatea y escribe
+ * mientras el trabajador llena el siguiente. La memoria usada no
+ * depende de N.
+ */
+static int modo_flujo(int argc, char **argv)
+{
+    uint64_t cantidad = 0, modulo = 0;
+
+    if (argc < 3 || leer_indice(argv[2], &cantidad) != 0) {
+        fprintf(stderr, "Error: N debe ser un entero mayor o igual a 0.\n");
+        return EXIT_FAILURE;
+    }
+    if (argc >= 5 && strcmp(argv[3], "--modulo") == 0) {
+        if (leer_indice(argv[4], &modulo) != 0 || modulo < 2) {
+            fprintf(stderr, "Error: M debe ser un entero mayor o igual a 2.\n");
+            return EXIT_FAILURE;
+        }
+    } else if (argc != 3) {
+        mostrar_uso(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (cantidad == 0) {
+        reportar_memoria_pico();
+        return EXIT_SUCCESS;
+    }
+
+    ArgumentosFlujo *argumentos =
+        (ArgumentosFlujo *)calloc(1, sizeof(ArgumentosFlujo));
+    if (argumentos == NULL) {
+        perror("Error en malloc para ArgumentosFlujo");
+        return EXIT_FAILURE;
+    }
+    argumentos->cantidad = cantidad;
+    argumentos->modulo   = modulo;
+    pthread_mutex_init(&argumentos->mutex, NULL);
+    pthread_cond_init(&argumentos->hay_lleno, NULL);
+    pthread_cond_init(&argumentos->hay_vacio, NULL);
+
+    Salida salida;
+    if (salida_abrir(&salida, STDOUT_FILENO, SALIDA_TAM_BUFER) != 0) {
+        perror("Error en malloc para el búfer de salida");
+        free(argumentos);
+        return EXIT_FAILURE;
+    }
+
+    pthread_t hilo_trabajador;
+    uint64_t marca_hilo = traza_ahora();
+    int codigo = pthread_create(&hilo_trabajador, NULL, trabajador_flujo,
+                                (void *)argumentos);
+    traza_completo("crear", marca_hilo, "hilo", 0);
+    if (codigo != 0) {
+        fprintf(stderr, "Error al crear el hilo (código %d).\n", codigo);
+        salida_cerrar(&salida);
+        free(argumentos);
+        return EXIT_FAILURE;
+    }
+
+    /* Consumidor: recorre los bloques en el mismo orden circular */
+    uint64_t escritos = 0;
+    int fallo = 0;
+    for (size_t b = 0; escritos < cantidad; b = (b + 1) % NUM_BLOQUES_FLUJO) {
+        BloqueFlujo *bloque = &argumentos->bloques[b];
+
+        uint64_t marca = traza_ahora();
+        pthread_mutex_lock(&argumentos->mutex);
+        while (!bloque->lleno) {
+            pthread_cond_wait(&argumentos->hay_lleno, &argumentos->mutex);
+        }
+        pthread_mutex_unlock(&argumentos->mutex);
+        traza_completo("esperar_lleno", marca, "bloque", (int64_t)b);
+
+        marca = traza_ahora();
+        if (!fallo && escribir_valores(&salida, bloque->valores,
+                                       bloque->cantidad, escritos > 0) != 0) {
+            fallo = 1;
+        }
+        traza_completo("escribir", marca, "terminos", (int64_t)bloque->cantidad);
+        escritos += bloque->cantidad;
+
+        /* Devolver el bloque aunque haya fallado, para no bloquear al
+         * trabajador; los términos restantes se descartan. */
+        pthread_mutex_lock(&argumentos->mutex);
+        bloque->lleno = 0;
+        pthread_cond_signal(&argumentos->hay_vacio);
+        pthread_mutex_unlock(&argumentos->mutex);
+    }
+
+    marca_hilo = traza_ahora();
+    pthread_join(hilo_trabajador, NULL);
+    traza_completo("join", marca_hilo, "hilo", 0);
+
+    if (!fallo) {
+        salida_escribir(&salida, "\n", 1);
+    }
+    if (salida_cerrar(&salida) != 0 || fallo) {
+        perror("Error al escribir la secuencia");
+        codigo = -1;
+    }
+
+    pthread_cond_destroy(&argumentos->hay_lleno);
+    pthread_cond_destroy(&argumentos->hay_vacio);
+    pthread_mutex_destroy(&argumentos->mutex);
+    free(argumentos);
+
+    reportar_memoria_pico();
+    return (codigo == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * trabajador_flujo
+ * -----------------------------------------
+ * Productor del modo de flujo: la ventana (F(i), F(i+1)) vive en
+ * dos variables locales y cada bloque se llena en cuanto el escritor
+ * lo devuelve.
+ */
+static void *trabajador_flujo(void *argumento)
+{
+    ArgumentosFlujo *argumentos = (ArgumentosFlujo *)argumento;
+    const uint64_t m = argumentos->modulo;
+    uint64_t actual = 0, siguiente = 1;
+    uint64_t restantes = argumentos->cantidad;
+
+    SONDA1(fibonacci, hilo_inicio, restantes);
+    traza_nombrar_hilo("trabajador", 0);
+    for (size_t b = 0; restantes > 0; b = (b + 1) % NUM_BLOQUES_FLUJO) {
+        BloqueFlujo *bloque = &argumentos->bloques[b];
+
+        uint64_t marca = traza_ahora();
+        pthread_mutex_lock(&argumentos->mutex);
+        while (bloque->lleno) {
+            pthread_cond_wait(&argumentos->hay_vacio, &argumentos->mutex);
+        }
+        pthread_mutex_unlock(&argumentos->mutex);
+        traza_completo("esperar_vacio", marca, "bloque", (int64_t)b);
+
+        marca = traza_ahora();
+        size_t tam = (restantes < TERMINOS_POR_BLOQUE) ? (size_t)restantes
+                                                       : TERMINOS_POR_BLOQUE;
+        for (size_t i = 0; i < tam; ++i) {
+            bloque->valores[i] = actual;
+            uint64_t nuevo = actual + siguiente;
+            if (m != 0 && (nuevo < actual || nuevo >= m)) {
+                nuevo -= m;
+            }
+            actual    = siguiente;
+            siguiente = nuevo;
+        }
+        bloque->cantidad = tam;
+        restantes -= tam;
+        traza_completo("generar", marca, "terminos", (int64_t)tam);
+        SONDA2(fibonacci, bloque_fin, b, tam);
+
+        pthread_mutex_lock(&argumentos->mutex);
+        bloque->lleno = 1;
+        pthread_cond_signal(&argumentos->hay_lleno);
+        pthread_mutex_unlock(&argumentos->mutex);
+    }
+
+    SONDA1(fibonacci, hilo_fin, argumentos->cantidad);
+    pthread_exit(NULL);
+}
+
+/*
+ * modo_dispersa
+ * -----------------------------------------
+ * Imprime F(0)..F(N-1) completos desde una SecuenciaDispersa con
+ * paso K. Como el recorrido es en orden, la caché del hilo avanza
+ * su cursor con una suma por término y los puntos de control solo
+ * se usan al comenzar.
+ */
+static int modo_dispersa(int argc, char **argv)
+{
+    uint64_t cantidad = 0, paso = 0;
+
+    if (argc != 4 || leer_indice(argv[2], &cantidad) != 0 ||
+        leer_indice(argv[3], &paso) != 0 || paso == 0) {
+        fprintf(stderr, "Error: se requiere N >= 0 y K >= 1.\n");
+        return EXIT_FAILURE;
+    }
+
+    SecuenciaDispersa secuencia;
+    if (sd_construir(&secuencia, cantidad, paso) != 0) {
+        fprintf(stderr, "Error: memoria insuficiente para la secuencia.\n");
+        return EXIT_FAILURE;
+    }
+
+    Salida salida;
+    if (salida_abrir(&salida, STDOUT_FILENO, SALIDA_TAM_BUFER) != 0) {
+        perror("Error en malloc para el búfer de salida");
+        sd_liberar(&secuencia);
+        return EXIT_FAILURE;
+    }
+
+    EnteroGrande termino;
+    eg_iniciar(&termino);
+    int codigo = 0;
+    for (uint64_t i = 0; i < cantidad && codigo == 0; ++i) {
+        if (sd_obtener(&secuencia, i, &termino) != 0) {
+            fprintf(stderr, "Error: memoria insuficiente para F(%llu).\n",
+                    (unsigned long long)i);
+            codigo = -1;
+            break;
+        }
+
+        size_t maximo = eg_digitos_maximos(&termino) + 1;
+        char *p = (maximo <= salida.capacidad)
+                      ? salida_reservar(&salida, maximo) : NULL;
+        char *texto = (p != NULL) ? p : (char *)malloc(maximo);
+        if (texto == NULL || salida.error) {
+            codigo = -1;
+            break;
+        }
+
+        /* Un término mayor que el búfer se convierte aparte */
+        size_t n = (i > 0) ? 1 : 0;
+        texto[0] = ' ';
+        size_t digitos = eg_a_decimal(&termino, texto + n);
+        if (digitos == 0) {
+            codigo = -1;
+        } else if (p != NULL) {
+            salida_confirmar(&salida, n + digitos);
+        } else {
+            codigo = salida_escribir(&salida, texto, n + digitos);
+        }
+        if (p == NULL) {
+            free(texto);
+        }
+    }
+
+    if (codigo == 0 && cantidad > 0) {
+        codigo = salida_escribir(&salida, "\n", 1);
+    }
+    if (salida_cerrar(&salida) != 0 && codigo == 0) {
+        perror("Error al escribir la secuencia");
+        codigo = -1;
+    }
+    eg_liberar(&termino);
+
+    fprintf(stderr, "Puntos de control: %zu (%zu KiB)\n",
+            secuencia.num_puntos, sd_bytes(&secuencia) / 1024);
+    sd_liberar(&secuencia);
+    reportar_memoria_pico();
+    return (codigo == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * modo_archivo
+ * -----------------------------------------
+ * Escribe F(0)..F(N-1) en RUTA con mapeo_fibonacci: el hilo
+ * principal solo calcula los desplazamientos y T hilos formatean
+ * tramos disjuntos del archivo a la vez.
+ */
+static int modo_archivo(int argc, char **argv)
+{
+    uint64_t cantidad = 0;
+    int      hilos    = 1;
+
+    if (argc < 4 || leer_indice(argv[2], &cantidad) != 0) {
+        fprintf(stderr, "Error: N debe ser un entero mayor o igual a 0.\n");
+        return EXIT_FAILURE;
+    }
+    if (argc == 6 && strcmp(argv[4], "--hilos") == 0) {
+        hilos = atoi(argv[5]);
+    } else if (argc != 4) {
+        mostrar_uso(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (hilos <= 0) {
+        fprintf(stderr,
+                "Advertencia: número de hilos inválido (%d). Se usará 1 hilo.\n",
+                hilos);
+        hilos = 1;
+    }
+
+    return (mapeo_fibonacci(argv[3], cantidad, hilos) == 0) ? EXIT_SUCCESS
+                                                            : EXIT_FAILURE;
+}
+
+/*
+ * modo_verificar
+ * -----------------------------------------
+ * --verificar [ARCHIVO] [opciones]: imprime el veredicto y retorna
+ * EXIT_FAILURE si la sucesión no es correcta.
+ */
+static int modo_verificar(int argc, char **argv)
+{
+    OpcionesVerificacion opciones;
+    const char *ruta = NULL;
+    int i = 2;
+
+    vf_opciones_por_defecto(&opciones);
+    if (i < argc && (argv[i][0] != '-' || strcmp(argv[i], "-") == 0)) {
+        ruta = argv[i++];
+    }
+
+    for (; i < argc; i += 2) {
+        uint64_t valor = 0;
+        if (i + 1 >= argc || leer_indice(argv[i + 1], &valor) != 0) {
+            mostrar_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (strcmp(argv[i], "--hilos") == 0 && valor >= 1) {
+            opciones.hilos = (int)valor;
+        } else if (strcmp(argv[i], "--muestras") == 0) {
+            opciones.muestras = (int)valor;
+        } else if (strcmp(argv[i], "--ventana") == 0 && valor >= 3) {
+            opciones.ventana = (int)valor;
+        } else if (strcmp(argv[i], "--primos") == 0 && valor >= 1 &&
+                   valor <= VF_MAX_PRIMOS) {
+            opciones.primos = (int)valor;
+        } else if (strcmp(argv[i], "--desde") == 0) {
+            opciones.desde = valor;
+        } else if (strcmp(argv[i], "--modulo") == 0 && valor != 1) {
+            opciones.reducido = 1;
+            opciones.modulo   = valor;
+        } else if (strcmp(argv[i], "--semilla") == 0) {
+            opciones.semilla = valor;
+        } else {
+            mostrar_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    ResultadoVerificacion resultado;
+    if (vf_verificar_archivo(ruta, &opciones, &resultado) != 0) {
+        fprintf(stderr, "Error: no se pudo verificar la sucesión.\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!resultado.correcta) {
+        printf("Sucesión incorrecta: F(%llu) %s (semilla %llu).\n",
+               (unsigned long long)resultado.indice_error, resultado.motivo,
+               (unsigned long long)opciones.semilla);
+        return EXIT_FAILURE;
+    }
+    printf("Sucesión correcta: %llu términos; %d ventanas, %llu términos "
+           "comprobados (semilla %llu).\n",
+           (unsigned long long)resultado.terminos, resultado.ventanas,
+           (unsigned long long)resultado.verificados,
+           (unsigned long long)opciones.semilla);
+    return EXIT_SUCCESS;
+}
+
+/*
+ * escribir_valores
+ * -----------------------------------------
+ * Formatea 'cantidad' valores de 64 bits separados por espacios
+ * directamente en el búfer de 'salida', de a TERMINOS_POR_BLOQUE con
+ * fd_lote_u64 (SIMD si la CPU lo permite). Con 'previos' distinto
+ * de 0 se antepone un espacio, porque ya se escribieron términos.
+ *
+ * Retorna 0 si tuvo éxito, -1 si la escritura falló.
+ */
+static int escribir_valores(Salida *salida, const uint64_t *valores,
+                            size_t cantidad, int previos)
+{
+    for (size_t i = 0; i < cantidad; i += TERMINOS_POR_BLOQUE) {
+        size_t trozo = (cantidad - i < TERMINOS_POR_BLOQUE)
+                           ? cantidad - i : TERMINOS_POR_BLOQUE;
+        char *p = salida_reservar(salida,
+                                  trozo * (FD_MAX_DIGITOS_U64 + 1) + 1);
+        if (p == NULL) {
+            return -1;
+        }
+
+        size_t n = 0;
+        if (previos || i > 0) {
+            p[n++] = ' ';
+        }
+        n += fd_lote_u64(valores + i, trozo, ' ', p + n);
+        salida_confirmar(salida, n);
+    }
+    return 0;
+}
+
+/*
+ * reportar_memoria_pico
+ * -----------------------------------------
+ * Muestra por stderr el pico de memoria residente del proceso
+ * (ru_maxrss, en KiB en Linux).
+ */
+static void reportar_memoria_pico(void)
+{
+    struct rusage uso;
+
+    if (getrusage(RUSAGE_SELF, &uso) == 0) {
+        fprintf(stderr, "Memoria pico (RSS): %ld KiB\n", uso.ru_maxrss);
+    }
+}
+
+/*
+ * modo_lote
+ * -----------------------------------------
+ * Lee los índices de ARCHIVO (o de stdin si se omite o es "-") y
+ * responde todas las consultas con lote_fibonacci.
+ */
+static int modo_lote(int argc, char **argv)
+{
+    const char *ruta = NULL;
+    uint64_t modulo = 0;
+    int hilos = 1;
+    int i = 2;
+
+    if (i < argc && (argv[i][0] != '-' || strcmp(argv[i], "-") == 0)) {
+        ruta = argv[i++];
+    }
+
+    for (; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            mostrar_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (strcmp(argv[i], "--hilos") == 0) {
+            hilos = atoi(argv[i + 1]);
+            if (hilos <= 0) {
+                fprintf(stderr,
+                        "Advertencia: número de hilos inválido (%d). Se usará 1 hilo.\n",
+                        hilos);
+                hilos = 1;
+            }
+        } else if (strcmp(argv[i], "--modulo") == 0) {
+            if (leer_indice(argv[i + 1], &modulo) != 0 || modulo < 2) {
+                fprintf(stderr, "Error: M debe ser un entero mayor o igual a 2.\n");
+                return EXIT_FAILURE;
+            }
+        } else {
+            mostrar_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    FILE *entrada = stdin;
+    if (ruta != NULL && strcmp(ruta, "-") != 0) {
+        entrada = fopen(ruta, "r");
+        if (entrada == NULL) {
+            perror("Error al abrir el archivo de consultas");
+            return EXIT_FAILURE;
+        }
+    }
+
+    int codigo = lote_fibonacci(entrada, stdout, hilos, modulo);
+
+    if (entrada != stdin) {
+        fclose(entrada);
+    }
+    return (codigo == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * leer_indice
+ * -----------------------------------------
+ * Convierte un entero decimal sin signo completo. Retorna 0 si
+ * tuvo éxito, -1 si el texto no es un número válido.
+ */
+static int leer_indice(const char *texto, uint64_t *valor)
+{
+    char *fin = NULL;
+
+    if (texto[0] < '0' || texto[0] > '9') {
+        return -1;
+    }
+    errno = 0;
+    *valor = strtoull(texto, &fin, 10);
+    return (errno != 0 || *fin != '\0') ? -1 : 0;
 }
 
 /*
@@ -150,38 +1091,237 @@ static void mostrar_uso(const char *nombre_programa)
  *
  * Parámetro:
  *  - argumento: puntero a ArgumentosFibonacci con:
- *      - arreglo  : arreglo compartido donde se escribirá la secuencia.
+ *      - arreglo, arreglo_128: niveles de 64 y 128 bits, ya
+ *        reservados, y sus capacidades.
  *      - cantidad : número de términos a generar.
  *
  * Comportamiento:
  *  - Maneja casos pequeños (N = 1, N = 2).
  *  - Para N >= 3, calcula los términos de forma iterativa:
  *      F(i) = F(i - 1) + F(i - 2)
+ *    en 64 bits mientras la suma no desborde, luego en 128 bits y
+ *    finalmente con EnteroGrande. __builtin_add_overflow (o el
+ *    acarreo en 128 bits) decide el cambio de nivel: por la holgura
+ *    de las capacidades, la suma que desborda siempre se intenta.
+ *    El arreglo de EnteroGrande se reserva aquí, con el tamaño
+ *    exacto que resta.
  *  - No retorna datos mediante pthread_exit; la comunicación se
- *    realiza a través del arreglo compartido.
+ *    realiza a través de los arreglos compartidos y de fin_64,
+ *    fin_128 y error.
  */
 static void *trabajador_fibonacci(void *argumento)
 {
     ArgumentosFibonacci *argumentos = (ArgumentosFibonacci *)argumento;
     tipo_fibonacci *arreglo         = argumentos->arreglo;
     int cantidad                    = argumentos->cantidad;
+    uint64_t marca                  = traza_ahora();
+
+    SONDA1(fibonacci, hilo_inicio, cantidad);
+    traza_nombrar_hilo("trabajador", 0);
+    argumentos->fin_64  = 0;
+    argumentos->fin_128 = 0;
+    argumentos->error   = 0;
 
     if (cantidad <= 0) {
+        traza_completo("generar", marca, "terminos", 0);
+        SONDA1(fibonacci, hilo_fin, 0);
         pthread_exit(NULL);
     }
 
     /* Casos base */
-    if (cantidad >= 1) {
-        arreglo[0] = 0ULL;
+    const int capacidad_64 = argumentos->capacidad_64;
+    int i = 0;
+    for (; i < capacidad_64 && i < 2; ++i) {
+        arreglo[i] = (tipo_fibonacci)i;
+    }
+
+    /* Nivel de 64 bits: hasta que la suma desborde */
+    int desborde = 0;
+    for (; i < capacidad_64; ++i) {
+        if (__builtin_add_overflow(arreglo[i - 1], arreglo[i - 2], &arreglo[i])) {
+            desborde = 1;
+            break;
+        }
     }
-    if (cantidad >= 2) {
-        arreglo[1] = 1ULL;
+    if (!desborde && i < cantidad) {
+        argumentos->error = ERROR_CAPACIDAD;
+    }
+    argumentos->fin_64 = i;
+    SONDA2(fibonacci, nivel_fin, 64, i);
+    if (i >= cantidad || argumentos->error) {
+        argumentos->fin_128 = i;
+        traza_completo("generar", marca, "terminos", i);
+        SONDA1(fibonacci, hilo_fin, i);
+        pthread_exit(NULL);
     }
 
-    /* Caso general: cálculo iterativo para i >= 2 */
-    for (int i = 2; i < cantidad; ++i) {
-        arreglo[i] = arreglo[i - 1] + arreglo[i - 2];
+    /* Nivel de 128 bits: los dos últimos términos viajan en registros */
+    tipo_fibonacci_128 anterior = arreglo[i - 2];
+    tipo_fibonacci_128 actual   = arreglo[i - 1];
+    tipo_fibonacci_128 *arreglo_128 = argumentos->arreglo_128;
+    const int inicio_128 = i;
+    const int limite_128 = inicio_128 + argumentos->capacidad_128;
+    desborde = 0;
+    for (; i < limite_128; ++i) {
+        tipo_fibonacci_128 siguiente = actual + anterior;
+        if (siguiente < actual) {
+            desborde = 1; /* desbordamiento de 128 bits */
+            break;
+        }
+        arreglo_128[i - inicio_128] = siguiente;
+        anterior = actual;
+        actual   = siguiente;
+    }
+    if (!desborde && i < cantidad) {
+        argumentos->error = ERROR_CAPACIDAD;
+    }
+    argumentos->fin_128 = i;
+    SONDA2(fibonacci, nivel_fin, 128, i);
+    if (i >= cantidad || argumentos->error) {
+        traza_completo("generar", marca, "terminos", i);
+        SONDA1(fibonacci, hilo_fin, i);
+        pthread_exit(NULL);
+    }
+
+    /* Nivel de precisión arbitraria: ya se sabe cuántos términos faltan */
+    EnteroGrande *grandes =
+        (EnteroGrande *)calloc((size_t)(cantidad - i), sizeof(EnteroGrande));
+    if (grandes == NULL) {
+        argumentos->error = ERROR_MEMORIA;
+        traza_completo("generar", marca, "terminos", i);
+        SONDA1(fibonacci, hilo_fin, i);
+        pthread_exit(NULL);
+    }
+    argumentos->arreglo_grande = grandes;
+    EnteroGrande previo_2, previo_1;
+    eg_iniciar(&previo_2);
+    eg_iniciar(&previo_1);
+
+    if (eg_asignar_u128(&previo_2, anterior) != 0 ||
+        eg_asignar_u128(&previo_1, actual) != 0) {
+        argumentos->error = ERROR_MEMORIA;
     }
 
+    const int inicio_grande = i;
+    for (; i < cantidad && !argumentos->error; ++i) {
+        const EnteroGrande *a = (i - 1 >= inicio_grande)
+                                ? &grandes[i - 1 - inicio_grande] : &previo_1;
+        const EnteroGrande *b = (i - 2 >= inicio_grande)
+                                ? &grandes[i - 2 - inicio_grande]
+                                : (i - 1 >= inicio_grande ? &previo_1 : &previo_2);
+        if (eg_sumar(&grandes[i - inicio_grande], a, b) != 0) {
+            argumentos->error = ERROR_MEMORIA;
+        }
+    }
+
+    eg_liberar(&previo_2);
+    eg_liberar(&previo_1);
+    SONDA2(fibonacci, nivel_fin, 0, i);
+    traza_completo("generar", marca, "terminos", i);
+    SONDA1(fibonacci, hilo_fin, i);
     pthread_exit(NULL);
 }
+
+/*
+ * imprimir_secuencia
+ * -----------------------------------------
+ * Imprime los N términos separados por espacios a través de un
+ * búfer de salida.h, como --flujo, pero siempre con write(2), como
+ * lo hacía stdio: el programa base no cambia de mecanismo según el
+ * destino ni con SALIDA_MODO. El nivel de 64 bits usa el mismo
+ * formateador por lotes (escribir_valores, con fd_lote_u64); el de
+ * 128 bits se formatea con fd_u128 de a TERMINOS_POR_BLOQUE términos
+ * directamente en el búfer, y los grandes con la conversión de
+ * entero_grande.h, también en el búfer salvo que no quepan.
+ *
+ * Retorna 0 si tuvo éxito, -1 en caso de error.
+ */
+static int imprimir_secuencia(const ArgumentosFibonacci *argumentos)
+{
+    const int cantidad = argumentos->cantidad;
+    const int fin_64   = argumentos->fin_64;
+    const int fin_128  = argumentos->fin_128;
+
+    Salida salida;
+    if (salida_abrir_con(&salida, STDOUT_FILENO, SALIDA_TAM_BUFER,
+                         SALIDA_WRITE) != 0) {
+        perror("Error en malloc para el búfer de salida");
+        return -1;
+    }
+
+    int codigo = escribir_valores(&salida, argumentos->arreglo,
+                                  (size_t)fin_64, 0);
+
+    for (int i = fin_64; i < fin_128 && codigo == 0; i += TERMINOS_POR_BLOQUE) {
+        int trozo = (fin_128 - i < TERMINOS_POR_BLOQUE)
+                        ? fin_128 - i : TERMINOS_POR_BLOQUE;
+        char *p = salida_reservar(&salida,
+                                  (size_t)trozo * (FD_MAX_DIGITOS_U128 + 1));
+        if (p == NULL) {
+            codigo = -1;
+            break;
+        }
+        size_t n = 0;
+        for (int k = i; k < i + trozo; ++k) {
+            p[n++] = ' ';
+            n += fd_u128(argumentos->arreglo_128[k - fin_64], p + n);
+        }
+        salida_confirmar(&salida, n);
+    }
+
+    const EnteroGrande *grandes = argumentos->arreglo_grande;
+    for (int i = fin_128; i < cantidad && codigo == 0; ++i) {
+        size_t maximo = eg_digitos_maximos(&grandes[i - fin_128]) + 1;
+        char *p = (maximo <= salida.capacidad)
+                      ? salida_reservar(&salida, maximo) : NULL;
+        char *texto = (p != NULL) ? p : (char *)malloc(maximo);
+        if (texto == NULL || salida.error) {
+            codigo = -1;
+            break;
+        }
+
+        /* Un término mayor que el búfer se convierte aparte */
+        texto[0] = ' ';
+        size_t digitos = eg_a_decimal(&grandes[i - fin_128], texto + 1);
+        if (digitos == 0) {
+            fprintf(stderr, "Error: memoria insuficiente en la conversión.\n");
+            codigo = -1;
+        } else if (p != NULL) {
+            salida_confirmar(&salida, 1 + digitos);
+        } else {
+            codigo = salida_escribir(&salida, texto, 1 + digitos);
+        }
+        if (p == NULL) {
+            free(texto);
+        }
+    }
+
+    if (codigo == 0) {
+        codigo = salida_escribir(&salida, "\n", 1);
+    }
+    if (salida_cerrar(&salida) != 0 && codigo == 0) {
+        perror("Error al escribir la secuencia");
+        codigo = -1;
+    }
+    return codigo;
+}
+
+/*
+ * liberar_secuencia
+ * -----------------------------------------
+ * Libera los niveles de la secuencia y la estructura de argumentos.
+ */
+static void liberar_secuencia(ArgumentosFibonacci *argumentos)
+{
+    int en_grande = argumentos->cantidad - argumentos->fin_128;
+
+    if (argumentos->arreglo_grande != NULL) {
+        for (int i = 0; i < en_grande; ++i) {
+            eg_liberar(&argumentos->arreglo_grande[i]);
+        }
+    }
+    free(argumentos->arreglo_grande);
+    free(argumentos->arreglo_128);
+    free(argumentos->arreglo);
+    free(argumentos);
+}
@@ -0,0 +1,406 @@
+/*
+ * formato_decimal.c
+ * -----------------------------------------
+ * Implementación de los formateadores declarados en
+ * formato_decimal.h.
+ */
+
+#include "formato_decimal.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FD_SIMD_X86 1
+#else
+#define FD_SIMD_X86 0
+#endif
+
+/* 10^19: mayor potencia de 10 que cabe en 64 bits */
+#define BASE_DECIMAL       10000000000000000000ULL
+#define DIGITOS_POR_BLOQUE 19
+
+/* Trozos de los formateadores SIMD */
+#define DIEZ_A_LA_8  100000000ULL
+#define DIEZ_A_LA_16 10000000000000000ULL
+
+static const uint64_t POTENCIAS_10[FD_MAX_DIGITOS_U64] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL
+};
+
+/* Implementación elegida para esta CPU (ver detectar_cpu) */
+static pthread_once_t        cpu_detectada = PTHREAD_ONCE_INIT;
+static ImplementacionFormato mejor_implementacion = FD_ESCALAR;
+static int                   tiene_sse2 = 0;
+static int                   tiene_avx2 = 0;
+
+static const char PARES_DIGITOS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/* Prototipos de funciones internas */
+static void   detectar_cpu(void);
+static size_t contar_digitos(uint64_t valor);
+static size_t colocar(uint64_t valor, const char *bajos, char *destino);
+static size_t lote_escalar(const uint64_t *valores, size_t cantidad,
+                           char separador, char *destino);
+#if FD_SIMD_X86
+static size_t lote_sse2(const uint64_t *valores, size_t cantidad,
+                        char separador, char *destino);
+static size_t lote_avx2(const uint64_t *valores, size_t cantidad,
+                        char separador, char *destino);
+#endif
+
+/*
+ * fd_u64
+ * -----------------------------------------
+ * Genera los dígitos de derecha a izquierda en un búfer local y
+ * los copia al destino.
+ */
+size_t fd_u64(uint64_t valor, char *destino)
+{
+    char  temporal[FD_MAX_DIGITOS_U64];
+    char *p = temporal + FD_MAX_DIGITOS_U64;
+
+    while (valor >= 100) {
+        unsigned par = (unsigned)(valor % 100);
+        valor /= 100;
+        p -= 2;
+        memcpy(p, PARES_DIGITOS + 2 * par, 2);
+    }
+    if (valor >= 10) {
+        p -= 2;
+        memcpy(p, PARES_DIGITOS + 2 * valor, 2);
+    } else {
+        *--p = (char)('0' + valor);
+    }
+
+    size_t longitud = (size_t)(temporal + FD_MAX_DIGITOS_U64 - p);
+    memcpy(destino, p, longitud);
+    return longitud;
+}
+
+void fd_u64_ancho(uint64_t valor, size_t ancho, char *destino)
+{
+    char *p = destino + ancho;
+
+    while (p - destino >= 2) {
+        unsigned par = (unsigned)(valor % 100);
+        valor /= 100;
+        p -= 2;
+        memcpy(p, PARES_DIGITOS + 2 * par, 2);
+    }
+    if (p > destino) {
+        *--p = (char)('0' + valor % 10);
+    }
+}
+
+/*
+ * fd_u128
+ * -----------------------------------------
+ * valor = (alto * 10^19 + medio) * 10^19 + bajo, con alto <= 3.
+ * Solo se usan divisiones de 128 bits para separar los trozos.
+ */
+size_t fd_u128(unsigned __int128 valor, char *destino)
+{
+    if ((uint64_t)(valor >> 64) == 0) {
+        return fd_u64((uint64_t)valor, destino);
+    }
+
+    uint64_t bajo = (uint64_t)(valor % BASE_DECIMAL);
+    unsigned __int128 cociente = valor / BASE_DECIMAL;
+    size_t n;
+
+    if ((uint64_t)(cociente >> 64) == 0 && (uint64_t)cociente < BASE_DECIMAL) {
+        n = fd_u64((uint64_t)cociente, destino);
+    } else {
+        uint64_t medio = (uint64_t)(cociente % BASE_DECIMAL);
+        uint64_t alto  = (uint64_t)(cociente / BASE_DECIMAL);
+        n = fd_u64(alto, destino);
+        fd_u64_ancho(medio, DIGITOS_POR_BLOQUE, destino + n);
+        n += DIGITOS_POR_BLOQUE;
+    }
+
+    fd_u64_ancho(bajo, DIGITOS_POR_BLOQUE, destino + n);
+    return n + DIGITOS_POR_BLOQUE;
+}
+
+size_t fd_lote_u64(const uint64_t *valores, size_t cantidad, char separador,
+                   char *destino)
+{
+    return fd_lote_u64_con(valores, cantidad, separador, destino,
+                           FD_AUTOMATICA);
+}
+
+size_t fd_lote_u64_con(const uint64_t *valores, size_t cantidad,
+                       char separador, char *destino,
+                       ImplementacionFormato implementacion)
+{
+    if (!fd_implementacion_disponible(implementacion)) {
+        implementacion = FD_AUTOMATICA;
+    }
+    if (implementacion == FD_AUTOMATICA) {
+        implementacion = mejor_implementacion;
+    }
+
+    switch (implementacion) {
+#if FD_SIMD_X86
+    case FD_AVX2:
+        return lote_avx2(valores, cantidad, separador, destino);
+    case FD_SSE2:
+        return lote_sse2(valores, cantidad, separador, destino);
+#endif
+    default:
+        return lote_escalar(valores, cantidad, separador, destino);
+    }
+}
+
+int fd_implementacion_disponible(ImplementacionFormato implementacion)
+{
+    pthread_once(&cpu_detectada, detectar_cpu);
+
+    switch (implementacion) {
+    case FD_SSE2:
+        return tiene_sse2;
+    case FD_AVX2:
+        return tiene_avx2;
+    default:
+        return 1;
+    }
+}
+
+const char *fd_nombre_implementacion(ImplementacionFormato implementacion)
+{
+    if (implementacion == FD_AUTOMATICA) {
+        pthread_once(&cpu_detectada, detectar_cpu);
+        implementacion = mejor_implementacion;
+    }
+
+    switch (implementacion) {
+    case FD_SSE2:
+        return "sse2";
+    case FD_AVX2:
+        return "avx2";
+    default:
+        return "escalar";
+    }
+}
+
+static void detectar_cpu(void)
+{
+#if FD_SIMD_X86
+    __builtin_cpu_init();
+    tiene_sse2 = __builtin_cpu_supports("sse2");
+    tiene_avx2 = __builtin_cpu_supports("avx2");
+#endif
+    mejor_implementacion = tiene_avx2 ? FD_AVX2
+                         : tiene_sse2 ? FD_SSE2 : FD_ESCALAR;
+}
+
+/*
+ * contar_digitos
+ * -----------------------------------------
+ * log10 aproximado a partir de la posición del bit más alto
+ * (1233 / 4096 ~ log10(2)), corregido con una comparación.
+ */
+static size_t contar_digitos(uint64_t valor)
+{
+    if (valor == 0) {
+        return 1;
+    }
+    size_t t = (size_t)((64 - __builtin_clzll(valor)) * 1233) >> 12;
+    return t + (valor >= POTENCIAS_10[t]);
+}
+
+/*
+ * colocar
+ * -----------------------------------------
+ * Escribe 'valor' a partir de 'bajos', sus 16 dígitos inferiores
+ * con ceros a la izquierda: si valor >= 10^16 se antepone la parte
+ * alta (a lo sumo 4 dígitos); si no, se descartan los ceros.
+ */
+static size_t colocar(uint64_t valor, const char *bajos, char *destino)
+{
+    if (valor >= DIEZ_A_LA_16) {
+        size_t n = fd_u64(valor / DIEZ_A_LA_16, destino);
+        memcpy(destino + n, bajos, 16);
+        return n + 16;
+    }
+
+    size_t n = contar_digitos(valor);
+    memcpy(destino, bajos + 16 - n, n);
+    return n;
+}
+
+static size_t lote_escalar(const uint64_t *valores, size_t cantidad,
+                           char separador, char *destino)
+{
+    char *p = destino;
+
+    for (size_t i = 0; i < cantidad; ++i) {
+        if (i > 0) {
+            *p++ = separador;
+        }
+        p += fd_u64(valores[i], p);
+    }
+    return (size_t)(p - destino);
+}
+
+#if FD_SIMD_X86
+
+/*
+ * ocho_digitos_sse2
+ * -----------------------------------------
+ * valor < 10^8 -> sus 8 dígitos (0..9) en carriles de 16 bits.
+ *
+ *  1. abcd = valor / 10^4 con un producto de 32x32 bits y un
+ *     desplazamiento (0xd1b71759 ~ 2^45 / 10^4); efgh = resto.
+ *  2. Se replican abcd y efgh en cuatro carriles cada uno y
+ *     mulhi_epu16 los divide por 10^3, 10^2, 10^1 y 10^0 a la vez:
+ *     [a, ab, abc, abcd, e, ef, efg, efgh].
+ *  3. Restando a cada carril el anterior por 10 queda un dígito
+ *     por carril.
+ */
+__attribute__((target("sse2")))
+static __m128i ocho_digitos_sse2(uint32_t valor)
+{
+    const __m128i v    = _mm_cvtsi32_si128((int)valor);
+    const __m128i abcd = _mm_srli_epi64(
+        _mm_mul_epu32(v, _mm_set1_epi32((int)0xd1b71759)), 45);
+    const __m128i efgh = _mm_sub_epi32(
+        v, _mm_mul_epu32(abcd, _mm_set1_epi32(10000)));
+
+    /* [abcd*4, efgh*4] replicados: el factor 4 da precisión a mulhi */
+    const __m128i v1 = _mm_slli_epi64(_mm_unpacklo_epi16(abcd, efgh), 2);
+    const __m128i v2a = _mm_unpacklo_epi16(v1, v1);
+    const __m128i v2 = _mm_unpacklo_epi32(v2a, v2a);
+
+    const __m128i v3 = _mm_mulhi_epu16(
+        v2, _mm_setr_epi16(8389, 5243, 13108, (short)0x8000,
+                           8389, 5243, 13108, (short)0x8000));
+    const __m128i v4 = _mm_mulhi_epu16(
+        v3, _mm_setr_epi16(1 << 7, 1 << 11, 1 << 13, (short)0x8000,
+                           1 << 7, 1 << 11, 1 << 13, (short)0x8000));
+
+    const __m128i v5 = _mm_mullo_epi16(v4, _mm_set1_epi16(10));
+    return _mm_sub_epi16(v4, _mm_slli_epi64(v5, 16));
+}
+
+/* Un valor por iteración: dos trozos de 8 dígitos en 128 bits */
+__attribute__((target("sse2")))
+static size_t lote_sse2(const uint64_t *valores, size_t cantidad,
+                        char separador, char *destino)
+{
+    const __m128i ceros = _mm_set1_epi8('0');
+    char  bajos[16];
+    char *p = destino;
+
+    for (size_t i = 0; i < cantidad; ++i) {
+        uint64_t resto = valores[i] % DIEZ_A_LA_16;
+        __m128i  alto  = ocho_digitos_sse2((uint32_t)(resto / DIEZ_A_LA_8));
+        __m128i  bajo  = ocho_digitos_sse2((uint32_t)(resto % DIEZ_A_LA_8));
+        _mm_storeu_si128((__m128i *)bajos,
+                         _mm_add_epi8(_mm_packus_epi16(alto, bajo), ceros));
+
+        if (i > 0) {
+            *p++ = separador;
+        }
+        p += colocar(valores[i], bajos, p);
+    }
+    return (size_t)(p - destino);
+}
+
+/*
+ * ocho_digitos_avx2
+ * -----------------------------------------
+ * Lo mismo que ocho_digitos_sse2 para dos valores a la vez: las
+ * operaciones de AVX2 usadas actúan sobre cada mitad de 128 bits
+ * por separado, así que 'x' queda en la mitad baja e 'y' en la alta.
+ */
+__attribute__((target("avx2")))
+static __m256i ocho_digitos_avx2(uint32_t x, uint32_t y)
+{
+    const __m256i v    = _mm256_setr_epi32((int)x, 0, 0, 0, (int)y, 0, 0, 0);
+    const __m256i abcd = _mm256_srli_epi64(
+        _mm256_mul_epu32(v, _mm256_set1_epi32((int)0xd1b71759)), 45);
+    const __m256i efgh = _mm256_sub_epi32(
+        v, _mm256_mul_epu32(abcd, _mm256_set1_epi32(10000)));
+
+    const __m256i v1  = _mm256_slli_epi64(_mm256_unpacklo_epi16(abcd, efgh), 2);
+    const __m256i v2a = _mm256_unpacklo_epi16(v1, v1);
+    const __m256i v2  = _mm256_unpacklo_epi32(v2a, v2a);
+
+    const __m256i v3 = _mm256_mulhi_epu16(
+        v2, _mm256_setr_epi16(8389, 5243, 13108, (short)0x8000,
+                              8389, 5243, 13108, (short)0x8000,
+                              8389, 5243, 13108, (short)0x8000,
+                              8389, 5243, 13108, (short)0x8000));
+    const __m256i v4 = _mm256_mulhi_epu16(
+        v3, _mm256_setr_epi16(1 << 7, 1 << 11, 1 << 13, (short)0x8000,
+                              1 << 7, 1 << 11, 1 << 13, (short)0x8000,
+                              1 << 7, 1 << 11, 1 << 13, (short)0x8000,
+                              1 << 7, 1 << 11, 1 << 13, (short)0x8000));
+
+    const __m256i v5 = _mm256_mullo_epi16(v4, _mm256_set1_epi16(10));
+    return _mm256_sub_epi16(v4, _mm256_slli_epi64(v5, 16));
+}
+
+/*
+ * lote_avx2
+ * -----------------------------------------
+ * Dos valores por iteración. packus une, en cada mitad de 128 bits,
+ * los 8 dígitos altos y los 8 bajos del mismo valor, así que los 32
+ * bytes resultantes son los 16 dígitos inferiores de cada uno.
+ */
+__attribute__((target("avx2")))
+static size_t lote_avx2(const uint64_t *valores, size_t cantidad,
+                        char separador, char *destino)
+{
+    const __m256i ceros = _mm256_set1_epi8('0');
+    char  bajos[32];
+    char *p = destino;
+    size_t i = 0;
+
+    for (; i + 1 < cantidad; i += 2) {
+        uint64_t ra = valores[i] % DIEZ_A_LA_16;
+        uint64_t rb = valores[i + 1] % DIEZ_A_LA_16;
+        __m256i altos = ocho_digitos_avx2((uint32_t)(ra / DIEZ_A_LA_8),
+                                          (uint32_t)(rb / DIEZ_A_LA_8));
+        __m256i bajos_v = ocho_digitos_avx2((uint32_t)(ra % DIEZ_A_LA_8),
+                                            (uint32_t)(rb % DIEZ_A_LA_8));
+        _mm256_storeu_si256((__m256i *)bajos,
+                            _mm256_add_epi8(_mm256_packus_epi16(altos, bajos_v),
+                                            ceros));
+
+        if (i > 0) {
+            *p++ = separador;
+        }
+        p += colocar(valores[i], bajos, p);
+        *p++ = separador;
+        p += colocar(valores[i + 1], bajos + 16, p);
+    }
+
+    if (i < cantidad) {
+        if (i > 0) {
+            *p++ = separador;
+        }
+        p += lote_sse2(valores + i, 1, separador, p);
+    }
+    return (size_t)(p - destino);
+}
+
+#endif /* FD_SIMD_X86 */
@@ -0,0 +1,67 @@
+/*
+ * formato_decimal.h
+ * -----------------------------------------
+ * Conversión rápida de enteros de 64 y 128 bits a texto decimal,
+ * sin pasar por printf.
+ *
+ * Los dígitos se generan de dos en dos con una tabla de 200 bytes
+ * ("00" .. "99"), lo que reduce a la mitad las divisiones. Los
+ * valores de 128 bits se parten en trozos de 19 dígitos (10^19 es
+ * la mayor potencia de 10 que cabe en 64 bits) y cada trozo se
+ * formatea con la rutina de 64 bits.
+ *
+ * Para secuencias de valores de 64 bits, fd_lote_u64 formatea un
+ * arreglo completo de una vez con instrucciones SIMD (SSE2 o AVX2,
+ * según la CPU, detectada una sola vez en tiempo de ejecución):
+ * los 16 dígitos inferiores de cada valor se obtienen en paralelo
+ * con divisiones por multiplicación (mulhi) sobre carriles de 16
+ * bits, y solo los (a lo sumo 4) dígitos superiores se generan con
+ * la tabla de pares.
+ *
+ * Ninguna función agrega '\0'; todas retornan la cantidad de
+ * caracteres escritos.
+ */
+
+#ifndef FORMATO_DECIMAL_H
+#define FORMATO_DECIMAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FD_MAX_DIGITOS_U64  20
+#define FD_MAX_DIGITOS_U128 39
+
+/* Escribe 'valor' sin ceros a la izquierda */
+size_t fd_u64(uint64_t valor, char *destino);
+size_t fd_u128(unsigned __int128 valor, char *destino);
+
+/* Implementación de fd_lote_u64_con; AUTOMATICA = la mejor que
+ * soporte la CPU */
+typedef enum {
+    FD_AUTOMATICA,
+    FD_ESCALAR,     /* fd_u64 por valor (tabla de pares) */
+    FD_SSE2,
+    FD_AVX2
+} ImplementacionFormato;
+
+/*
+ * fd_lote_u64: escribe 'cantidad' valores separados por 'separador'
+ * (sin separador final). 'destino' debe tener espacio para
+ * cantidad * (FD_MAX_DIGITOS_U64 + 1) bytes.
+ * fd_lote_u64_con: ídem con una implementación forzada; si la CPU
+ * no la soporta se usa la automática.
+ * fd_nombre_implementacion: "escalar", "sse2" o "avx2".
+ */
+size_t fd_lote_u64(const uint64_t *valores, size_t cantidad, char separador,
+                   char *destino);
+size_t fd_lote_u64_con(const uint64_t *valores, size_t cantidad,
+                       char separador, char *destino,
+                       ImplementacionFormato implementacion);
+int         fd_implementacion_disponible(ImplementacionFormato implementacion);
+const char *fd_nombre_implementacion(ImplementacionFormato implementacion);
+
+/* Escribe exactamente 'ancho' dígitos (ancho <= 20), con ceros a la
+ * izquierda; 'valor' debe ser menor que 10^ancho */
+void fd_u64_ancho(uint64_t valor, size_t ancho, char *destino);
+
+#endif /* FORMATO_DECIMAL_H */
@@ -0,0 +1,201 @@
+/*
+ * frecuencia.c
+ * -----------------------------------------
+ * Implementación de la medición declarada en frecuencia.h.
+ */
+
+#define _GNU_SOURCE
+
+#include "frecuencia.h"
+
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "reloj.h"
+
+/* Registros específicos del modelo (x86) */
+#define MSR_MPERF 0xE7
+#define MSR_APERF 0xE8
+
+/* Prototipos de funciones internas */
+static int      abrir_ciclos(void);
+static int      leer_msr(int fd, uint32_t registro, uint64_t *valor);
+static uint64_t cpu_hilo_ns(void);
+static int      leer_linea(const char *ruta, char *texto, size_t tam);
+
+int fr_iniciar(MedidorFrecuencia *m)
+{
+    memset(m, 0, sizeof(*m));
+    m->fuente    = FR_NINGUNA;
+    m->fd_ciclos = abrir_ciclos();
+    m->fd_msr    = -1;
+
+    if (m->fd_ciclos >= 0) {
+        m->fuente = FR_PERF;
+    } else if (reloj_fuente() == RELOJ_TSC) {
+        char ruta[64];
+        m->cpu = sched_getcpu();
+        snprintf(ruta, sizeof(ruta), "/dev/cpu/%d/msr", m->cpu);
+        m->fd_msr = (m->cpu >= 0) ? open(ruta, O_RDONLY) : -1;
+        if (m->fd_msr >= 0 &&
+            leer_msr(m->fd_msr, MSR_APERF, &m->aperf) == 0 &&
+            leer_msr(m->fd_msr, MSR_MPERF, &m->mperf) == 0) {
+            m->fuente = FR_APERF_MPERF;
+        }
+    }
+
+    m->ns_cpu = cpu_hilo_ns();
+    if (m->fuente == FR_PERF) {
+        ioctl(m->fd_ciclos, PERF_EVENT_IOC_RESET, 0);
+        ioctl(m->fd_ciclos, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    return (m->fuente == FR_NINGUNA) ? -1 : 0;
+}
+
+/*
+ * fr_detener
+ * -----------------------------------------
+ * Con perf, si el contador se multiplexó con otros eventos, se
+ * escala por tiempo habilitado / tiempo contando. Con APERF/MPERF,
+ * los ciclos son la frecuencia nominal por la razón APERF/MPERF por
+ * el tiempo en CPU.
+ */
+void fr_detener(MedidorFrecuencia *m, LecturaFrecuencia *lectura)
+{
+    uint64_t ns_cpu = cpu_hilo_ns();
+
+    lectura->fuente    = m->fuente;
+    lectura->ciclos    = 0;
+    lectura->ns_en_cpu = ns_cpu - m->ns_cpu;
+
+    if (m->fuente == FR_PERF) {
+        uint64_t valores[3];   /* valor, habilitado, contando */
+        ioctl(m->fd_ciclos, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(m->fd_ciclos, valores, sizeof(valores)) ==
+                (ssize_t)sizeof(valores) && valores[2] > 0) {
+            lectura->ciclos = (uint64_t)((double)valores[0] *
+                                         (double)valores[1] / (double)valores[2]);
+        } else {
+            lectura->fuente = FR_NINGUNA;
+        }
+        close(m->fd_ciclos);
+    } else if (m->fuente == FR_APERF_MPERF) {
+        uint64_t aperf = 0, mperf = 0;
+        if (sched_getcpu() == m->cpu &&
+            leer_msr(m->fd_msr, MSR_APERF, &aperf) == 0 &&
+            leer_msr(m->fd_msr, MSR_MPERF, &mperf) == 0 &&
+            mperf > m->mperf) {
+            double razon = (double)(aperf - m->aperf) / (double)(mperf - m->mperf);
+            lectura->ciclos = (uint64_t)(razon * reloj_ghz() *
+                                         (double)lectura->ns_en_cpu);
+        } else {
+            lectura->fuente = FR_NINGUNA;   /* el hilo migró */
+        }
+    }
+    if (m->fd_msr >= 0) {
+        close(m->fd_msr);
+    }
+    m->fd_ciclos = -1;
+    m->fd_msr    = -1;
+}
+
+double fr_ghz(const LecturaFrecuencia *lectura)
+{
+    if (lectura->fuente == FR_NINGUNA || lectura->ns_en_cpu == 0) {
+        return 0.0;
+    }
+    return (double)lectura->ciclos / (double)lectura->ns_en_cpu;
+}
+
+const char *fr_nombre_fuente(FuenteFrecuencia fuente)
+{
+    switch (fuente) {
+    case FR_PERF:
+        return "perf";
+    case FR_APERF_MPERF:
+        return "aperf/mperf";
+    default:
+        return "no disponible";
+    }
+}
+
+int fr_politica(char *texto, size_t tam)
+{
+    char gobernador[64], controlador[64];
+
+    if (leer_linea("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor",
+                   gobernador, sizeof(gobernador)) != 0) {
+        snprintf(texto, tam, "no disponible");
+        return -1;
+    }
+    if (leer_linea("/sys/devices/system/cpu/cpu0/cpufreq/scaling_driver",
+                   controlador, sizeof(controlador)) == 0) {
+        snprintf(texto, tam, "%s (%s)", gobernador, controlador);
+    } else {
+        snprintf(texto, tam, "%s", gobernador);
+    }
+    return 0;
+}
+
+/*
+ * abrir_ciclos
+ * -----------------------------------------
+ * Contador de ciclos del hilo que llama, en cualquier CPU, creado
+ * deshabilitado. Solo modo usuario, para que funcione con
+ * perf_event_paranoid = 2 (el valor por defecto).
+ */
+static int abrir_ciclos(void)
+{
+    struct perf_event_attr atributos;
+
+    memset(&atributos, 0, sizeof(atributos));
+    atributos.size           = sizeof(atributos);
+    atributos.type           = PERF_TYPE_HARDWARE;
+    atributos.config         = PERF_COUNT_HW_CPU_CYCLES;
+    atributos.disabled       = 1;
+    atributos.exclude_kernel = 1;
+    atributos.exclude_hv     = 1;
+    atributos.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &atributos, 0, -1, -1,
+                        PERF_FLAG_FD_CLOEXEC);
+}
+
+static int leer_msr(int fd, uint32_t registro, uint64_t *valor)
+{
+    return (pread(fd, valor, sizeof(*valor), registro) ==
+            (ssize_t)sizeof(*valor)) ? 0 : -1;
+}
+
+static uint64_t cpu_hilo_ns(void)
+{
+    struct timespec instante;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &instante);
+    return (uint64_t)instante.tv_sec * 1000000000ULL + (uint64_t)instante.tv_nsec;
+}
+
+/* Primera línea de un archivo, sin el salto final */
+static int leer_linea(const char *ruta, char *texto, size_t tam)
+{
+    FILE *archivo = fopen(ruta, "r");
+
+    if (archivo == NULL) {
+        return -1;
+    }
+    if (fgets(texto, (int)tam, archivo) == NULL) {
+        fclose(archivo);
+        return -1;
+    }
+    fclose(archivo);
+    texto[strcspn(texto, "\n")] = '\0';
+    return 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * frecuencia.h
+ * -----------------------------------------
+ * Frecuencia efectiva de un hilo mientras calcula, para separar la
+ * pérdida de speedup por bajada de frecuencia (turbo que se reparte
+ * entre más núcleos, límites térmicos o de potencia) de la pérdida
+ * por contención.
+ *
+ * El hilo que mide llama a fr_iniciar antes del tramo y a fr_detener
+ * al final. Fuentes, en orden de preferencia:
+ *  - perf_event_open: ciclos del núcleo (PERF_COUNT_HW_CPU_CYCLES)
+ *    del propio hilo, solo en modo usuario.
+ *  - APERF/MPERF por /dev/cpu/N/msr (módulo msr, requiere root): la
+ *    razón APERF/MPERF por la frecuencia nominal (la del TSC, así
+ *    que reloj_iniciar debe haberse llamado antes). Son contadores
+ *    de la CPU, no del hilo, así que la lectura solo vale si el hilo
+ *    no migró durante el tramo.
+ * La frecuencia es esos ciclos sobre el tiempo que el hilo estuvo en
+ * CPU (CLOCK_THREAD_CPUTIME_ID), no sobre el tiempo de pared: un
+ * hilo desalojado no parece más lento. Si no hay ninguna fuente de
+ * ciclos (p. ej. máquinas virtuales sin contadores de hardware) la
+ * frecuencia queda en 0, pero el tiempo en CPU se mide igual.
+ */
+
+#ifndef FRECUENCIA_H
+#define FRECUENCIA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    FR_NINGUNA = 0,
+    FR_PERF,
+    FR_APERF_MPERF
+} FuenteFrecuencia;
+
+/* Estado de una medición en curso; solo lo usa el hilo que la abrió */
+typedef struct {
+    FuenteFrecuencia fuente;
+    int      fd_ciclos;
+    int      fd_msr;
+    int      cpu;
+    uint64_t aperf;
+    uint64_t mperf;
+    uint64_t ns_cpu;       /* CLOCK_THREAD_CPUTIME_ID al iniciar */
+} MedidorFrecuencia;
+
+typedef struct {
+    FuenteFrecuencia fuente;
+    uint64_t ciclos;       /* ciclos efectivos del tramo (0 si n/d) */
+    uint64_t ns_en_cpu;    /* tiempo que el hilo estuvo en CPU */
+} LecturaFrecuencia;
+
+/* Retorna 0 si hay fuente de ciclos, -1 si solo se mide el tiempo
+ * en CPU */
+int  fr_iniciar(MedidorFrecuencia *m);
+void fr_detener(MedidorFrecuencia *m, LecturaFrecuencia *lectura);
+
+/* Frecuencia media del tramo en GHz, o 0 si no hay ciclos */
+double      fr_ghz(const LecturaFrecuencia *lectura);
+const char *fr_nombre_fuente(FuenteFrecuencia fuente);
+
+/*
+ * fr_politica: gobernador y controlador de escalado de la CPU 0
+ * (cpufreq), p. ej. "performance (intel_pstate)". Retorna -1 y deja
+ * "no disponible" si el sistema no expone cpufreq.
+ */
+int fr_politica(char *texto, size_t tam);
+
+#endif /* FRECUENCIA_H */
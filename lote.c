@@ -0,0 +1,548 @@
+/*
+ * lote.c
+ * -----------------------------------------
+ * Implementación de las consultas por lotes declaradas en lote.h.
+ *
+ * Reparto del trabajo:
+ *  - Modo disperso: los índices únicos ordenados se toman en grupos
+ *    de GRUPO_CONSULTAS desde el final (los más costosos primero)
+ *    mediante un contador protegido por mutex, para equilibrar la
+ *    carga entre hilos.
+ *  - Modo denso: el rango se parte en tramos de costo parecido. Sin
+ *    módulo, el costo de avanzar hasta k crece como k^2 (cada suma
+ *    es O(k)), por lo que los cortes se eligen en raíces cuadradas.
+ *
+ * Cada hilo convierte sus propios resultados a decimal; el hilo
+ * principal solo los escribe en el orden de entrada.
+ */
+
+#include "lote.h"
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "entero_grande.h"
+#include "recurrencia.h"
+
+/* Consultas únicas que toma un hilo de una vez en modo disperso */
+#define GRUPO_CONSULTAS 8
+
+/* Saltos de hasta esta distancia se recorren con sumas */
+#define MAX_PASOS_SUMA 64
+
+/* Denso: separación media entre índices consultados que justifica
+ * recorrer todo el rango en lugar de saltar a cada uno */
+#define SEPARACION_BARRIDO 32
+
+/*
+ * EstadoLote
+ * -----------------------------------------
+ * Datos compartidos por los hilos:
+ *  - indices   : índices únicos en orden creciente.
+ *  - textos    : F(indices[i]) en decimal, terminado en '\n'
+ *                (modo sin módulo).
+ *  - valores   : F(indices[i]) mod 'modulo' (modo con módulo).
+ *  - hilos_conversion: hilos para cada conversión a decimal (todos
+ *                si hay una sola consulta).
+ *  - pendientes: grupos aún no asignados (modo disperso).
+ */
+typedef struct {
+    const uint64_t *indices;
+    size_t          cantidad;
+    uint64_t        modulo;
+    Recurrencia     recurrencia;
+    char          **textos;
+    size_t         *longitudes;
+    uint64_t       *valores;
+    int             hilos_conversion;
+
+    pthread_mutex_t mutex;
+    size_t          pendientes;
+    int             error;
+} EstadoLote;
+
+/*
+ * TrabajoLote
+ * -----------------------------------------
+ * Argumentos de cada hilo. En modo denso, [desde, hasta) es su tramo
+ * de 'indices'; en modo disperso se ignora.
+ */
+typedef struct {
+    EstadoLote *estado;
+    size_t      desde;
+    size_t      hasta;
+} TrabajoLote;
+
+/*
+ * PilaPrefijos
+ * -----------------------------------------
+ * (fk[s], fk1[s]) = (F(base >> s), F((base >> s) + 1)) para
+ * s >= 1, donde 'base' es la última consulta resuelta por
+ * duplicación; el nivel 64 es (F(0), F(1)). (fk[0], fk1[0]) es el
+ * par de la última consulta respondida, k_actual.
+ */
+typedef struct {
+    EnteroGrande fk[65];
+    EnteroGrande fk1[65];
+    uint64_t     base;
+    int          valida;
+    uint64_t     k_actual;
+} PilaPrefijos;
+
+/* Prototipos de funciones internas */
+static int     leer_indices(FILE *entrada, uint64_t **indices, size_t *cantidad);
+static int     comparar_u64(const void *a, const void *b);
+static size_t  buscar(const uint64_t *indices, size_t cantidad, uint64_t k);
+static int     guardar_texto(EstadoLote *estado, size_t posicion,
+                             const EnteroGrande *valor);
+static int     resolver_disperso(EstadoLote *estado, PilaPrefijos *pila,
+                                 size_t posicion);
+static void   *hilo_disperso(void *argumento);
+static void   *hilo_denso(void *argumento);
+static void    marcar_error(EstadoLote *estado);
+
+int lote_fibonacci(FILE *entrada, FILE *salida, int hilos, uint64_t modulo)
+{
+    uint64_t *pedidos = NULL;
+    size_t    num_pedidos = 0;
+
+    if (leer_indices(entrada, &pedidos, &num_pedidos) != 0) {
+        return -1;
+    }
+    if (num_pedidos == 0) {
+        free(pedidos);
+        return 0;
+    }
+
+    /* Índices únicos ordenados */
+    uint64_t *indices = (uint64_t *)malloc(sizeof(uint64_t) * num_pedidos);
+    if (indices == NULL) {
+        perror("Error en malloc para los índices");
+        free(pedidos);
+        return -1;
+    }
+    memcpy(indices, pedidos, sizeof(uint64_t) * num_pedidos);
+    qsort(indices, num_pedidos, sizeof(uint64_t), comparar_u64);
+
+    size_t cantidad = 1;
+    for (size_t i = 1; i < num_pedidos; ++i) {
+        if (indices[i] != indices[cantidad - 1]) {
+            indices[cantidad++] = indices[i];
+        }
+    }
+
+    /* Sin módulo, F(k) se calcula completo: el índice tiene un tope */
+    if (modulo == 0 && indices[cantidad - 1] > LOTE_MAX_INDICE_EXACTO) {
+        fprintf(stderr,
+                "Error: el índice %llu supera el máximo sin módulo (%llu); "
+                "use --modulo M.\n",
+                (unsigned long long)indices[cantidad - 1],
+                (unsigned long long)LOTE_MAX_INDICE_EXACTO);
+        free(indices);
+        free(pedidos);
+        return -1;
+    }
+
+    EstadoLote estado;
+    memset(&estado, 0, sizeof(estado));
+    estado.indices  = indices;
+    estado.cantidad = cantidad;
+    estado.modulo   = modulo;
+    pthread_mutex_init(&estado.mutex, NULL);
+
+    if (modulo != 0) {
+        rec_predefinida(&estado.recurrencia, "fibonacci", modulo);
+        estado.valores = (uint64_t *)malloc(sizeof(uint64_t) * cantidad);
+    } else {
+        estado.textos     = (char **)calloc(cantidad, sizeof(char *));
+        estado.longitudes = (size_t *)calloc(cantidad, sizeof(size_t));
+    }
+    if ((modulo != 0 && estado.valores == NULL) ||
+        (modulo == 0 && (estado.textos == NULL || estado.longitudes == NULL))) {
+        perror("Error en malloc para los resultados");
+        estado.error = 1;
+    }
+
+    if ((size_t)hilos > cantidad) {
+        hilos = (int)cantidad;
+    }
+
+    /* Una sola consulta enorme: los hilos se aprovechan dentro de la
+     * multiplicación y de la conversión a decimal. */
+    estado.hilos_conversion = 1;
+    if (cantidad == 1 && modulo == 0) {
+        eg_configurar_hilos(hilos);
+        estado.hilos_conversion = hilos;
+    }
+
+    uint64_t extension = indices[cantidad - 1] - indices[0];
+    int denso = (extension / SEPARACION_BARRIDO <= cantidad);
+
+    pthread_t   *ids      = (pthread_t *)malloc(sizeof(pthread_t) * (size_t)hilos);
+    TrabajoLote *trabajos = (TrabajoLote *)malloc(sizeof(TrabajoLote) * (size_t)hilos);
+    int         *creado   = (int *)calloc((size_t)hilos, sizeof(int));
+    if (ids == NULL || trabajos == NULL || creado == NULL) {
+        perror("Error en malloc para los hilos");
+        estado.error = 1;
+    }
+
+    if (!estado.error) {
+        estado.pendientes = (cantidad + GRUPO_CONSULTAS - 1) / GRUPO_CONSULTAS;
+
+        /* Cortes de los tramos densos: costo ~ k^2 sin módulo, ~ k con él */
+        double k0 = (double)indices[0];
+        double k1 = (double)indices[cantidad - 1];
+        size_t corte = 0;
+
+        for (int t = 0; t < hilos; ++t) {
+            double fraccion = (double)(t + 1) / hilos;
+            uint64_t limite;
+            if (modulo == 0) {
+                limite = (uint64_t)sqrt(k0 * k0 + (k1 * k1 - k0 * k0) * fraccion);
+            } else {
+                limite = (uint64_t)(k0 + (k1 - k0) * fraccion);
+            }
+
+            trabajos[t].estado = &estado;
+            trabajos[t].desde  = corte;
+            corte = (t == hilos - 1) ? cantidad
+                                     : buscar(indices, cantidad, limite + 1);
+            if (corte < trabajos[t].desde) {
+                corte = trabajos[t].desde;
+            }
+            trabajos[t].hasta = corte;
+        }
+
+        void *(*rutina)(void *) = denso ? hilo_denso : hilo_disperso;
+        for (int t = 1; t < hilos; ++t) {
+            creado[t] = (pthread_create(&ids[t], NULL, rutina, &trabajos[t]) == 0);
+        }
+        rutina(&trabajos[0]);
+        for (int t = 1; t < hilos; ++t) {
+            if (creado[t]) {
+                pthread_join(ids[t], NULL);
+            } else {
+                rutina(&trabajos[t]);
+            }
+        }
+    }
+
+    /* Escritura en el orden de entrada */
+    int codigo = estado.error ? -1 : 0;
+    for (size_t i = 0; i < num_pedidos && codigo == 0; ++i) {
+        size_t posicion = buscar(indices, cantidad, pedidos[i]);
+        if (modulo != 0) {
+            fprintf(salida, "%llu\n", (unsigned long long)estado.valores[posicion]);
+        } else {
+            fwrite(estado.textos[posicion], 1, estado.longitudes[posicion], salida);
+        }
+    }
+    if (codigo == 0 && ferror(salida)) {
+        perror("Error al escribir los resultados");
+        codigo = -1;
+    }
+
+    if (estado.textos != NULL) {
+        for (size_t i = 0; i < cantidad; ++i) {
+            free(estado.textos[i]);
+        }
+    }
+    free(estado.textos);
+    free(estado.longitudes);
+    free(estado.valores);
+    free(ids);
+    free(trabajos);
+    free(creado);
+    free(indices);
+    free(pedidos);
+    pthread_mutex_destroy(&estado.mutex);
+    return codigo;
+}
+
+/*
+ * leer_indices
+ * -----------------------------------------
+ * Lee enteros sin signo separados por espacios en blanco hasta el
+ * final del flujo.
+ */
+static int leer_indices(FILE *entrada, uint64_t **indices, size_t *cantidad)
+{
+    size_t capacidad = 1024;
+    size_t n = 0;
+    uint64_t *valores = (uint64_t *)malloc(sizeof(uint64_t) * capacidad);
+    char palabra[32];
+
+    if (valores == NULL) {
+        perror("Error en malloc para los índices");
+        return -1;
+    }
+
+    while (fscanf(entrada, "%31s", palabra) == 1) {
+        char *fin = NULL;
+
+        errno = 0;
+        unsigned long long k = strtoull(palabra, &fin, 10);
+        if (palabra[0] < '0' || palabra[0] > '9' || errno != 0 || *fin != '\0') {
+            fprintf(stderr, "Error: índice inválido '%s' (consulta %zu).\n",
+                    palabra, n + 1);
+            free(valores);
+            return -1;
+        }
+
+        if (n == capacidad) {
+            capacidad *= 2;
+            uint64_t *nuevo = (uint64_t *)realloc(valores, sizeof(uint64_t) * capacidad);
+            if (nuevo == NULL) {
+                perror("Error en realloc para los índices");
+                free(valores);
+                return -1;
+            }
+            valores = nuevo;
+        }
+        valores[n++] = (uint64_t)k;
+    }
+
+    *indices  = valores;
+    *cantidad = n;
+    return 0;
+}
+
+static int comparar_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Primera posición i con indices[i] >= k */
+static size_t buscar(const uint64_t *indices, size_t cantidad, uint64_t k)
+{
+    size_t izquierda = 0, derecha = cantidad;
+
+    while (izquierda < derecha) {
+        size_t medio = izquierda + (derecha - izquierda) / 2;
+        if (indices[medio] < k) {
+            izquierda = medio + 1;
+        } else {
+            derecha = medio;
+        }
+    }
+    return izquierda;
+}
+
+/*
+ * guardar_texto
+ * -----------------------------------------
+ * Convierte 'valor' a decimal y lo guarda, con '\n' final, como
+ * resultado de la consulta única 'posicion'.
+ */
+static int guardar_texto(EstadoLote *estado, size_t posicion,
+                         const EnteroGrande *valor)
+{
+    char *texto = (char *)malloc(eg_digitos_maximos(valor) + 1);
+    if (texto == NULL) {
+        return -1;
+    }
+
+    size_t digitos = eg_a_decimal_hilos(valor, texto, estado->hilos_conversion);
+    if (digitos == 0) {
+        free(texto);
+        return -1;
+    }
+    texto[digitos] = '\n';
+
+    estado->textos[posicion]     = texto;
+    estado->longitudes[posicion] = digitos + 1;
+    return 0;
+}
+
+/*
+ * resolver_disperso
+ * -----------------------------------------
+ * Deja F(k) en pila->fk[0], con k = indices[posicion]:
+ *  - Si k está a lo sumo MAX_PASOS_SUMA por delante de la consulta
+ *    anterior, avanza con sumas.
+ *  - Si no, retoma la duplicación desde el prefijo binario más largo
+ *    que k comparte con 'base' y guarda los niveles intermedios.
+ */
+static int resolver_disperso(EstadoLote *estado, PilaPrefijos *pila,
+                             size_t posicion)
+{
+    const uint64_t k = estado->indices[posicion];
+
+    if (pila->valida && k > pila->k_actual &&
+        k - pila->k_actual <= MAX_PASOS_SUMA) {
+        for (uint64_t i = pila->k_actual; i < k; ++i) {
+            /* (F(i), F(i+1)) -> (F(i+1), F(i+2)) */
+            if (eg_sumar(&pila->fk[0], &pila->fk[0], &pila->fk1[0]) != 0) {
+                return -1;
+            }
+            EnteroGrande tmp = pila->fk[0];
+            pila->fk[0]  = pila->fk1[0];
+            pila->fk1[0] = tmp;
+        }
+        pila->k_actual = k;
+        return 0;
+    }
+
+    /* Nivel más bajo cuyo prefijo coincide con el de 'base' */
+    int nivel = 64;
+    if (pila->valida) {
+        uint64_t diferencia = k ^ pila->base;
+        nivel = (diferencia == 0) ? 1 : 64 - __builtin_clzll(diferencia);
+        if (nivel < 1) {
+            nivel = 1;
+        }
+    } else if (eg_asignar_u64(&pila->fk[64], 0) != 0 ||
+               eg_asignar_u64(&pila->fk1[64], 1) != 0) {
+        return -1;
+    }
+
+    for (int s = nivel - 1; s >= 0; --s) {
+        if (eg_copiar(&pila->fk[s], &pila->fk[s + 1]) != 0 ||
+            eg_copiar(&pila->fk1[s], &pila->fk1[s + 1]) != 0 ||
+            eg_fibonacci_desde(k >> s, 1, &pila->fk[s], &pila->fk1[s]) != 0) {
+            return -1;
+        }
+    }
+
+    pila->base     = k;
+    pila->valida   = 1;
+    pila->k_actual = k;
+    return 0;
+}
+
+/*
+ * hilo_disperso
+ * -----------------------------------------
+ * Toma grupos de consultas únicas, de mayor a menor índice, y
+ * resuelve cada grupo en orden creciente.
+ */
+static void *hilo_disperso(void *argumento)
+{
+    TrabajoLote *trabajo = (TrabajoLote *)argumento;
+    EstadoLote  *estado  = trabajo->estado;
+    PilaPrefijos *pila   = NULL;
+
+    if (estado->modulo == 0) {
+        pila = (PilaPrefijos *)calloc(1, sizeof(PilaPrefijos));
+        if (pila == NULL) {
+            marcar_error(estado);
+            return NULL;
+        }
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&estado->mutex);
+        int    seguir = (estado->pendientes > 0 && !estado->error);
+        size_t grupo  = seguir ? --estado->pendientes : 0;
+        pthread_mutex_unlock(&estado->mutex);
+        if (!seguir) {
+            break;
+        }
+
+        size_t desde = grupo * GRUPO_CONSULTAS;
+        size_t hasta = desde + GRUPO_CONSULTAS;
+        if (hasta > estado->cantidad) {
+            hasta = estado->cantidad;
+        }
+
+        for (size_t i = desde; i < hasta; ++i) {
+            if (estado->modulo != 0) {
+                estado->valores[i] = rec_termino(&estado->recurrencia,
+                                                 estado->indices[i]);
+                continue;
+            }
+            if (resolver_disperso(estado, pila, i) != 0 ||
+                guardar_texto(estado, i, &pila->fk[0]) != 0) {
+                marcar_error(estado);
+                break;
+            }
+        }
+    }
+
+    if (pila != NULL) {
+        for (int s = 0; s <= 64; ++s) {
+            eg_liberar(&pila->fk[s]);
+            eg_liberar(&pila->fk1[s]);
+        }
+        free(pila);
+    }
+    return NULL;
+}
+
+/*
+ * hilo_denso
+ * -----------------------------------------
+ * Salta al primer índice del tramo y recorre la sucesión sumando
+ * hasta el último, guardando cada término consultado.
+ */
+static void *hilo_denso(void *argumento)
+{
+    TrabajoLote *trabajo = (TrabajoLote *)argumento;
+    EstadoLote  *estado  = trabajo->estado;
+    const uint64_t *indices = estado->indices;
+
+    if (trabajo->desde >= trabajo->hasta) {
+        return NULL;
+    }
+
+    uint64_t k = indices[trabajo->desde];
+
+    if (estado->modulo != 0) {
+        const uint64_t m = estado->modulo;
+        uint64_t par[RECURRENCIA_ORDEN_MAX];
+        rec_estado(&estado->recurrencia, k, par);
+
+        uint64_t actual = par[0], siguiente = par[1];
+        for (size_t i = trabajo->desde; i < trabajo->hasta; ++i) {
+            for (; k < indices[i]; ++k) {
+                uint64_t nuevo = actual + siguiente;
+                if (nuevo < actual || nuevo >= m) {
+                    nuevo -= m;
+                }
+                actual    = siguiente;
+                siguiente = nuevo;
+            }
+            estado->valores[i] = actual;
+        }
+        return NULL;
+    }
+
+    EnteroGrande actual, siguiente;
+    eg_iniciar(&actual);
+    eg_iniciar(&siguiente);
+
+    int fallo = (eg_fibonacci(k, &actual, &siguiente) != 0);
+
+    for (size_t i = trabajo->desde; i < trabajo->hasta && !fallo; ++i) {
+        for (; k < indices[i] && !fallo; ++k) {
+            fallo = (eg_sumar(&actual, &actual, &siguiente) != 0);
+            EnteroGrande tmp = actual;
+            actual    = siguiente;
+            siguiente = tmp;
+        }
+        fallo = fallo || guardar_texto(estado, i, &actual) != 0;
+    }
+    if (fallo) {
+        marcar_error(estado);
+    }
+
+    eg_liberar(&actual);
+    eg_liberar(&siguiente);
+    return NULL;
+}
+
+static void marcar_error(EstadoLote *estado)
+{
+    pthread_mutex_lock(&estado->mutex);
+    if (!estado->error) {
+        fprintf(stderr, "Error: memoria insuficiente al resolver las consultas.\n");
+    }
+    estado->error = 1;
+    pthread_mutex_unlock(&estado->mutex);
+}
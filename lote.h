@@ -0,0 +1,48 @@
+/*
+ * lote.h
+ * -----------------------------------------
+ * Consultas de Fibonacci por lotes: muchos índices k dispersos
+ * resueltos en una sola ejecución.
+ *
+ * Los índices se leen de un flujo (separados por espacios o saltos
+ * de línea), se ordenan y se eliminan los repetidos. Según lo
+ * densos que sean se resuelven de una de dos formas:
+ *  - Dispersos: duplicación rápida por índice, reutilizando los
+ *    pares (F(m), F(m+1)) de los prefijos binarios comunes con la
+ *    consulta anterior y avanzando con sumas si el salto es corto.
+ *  - Densos: un barrido F(k), F(k+1), ... por tramos contiguos, uno
+ *    por hilo, que salta al comienzo de su tramo y solo suma.
+ *
+ * Los resultados se escriben uno por línea en el orden de entrada
+ * (incluidos los repetidos).
+ */
+
+#ifndef LOTE_H
+#define LOTE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Mayor índice aceptado sin módulo. F(k) tiene unos 0.209 k dígitos
+ * decimales, y cada consulta única se conserva completa (en binario
+ * y en decimal) hasta escribir los resultados: F(10^8) ya ocupa
+ * ~21 MB de texto. Los índices mayores exigen --modulo, donde el
+ * costo es logarítmico en k y no hay límite.
+ */
+#define LOTE_MAX_INDICE_EXACTO 100000000ull
+
+/*
+ * lote_fibonacci
+ * -----------------------------------------
+ * Responde todas las consultas de 'entrada' en 'salida' usando
+ * 'hilos' hilos. Con modulo == 0 se imprime F(k) completo en
+ * decimal; en otro caso, F(k) mod 'modulo'.
+ *
+ * Retorna 0 si tuvo éxito, -1 ante una entrada inválida (incluido
+ * un índice mayor que LOTE_MAX_INDICE_EXACTO con modulo == 0) o
+ * falta de memoria (con un mensaje en stderr).
+ */
+int lote_fibonacci(FILE *entrada, FILE *salida, int hilos, uint64_t modulo);
+
+#endif /* LOTE_H */
@@ -0,0 +1,306 @@
+/*
+ * mapeo.c
+ * -----------------------------------------
+ * Implementación de la escritura en paralelo declarada en mapeo.h.
+ */
+
+#define _GNU_SOURCE
+
+#include "mapeo.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "entero_grande.h"
+#include "formato_decimal.h"
+
+/* Los términos hasta F(186) caben en 128 bits: longitud exacta */
+#define LIMITE_EXACTO 187
+
+/* Distancia mínima a un entero para confiar en la estimación */
+#define MARGEN_ESTIMACION 1e-7L
+
+#define MAX_HILOS_MAPEO 64
+
+/*
+ * TramoMapeo
+ * -----------------------------------------
+ * Trabajo de un hilo: términos [desde, hasta), que empiezan en el
+ * byte 'inicio' del mapeo y terminan justo antes de 'fin'.
+ */
+typedef struct {
+    char     *mapa;
+    uint64_t  desde;
+    uint64_t  hasta;
+    uint64_t  cantidad;     /* N: el último término lleva '\n' */
+    size_t    inicio;
+    size_t    fin;
+    int       error;
+} TramoMapeo;
+
+/* Prototipos de funciones internas */
+static size_t longitud_estimada(uint64_t i, int *dudosa);
+static int    longitud_exacta(uint64_t i, size_t *longitud);
+static size_t formatear(const EnteroGrande *x, char **texto, size_t *tam);
+static void  *escribir_tramo(void *argumento);
+
+int mapeo_fibonacci(const char *ruta, uint64_t cantidad, int hilos)
+{
+    if (hilos < 1) {
+        hilos = 1;
+    }
+    if (hilos > MAX_HILOS_MAPEO) {
+        hilos = MAX_HILOS_MAPEO;
+    }
+    if ((uint64_t)hilos > cantidad && cantidad > 0) {
+        hilos = (int)cantidad;
+    }
+
+    /*
+     * Cortes: cada tramo recibe ~1/hilos del tamaño estimado (basta
+     * para equilibrar); los desplazamientos y el tamaño total sí son
+     * exactos.
+     */
+    size_t estimado = 0;
+    for (uint64_t i = 0; i < cantidad; ++i) {
+        int dudosa = 0;
+        estimado += longitud_estimada(i, &dudosa) + 1;
+    }
+
+    TramoMapeo tramos[MAX_HILOS_MAPEO];
+    size_t     total = 0;
+    uint64_t   i = 0;
+    for (int h = 0; h < hilos; ++h) {
+        size_t objetivo = (h + 1 == hilos)
+                              ? SIZE_MAX
+                              : (size_t)((double)estimado * (h + 1) / hilos);
+        tramos[h].cantidad = cantidad;
+        tramos[h].desde    = i;
+        tramos[h].inicio   = total;
+        tramos[h].error    = 0;
+        for (; i < cantidad && total < objetivo; ++i) {
+            int    dudosa   = 0;
+            size_t longitud = longitud_estimada(i, &dudosa);
+            if (dudosa && longitud_exacta(i, &longitud) != 0) {
+                fprintf(stderr, "Error: memoria insuficiente para F(%llu).\n",
+                        (unsigned long long)i);
+                return -1;
+            }
+            total += longitud + 1;
+        }
+        tramos[h].hasta = i;
+        tramos[h].fin   = total;
+    }
+
+    int descriptor = open(ruta, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        perror("Error al abrir el archivo de salida");
+        return -1;
+    }
+    if (total == 0) {
+        close(descriptor);
+        return 0;
+    }
+
+    /* Reservar los bloques de una vez; sin soporte, solo el tamaño */
+    if (fallocate(descriptor, 0, 0, (off_t)total) != 0 &&
+        (errno != EOPNOTSUPP || ftruncate(descriptor, (off_t)total) != 0)) {
+        perror("Error al reservar el archivo de salida");
+        close(descriptor);
+        return -1;
+    }
+
+    char *mapa = (char *)mmap(NULL, total, PROT_READ | PROT_WRITE,
+                              MAP_SHARED, descriptor, 0);
+    if (mapa == MAP_FAILED) {
+        perror("Error en mmap del archivo de salida");
+        close(descriptor);
+        return -1;
+    }
+    for (int h = 0; h < hilos; ++h) {
+        tramos[h].mapa = mapa;
+    }
+
+    pthread_t ids[MAX_HILOS_MAPEO];
+    int creados = 0;
+    for (int h = 0; h < hilos; ++h) {
+        if (pthread_create(&ids[h], NULL, escribir_tramo, &tramos[h]) != 0) {
+            tramos[h].error = 1;
+            break;
+        }
+        creados++;
+    }
+    int codigo = (creados == hilos) ? 0 : -1;
+    for (int h = 0; h < creados; ++h) {
+        pthread_join(ids[h], NULL);
+        if (tramos[h].error) {
+            codigo = -1;
+        }
+    }
+
+    if (munmap(mapa, total) != 0 || close(descriptor) != 0) {
+        perror("Error al cerrar el archivo de salida");
+        codigo = -1;
+    }
+    if (codigo != 0) {
+        fprintf(stderr, "Error: no se pudo escribir la secuencia en %s.\n",
+                ruta);
+    }
+    return codigo;
+}
+
+/*
+ * longitud_estimada
+ * -----------------------------------------
+ * Dígitos de F(i). Para i < LIMITE_EXACTO se cuentan sobre el valor
+ * exacto; más allá se usa la fórmula de mapeo.h en long double y
+ * se marca 'dudosa' si la parte fraccionaria queda a menos de
+ * MARGEN_ESTIMACION de un entero.
+ */
+static size_t longitud_estimada(uint64_t i, int *dudosa)
+{
+    *dudosa = 0;
+
+    if (i < LIMITE_EXACTO) {
+        unsigned __int128 actual = 0, siguiente = 1;
+        char texto[FD_MAX_DIGITOS_U128];
+        for (uint64_t k = 0; k < i; ++k) {
+            unsigned __int128 nuevo = actual + siguiente;
+            actual    = siguiente;
+            siguiente = nuevo;
+        }
+        return fd_u128(actual, texto);
+    }
+
+    const long double log10_phi   = log10l((1.0L + sqrtl(5.0L)) / 2.0L);
+    const long double log10_raiz5 = 0.5L * log10l(5.0L);
+    long double x    = (long double)i * log10_phi - log10_raiz5;
+    long double piso = floorl(x);
+
+    if (x - piso < MARGEN_ESTIMACION || x - piso > 1.0L - MARGEN_ESTIMACION) {
+        *dudosa = 1;
+    }
+    return (size_t)piso + 1;
+}
+
+/*
+ * longitud_exacta
+ * -----------------------------------------
+ * Dígitos de F(i) contados sobre su conversión a decimal; solo para
+ * los pocos índices con estimación dudosa.
+ */
+static int longitud_exacta(uint64_t i, size_t *longitud)
+{
+    EnteroGrande fk, fk1;
+    char  *texto = NULL;
+    size_t tam   = 0;
+    eg_iniciar(&fk);
+    eg_iniciar(&fk1);
+
+    int codigo = -1;
+    if (eg_fibonacci(i, &fk, &fk1) == 0) {
+        *longitud = formatear(&fk, &texto, &tam);
+        codigo    = (*longitud > 0) ? 0 : -1;
+    }
+
+    free(texto);
+    eg_liberar(&fk);
+    eg_liberar(&fk1);
+    return codigo;
+}
+
+/*
+ * formatear
+ * -----------------------------------------
+ * Convierte x en '*texto', que crece según haga falta (la
+ * conversión de entero_grande.c usa eg_digitos_maximos bytes de
+ * trabajo). Retorna los dígitos escritos, 0 si faltó memoria.
+ */
+static size_t formatear(const EnteroGrande *x, char **texto, size_t *tam)
+{
+    size_t necesario = eg_digitos_maximos(x);
+
+    if (necesario < FD_MAX_DIGITOS_U128) {
+        necesario = FD_MAX_DIGITOS_U128;
+    }
+    if (necesario > *tam) {
+        char *nuevo = (char *)realloc(*texto, necesario);
+        if (nuevo == NULL) {
+            return 0;
+        }
+        *texto = nuevo;
+        *tam   = necesario;
+    }
+
+    if (x->longitud <= 2) {
+        unsigned __int128 valor = 0;
+        for (size_t k = x->longitud; k-- > 0;) {
+            valor = (valor << 64) | x->palabras[k];
+        }
+        return fd_u128(valor, *texto);
+    }
+    return eg_a_decimal(x, *texto);
+}
+
+/*
+ * escribir_tramo
+ * -----------------------------------------
+ * Hilo trabajador: (F(desde), F(desde+1)) por duplicación rápida y
+ * luego sumas. Cada término se formatea aparte y se copia a su
+ * posición; si su longitud no es la prevista se detiene sin
+ * escribir fuera del tramo.
+ */
+static void *escribir_tramo(void *argumento)
+{
+    TramoMapeo *tramo = (TramoMapeo *)argumento;
+    EnteroGrande actual, siguiente;
+    char  *texto = NULL;
+    size_t tam   = 0;
+    size_t pos   = tramo->inicio;
+    eg_iniciar(&actual);
+    eg_iniciar(&siguiente);
+
+    if (tramo->desde < tramo->hasta &&
+        eg_fibonacci(tramo->desde, &actual, &siguiente) != 0) {
+        tramo->error = 1;
+    }
+
+    for (uint64_t i = tramo->desde; i < tramo->hasta && !tramo->error; ++i) {
+        int    dudosa   = 0;
+        size_t prevista = longitud_estimada(i, &dudosa);
+        size_t digitos  = formatear(&actual, &texto, &tam);
+
+        if (digitos == 0 || (!dudosa && digitos != prevista) ||
+            pos + digitos + 1 > tramo->fin) {
+            tramo->error = 1;
+            break;
+        }
+        memcpy(tramo->mapa + pos, texto, digitos);
+        pos += digitos;
+        tramo->mapa[pos++] = (i + 1 == tramo->cantidad) ? '\n' : ' ';
+
+        /* (F(i), F(i+1)) -> (F(i+1), F(i+2)) */
+        if (eg_sumar(&actual, &actual, &siguiente) != 0) {
+            tramo->error = 1;
+        }
+        EnteroGrande tmp = actual;
+        actual    = siguiente;
+        siguiente = tmp;
+    }
+    if (pos != tramo->fin) {
+        tramo->error = 1;
+    }
+
+    free(texto);
+    eg_liberar(&actual);
+    eg_liberar(&siguiente);
+    return NULL;
+}
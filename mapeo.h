@@ -0,0 +1,44 @@
+/*
+ * mapeo.h
+ * -----------------------------------------
+ * Escritura en paralelo de F(0) .. F(N-1) completos a un archivo
+ * mapeado en memoria.
+ *
+ * La longitud decimal de cada término se conoce de antemano:
+ * F(i) ~ phi^i / sqrt(5), así que tiene
+ *
+ *     floor(i * log10(phi) - log10(sqrt(5))) + 1
+ *
+ * dígitos. Cuando ese valor queda demasiado cerca de un entero para
+ * confiar en la aritmética de punto flotante, se calcula el término
+ * y se cuentan sus dígitos. Con las longitudes se obtiene el
+ * desplazamiento de cada término en el archivo, que se reserva
+ * completo con fallocate(2) y se proyecta con mmap(2).
+ *
+ * La secuencia se parte en tramos contiguos con la misma cantidad
+ * de bytes (los términos crecen, así que los tramos finales tienen
+ * menos términos). Cada hilo salta al comienzo de su tramo por
+ * duplicación rápida, avanza con sumas y formatea cada término
+ * directamente en su porción del mapeo.
+ *
+ * El formato es el del modo secuencial de fibonacci.c: términos
+ * separados por un espacio y un salto de línea final.
+ */
+
+#ifndef MAPEO_H
+#define MAPEO_H
+
+#include <stdint.h>
+
+/*
+ * mapeo_fibonacci
+ * -----------------------------------------
+ * Escribe F(0) .. F(cantidad - 1) en 'ruta' (que se crea o se
+ * trunca) usando 'hilos' hilos.
+ *
+ * Retorna 0 si tuvo éxito, -1 ante un error de E/S o falta de
+ * memoria (con un mensaje en stderr).
+ */
+int mapeo_fibonacci(const char *ruta, uint64_t cantidad, int hilos);
+
+#endif /* MAPEO_H */
@@ -0,0 +1,507 @@
+/*
+ * ntt.c
+ * -----------------------------------------
+ * Implementación de la multiplicación por NTT declarada en ntt.h.
+ *
+ * Para cada primo p = c * 2^k + 1:
+ *  1. Los operandos se parten en coeficientes de 32 bits, reducidos
+ *     módulo p y llevados a forma de Montgomery (R = 2^32).
+ *  2. Transformada directa por decimación en frecuencia (la salida
+ *     queda en orden de bits invertido, sin permutar).
+ *  3. Producto punto a punto.
+ *  4. Transformada inversa por decimación en tiempo (acepta el
+ *     orden invertido y devuelve el natural) y escala por 1/n.
+ *
+ * Los tres residuos de cada coeficiente se combinan con el teorema
+ * chino del resto en un valor de hasta 89 bits y se propagan los
+ * acarreos en base 2^32.
+ */
+
+#include "ntt.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_PRIMOS            3
+#define LOG_MAX_TRANSFORMADA  24
+
+typedef unsigned __int128 u128;
+
+/*
+ * PrimoNtt
+ * -----------------------------------------
+ * Primo de la forma c * 2^k + 1 (k >= LOG_MAX_TRANSFORMADA) con una
+ * raíz primitiva y sus constantes de Montgomery:
+ *  - p_inv_neg: -p^(-1) mod 2^32.
+ *  - r2       : 2^64 mod p (convierte a forma de Montgomery).
+ */
+typedef struct {
+    uint32_t p;
+    uint32_t generador;
+    uint32_t p_inv_neg;
+    uint32_t r2;
+} PrimoNtt;
+
+/*
+ * TareaPrimo
+ * -----------------------------------------
+ * Convolución completa módulo un primo. Al terminar, 'resultado'
+ * contiene n coeficientes en forma normal (no Montgomery).
+ */
+typedef struct {
+    const PrimoNtt *primo;
+    const uint64_t *a;
+    size_t          la;
+    const uint64_t *b;
+    size_t          lb;
+    int             cuadrado;
+    size_t          n;
+    int             subhilos;
+    uint32_t       *resultado;
+} TareaPrimo;
+
+/*
+ * TareaTransformada
+ * -----------------------------------------
+ * Transformada directa de un operando, para ejecutarla en un hilo
+ * aparte mientras el hilo del primo transforma el otro.
+ */
+typedef struct {
+    const PrimoNtt *primo;
+    uint32_t       *valores;
+    size_t          n;
+    const uint32_t *raices;
+} TareaTransformada;
+
+/*
+ * TrabajadorNtt
+ * -----------------------------------------
+ * Conjunto de primos que procesa un mismo hilo.
+ */
+typedef struct {
+    TareaPrimo *tareas;
+    int         primero;
+    int         salto;
+} TrabajadorNtt;
+
+static PrimoNtt primos[NUM_PRIMOS] = {
+    { 2013265921u, 31u, 0u, 0u },   /* 15 * 2^27 + 1 */
+    {  469762049u,  3u, 0u, 0u },   /*  7 * 2^26 + 1 */
+    {  754974721u, 11u, 0u, 0u },   /* 45 * 2^24 + 1 */
+};
+
+/* Constantes del teorema chino del resto */
+static uint64_t inv_p0_mod_p1;
+static uint64_t inv_p0p1_mod_p2;
+
+static pthread_once_t constantes_listas = PTHREAD_ONCE_INIT;
+
+/* Prototipos de funciones internas */
+static void     preparar_constantes(void);
+static uint64_t potencia_modular(uint64_t base, uint64_t exponente,
+                                 uint64_t modulo);
+static uint32_t mont_mul(uint32_t a, uint32_t b, const PrimoNtt *primo);
+static uint32_t mont_potencia(uint32_t base, uint64_t exponente,
+                              const PrimoNtt *primo);
+static void     cargar_operando(uint32_t *destino, size_t n,
+                                const uint64_t *palabras, size_t longitud,
+                                const PrimoNtt *primo);
+static void     tabla_raices(uint32_t *raices, size_t n, int inversa,
+                             const PrimoNtt *primo);
+static void     transformada_directa(uint32_t *v, size_t n,
+                                     const uint32_t *raices,
+                                     const PrimoNtt *primo);
+static void     transformada_inversa(uint32_t *v, size_t n,
+                                     const uint32_t *raices,
+                                     const PrimoNtt *primo);
+static int      ejecutar_primo(TareaPrimo *tarea);
+static void    *hilo_transformada(void *argumento);
+static void    *hilo_trabajador(void *argumento);
+
+size_t ntt_max_palabras(void)
+{
+    /* 2 coeficientes por palabra y convolución de longitud 2^24 */
+    return (size_t)1 << (LOG_MAX_TRANSFORMADA - 1);
+}
+
+int ntt_multiplicar(uint64_t *r, const uint64_t *a, size_t la,
+                    const uint64_t *b, size_t lb, int hilos)
+{
+    if (la + lb > ntt_max_palabras()) {
+        return -1;
+    }
+    pthread_once(&constantes_listas, preparar_constantes);
+
+    size_t coeficientes = 2 * (la + lb) - 1;
+    size_t n = 1;
+    while (n < coeficientes) {
+        n <<= 1;
+    }
+
+    int cuadrado = (a == b && la == lb);
+    int trabajadores = (hilos >= NUM_PRIMOS) ? NUM_PRIMOS
+                                             : (hilos < 1 ? 1 : hilos);
+
+    TareaPrimo tareas[NUM_PRIMOS];
+    for (int j = 0; j < NUM_PRIMOS; ++j) {
+        tareas[j].primo     = &primos[j];
+        tareas[j].a         = a;
+        tareas[j].la        = la;
+        tareas[j].b         = b;
+        tareas[j].lb        = lb;
+        tareas[j].cuadrado  = cuadrado;
+        tareas[j].n         = n;
+        tareas[j].subhilos  = (hilos >= 2 * NUM_PRIMOS && !cuadrado) ? 2 : 1;
+        tareas[j].resultado = NULL;
+    }
+
+    /* El trabajador 0 es el hilo actual */
+    pthread_t     hilos_primos[NUM_PRIMOS];
+    TrabajadorNtt trabajos[NUM_PRIMOS];
+    int           creados[NUM_PRIMOS] = { 0 };
+
+    for (int w = 0; w < trabajadores; ++w) {
+        trabajos[w].tareas  = tareas;
+        trabajos[w].primero = w;
+        trabajos[w].salto   = trabajadores;
+    }
+    for (int w = 1; w < trabajadores; ++w) {
+        creados[w] = (pthread_create(&hilos_primos[w], NULL,
+                                     hilo_trabajador, &trabajos[w]) == 0);
+    }
+
+    hilo_trabajador(&trabajos[0]);
+    for (int w = 1; w < trabajadores; ++w) {
+        if (creados[w]) {
+            pthread_join(hilos_primos[w], NULL);
+        } else {
+            hilo_trabajador(&trabajos[w]);
+        }
+    }
+
+    int codigo = 0;
+    for (int j = 0; j < NUM_PRIMOS; ++j) {
+        if (tareas[j].resultado == NULL) {
+            codigo = -1;
+        }
+    }
+
+    if (codigo == 0) {
+        /* Teorema chino del resto y propagación de acarreos */
+        const uint64_t p0 = primos[0].p;
+        const uint64_t p1 = primos[1].p;
+        const uint64_t p2 = primos[2].p;
+        const u128 p0p1 = (u128)p0 * p1;
+        const size_t piezas = 2 * (la + lb);
+        u128 acarreo = 0;
+
+        memset(r, 0, sizeof(uint64_t) * (la + lb));
+
+        for (size_t i = 0; i < piezas; ++i) {
+            u128 x = 0;
+
+            if (i < coeficientes) {
+                uint64_t r0 = tareas[0].resultado[i];
+                uint64_t r1 = tareas[1].resultado[i];
+                uint64_t r2 = tareas[2].resultado[i];
+
+                /* x01 = r0 + p0 * t, con x01 = r1 (mod p1) */
+                uint64_t t = ((r1 + p1 - r0 % p1) % p1) * inv_p0_mod_p1 % p1;
+                uint64_t x01 = r0 + p0 * t;
+
+                /* x = x01 + p0 p1 * s, con x = r2 (mod p2) */
+                uint64_t s = ((r2 + p2 - x01 % p2) % p2) * inv_p0p1_mod_p2 % p2;
+                x = (u128)x01 + p0p1 * s;
+            }
+
+            acarreo += x;
+            r[i / 2] |= (uint64_t)(uint32_t)acarreo << (32 * (i & 1));
+            acarreo >>= 32;
+        }
+    }
+
+    for (int j = 0; j < NUM_PRIMOS; ++j) {
+        free(tareas[j].resultado);
+    }
+    return codigo;
+}
+
+/*
+ * preparar_constantes
+ * -----------------------------------------
+ * Constantes de Montgomery de cada primo e inversos del teorema
+ * chino del resto (por el pequeño teorema de Fermat).
+ */
+static void preparar_constantes(void)
+{
+    for (int j = 0; j < NUM_PRIMOS; ++j) {
+        uint32_t p = primos[j].p;
+
+        /* Newton sobre 2-ádicos: cada paso duplica los bits correctos */
+        uint32_t inverso = p;
+        for (int i = 0; i < 5; ++i) {
+            inverso *= 2u - p * inverso;
+        }
+        primos[j].p_inv_neg = (uint32_t)(0u - inverso);
+        primos[j].r2        = (uint32_t)(((u128)1 << 64) % p);
+    }
+
+    uint64_t p0 = primos[0].p;
+    uint64_t p1 = primos[1].p;
+    uint64_t p2 = primos[2].p;
+
+    inv_p0_mod_p1   = potencia_modular(p0 % p1, p1 - 2, p1);
+    inv_p0p1_mod_p2 = potencia_modular((uint64_t)((u128)p0 * p1 % p2),
+                                       p2 - 2, p2);
+}
+
+static uint64_t potencia_modular(uint64_t base, uint64_t exponente,
+                                 uint64_t modulo)
+{
+    uint64_t resultado = 1 % modulo;
+
+    base %= modulo;
+    while (exponente > 0) {
+        if (exponente & 1u) {
+            resultado = (uint64_t)((u128)resultado * base % modulo);
+        }
+        base = (uint64_t)((u128)base * base % modulo);
+        exponente >>= 1;
+    }
+    return resultado;
+}
+
+/*
+ * mont_mul
+ * -----------------------------------------
+ * a * b * 2^(-32) mod p (reducción de Montgomery). Con p < 2^31 la
+ * suma intermedia no desborda 64 bits.
+ */
+static inline uint32_t mont_mul(uint32_t a, uint32_t b, const PrimoNtt *primo)
+{
+    uint64_t t = (uint64_t)a * b;
+    uint32_t m = (uint32_t)t * primo->p_inv_neg;
+    uint32_t u = (uint32_t)((t + (uint64_t)m * primo->p) >> 32);
+
+    return (u >= primo->p) ? u - primo->p : u;
+}
+
+static inline uint32_t mont_sumar(uint32_t a, uint32_t b, uint32_t p)
+{
+    uint32_t s = a + b;
+    return (s >= p) ? s - p : s;
+}
+
+static inline uint32_t mont_restar(uint32_t a, uint32_t b, uint32_t p)
+{
+    return (a >= b) ? a - b : a + p - b;
+}
+
+static uint32_t mont_potencia(uint32_t base, uint64_t exponente,
+                              const PrimoNtt *primo)
+{
+    uint32_t resultado = mont_mul(1u, primo->r2, primo); /* 1 en forma Montgomery */
+
+    while (exponente > 0) {
+        if (exponente & 1u) {
+            resultado = mont_mul(resultado, base, primo);
+        }
+        base = mont_mul(base, base, primo);
+        exponente >>= 1;
+    }
+    return resultado;
+}
+
+/*
+ * cargar_operando
+ * -----------------------------------------
+ * Parte cada palabra en dos coeficientes de 32 bits, los reduce
+ * módulo p, los pasa a forma de Montgomery y rellena con ceros
+ * hasta n.
+ */
+static void cargar_operando(uint32_t *destino, size_t n,
+                            const uint64_t *palabras, size_t longitud,
+                            const PrimoNtt *primo)
+{
+    for (size_t i = 0; i < longitud; ++i) {
+        uint32_t bajo = (uint32_t)palabras[i];
+        uint32_t alto = (uint32_t)(palabras[i] >> 32);
+        destino[2 * i]     = mont_mul(bajo % primo->p, primo->r2, primo);
+        destino[2 * i + 1] = mont_mul(alto % primo->p, primo->r2, primo);
+    }
+    memset(destino + 2 * longitud, 0,
+           sizeof(uint32_t) * (n - 2 * longitud));
+}
+
+/*
+ * tabla_raices
+ * -----------------------------------------
+ * raices[j] = w^j (o w^-j si 'inversa') para j < n / 2, con w raíz
+ * primitiva n-ésima de la unidad, en forma de Montgomery.
+ */
+static void tabla_raices(uint32_t *raices, size_t n, int inversa,
+                         const PrimoNtt *primo)
+{
+    uint32_t g = mont_mul(primo->generador, primo->r2, primo);
+    uint64_t exponente = (uint64_t)(primo->p - 1) / n;
+    if (inversa) {
+        exponente = (uint64_t)(primo->p - 1) - exponente;
+    }
+    uint32_t w = mont_potencia(g, exponente, primo);
+
+    raices[0] = mont_mul(1u, primo->r2, primo);
+    for (size_t j = 1; j < n / 2; ++j) {
+        raices[j] = mont_mul(raices[j - 1], w, primo);
+    }
+}
+
+/*
+ * transformada_directa
+ * -----------------------------------------
+ * Decimación en frecuencia (Gentleman-Sande). Entrada en orden
+ * natural, salida en orden de bits invertido.
+ */
+static void transformada_directa(uint32_t *v, size_t n,
+                                 const uint32_t *raices,
+                                 const PrimoNtt *primo)
+{
+    const uint32_t p = primo->p;
+
+    for (size_t largo = n; largo >= 2; largo >>= 1) {
+        size_t mitad = largo / 2;
+        size_t salto = n / largo;
+
+        for (size_t i = 0; i < n; i += largo) {
+            for (size_t j = 0; j < mitad; ++j) {
+                uint32_t u = v[i + j];
+                uint32_t t = v[i + j + mitad];
+                v[i + j]         = mont_sumar(u, t, p);
+                v[i + j + mitad] = mont_mul(mont_restar(u, t, p),
+                                            raices[j * salto], primo);
+            }
+        }
+    }
+}
+
+/*
+ * transformada_inversa
+ * -----------------------------------------
+ * Decimación en tiempo (Cooley-Tukey) con raíces inversas. Entrada
+ * en orden de bits invertido, salida en orden natural, sin escalar.
+ */
+static void transformada_inversa(uint32_t *v, size_t n,
+                                 const uint32_t *raices,
+                                 const PrimoNtt *primo)
+{
+    const uint32_t p = primo->p;
+
+    for (size_t largo = 2; largo <= n; largo <<= 1) {
+        size_t mitad = largo / 2;
+        size_t salto = n / largo;
+
+        for (size_t i = 0; i < n; i += largo) {
+            for (size_t j = 0; j < mitad; ++j) {
+                uint32_t u = v[i + j];
+                uint32_t t = mont_mul(v[i + j + mitad], raices[j * salto],
+                                      primo);
+                v[i + j]         = mont_sumar(u, t, p);
+                v[i + j + mitad] = mont_restar(u, t, p);
+            }
+        }
+    }
+}
+
+/*
+ * ejecutar_primo
+ * -----------------------------------------
+ * Convolución de a y b módulo tarea->primo. Deja el resultado en
+ * tarea->resultado (NULL si no hubo memoria).
+ */
+static int ejecutar_primo(TareaPrimo *tarea)
+{
+    const PrimoNtt *primo = tarea->primo;
+    const size_t    n     = tarea->n;
+
+    uint32_t *fa      = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    uint32_t *fb      = tarea->cuadrado ? NULL
+                                        : (uint32_t *)malloc(sizeof(uint32_t) * n);
+    uint32_t *directas = (uint32_t *)malloc(sizeof(uint32_t) * (n / 2 + 1));
+    uint32_t *inversas = (uint32_t *)malloc(sizeof(uint32_t) * (n / 2 + 1));
+
+    if (fa == NULL || directas == NULL || inversas == NULL ||
+        (!tarea->cuadrado && fb == NULL)) {
+        free(fa);
+        free(fb);
+        free(directas);
+        free(inversas);
+        return -1;
+    }
+
+    tabla_raices(directas, n, 0, primo);
+    tabla_raices(inversas, n, 1, primo);
+
+    cargar_operando(fa, n, tarea->a, tarea->la, primo);
+
+    if (tarea->cuadrado) {
+        transformada_directa(fa, n, directas, primo);
+        for (size_t i = 0; i < n; ++i) {
+            fa[i] = mont_mul(fa[i], fa[i], primo);
+        }
+    } else {
+        cargar_operando(fb, n, tarea->b, tarea->lb, primo);
+
+        TareaTransformada otra = { primo, fb, n, directas };
+        pthread_t hilo;
+        int en_paralelo = (tarea->subhilos > 1 &&
+                           pthread_create(&hilo, NULL, hilo_transformada,
+                                          &otra) == 0);
+
+        transformada_directa(fa, n, directas, primo);
+        if (en_paralelo) {
+            pthread_join(hilo, NULL);
+        } else {
+            transformada_directa(fb, n, directas, primo);
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            fa[i] = mont_mul(fa[i], fb[i], primo);
+        }
+    }
+
+    transformada_inversa(fa, n, inversas, primo);
+
+    /* Escala por 1/n y salida de la forma de Montgomery en un paso:
+     * mont_mul(x, n^-1 en forma normal) = x_normal * n^-1. */
+    uint32_t n_inverso = (uint32_t)potencia_modular(n % primo->p,
+                                                    primo->p - 2, primo->p);
+    for (size_t i = 0; i < n; ++i) {
+        fa[i] = mont_mul(fa[i], n_inverso, primo);
+    }
+
+    free(fb);
+    free(directas);
+    free(inversas);
+
+    tarea->resultado = fa;
+    return 0;
+}
+
+static void *hilo_transformada(void *argumento)
+{
+    TareaTransformada *tarea = (TareaTransformada *)argumento;
+
+    transformada_directa(tarea->valores, tarea->n, tarea->raices,
+                         tarea->primo);
+    return NULL;
+}
+
+static void *hilo_trabajador(void *argumento)
+{
+    TrabajadorNtt *trabajo = (TrabajadorNtt *)argumento;
+
+    for (int j = trabajo->primero; j < NUM_PRIMOS; j += trabajo->salto) {
+        ejecutar_primo(&trabajo->tareas[j]);
+    }
+    return NULL;
+}
@@ -0,0 +1,40 @@
+/*
+ * ntt.h
+ * -----------------------------------------
+ * Multiplicación de enteros grandes por transformada teórico-
+ * numérica (NTT) con tres primos y reconstrucción por el teorema
+ * chino del resto.
+ *
+ * Los operandos son arreglos de palabras de 64 bits (base 2^64,
+ * little-endian), como en entero_grande.h. Cada palabra se parte en
+ * dos coeficientes de 32 bits; con longitud de transformada máxima
+ * 2^24, los coeficientes de la convolución (< 2^24 * 2^64 = 2^88)
+ * caben en el producto de los tres primos (~2^89.2).
+ */
+
+#ifndef NTT_H
+#define NTT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Suma máxima de longitudes (en palabras) que admite ntt_multiplicar */
+size_t ntt_max_palabras(void);
+
+/*
+ * ntt_multiplicar
+ * -----------------------------------------
+ * r[0..la+lb) = a * b. 'r' no puede solaparse con los operandos.
+ * Si a y b son el mismo arreglo con la misma longitud, se calcula
+ * un cuadrado (una transformada directa menos por primo).
+ *
+ * 'hilos' limita los hilos usados: uno por primo, y dos por primo
+ * (una transformada directa de cada operando) a partir de 6.
+ *
+ * Retorna 0 si tuvo éxito, -1 si los operandos exceden
+ * ntt_max_palabras() o no hubo memoria.
+ */
+int ntt_multiplicar(uint64_t *r, const uint64_t *a, size_t la,
+                    const uint64_t *b, size_t lb, int hilos);
+
+#endif /* NTT_H */
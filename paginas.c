@@ -0,0 +1,305 @@
+/*
+ * paginas.c
+ * -----------------------------------------
+ * Implementación de las reservas declaradas en paginas.h.
+ *
+ * La política intercalada se aplica con la llamada al sistema mbind
+ * directamente, sin libnuma; los nodos se leen de
+ * /sys/devices/system/node/has_memory.
+ */
+
+#define _GNU_SOURCE
+
+#include "paginas.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* Páginas enormes de x86-64 (transparentes y de hugetlbfs) */
+#define TAM_PAGINA_ENORME ((size_t)2 << 20)
+
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+
+/* Mismo mínimo por hilo que rec_llenar_paralelo */
+#define ELEMENTOS_MINIMOS_POR_HILO 4096
+
+/*
+ * TareaPrefallo
+ * -----------------------------------------
+ * Bytes [desde, hasta) que toca un hilo de pg_prefallar.
+ */
+typedef struct {
+    char  *desde;
+    char  *hasta;
+    size_t pagina;
+} TareaPrefallo;
+
+/* Prototipos de funciones internas */
+static size_t redondear(size_t valor, size_t multiplo);
+static int    leer_nodos(unsigned long *mascara);
+static void  *prefallar_bloque(void *argumento);
+
+int pg_reservar(ReservaPaginas *r, size_t bytes, TipoPaginas tipo,
+                PoliticaNuma numa)
+{
+    const size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    const int    comunes = MAP_PRIVATE | MAP_ANONYMOUS;
+    size_t       util = 0;
+
+    r->datos    = NULL;
+    r->bytes    = bytes;
+    r->mapa     = MAP_FAILED;
+    r->tam_mapa = 0;
+    r->tipo     = tipo;
+    r->nodos    = 0;
+    if (bytes == 0) {
+        bytes = 1;
+    }
+
+    if (r->tipo == PAGINAS_HUGETLB) {
+        util        = redondear(bytes, TAM_PAGINA_ENORME);
+        r->mapa     = mmap(NULL, util, PROT_READ | PROT_WRITE,
+                           comunes | MAP_HUGETLB, -1, 0);
+        r->tam_mapa = util;
+        if (r->mapa == MAP_FAILED) {
+            r->tipo = PAGINAS_ENORMES;   /* el conjunto no alcanza */
+        }
+    }
+
+    if (r->tipo == PAGINAS_ENORMES) {
+        /* Sobra una página enorme para poder alinear el comienzo */
+        util        = redondear(bytes, TAM_PAGINA_ENORME);
+        r->tam_mapa = util + TAM_PAGINA_ENORME;
+        r->mapa     = mmap(NULL, r->tam_mapa, PROT_READ | PROT_WRITE,
+                           comunes, -1, 0);
+        if (r->mapa == MAP_FAILED) {
+            return -1;
+        }
+        uintptr_t inicio = (uintptr_t)r->mapa;
+        r->datos = (void *)redondear(inicio, TAM_PAGINA_ENORME);
+        if (madvise(r->datos, util, MADV_HUGEPAGE) != 0) {
+            r->tipo = PAGINAS_NORMALES;
+        }
+    } else if (r->tipo == PAGINAS_NORMALES) {
+        util        = redondear(bytes, pagina);
+        r->tam_mapa = util;
+        r->mapa     = mmap(NULL, util, PROT_READ | PROT_WRITE, comunes, -1, 0);
+        if (r->mapa == MAP_FAILED) {
+            return -1;
+        }
+        r->datos = r->mapa;
+        /* Con THP en "always" el kernel las promovería igual */
+        madvise(r->datos, util, MADV_NOHUGEPAGE);
+    } else {
+        r->datos = r->mapa;
+    }
+
+    if (numa == NUMA_INTERCALADA) {
+        unsigned long mascara = 0;
+        int nodos = leer_nodos(&mascara);
+        if (nodos > 1 &&
+            syscall(SYS_mbind, r->datos, util, MPOL_INTERLEAVE, &mascara,
+                    8 * sizeof(mascara) + 1, 0) == 0) {
+            r->nodos = nodos;
+        }
+    }
+    return 0;
+}
+
+void pg_liberar(ReservaPaginas *r)
+{
+    if (r->mapa != MAP_FAILED && r->mapa != NULL) {
+        munmap(r->mapa, r->tam_mapa);
+    }
+    r->mapa  = NULL;
+    r->datos = NULL;
+}
+
+/*
+ * pg_prefallar
+ * -----------------------------------------
+ * Reparte los elementos igual que rec_llenar_paralelo (bloques de
+ * cantidad / hilos, los primeros con uno más) para que cada hilo
+ * toque exactamente las páginas de un bloque.
+ */
+int pg_prefallar(ReservaPaginas *r, size_t cantidad, size_t tam_elemento,
+                 int hilos)
+{
+    const size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    char *datos = (char *)r->datos;
+
+    if (hilos < 1) {
+        hilos = 1;
+    }
+    if ((size_t)hilos > cantidad / ELEMENTOS_MINIMOS_POR_HILO) {
+        hilos = (int)(cantidad / ELEMENTOS_MINIMOS_POR_HILO);
+    }
+    if (hilos <= 1) {
+        TareaPrefallo tarea = { datos, datos + cantidad * tam_elemento, pagina };
+        prefallar_bloque(&tarea);
+        return 0;
+    }
+
+    pthread_t     *ids    = (pthread_t *)malloc(sizeof(pthread_t) * (size_t)hilos);
+    TareaPrefallo *tareas = (TareaPrefallo *)malloc(sizeof(TareaPrefallo) * (size_t)hilos);
+    int           *creado = (int *)calloc((size_t)hilos, sizeof(int));
+    if (ids == NULL || tareas == NULL || creado == NULL) {
+        free(ids);
+        free(tareas);
+        free(creado);
+        TareaPrefallo tarea = { datos, datos + cantidad * tam_elemento, pagina };
+        prefallar_bloque(&tarea);
+        return -1;
+    }
+
+    size_t base  = cantidad / (size_t)hilos;
+    size_t resto = cantidad % (size_t)hilos;
+    size_t desplazamiento = 0;
+    int    codigo = 0;
+
+    for (int t = 0; t < hilos; ++t) {
+        size_t tam = base + ((size_t)t < resto ? 1 : 0);
+        tareas[t].desde  = datos + desplazamiento * tam_elemento;
+        tareas[t].hasta  = datos + (desplazamiento + tam) * tam_elemento;
+        tareas[t].pagina = pagina;
+        desplazamiento += tam;
+
+        creado[t] = (pthread_create(&ids[t], NULL, prefallar_bloque,
+                                    &tareas[t]) == 0);
+    }
+
+    for (int t = 0; t < hilos; ++t) {
+        if (creado[t]) {
+            pthread_join(ids[t], NULL);
+        } else {
+            prefallar_bloque(&tareas[t]);
+            codigo = -1;
+        }
+    }
+
+    free(ids);
+    free(tareas);
+    free(creado);
+    return codigo;
+}
+
+void pg_fallos(long *menores, long *mayores)
+{
+    struct rusage uso;
+
+    if (getrusage(RUSAGE_SELF, &uso) != 0) {
+        *menores = 0;
+        *mayores = 0;
+        return;
+    }
+    *menores = uso.ru_minflt;
+    *mayores = uso.ru_majflt;
+}
+
+const char *pg_nombre_tipo(TipoPaginas tipo)
+{
+    switch (tipo) {
+    case PAGINAS_ENORMES:
+        return "enormes";
+    case PAGINAS_HUGETLB:
+        return "hugetlb";
+    default:
+        return "normales";
+    }
+}
+
+int pg_leer_tipo(const char *nombre, TipoPaginas *tipo)
+{
+    static const TipoPaginas TIPOS[] = {
+        PAGINAS_NORMALES, PAGINAS_ENORMES, PAGINAS_HUGETLB
+    };
+
+    for (size_t t = 0; t < sizeof(TIPOS) / sizeof(TIPOS[0]); ++t) {
+        if (strcmp(nombre, pg_nombre_tipo(TIPOS[t])) == 0) {
+            *tipo = TIPOS[t];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*
+ * prefallar_bloque
+ * -----------------------------------------
+ * Hilo de pg_prefallar. MADV_POPULATE_WRITE (Linux 5.14) crea las
+ * páginas de una vez; si no está disponible se escribe un byte por
+ * página. Los extremos se redondean a páginas completas: una página
+ * compartida con el bloque vecino la toca quien llegue primero.
+ */
+static void *prefallar_bloque(void *argumento)
+{
+    TareaPrefallo *tarea = (TareaPrefallo *)argumento;
+    char *desde = (char *)((uintptr_t)tarea->desde / tarea->pagina * tarea->pagina);
+    char *hasta = (char *)redondear((uintptr_t)tarea->hasta, tarea->pagina);
+
+    if (desde >= hasta) {
+        return NULL;
+    }
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(desde, (size_t)(hasta - desde), MADV_POPULATE_WRITE) == 0) {
+        return NULL;
+    }
+#endif
+    for (volatile char *p = desde; p < hasta; p += tarea->pagina) {
+        *p = *p;
+    }
+    return NULL;
+}
+
+/*
+ * leer_nodos
+ * -----------------------------------------
+ * Interpreta la lista de nodos con memoria ("0", "0-3", "0,2-3") como
+ * máscara de bits. Retorna cuántos nodos hay (0 si no se pudo leer;
+ * se ignoran los nodos de índice 64 o mayor).
+ */
+static int leer_nodos(unsigned long *mascara)
+{
+    FILE *archivo = fopen("/sys/devices/system/node/has_memory", "r");
+    char  linea[256];
+    int   nodos = 0;
+
+    *mascara = 0;
+    if (archivo == NULL) {
+        return 0;
+    }
+    if (fgets(linea, sizeof(linea), archivo) != NULL) {
+        char *p = linea;
+        while (*p >= '0' && *p <= '9') {
+            long desde = strtol(p, &p, 10);
+            long hasta = desde;
+            if (*p == '-') {
+                hasta = strtol(p + 1, &p, 10);
+            }
+            for (long n = desde; n <= hasta && n < 64; ++n) {
+                *mascara |= 1UL << n;
+                nodos++;
+            }
+            if (*p == ',') {
+                p++;
+            }
+        }
+    }
+    fclose(archivo);
+    return nodos;
+}
+
+/* Menor múltiplo de 'multiplo' (potencia de 2) mayor o igual a 'valor' */
+static size_t redondear(size_t valor, size_t multiplo)
+{
+    return (valor + multiplo - 1) & ~(multiplo - 1);
+}
@@ -0,0 +1,83 @@
+/*
+ * paginas.h
+ * -----------------------------------------
+ * Reserva de arreglos grandes con control de páginas y de NUMA.
+ *
+ * Un arreglo de cientos de millones de términos ocupa varios GiB; con
+ * páginas de 4 KiB eso son millones de fallos de página en las
+ * primeras escrituras. Aquí el arreglo se obtiene con mmap y puede
+ * usar:
+ *  - PAGINAS_NORMALES: páginas de 4 KiB.
+ *  - PAGINAS_ENORMES: páginas transparentes de 2 MiB
+ *    (madvise(MADV_HUGEPAGE) sobre una región alineada a 2 MiB).
+ *  - PAGINAS_HUGETLB: páginas del conjunto reservado por el
+ *    administrador (MAP_HUGETLB, vm.nr_hugepages). Si no alcanzan se
+ *    usan páginas transparentes, y si tampoco, normales.
+ *
+ * Ubicación en NUMA:
+ *  - NUMA_PRIMER_TOQUE: la política del kernel por defecto; cada
+ *    página queda en el nodo del hilo que la escribe primero. Como
+ *    rec_llenar_paralelo reparte el arreglo en bloques contiguos, sin
+ *    prefallo cada bloque queda junto al hilo que lo llena.
+ *  - NUMA_INTERCALADA: las páginas se reparten por turno entre los
+ *    nodos con memoria (mbind(MPOL_INTERLEAVE)), para que el ancho de
+ *    banda de todos los nodos sirva a todos los hilos. Con un solo
+ *    nodo no tiene efecto.
+ *
+ * pg_prefallar toca las páginas en paralelo antes de usarlas, con el
+ * mismo reparto en bloques que rec_llenar_paralelo, para sacar los
+ * fallos del cálculo o medirlos por separado.
+ */
+
+#ifndef PAGINAS_H
+#define PAGINAS_H
+
+#include <stddef.h>
+
+typedef enum {
+    PAGINAS_NORMALES,
+    PAGINAS_ENORMES,
+    PAGINAS_HUGETLB
+} TipoPaginas;
+
+typedef enum {
+    NUMA_PRIMER_TOQUE,
+    NUMA_INTERCALADA
+} PoliticaNuma;
+
+typedef struct {
+    void        *datos;       /* alineado al tamaño de página usado */
+    size_t       bytes;       /* pedidos */
+    void        *mapa;        /* región completa devuelta por mmap */
+    size_t       tam_mapa;
+    TipoPaginas  tipo;        /* el realmente obtenido */
+    int          nodos;       /* nodos de la política intercalada (0 si no) */
+} ReservaPaginas;
+
+/*
+ * pg_reservar: 'bytes' bytes en cero del tipo pedido (o del mejor
+ * disponible, ver arriba). Retorna 0 si tuvo éxito, -1 si mmap
+ * falló.
+ * pg_liberar: devuelve la región al sistema.
+ */
+int  pg_reservar(ReservaPaginas *r, size_t bytes, TipoPaginas tipo,
+                 PoliticaNuma numa);
+void pg_liberar(ReservaPaginas *r);
+
+/*
+ * pg_prefallar: los datos son 'cantidad' elementos de 'tam_elemento'
+ * bytes, repartidos en 'hilos' bloques como en rec_llenar_paralelo;
+ * cada hilo toca las páginas de su bloque. Retorna 0 si tuvo éxito,
+ * -1 si no se pudieron crear los hilos (las páginas se tocan igual).
+ */
+int  pg_prefallar(ReservaPaginas *r, size_t cantidad, size_t tam_elemento,
+                  int hilos);
+
+/* Fallos de página menores y mayores del proceso hasta ahora */
+void pg_fallos(long *menores, long *mayores);
+
+/* "normales", "enormes" o "hugetlb"; pg_leer_tipo: -1 si no existe */
+const char *pg_nombre_tipo(TipoPaginas tipo);
+int         pg_leer_tipo(const char *nombre, TipoPaginas *tipo);
+
+#endif /* PAGINAS_H */
@@ -36,9 +36,15 @@
  * Uso:
  *      ./pi               -> usa n por defecto (2 000 000 000)
  *      ./pi n             -> usa el valor de n indicado
+ *      ./pi --cache RUTA [n]
+ *                         -> reutiliza/almacena sumas parciales en
+ *                            la caché persistente RUTA (ver cache_pi.h)
  *
  * Parámetros:
  *  - n: número de subintervalos (entero positivo).
+ *
+ * El tiempo se mide con reloj.h (TSC invariante calibrado, o
+ * CLOCK_MONOTONIC si no lo hay; RELOJ=monotonic lo fuerza).
  */
 
 #define _POSIX_C_SOURCE 199309L
@@ -46,7 +52,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
-#include <time.h>
+#include <string.h>
+
+#include "cache_pi.h"
+#include "reloj.h"
 
 /* Constantes de configuración y referencia */
 static const int    N_INTERVALOS_POR_DEFECTO = 2000000000;
@@ -55,18 +64,28 @@ static const double PI_REFERENCIA            = 3.141592653589793238462643;
 /* Prototipos de funciones internas */
 static double funcion_integrando(double x);
 static double calcular_pi_secuencial(int numero_intervalos);
-static double obtener_tiempo(void);
+static double calcular_pi_con_cache(int numero_intervalos, CachePi *cache,
+                                    int64_t *bloques_reutilizados,
+                                    int64_t *bloques_sin_guardar);
 
 int main(int argc, char **argv)
 {
     int    numero_intervalos = N_INTERVALOS_POR_DEFECTO;
     double pi_aproximado     = 0.0;
-    double tiempo_inicio     = 0.0;
-    double tiempo_fin        = 0.0;
+    uint64_t tiempo_inicio   = 0;
+    uint64_t tiempo_fin      = 0;
+    const char *ruta_cache   = NULL;
+    int    primer_posicional = 1;
+
+    /* Opción --cache RUTA antes de los argumentos posicionales */
+    if (argc >= 3 && strcmp(argv[1], "--cache") == 0) {
+        ruta_cache        = argv[2];
+        primer_posicional = 3;
+    }
 
     /* Permitir que el usuario sobreescriba el número de intervalos */
-    if (argc >= 2) {
-        numero_intervalos = atoi(argv[1]);
+    if (argc > primer_posicional) {
+        numero_intervalos = atoi(argv[primer_posicional]);
     }
 
     if (numero_intervalos <= 0 || numero_intervalos > 2147483647) {
@@ -75,19 +94,51 @@ int main(int argc, char **argv)
         return EXIT_FAILURE;
     }
 
+    CachePi cache;
+    int64_t bloques_reutilizados = 0;
+    int64_t bloques_sin_guardar  = 0;
+
+    if (ruta_cache != NULL && cache_pi_abrir(&cache, ruta_cache) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    reloj_iniciar();
+
     /* Medimos solo el tiempo del cálculo numérico de pi */
-    tiempo_inicio   = obtener_tiempo();
-    pi_aproximado   = calcular_pi_secuencial(numero_intervalos);
-    tiempo_fin      = obtener_tiempo();
+    tiempo_inicio   = reloj_ns();
+    if (ruta_cache != NULL) {
+        pi_aproximado = calcular_pi_con_cache(numero_intervalos, &cache,
+                                              &bloques_reutilizados,
+                                              &bloques_sin_guardar);
+    } else {
+        pi_aproximado = calcular_pi_secuencial(numero_intervalos);
+    }
+    tiempo_fin      = reloj_ns();
 
     printf("\nConfiguración:\n");
     printf("  n (subintervalos) = %d\n", numero_intervalos);
+    if (reloj_fuente() == RELOJ_TSC) {
+        printf("  reloj             = tsc (%.3f GHz)\n", reloj_ghz());
+    } else {
+        printf("  reloj             = monotonic\n");
+    }
+    if (ruta_cache != NULL) {
+        printf("  caché             = %s (%lld de %lld bloques reutilizados)\n",
+               ruta_cache,
+               (long long)bloques_reutilizados,
+               (long long)cache_pi_num_bloques(numero_intervalos));
+        if (bloques_sin_guardar > 0) {
+            printf("  sin guardar       = %lld bloques (caché llena o "
+                   "sin bloqueo)\n", (long long)bloques_sin_guardar);
+        }
+        cache_pi_cerrar(&cache);
+    }
 
     printf("\npi se aproxima a      = %.20f\n", pi_aproximado);
     printf("Error absoluto        = %.20f\n",
            fabs(pi_aproximado - PI_REFERENCIA));
     printf("Tiempo secuencial (s) = %.6f\n",
-           tiempo_fin - tiempo_inicio);
+           (double)(tiempo_fin - tiempo_inicio) * 1e-9);
 
     return EXIT_SUCCESS;
 }
@@ -129,18 +180,60 @@ static double calcular_pi_secuencial(int numero_intervalos)
 }
 
 /*
- * obtener_tiempo
+ * calcular_pi_con_cache
  * -----------------------------------------
- * Retorna un timestamp en segundos, usando un reloj
- * de alta resolución (CLOCK_MONOTONIC).
+ * Igual que calcular_pi_secuencial, pero recorre [0, n) en los
+ * bloques de la rejilla común de cache_pi.h. La suma de cada
+ * bloque se toma de la caché si existe; si no, se calcula (subbloque
+ * a subbloque, como exige cache_pi.h) y se almacena para ejecuciones
+ * posteriores (de pi o de pi_p).
  *
- * Esta función es útil para medir tiempos de ejecución.
+ * Parámetros:
+ *  - numero_intervalos   : cantidad de subintervalos (n > 0).
+ *  - cache               : caché abierta con cache_pi_abrir.
+ *  - bloques_reutilizados: salida, bloques encontrados en la caché.
+ *  - bloques_sin_guardar : salida, bloques calculados que
+ *                          cache_pi_guardar no pudo almacenar.
+ *
+ * Retorna:
+ *  - Aproximación de pi como número de doble precisión.
  */
-static double obtener_tiempo(void)
+static double calcular_pi_con_cache(int numero_intervalos, CachePi *cache,
+                                    int64_t *bloques_reutilizados,
+                                    int64_t *bloques_sin_guardar)
 {
-    struct timespec instante;
-
-    clock_gettime(CLOCK_MONOTONIC, &instante);
+    const double  paso        = 1.0 / (double)numero_intervalos;
+    const int64_t num_bloques = cache_pi_num_bloques(numero_intervalos);
+    double        suma        = 0.0;
+
+    *bloques_reutilizados = 0;
+    *bloques_sin_guardar  = 0;
+
+    for (int64_t b = 0; b < num_bloques; ++b) {
+        ClaveCache clave = cache_pi_clave_bloque(numero_intervalos, b);
+        double suma_bloque = 0.0;
+
+        if (cache_pi_buscar(cache, &clave, &suma_bloque)) {
+            (*bloques_reutilizados)++;
+        } else {
+            for (int64_t s = clave.inicio; s < clave.fin;
+                 s += TAM_SUBBLOQUE_CACHE) {
+                int64_t fin_subbloque = (clave.fin - s < TAM_SUBBLOQUE_CACHE)
+                                        ? clave.fin : s + TAM_SUBBLOQUE_CACHE;
+                double  suma_subbloque = 0.0;
+                for (int64_t i = s; i < fin_subbloque; ++i) {
+                    double x_punto_medio = paso * ((double)i + 0.5);
+                    suma_subbloque += funcion_integrando(x_punto_medio);
+                }
+                suma_bloque += suma_subbloque;
+            }
+            if (cache_pi_guardar(cache, &clave, suma_bloque) != 0) {
+                (*bloques_sin_guardar)++;
+            }
+        }
+
+        suma += suma_bloque;
+    }
 
-    return (double)instante.tv_sec + (double)instante.tv_nsec * 1e-9;
+    return paso * suma;
 }
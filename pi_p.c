@@ -16,10 +16,52 @@
  *      ./pi_p               -> H = 4 (por defecto), n = 2 000 000 000
  *      ./pi_p H             -> usa H hilos, n por defecto
  *      ./pi_p H n           -> usa H hilos y n subintervalos
+ *      ./pi_p --cache RUTA [H [n]]
+ *                           -> reutiliza/almacena sumas parciales en
+ *                              la caché persistente RUTA (ver cache_pi.h)
+ *      ./pi_p --por-hilo [H [n]]
+ *                           -> informa además el tiempo de cómputo
+ *                              de cada hilo
+ *      ./pi_p --frecuencia [H [n]]
+ *                           -> mide además la frecuencia efectiva de
+ *                              cada hilo y la de una ejecución de
+ *                              referencia con 1 hilo, e informa el
+ *                              speedup normalizado por frecuencia
+ *                              (ver frecuencia.h)
+ *      ./pi_p --bajo-jitter [H [n]]
+ *                           -> mide con poco ruido: memoria bloqueada,
+ *                              pilas pre-tocadas, trabajadores con
+ *                              SCHED_FIFO si se permite y el hilo
+ *                              principal en otra CPU; informa los
+ *                              cambios de contexto involuntarios que
+ *                              aún ocurrieron (ver aislamiento.h)
+ *      ./pi_p --techo [H [n]]
+ *                           -> modelo roofline: mide los picos de
+ *                              punto flotante de la máquina (ver
+ *                              techo.h) y, para 1, 2, 4, ... hasta H
+ *                              hilos, el rendimiento logrado por el
+ *                              cálculo como porcentaje de esos picos
  *
  * Parámetros:
  *  - H: número de hilos (entero positivo).
  *  - n: número de subintervalos (entero positivo).
+ *
+ * Los tiempos se miden con reloj.h (TSC invariante calibrado, o
+ * CLOCK_MONOTONIC si no lo hay; RELOJ=monotonic lo fuerza).
+ *
+ * Con la variable de entorno TRAZA=RUTA se escribe en RUTA la línea
+ * de tiempo de los hilos (creación, suma parcial, join) en formato
+ * Chrome trace-event; ver traza.h.
+ *
+ * Sondas USDT (proveedor pi_p, ver sondas.h), para bpftrace o perf:
+ *  - hilo_inicio(hilo), hilo_fin(hilo, iteraciones): vida de cada
+ *    hilo trabajador.
+ *  - tramo_fin(hilo, inicio, fin): un rango de iteraciones terminado
+ *    (el rango completo del hilo, o cada subbloque en el modo con
+ *    caché).
+ *  - reduccion_inicio(partes), parcial(hilo), reduccion_fin(partes):
+ *    la reducción en el hilo principal; parcial se dispara al sumar
+ *    la suma de cada hilo (solo sin caché).
  */
 
 #define _POSIX_C_SOURCE 199309L
@@ -27,14 +69,29 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
-#include <time.h>
+#include <string.h>
 #include <pthread.h>
 
+#include "aislamiento.h"
+#include "cache_pi.h"
+#include "frecuencia.h"
+#include "reloj.h"
+#include "sondas.h"
+#include "techo.h"
+#include "traza.h"
+
 /* Constantes de configuración y referencia */
 static const int    N_INTERVALOS_POR_DEFECTO = 2000000000;
 static const int    HILOS_POR_DEFECTO       = 4;
 static const double PI_REFERENCIA           = 3.141592653589793238462643;
 
+/* Operaciones de punto flotante por subintervalo en
+ * trabajo_suma_parcial: 3 sumas ((double)i + 0.5, 1.0 + x*x y la
+ * acumulación), 2 productos y 1 división. La conversión de i a double
+ * no se cuenta. */
+static const int FLOP_POR_INTERVALO        = 6;
+static const int DIVISIONES_POR_INTERVALO  = 1;
+
 /*
  * DatosHilo
  * -----------------------------------------
@@ -42,29 +99,123 @@ static const double PI_REFERENCIA           = 3.141592653589793238462643;
  *  - indice_inicio: primer índice de iteración (inclusive).
  *  - indice_fin   : último índice de iteración (exclusive).
  *  - paso         : ancho del subintervalo, h = 1.0 / n.
+ *  - indice_hilo  : posición del hilo (0..H-1), para la traza.
+ *  - ciclos       : salida, duración del cómputo (reloj_ciclos).
+ *  - frecuencia   : salida, frecuencia efectiva del cómputo; NULL si
+ *                   no se mide.
+ *  - aislamiento  : modo --bajo-jitter, donde el hilo deja sus cambios
+ *                   de contexto involuntarios; NULL si no se usa.
  */
 typedef struct {
-    int    indice_inicio;
-    int    indice_fin;
-    double paso;
+    int                indice_inicio;
+    int                indice_fin;
+    double             paso;
+    int                indice_hilo;
+    uint64_t           ciclos;
+    LecturaFrecuencia *frecuencia;
+    Aislamiento       *aislamiento;
 } DatosHilo;
 
+/*
+ * DatosHiloCache
+ * -----------------------------------------
+ * Trabajo de un hilo cuando se usa la caché persistente:
+ *  - subbloques   : índices (de TAM_SUBBLOQUE_CACHE iteraciones sobre
+ *                   [0, n)) de los subbloques que faltan, compartido.
+ *  - desde, hasta : posiciones [desde, hasta) de 'subbloques' que
+ *                   calcula este hilo.
+ *  - n            : número total de subintervalos.
+ *  - paso         : ancho del subintervalo, h = 1.0 / n.
+ *  - sumas        : arreglo compartido, una suma por elemento de
+ *                   'subbloques' (posiciones disjuntas entre hilos).
+ *  - indice_hilo  : posición del hilo (0..H-1), para la traza.
+ *  - ciclos       : salida, duración del cómputo (reloj_ciclos).
+ */
+typedef struct {
+    const int64_t *subbloques;
+    int64_t        desde;
+    int64_t        hasta;
+    int            n;
+    double         paso;
+    double        *sumas;
+    int            indice_hilo;
+    uint64_t       ciclos;
+} DatosHiloCache;
+
 /* Prototipos de funciones internas */
-static double calcular_pi_paralelo(int numero_intervalos, int numero_hilos);
+static double calcular_pi_paralelo(int numero_intervalos, int numero_hilos,
+                                   uint64_t *ciclos_hilo,
+                                   LecturaFrecuencia *frecuencias,
+                                   Aislamiento *aislamiento);
+static double calcular_pi_paralelo_con_cache(int numero_intervalos,
+                                             int numero_hilos,
+                                             CachePi *cache,
+                                             int64_t *bloques_reutilizados,
+                                             int64_t *bloques_sin_guardar,
+                                             int *hilos_efectivos,
+                                             uint64_t *ciclos_hilo);
 static void  *trabajo_suma_parcial(void *argumento);
-static double obtener_tiempo(void);
+static void  *trabajo_subbloques_cache(void *argumento);
+static void   mostrar_tiempos_hilos(const uint64_t *ciclos_hilo,
+                                    int numero_hilos);
+static void   mostrar_frecuencias(const LecturaFrecuencia *referencia,
+                                  uint64_t ns_referencia,
+                                  const LecturaFrecuencia *frecuencias,
+                                  const uint64_t *ciclos_hilo,
+                                  int numero_hilos, uint64_t ns_paralelo);
+static void   mostrar_aislamiento(const Aislamiento *aislamiento,
+                                  long involuntarios_principal,
+                                  long involuntarios_proceso);
+static int    ejecutar_techo(int numero_intervalos, int numero_hilos);
+static void   mostrar_picos(const PicosTecho *picos);
 static void   mostrar_uso(const char *nombre_programa);
 
 int main(int argc, char **argv)
 {
     int numero_hilos     = HILOS_POR_DEFECTO;
     int numero_intervalos = N_INTERVALOS_POR_DEFECTO;
+    const char *ruta_cache = NULL;
+    int primer_posicional  = 1;
+    int por_hilo           = 0;
+    int medir_frecuencia   = 0;
+    int techo              = 0;
+    int bajo_jitter        = 0;
+
+    if (traza_iniciar() != 0) {
+        fprintf(stderr, "Advertencia: no se pudo activar la traza.\n");
+    }
+    traza_nombrar_hilo("principal", -1);
 
-    if (argc >= 2) {
-        numero_hilos = atoi(argv[1]);
+    /* Opciones antes de los argumentos posicionales */
+    while (primer_posicional < argc &&
+           strncmp(argv[primer_posicional], "--", 2) == 0) {
+        const char *opcion = argv[primer_posicional];
+        if (strcmp(opcion, "--cache") == 0 && primer_posicional + 1 < argc) {
+            ruta_cache         = argv[primer_posicional + 1];
+            primer_posicional += 2;
+        } else if (strcmp(opcion, "--por-hilo") == 0) {
+            por_hilo = 1;
+            primer_posicional++;
+        } else if (strcmp(opcion, "--frecuencia") == 0) {
+            medir_frecuencia = 1;
+            primer_posicional++;
+        } else if (strcmp(opcion, "--bajo-jitter") == 0) {
+            bajo_jitter = 1;
+            primer_posicional++;
+        } else if (strcmp(opcion, "--techo") == 0) {
+            techo = 1;
+            primer_posicional++;
+        } else {
+            mostrar_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc > primer_posicional) {
+        numero_hilos = atoi(argv[primer_posicional]);
     }
-    if (argc >= 3) {
-        numero_intervalos = atoi(argv[2]);
+    if (argc > primer_posicional + 1) {
+        numero_intervalos = atoi(argv[primer_posicional + 1]);
     }
 
     if (numero_hilos <= 0) {
@@ -81,24 +232,377 @@ int main(int argc, char **argv)
         return EXIT_FAILURE;
     }
 
-    double tiempo_inicio   = obtener_tiempo();
-    double pi_aproximado   = calcular_pi_paralelo(numero_intervalos,
-                                                  numero_hilos);
-    double tiempo_fin      = obtener_tiempo();
+    if (medir_frecuencia && ruta_cache != NULL) {
+        fprintf(stderr, "Error: --frecuencia no se combina con --cache.\n");
+        return EXIT_FAILURE;
+    }
+
+    if (bajo_jitter && ruta_cache != NULL) {
+        fprintf(stderr, "Error: --bajo-jitter no se combina con --cache.\n");
+        return EXIT_FAILURE;
+    }
+
+    if (techo) {
+        if (ruta_cache != NULL || por_hilo || medir_frecuencia || bajo_jitter) {
+            fprintf(stderr, "Error: --techo no se combina con otras opciones.\n");
+            return EXIT_FAILURE;
+        }
+        return (ejecutar_techo(numero_intervalos, numero_hilos) == 0)
+               ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    CachePi cache;
+    int64_t bloques_reutilizados = 0;
+    int64_t bloques_sin_guardar  = 0;
+    int     hilos_efectivos      = numero_hilos;
+
+    if (ruta_cache != NULL && cache_pi_abrir(&cache, ruta_cache) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    uint64_t *ciclos_hilo = (uint64_t *)calloc((size_t)numero_hilos,
+                                               sizeof(uint64_t));
+    LecturaFrecuencia *frecuencias = NULL;
+    if (medir_frecuencia) {
+        frecuencias = (LecturaFrecuencia *)calloc((size_t)numero_hilos,
+                                                  sizeof(LecturaFrecuencia));
+    }
+    if (ciclos_hilo == NULL || (medir_frecuencia && frecuencias == NULL)) {
+        fprintf(stderr, "Error: fallo al reservar memoria para hilos.\n");
+        free(ciclos_hilo);
+        return EXIT_FAILURE;
+    }
+    reloj_iniciar();
+
+    /* Antes de la referencia, para que ambas corran igual */
+    Aislamiento  aislamiento;
+    Aislamiento *usar_aislamiento = NULL;
+    if (bajo_jitter) {
+        if (ai_preparar(&aislamiento, numero_hilos) != 0) {
+            fprintf(stderr, "Error: fallo al reservar las pilas de los hilos.\n");
+            free(ciclos_hilo);
+            free(frecuencias);
+            return EXIT_FAILURE;
+        }
+        usar_aislamiento = &aislamiento;
+    }
+
+    /* Referencia con 1 hilo, para normalizar el speedup */
+    LecturaFrecuencia referencia = { FR_NINGUNA, 0, 0 };
+    uint64_t ciclos_referencia   = 0;
+    uint64_t ns_referencia       = 0;
+    if (medir_frecuencia) {
+        uint64_t inicio = reloj_ns();
+        calcular_pi_paralelo(numero_intervalos, 1, &ciclos_referencia,
+                             &referencia, usar_aislamiento);
+        ns_referencia = reloj_ns() - inicio;
+    }
+
+    long     involuntarios_principal = ai_involuntarios_hilo();
+    long     involuntarios_proceso   = ai_involuntarios_proceso();
+    uint64_t tiempo_inicio = reloj_ns();
+    double   pi_aproximado = (ruta_cache != NULL)
+        ? calcular_pi_paralelo_con_cache(numero_intervalos, numero_hilos,
+                                         &cache, &bloques_reutilizados,
+                                         &bloques_sin_guardar,
+                                         &hilos_efectivos, ciclos_hilo)
+        : calcular_pi_paralelo(numero_intervalos, numero_hilos, ciclos_hilo,
+                               frecuencias, usar_aislamiento);
+    uint64_t tiempo_fin    = reloj_ns();
+    involuntarios_principal = ai_involuntarios_hilo() - involuntarios_principal;
+    involuntarios_proceso   = ai_involuntarios_proceso() - involuntarios_proceso;
 
     printf("\nConfiguración:\n");
     printf("  n (subintervalos) = %d\n", numero_intervalos);
     printf("  H (hilos)         = %d\n", numero_hilos);
+    if (reloj_fuente() == RELOJ_TSC) {
+        printf("  reloj             = tsc (%.3f GHz)\n", reloj_ghz());
+    } else {
+        printf("  reloj             = monotonic\n");
+    }
+    if (ruta_cache != NULL) {
+        printf("  caché             = %s (%lld de %lld bloques reutilizados)\n",
+               ruta_cache,
+               (long long)bloques_reutilizados,
+               (long long)cache_pi_num_bloques(numero_intervalos));
+        if (bloques_sin_guardar > 0) {
+            printf("  sin guardar       = %lld bloques (caché llena o "
+                   "sin bloqueo)\n", (long long)bloques_sin_guardar);
+        }
+        if (hilos_efectivos == 0) {
+            printf("  hilos efectivos   = 0 (todos los bloques estaban en "
+                   "la caché)\n");
+        } else if (hilos_efectivos < numero_hilos) {
+            printf("  hilos efectivos   = %d (no hay más subbloques de "
+                   "2^20 por calcular)\n", hilos_efectivos);
+        }
+        cache_pi_cerrar(&cache);
+    }
 
     printf("\npi se aproxima a      = %.20f\n", pi_aproximado);
     printf("Error absoluto        = %.20f\n",
            fabs(pi_aproximado - PI_REFERENCIA));
     printf("Tiempo paralelo (s)   = %.6f\n",
-           tiempo_fin - tiempo_inicio);
+           (double)(tiempo_fin - tiempo_inicio) * 1e-9);
+    if (por_hilo) {
+        mostrar_tiempos_hilos(ciclos_hilo, numero_hilos);
+    }
+    if (medir_frecuencia) {
+        mostrar_frecuencias(&referencia, ns_referencia, frecuencias,
+                            ciclos_hilo, numero_hilos,
+                            tiempo_fin - tiempo_inicio);
+    }
+    if (bajo_jitter) {
+        mostrar_aislamiento(&aislamiento, involuntarios_principal,
+                            involuntarios_proceso);
+        ai_liberar(&aislamiento);
+    }
 
+    free(ciclos_hilo);
+    free(frecuencias);
     return EXIT_SUCCESS;
 }
 
+/*
+ * ejecutar_techo
+ * -----------------------------------------
+ * Modo --techo. Para H = 1, 2, 4, ... y el propio H, mide los picos
+ * con H hilos (así el pico incluye la bajada de frecuencia de tener
+ * H núcleos activos) y luego el cálculo de pi con H hilos.
+ *
+ * El rendimiento logrado es n * FLOP_POR_INTERVALO sobre el tiempo
+ * paralelo. Se compara con el pico de FMA vectorial, el techo real
+ * de la máquina, y las divisiones con los picos de división escalar
+ * y vectorial: el lazo no se vectoriza (la acumulación en orden
+ * estricto lo impide sin -ffast-math) y cada subintervalo depende de
+ * una división, así que el techo que importa suele ser el de
+ * división escalar.
+ *
+ * Retorna 0, o -1 si no se pudieron medir los picos.
+ */
+static int ejecutar_techo(int numero_intervalos, int numero_hilos)
+{
+    uint64_t *ciclos_hilo = (uint64_t *)calloc((size_t)numero_hilos,
+                                               sizeof(uint64_t));
+    if (ciclos_hilo == NULL) {
+        fprintf(stderr, "Error: fallo al reservar memoria para hilos.\n");
+        return -1;
+    }
+    reloj_iniciar();
+
+    printf("\nConfiguración:\n");
+    printf("  n (subintervalos) = %d\n", numero_intervalos);
+    printf("  H (hilos)         = %d\n", numero_hilos);
+    if (reloj_fuente() == RELOJ_TSC) {
+        printf("  reloj             = tsc (%.3f GHz)\n", reloj_ghz());
+    } else {
+        printf("  reloj             = monotonic\n");
+    }
+    printf("  operaciones       = %d FLOP y %d división por subintervalo\n",
+           FLOP_POR_INTERVALO, DIVISIONES_POR_INTERVALO);
+
+    PicosTecho picos[64];
+    int        cantidad = 0;
+    for (int h = 1; cantidad < 64; h *= 2) {
+        int hilos = (h < numero_hilos) ? h : numero_hilos;
+        if (techo_medir(&picos[cantidad], hilos) != 0) {
+            fprintf(stderr, "Error: no se pudieron medir los picos con %d hilos.\n",
+                    hilos);
+            free(ciclos_hilo);
+            return -1;
+        }
+        cantidad++;
+        if (hilos == numero_hilos) {
+            break;
+        }
+    }
+
+    printf("\nPicos medidos (G/s; FLOP, con la FMA como 2, o divisiones):\n");
+    for (int i = 0; i < cantidad; ++i) {
+        mostrar_picos(&picos[i]);
+    }
+
+    printf("\nRendimiento del cálculo:\n");
+    printf("  %3s  %10s  %8s  %9s  %8s  %9s  %9s\n", "H", "tiempo (s)",
+           "GFLOP/s", "% fma vec", "Gdiv/s", "% div esc", "% div vec");
+    for (int i = 0; i < cantidad; ++i) {
+        const PicosTecho *p = &picos[i];
+        uint64_t inicio = reloj_ns();
+        double pi_aproximado = calcular_pi_paralelo(numero_intervalos, p->hilos,
+                                                    ciclos_hilo, NULL, NULL);
+        double segundos = (double)(reloj_ns() - inicio) * 1e-9;
+        double flops = (double)numero_intervalos * FLOP_POR_INTERVALO / segundos;
+        double divs  = (double)numero_intervalos * DIVISIONES_POR_INTERVALO /
+                       segundos;
+
+        printf("  %3d  %10.6f  %8.3f  %9.2f  %8.3f  %9.2f  %9.2f\n",
+               p->hilos, segundos, flops * 1e-9,
+               (p->vectorial[TECHO_FMA] > 0.0)
+                   ? 100.0 * flops / p->vectorial[TECHO_FMA] : 0.0,
+               divs * 1e-9,
+               100.0 * divs / p->escalar[TECHO_DIVISION],
+               100.0 * divs / p->vectorial[TECHO_DIVISION]);
+        if (fabs(pi_aproximado - PI_REFERENCIA) > 1e-6) {
+            fprintf(stderr, "Advertencia: pi = %.15f con H = %d.\n",
+                    pi_aproximado, p->hilos);
+        }
+    }
+
+    free(ciclos_hilo);
+    return 0;
+}
+
+/* Una fila de picos: escalar / vectorial por operación */
+static void mostrar_picos(const PicosTecho *picos)
+{
+    printf("  H = %d (vector de %d doubles)\n", picos->hilos, picos->ancho);
+    for (int op = 0; op < TECHO_NUM_OPERACIONES; ++op) {
+        printf("    %-9s escalar %8.3f   vectorial %8.3f\n",
+               techo_nombre_operacion((OperacionTecho)op),
+               picos->escalar[op] * 1e-9, picos->vectorial[op] * 1e-9);
+    }
+}
+
+/*
+ * mostrar_aislamiento
+ * -----------------------------------------
+ * Qué medidas del modo --bajo-jitter se aplicaron y cuántos cambios
+ * de contexto involuntarios hubo durante el cálculo: de cada
+ * trabajador, del hilo principal y del proceso completo.
+ */
+static void mostrar_aislamiento(const Aislamiento *aislamiento,
+                                long involuntarios_principal,
+                                long involuntarios_proceso)
+{
+    long total_trabajadores = 0;
+
+    printf("\nBajo jitter:\n");
+    if (aislamiento->memoria_bloqueada) {
+        printf("  memoria bloqueada  = sí (mlockall)\n");
+    } else {
+        printf("  memoria bloqueada  = no (%s)\n",
+               strerror(aislamiento->errno_bloqueo));
+    }
+    printf("  pilas              = %d KiB por hilo, pre-tocadas\n",
+           AI_TAM_PILA / 1024);
+    if (aislamiento->tiempo_real) {
+        printf("  trabajadores       = SCHED_FIFO, prioridad %d\n",
+               aislamiento->prioridad);
+    } else {
+        printf("  trabajadores       = SCHED_OTHER (SCHED_FIFO no permitido)\n");
+    }
+    if (aislamiento->cpu_principal >= 0) {
+        printf("  hilo principal     = CPU %d; trabajadores en %d CPUs más\n",
+               aislamiento->cpu_principal, aislamiento->num_cpus_trabajo);
+    } else {
+        printf("  hilo principal     = sin fijar (una sola CPU disponible)\n");
+    }
+
+    printf("  cambios de contexto involuntarios:\n");
+    for (int h = 0; h < aislamiento->numero_hilos; ++h) {
+        printf("    hilo %3d         = %ld\n", h, aislamiento->involuntarios[h]);
+        total_trabajadores += aislamiento->involuntarios[h];
+    }
+    printf("    trabajadores     = %ld\n", total_trabajadores);
+    printf("    hilo principal   = %ld\n", involuntarios_principal);
+    printf("    proceso          = %ld\n", involuntarios_proceso);
+}
+
+/*
+ * mostrar_frecuencias
+ * -----------------------------------------
+ * Frecuencia efectiva de la referencia con 1 hilo y de cada hilo de
+ * la ejecución paralela, con la fracción de su tiempo que estuvo en
+ * CPU (menos del 100 % indica más hilos que núcleos u otra carga).
+ *
+ * El speedup normalizado corrige el tiempo paralelo a la frecuencia
+ * de la referencia: speedup bruto * f(1 hilo) / f(H hilos), con
+ * f(H hilos) la media ponderada por tiempo en CPU. Si se acerca al
+ * ideal y el bruto no, la pérdida viene de la bajada de frecuencia
+ * y no de la contención.
+ */
+static void mostrar_frecuencias(const LecturaFrecuencia *referencia,
+                                uint64_t ns_referencia,
+                                const LecturaFrecuencia *frecuencias,
+                                const uint64_t *ciclos_hilo,
+                                int numero_hilos, uint64_t ns_paralelo)
+{
+    char     politica[160];
+    uint64_t ciclos = 0, ns_en_cpu = 0;
+
+    fr_politica(politica, sizeof(politica));
+    printf("\nFrecuencia efectiva (fuente: %s):\n",
+           fr_nombre_fuente(referencia->fuente));
+    printf("  escalado de frecuencia = %s\n", politica);
+    printf("  referencia, 1 hilo     = ");
+    if (fr_ghz(referencia) > 0.0) {
+        printf("%.3f GHz, ", fr_ghz(referencia));
+    }
+    printf("%.6f s\n", (double)ns_referencia * 1e-9);
+
+    for (int h = 0; h < numero_hilos; ++h) {
+        const LecturaFrecuencia *l = &frecuencias[h];
+        uint64_t ns_hilo = reloj_ciclos_a_ns(ciclos_hilo[h]);
+        double en_cpu = (ns_hilo > 0)
+                        ? 100.0 * (double)l->ns_en_cpu / (double)ns_hilo : 0.0;
+
+        printf("  hilo %3d               = ", h);
+        if (fr_ghz(l) > 0.0) {
+            printf("%.3f GHz, ", fr_ghz(l));
+            ciclos    += l->ciclos;
+            ns_en_cpu += l->ns_en_cpu;
+        }
+        printf("%.1f %% en CPU\n", en_cpu);
+    }
+
+    double bruto = (ns_paralelo > 0)
+                   ? (double)ns_referencia / (double)ns_paralelo : 0.0;
+    printf("  speedup bruto          = %.3f\n", bruto);
+    if (fr_ghz(referencia) > 0.0 && ciclos > 0) {
+        double media = (double)ciclos / (double)ns_en_cpu;
+        printf("  frecuencia media (H=%d) = %.3f GHz\n", numero_hilos, media);
+        printf("  speedup normalizado    = %.3f\n",
+               bruto * fr_ghz(referencia) / media);
+    } else {
+        printf("  speedup normalizado    = n/d (sin contador de ciclos)\n");
+    }
+}
+
+/*
+ * mostrar_tiempos_hilos
+ * -----------------------------------------
+ * Tiempo de cómputo de cada hilo (sin creación ni join) y el
+ * desbalance entre el más lento y el más rápido. Los hilos sin
+ * trabajo (modo con caché, todo reutilizado) no se muestran.
+ */
+static void mostrar_tiempos_hilos(const uint64_t *ciclos_hilo,
+                                  int numero_hilos)
+{
+    uint64_t minimo = UINT64_MAX, maximo = 0;
+
+    printf("\nTiempo por hilo:\n");
+    for (int h = 0; h < numero_hilos; ++h) {
+        if (ciclos_hilo[h] == 0) {
+            continue;
+        }
+        double segundos = (double)reloj_ciclos_a_ns(ciclos_hilo[h]) * 1e-9;
+        if (reloj_fuente() == RELOJ_TSC) {
+            printf("  hilo %3d: %.6f s (%llu ciclos)\n", h, segundos,
+                   (unsigned long long)ciclos_hilo[h]);
+        } else {
+            printf("  hilo %3d: %.6f s\n", h, segundos);
+        }
+        minimo = (ciclos_hilo[h] < minimo) ? ciclos_hilo[h] : minimo;
+        maximo = (ciclos_hilo[h] > maximo) ? ciclos_hilo[h] : maximo;
+    }
+    if (maximo > 0) {
+        printf("  desbalance (máx/mín) = %.3f\n",
+               (double)maximo / (double)minimo);
+    } else {
+        printf("  (ningún hilo tuvo bloques por calcular)\n");
+    }
+}
+
 /*
  * mostrar_uso
  * -----------------------------------------
@@ -110,11 +614,26 @@ static void mostrar_uso(const char *nombre_programa)
             "Uso:\n"
             "  %s              -> H = %d, n = %d\n"
             "  %s H            -> H hilos, n por defecto\n"
-            "  %s H n          -> H hilos y n subintervalos\n",
+            "  %s H n          -> H hilos y n subintervalos\n"
+            "  %s --cache RUTA [H [n]]\n"
+            "                  -> usa la caché persistente RUTA\n"
+            "  %s --por-hilo [H [n]]\n"
+            "                  -> informa el tiempo de cada hilo\n"
+            "  %s --frecuencia [H [n]]\n"
+            "                  -> frecuencia efectiva y speedup normalizado\n"
+            "  %s --bajo-jitter [H [n]]\n"
+            "                  -> mide con poco ruido e informa cambios de contexto\n"
+            "  %s --techo [H [n]]\n"
+            "                  -> rendimiento como porcentaje de los picos\n",
             nombre_programa,
             HILOS_POR_DEFECTO,
             N_INTERVALOS_POR_DEFECTO,
             nombre_programa,
+            nombre_programa,
+            nombre_programa,
+            nombre_programa,
+            nombre_programa,
+            nombre_programa,
             nombre_programa);
 }
 
@@ -140,10 +659,32 @@ static void *trabajo_suma_parcial(void *argumento)
     DatosHilo *datos = (DatosHilo *)argumento;
     double suma_local = 0.0;
 
+    SONDA1(pi_p, hilo_inicio, datos->indice_hilo);
+    traza_nombrar_hilo("hilo", datos->indice_hilo);
+    traza_comenzar("suma_parcial", "inicio", datos->indice_inicio,
+                   "fin", datos->indice_fin);
+    MedidorFrecuencia medidor;
+    if (datos->frecuencia != NULL) {
+        fr_iniciar(&medidor);
+    }
+    uint64_t inicio = reloj_ciclos();
     for (int i = datos->indice_inicio; i < datos->indice_fin; ++i) {
         double x = datos->paso * ((double)i + 0.5);
         suma_local += 4.0 / (1.0 + x * x);
     }
+    datos->ciclos = reloj_ciclos() - inicio;
+    if (datos->frecuencia != NULL) {
+        fr_detener(&medidor, datos->frecuencia);
+    }
+    traza_terminar("suma_parcial");
+    SONDA3(pi_p, tramo_fin, datos->indice_hilo, datos->indice_inicio,
+           datos->indice_fin);
+    SONDA2(pi_p, hilo_fin, datos->indice_hilo,
+           datos->indice_fin - datos->indice_inicio);
+    if (datos->aislamiento != NULL) {
+        datos->aislamiento->involuntarios[datos->indice_hilo] =
+            ai_involuntarios_hilo();
+    }
 
     double *resultado = (double *)malloc(sizeof(double));
     if (resultado == NULL) {
@@ -166,6 +707,11 @@ static void *trabajo_suma_parcial(void *argumento)
  * Parámetros:
  *  - numero_intervalos: número total de subintervalos.
  *  - numero_hilos     : número de hilos a crear.
+ *  - ciclos_hilo      : salida, duración del cómputo de cada hilo.
+ *  - frecuencias      : salida, frecuencia efectiva de cada hilo; NULL
+ *                       si no se mide.
+ *  - aislamiento      : modo --bajo-jitter (pila, CPU y política de
+ *                       cada hilo); NULL para crearlos por defecto.
  *
  * Retorna:
  *  - Aproximación de pi como número de doble precisión.
@@ -174,7 +720,10 @@ static void *trabajo_suma_parcial(void *argumento)
  *  - En caso de error grave de memoria o creación de hilos,
  *    se imprime un mensaje y el programa termina con EXIT_FAILURE.
  */
-static double calcular_pi_paralelo(int numero_intervalos, int numero_hilos)
+static double calcular_pi_paralelo(int numero_intervalos, int numero_hilos,
+                                   uint64_t *ciclos_hilo,
+                                   LecturaFrecuencia *frecuencias,
+                                   Aislamiento *aislamiento)
 {
     const double paso = 1.0 / (double)numero_intervalos;
 
@@ -202,13 +751,28 @@ static double calcular_pi_paralelo(int numero_intervalos, int numero_hilos)
         datos_hilos[h].indice_inicio = inicio_actual;
         datos_hilos[h].indice_fin    = inicio_actual + tam_bloque + extra;
         datos_hilos[h].paso          = paso;
+        datos_hilos[h].indice_hilo   = h;
+        datos_hilos[h].frecuencia    = (frecuencias != NULL) ? &frecuencias[h]
+                                                             : NULL;
+        datos_hilos[h].aislamiento   = aislamiento;
 
         inicio_actual = datos_hilos[h].indice_fin;
 
+        pthread_attr_t  atributos;
+        pthread_attr_t *usar_atributos = NULL;
+        if (aislamiento != NULL && ai_atributos(aislamiento, h, &atributos) == 0) {
+            usar_atributos = &atributos;
+        }
+
+        uint64_t marca = traza_ahora();
         int codigo = pthread_create(&hilos[h],
-                                    NULL,
+                                    usar_atributos,
                                     trabajo_suma_parcial,
                                     &datos_hilos[h]);
+        traza_completo("crear", marca, "hilo", h);
+        if (usar_atributos != NULL) {
+            pthread_attr_destroy(usar_atributos);
+        }
         if (codigo != 0) {
             fprintf(stderr,
                     "Error al crear el hilo %d (código %d).\n", h, codigo);
@@ -225,9 +789,13 @@ static double calcular_pi_paralelo(int numero_intervalos, int numero_hilos)
     /* Recolección de resultados parciales */
     double suma_global = 0.0;
 
+    SONDA1(pi_p, reduccion_inicio, numero_hilos);
+
     for (int h = 0; h < numero_hilos; ++h) {
         void *retorno = NULL;
+        uint64_t marca = traza_ahora();
         int codigo = pthread_join(hilos[h], &retorno);
+        traza_completo("join", marca, "hilo", h);
         if (codigo != 0) {
             fprintf(stderr,
                     "Error en pthread_join para el hilo %d (código %d).\n",
@@ -239,11 +807,14 @@ static double calcular_pi_paralelo(int numero_intervalos, int numero_hilos)
             double *suma_parcial = (double *)retorno;
             suma_global += *suma_parcial;
             free(suma_parcial);
+            ciclos_hilo[h] = datos_hilos[h].ciclos;
+            SONDA1(pi_p, parcial, h);
         } else {
             fprintf(stderr,
                     "Advertencia: el hilo %d retornó NULL.\n", h);
         }
     }
+    SONDA1(pi_p, reduccion_fin, numero_hilos);
 
     free(hilos);
     free(datos_hilos);
@@ -252,16 +823,239 @@ static double calcular_pi_paralelo(int numero_intervalos, int numero_hilos)
 }
 
 /*
- * obtener_tiempo
+ * trabajo_subbloques_cache
+ * -----------------------------------------
+ * Función ejecutada por cada hilo en el modo con caché.
+ *
+ * Parámetro:
+ *  - argumento: puntero a DatosHiloCache.
+ *
+ * Comportamiento:
+ *  - Para cada subbloque asignado, acumula f(x_i) sobre su rango de
+ *    índices y escribe la suma en sumas[k]. Sumar los subbloques en
+ *    bloques y publicarlos en la caché queda para el hilo principal,
+ *    porque un bloque puede repartirse entre dos hilos.
+ *  - No retorna datos mediante pthread_exit.
+ */
+static void *trabajo_subbloques_cache(void *argumento)
+{
+    DatosHiloCache *datos = (DatosHiloCache *)argumento;
+    int64_t iteraciones = 0;
+    uint64_t inicio     = reloj_ciclos();
+
+    SONDA1(pi_p, hilo_inicio, datos->indice_hilo);
+    traza_nombrar_hilo("hilo", datos->indice_hilo);
+    for (int64_t k = datos->desde; k < datos->hasta; ++k) {
+        int64_t primero = datos->subbloques[k] * TAM_SUBBLOQUE_CACHE;
+        int64_t ultimo  = primero + TAM_SUBBLOQUE_CACHE;
+        if (ultimo > datos->n) {
+            ultimo = datos->n;
+        }
+        double suma_local = 0.0;
+
+        traza_comenzar("subbloque", "subbloque", datos->subbloques[k],
+                       "inicio", primero);
+        for (int64_t i = primero; i < ultimo; ++i) {
+            double x = datos->paso * ((double)i + 0.5);
+            suma_local += 4.0 / (1.0 + x * x);
+        }
+
+        datos->sumas[k] = suma_local;
+        traza_terminar("subbloque");
+        SONDA3(pi_p, tramo_fin, datos->indice_hilo, primero, ultimo);
+        iteraciones += ultimo - primero;
+    }
+    datos->ciclos = reloj_ciclos() - inicio;
+    SONDA2(pi_p, hilo_fin, datos->indice_hilo, iteraciones);
+
+    pthread_exit(NULL);
+}
+
+/*
+ * calcular_pi_paralelo_con_cache
  * -----------------------------------------
- * Retorna un timestamp en segundos, usando un reloj
- * de alta resolución (CLOCK_MONOTONIC).
+ * Variante de calcular_pi_paralelo que recorre [0, n) en los
+ * bloques de la rejilla común de cache_pi.h:
+ *  - Los bloques presentes en la caché se reutilizan directamente.
+ *  - Los subbloques de los bloques faltantes se reparten en tramos
+ *    contiguos entre los H hilos, aunque falte un solo bloque; un
+ *    bloque puede quedar repartido entre dos hilos.
+ *  - El hilo principal suma los subbloques de cada bloque en orden y
+ *    publica el bloque completo en la caché.
+ *
+ * Como cada bloque se acumula subbloque a subbloque y la suma final
+ * bloque a bloque, siempre en orden, el resultado es idéntico al de
+ * './pi --cache' para cualquier H. El reparto es de a subbloques
+ * (2^20 iteraciones): si faltan menos subbloques que H, se crean
+ * tantos hilos como subbloques.
+ *
+ * Parámetros:
+ *  - numero_intervalos   : número total de subintervalos.
+ *  - numero_hilos        : número máximo de hilos a crear.
+ *  - cache               : caché abierta con cache_pi_abrir.
+ *  - bloques_reutilizados: salida, bloques encontrados en la caché.
+ *  - bloques_sin_guardar : salida, bloques calculados que
+ *                          cache_pi_guardar no pudo almacenar.
+ *  - hilos_efectivos     : salida, hilos creados (0 si todos los
+ *                          bloques estaban en la caché).
+ *  - ciclos_hilo         : salida, duración del cómputo de cada hilo.
+ *
+ * Retorna:
+ *  - Aproximación de pi como número de doble precisión.
  */
-static double obtener_tiempo(void)
+static double calcular_pi_paralelo_con_cache(int numero_intervalos,
+                                             int numero_hilos,
+                                             CachePi *cache,
+                                             int64_t *bloques_reutilizados,
+                                             int64_t *bloques_sin_guardar,
+                                             int *hilos_efectivos,
+                                             uint64_t *ciclos_hilo)
 {
-    struct timespec instante;
+    const double  paso        = 1.0 / (double)numero_intervalos;
+    const int64_t num_bloques = cache_pi_num_bloques(numero_intervalos);
+    const int64_t num_subbloques_total =
+        ((int64_t)numero_intervalos + TAM_SUBBLOQUE_CACHE - 1) /
+        TAM_SUBBLOQUE_CACHE;
 
-    clock_gettime(CLOCK_MONOTONIC, &instante);
+    double  *sumas_bloque = (double *)malloc(sizeof(double) * (size_t)num_bloques);
+    int64_t *faltantes    = (int64_t *)malloc(sizeof(int64_t) * (size_t)num_bloques);
+    int64_t *subbloques   = (int64_t *)malloc(sizeof(int64_t) *
+                                              (size_t)num_subbloques_total);
+    double  *sumas        = (double *)malloc(sizeof(double) *
+                                             (size_t)num_subbloques_total);
+    pthread_t *hilos      = (pthread_t *)malloc(sizeof(pthread_t) * numero_hilos);
+    DatosHiloCache *datos_hilos =
+        (DatosHiloCache *)malloc(sizeof(DatosHiloCache) * numero_hilos);
 
-    return (double)instante.tv_sec + (double)instante.tv_nsec * 1e-9;
+    if (sumas_bloque == NULL || faltantes == NULL || subbloques == NULL ||
+        sumas == NULL || hilos == NULL || datos_hilos == NULL) {
+        fprintf(stderr, "Error: fallo al reservar memoria para hilos.\n");
+        free(sumas_bloque);
+        free(faltantes);
+        free(subbloques);
+        free(sumas);
+        free(hilos);
+        free(datos_hilos);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Consulta de la caché: solo los subbloques de los bloques
+     * ausentes van a los hilos */
+    uint64_t marca_consulta = traza_ahora();
+    int64_t num_faltantes  = 0;
+    int64_t num_subbloques = 0;
+    *bloques_reutilizados = 0;
+
+    for (int64_t b = 0; b < num_bloques; ++b) {
+        ClaveCache clave = cache_pi_clave_bloque(numero_intervalos, b);
+        if (cache_pi_buscar(cache, &clave, &sumas_bloque[b])) {
+            (*bloques_reutilizados)++;
+            continue;
+        }
+        faltantes[num_faltantes++] = b;
+        for (int64_t s = b * SUBBLOQUES_POR_BLOQUE;
+             s < (b + 1) * SUBBLOQUES_POR_BLOQUE && s < num_subbloques_total;
+             ++s) {
+            subbloques[num_subbloques++] = s;
+        }
+    }
+    traza_completo("consulta_cache", marca_consulta,
+                   "reutilizados", *bloques_reutilizados);
+
+    /* No tiene sentido crear más hilos que subbloques por calcular */
+    int hilos_usados = numero_hilos;
+    if ((int64_t)hilos_usados > num_subbloques) {
+        hilos_usados = (int)num_subbloques;
+    }
+    *hilos_efectivos = hilos_usados;
+
+    int64_t tam_tramo = (hilos_usados > 0) ? num_subbloques / hilos_usados : 0;
+    int64_t resto     = (hilos_usados > 0) ? num_subbloques % hilos_usados : 0;
+    int64_t inicio_actual = 0;
+
+    for (int h = 0; h < hilos_usados; ++h) {
+        int64_t cantidad = tam_tramo + ((h < resto) ? 1 : 0);
+
+        datos_hilos[h].subbloques  = subbloques;
+        datos_hilos[h].desde       = inicio_actual;
+        datos_hilos[h].hasta       = inicio_actual + cantidad;
+        datos_hilos[h].n           = numero_intervalos;
+        datos_hilos[h].paso        = paso;
+        datos_hilos[h].sumas       = sumas;
+        datos_hilos[h].indice_hilo = h;
+
+        inicio_actual += cantidad;
+
+        uint64_t marca = traza_ahora();
+        int codigo = pthread_create(&hilos[h],
+                                    NULL,
+                                    trabajo_subbloques_cache,
+                                    &datos_hilos[h]);
+        traza_completo("crear", marca, "hilo", h);
+        if (codigo != 0) {
+            fprintf(stderr,
+                    "Error al crear el hilo %d (código %d).\n", h, codigo);
+            for (int j = 0; j < h; ++j) {
+                pthread_join(hilos[j], NULL);
+            }
+            free(sumas_bloque);
+            free(faltantes);
+            free(subbloques);
+            free(sumas);
+            free(hilos);
+            free(datos_hilos);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (int h = 0; h < hilos_usados; ++h) {
+        uint64_t marca = traza_ahora();
+        int codigo = pthread_join(hilos[h], NULL);
+        traza_completo("join", marca, "hilo", h);
+        if (codigo != 0) {
+            fprintf(stderr,
+                    "Error en pthread_join para el hilo %d (código %d).\n",
+                    h, codigo);
+            continue;
+        }
+        ciclos_hilo[h] = datos_hilos[h].ciclos;
+    }
+
+    /* Bloques faltantes: sus subbloques en orden, y a la caché */
+    uint64_t marca_publicar = traza_ahora();
+    int64_t k = 0;
+    *bloques_sin_guardar = 0;
+    for (int64_t f = 0; f < num_faltantes; ++f) {
+        int64_t    b     = faltantes[f];
+        ClaveCache clave = cache_pi_clave_bloque(numero_intervalos, b);
+        double     suma_bloque = 0.0;
+        for (; k < num_subbloques &&
+               subbloques[k] < (b + 1) * SUBBLOQUES_POR_BLOQUE; ++k) {
+            suma_bloque += sumas[k];
+        }
+        sumas_bloque[b] = suma_bloque;
+        if (cache_pi_guardar(cache, &clave, suma_bloque) != 0) {
+            (*bloques_sin_guardar)++;
+        }
+    }
+    traza_completo("publicar_cache", marca_publicar, "bloques", num_faltantes);
+
+    /* Reducción en orden de bloque: independiente de H */
+    uint64_t marca = traza_ahora();
+    double suma_global = 0.0;
+    SONDA1(pi_p, reduccion_inicio, num_bloques);
+    for (int64_t b = 0; b < num_bloques; ++b) {
+        suma_global += sumas_bloque[b];
+    }
+    SONDA1(pi_p, reduccion_fin, num_bloques);
+    traza_completo("reduccion", marca, "bloques", num_bloques);
+
+    free(sumas_bloque);
+    free(faltantes);
+    free(subbloques);
+    free(sumas);
+    free(hilos);
+    free(datos_hilos);
+
+    return paso * suma_global;
 }
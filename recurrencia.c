@@ -0,0 +1,511 @@
+/*
+ * recurrencia.c
+ * -----------------------------------------
+ * Implementación del motor de recurrencias lineales declarado en
+ * recurrencia.h.
+ *
+ * Los polinomios de grado < k se guardan como arreglos de k
+ * coeficientes (pol[j] acompaña a x^j) y representan clases módulo
+ * el polinomio característico P(x). Si x^n = sum d_j x^j (mod P),
+ * entonces a(n) = sum d_j a(j).
+ */
+
+#include "recurrencia.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef unsigned __int128 u128;
+
+/*
+ * DefinicionPredefinida
+ * -----------------------------------------
+ * Coeficientes y semillas de una recurrencia con nombre.
+ */
+typedef struct {
+    const char *nombre;
+    const char *coeficientes;
+    const char *semillas;
+} DefinicionPredefinida;
+
+/*
+ * TareaBloque
+ * -----------------------------------------
+ * Bloque contiguo de la secuencia asignado a un hilo.
+ */
+typedef struct {
+    const Recurrencia *recurrencia;
+    uint64_t           inicio;
+    uint64_t          *destino;
+    size_t             cantidad;
+} TareaBloque;
+
+static const DefinicionPredefinida PREDEFINIDAS[] = {
+    { "fibonacci",  "1,1",     "0,1"     },
+    { "lucas",      "1,1",     "2,1"     },
+    { "pell",       "2,1",     "0,1"     },
+    { "pell-lucas", "2,1",     "2,2"     },
+    { "jacobsthal", "1,2",     "0,1"     },
+    { "tribonacci", "1,1,1",   "0,0,1"   },
+    { "tetranacci", "1,1,1,1", "0,0,0,1" },
+    { "padovan",    "0,1,1",   "1,1,1"   },
+};
+
+#define NUM_PREDEFINIDAS (sizeof(PREDEFINIDAS) / sizeof(PREDEFINIDAS[0]))
+
+/* Prototipos de funciones internas */
+static int      leer_lista(const char *texto, uint64_t modulo,
+                           uint64_t *valores, int *cantidad);
+static uint64_t mod_sumar(uint64_t a, uint64_t b, uint64_t m);
+static uint64_t mod_mul(uint64_t a, uint64_t b, uint64_t m);
+static void     pol_multiplicar(const Recurrencia *r, const uint64_t *a,
+                                const uint64_t *b, uint64_t *resultado);
+static void     pol_por_x(const Recurrencia *r, uint64_t *pol);
+static void     potencia_x(const Recurrencia *r, uint64_t n, uint64_t *pol);
+static uint64_t evaluar(const Recurrencia *r, const uint64_t *pol);
+static void     potencia_x_orden2(const Recurrencia *r, uint64_t n,
+                                  uint64_t *u, uint64_t *v);
+static void     continuar(const Recurrencia *r, uint64_t *destino,
+                          size_t cantidad);
+static void    *hilo_bloque(void *argumento);
+
+int rec_definir(Recurrencia *r, const char *coeficientes,
+                const char *semillas, uint64_t modulo)
+{
+    int num_coeficientes = 0;
+    int num_semillas     = 0;
+
+    if (modulo == 1) {
+        return -1;
+    }
+    if (leer_lista(coeficientes, modulo, r->coeficientes,
+                   &num_coeficientes) != 0 ||
+        leer_lista(semillas, modulo, r->semillas, &num_semillas) != 0 ||
+        num_coeficientes != num_semillas) {
+        return -1;
+    }
+
+    r->orden  = num_coeficientes;
+    r->modulo = modulo;
+    return 0;
+}
+
+int rec_predefinida(Recurrencia *r, const char *nombre, uint64_t modulo)
+{
+    for (size_t i = 0; i < NUM_PREDEFINIDAS; ++i) {
+        if (strcmp(nombre, PREDEFINIDAS[i].nombre) == 0) {
+            return rec_definir(r, PREDEFINIDAS[i].coeficientes,
+                               PREDEFINIDAS[i].semillas, modulo);
+        }
+    }
+    return -1;
+}
+
+const char *rec_nombres_predefinidos(void)
+{
+    return "fibonacci lucas pell pell-lucas jacobsthal tribonacci "
+           "tetranacci padovan";
+}
+
+/*
+ * rec_termino
+ * -----------------------------------------
+ * a(n) = sum d_j a(j), con x^n = sum d_j x^j (mod P).
+ */
+uint64_t rec_termino(const Recurrencia *r, uint64_t n)
+{
+    if (n < (uint64_t)r->orden) {
+        return r->semillas[n];
+    }
+
+    if (r->orden == 2) {
+        uint64_t u, v;
+        potencia_x_orden2(r, n, &u, &v);
+        return mod_sumar(mod_mul(u, r->semillas[1], r->modulo),
+                         mod_mul(v, r->semillas[0], r->modulo), r->modulo);
+    }
+
+    uint64_t pol[RECURRENCIA_ORDEN_MAX];
+    potencia_x(r, n, pol);
+    return evaluar(r, pol);
+}
+
+/*
+ * rec_estado
+ * -----------------------------------------
+ * Calcula x^n una sola vez y obtiene los k - 1 términos siguientes
+ * multiplicando por x, lo que cuesta O(k) cada vez.
+ */
+void rec_estado(const Recurrencia *r, uint64_t n, uint64_t *ventana)
+{
+    const int k = r->orden;
+
+    if (n < (uint64_t)k) {
+        /* La ventana arranca dentro de las semillas */
+        uint64_t completa[2 * RECURRENCIA_ORDEN_MAX];
+        memcpy(completa, r->semillas, sizeof(uint64_t) * (size_t)k);
+        continuar(r, completa, (size_t)n);
+        memcpy(ventana, completa + n, sizeof(uint64_t) * (size_t)k);
+        return;
+    }
+
+    if (k == 2) {
+        uint64_t u, v;
+        potencia_x_orden2(r, n, &u, &v);
+        uint64_t a0 = r->semillas[0], a1 = r->semillas[1];
+        uint64_t m = r->modulo;
+        ventana[0] = mod_sumar(mod_mul(u, a1, m), mod_mul(v, a0, m), m);
+        /* x^(n+1) = (u p + v) x + u q */
+        uint64_t u1 = mod_sumar(mod_mul(u, r->coeficientes[0], m), v, m);
+        uint64_t v1 = mod_mul(u, r->coeficientes[1], m);
+        ventana[1] = mod_sumar(mod_mul(u1, a1, m), mod_mul(v1, a0, m), m);
+        return;
+    }
+
+    uint64_t pol[RECURRENCIA_ORDEN_MAX];
+    potencia_x(r, n, pol);
+    for (int i = 0; i < k; ++i) {
+        if (i > 0) {
+            pol_por_x(r, pol);
+        }
+        ventana[i] = evaluar(r, pol);
+    }
+}
+
+/*
+ * rec_llenar
+ * -----------------------------------------
+ * Los primeros k términos salen de rec_estado; el resto, de la
+ * recurrencia aplicada sobre el propio arreglo de destino.
+ */
+void rec_llenar(const Recurrencia *r, uint64_t inicio,
+                uint64_t *destino, size_t cantidad)
+{
+    const size_t k = (size_t)r->orden;
+    uint64_t ventana[RECURRENCIA_ORDEN_MAX];
+
+    if (cantidad == 0) {
+        return;
+    }
+
+    rec_estado(r, inicio, ventana);
+    if (cantidad <= k) {
+        memcpy(destino, ventana, sizeof(uint64_t) * cantidad);
+        return;
+    }
+
+    memcpy(destino, ventana, sizeof(uint64_t) * k);
+    continuar(r, destino, cantidad - k);
+}
+
+int rec_llenar_paralelo(const Recurrencia *r, uint64_t inicio,
+                        uint64_t *destino, size_t cantidad, int hilos)
+{
+    if (hilos < 1) {
+        return -1;
+    }
+
+    /* Bloques pequeños no compensan el salto ni la creación del hilo */
+    size_t minimo = 4096;
+    if ((size_t)hilos > cantidad / minimo) {
+        hilos = (int)(cantidad / minimo);
+    }
+    if (hilos <= 1) {
+        rec_llenar(r, inicio, destino, cantidad);
+        return 0;
+    }
+
+    pthread_t   *ids    = (pthread_t *)malloc(sizeof(pthread_t) * (size_t)hilos);
+    TareaBloque *tareas = (TareaBloque *)malloc(sizeof(TareaBloque) * (size_t)hilos);
+    int         *creado = (int *)calloc((size_t)hilos, sizeof(int));
+    if (ids == NULL || tareas == NULL || creado == NULL) {
+        free(ids);
+        free(tareas);
+        free(creado);
+        return -1;
+    }
+
+    size_t base  = cantidad / (size_t)hilos;
+    size_t resto = cantidad % (size_t)hilos;
+    size_t desplazamiento = 0;
+
+    for (int t = 0; t < hilos; ++t) {
+        size_t tam = base + ((size_t)t < resto ? 1 : 0);
+        tareas[t].recurrencia = r;
+        tareas[t].inicio      = inicio + desplazamiento;
+        tareas[t].destino     = destino + desplazamiento;
+        tareas[t].cantidad    = tam;
+        desplazamiento += tam;
+
+        creado[t] = (pthread_create(&ids[t], NULL, hilo_bloque,
+                                    &tareas[t]) == 0);
+    }
+
+    for (int t = 0; t < hilos; ++t) {
+        if (creado[t]) {
+            pthread_join(ids[t], NULL);
+        } else {
+            /* Sin hilo disponible: el bloque se llena aquí */
+            hilo_bloque(&tareas[t]);
+        }
+    }
+
+    free(ids);
+    free(tareas);
+    free(creado);
+    return 0;
+}
+
+/*
+ * leer_lista
+ * -----------------------------------------
+ * Interpreta "v1,v2,...". Los valores negativos se llevan a su
+ * clase módulo 'modulo' (complemento a dos si modulo == 0).
+ */
+static int leer_lista(const char *texto, uint64_t modulo,
+                      uint64_t *valores, int *cantidad)
+{
+    const char *cursor = texto;
+    int n = 0;
+
+    if (texto == NULL || *texto == '\0') {
+        return -1;
+    }
+
+    for (;;) {
+        char *fin = NULL;
+        int negativo = (*cursor == '-');
+        if (negativo) {
+            cursor++;
+        }
+        if (*cursor < '0' || *cursor > '9' || n >= RECURRENCIA_ORDEN_MAX) {
+            return -1;
+        }
+
+        errno = 0;
+        unsigned long long v = strtoull(cursor, &fin, 10);
+        if (errno != 0) {
+            return -1;
+        }
+
+        uint64_t valor = (modulo != 0) ? (uint64_t)v % modulo : (uint64_t)v;
+        if (negativo && valor != 0) {
+            valor = (modulo != 0) ? modulo - valor : (uint64_t)0 - valor;
+        }
+        valores[n++] = valor;
+
+        if (*fin == '\0') {
+            break;
+        }
+        if (*fin != ',') {
+            return -1;
+        }
+        cursor = fin + 1;
+    }
+
+    *cantidad = n;
+    return 0;
+}
+
+/* Suma y producto módulo m (m == 0: módulo 2^64), con a, b < m */
+static inline uint64_t mod_sumar(uint64_t a, uint64_t b, uint64_t m)
+{
+    uint64_t s = a + b;
+
+    if (m != 0 && (s < a || s >= m)) {
+        s -= m;
+    }
+    return s;
+}
+
+static inline uint64_t mod_mul(uint64_t a, uint64_t b, uint64_t m)
+{
+    return (m != 0) ? (uint64_t)((u128)a * b % m) : a * b;
+}
+
+/*
+ * pol_multiplicar
+ * -----------------------------------------
+ * resultado = a * b mod P. Los términos de grado i >= k se
+ * reducen con x^i = sum c_j x^(i-j), de mayor a menor grado.
+ */
+static void pol_multiplicar(const Recurrencia *r, const uint64_t *a,
+                            const uint64_t *b, uint64_t *resultado)
+{
+    const int k = r->orden;
+    const uint64_t m = r->modulo;
+    uint64_t producto[2 * RECURRENCIA_ORDEN_MAX] = { 0 };
+
+    for (int i = 0; i < k; ++i) {
+        if (a[i] == 0) {
+            continue;
+        }
+        for (int j = 0; j < k; ++j) {
+            producto[i + j] = mod_sumar(producto[i + j],
+                                        mod_mul(a[i], b[j], m), m);
+        }
+    }
+
+    for (int i = 2 * k - 2; i >= k; --i) {
+        uint64_t t = producto[i];
+        if (t == 0) {
+            continue;
+        }
+        for (int j = 1; j <= k; ++j) {
+            producto[i - j] = mod_sumar(producto[i - j],
+                                        mod_mul(t, r->coeficientes[j - 1], m), m);
+        }
+    }
+
+    memcpy(resultado, producto, sizeof(uint64_t) * (size_t)k);
+}
+
+/* pol = pol * x mod P */
+static void pol_por_x(const Recurrencia *r, uint64_t *pol)
+{
+    const int k = r->orden;
+    const uint64_t m = r->modulo;
+    uint64_t alto = pol[k - 1];
+
+    for (int j = k - 1; j > 0; --j) {
+        pol[j] = pol[j - 1];
+    }
+    pol[0] = 0;
+
+    /* alto * x^k = alto * sum c_j x^(k-j) */
+    for (int j = 1; j <= k; ++j) {
+        pol[k - j] = mod_sumar(pol[k - j],
+                               mod_mul(alto, r->coeficientes[j - 1], m), m);
+    }
+}
+
+/* pol = x^n mod P, recorriendo los bits de n de mayor a menor */
+static void potencia_x(const Recurrencia *r, uint64_t n, uint64_t *pol)
+{
+    const int k = r->orden;
+
+    memset(pol, 0, sizeof(uint64_t) * (size_t)k);
+    pol[0] = 1;
+
+    for (int bit = 63 - __builtin_clzll(n | 1); bit >= 0; --bit) {
+        pol_multiplicar(r, pol, pol, pol);
+        if ((n >> bit) & 1u) {
+            pol_por_x(r, pol);
+        }
+    }
+}
+
+static uint64_t evaluar(const Recurrencia *r, const uint64_t *pol)
+{
+    uint64_t suma = 0;
+
+    for (int j = 0; j < r->orden; ++j) {
+        suma = mod_sumar(suma, mod_mul(pol[j], r->semillas[j], r->modulo),
+                         r->modulo);
+    }
+    return suma;
+}
+
+/*
+ * potencia_x_orden2
+ * -----------------------------------------
+ * x^n = u x + v (mod x^2 - p x - q), con las fórmulas cerradas
+ *
+ *   (u x + v)^2 = (p u^2 + 2 u v) x + (q u^2 + v^2)
+ *   (u x + v) x = (p u + v) x + q u
+ *
+ * que evitan los bucles genéricos de pol_multiplicar.
+ */
+static void potencia_x_orden2(const Recurrencia *r, uint64_t n,
+                              uint64_t *u, uint64_t *v)
+{
+    const uint64_t p = r->coeficientes[0];
+    const uint64_t q = r->coeficientes[1];
+    const uint64_t m = r->modulo;
+    uint64_t a = 0, b = 1;   /* x^0 = 0 x + 1 */
+
+    for (int bit = 63 - __builtin_clzll(n | 1); bit >= 0; --bit) {
+        uint64_t aa = mod_mul(a, a, m);
+        uint64_t ab = mod_mul(a, b, m);
+        uint64_t na = mod_sumar(mod_mul(p, aa, m), mod_sumar(ab, ab, m), m);
+        uint64_t nb = mod_sumar(mod_mul(q, aa, m), mod_mul(b, b, m), m);
+        a = na;
+        b = nb;
+
+        if ((n >> bit) & 1u) {
+            uint64_t siguiente_a = mod_sumar(mod_mul(p, a, m), b, m);
+            b = mod_mul(q, a, m);
+            a = siguiente_a;
+        }
+    }
+
+    *u = a;
+    *v = b;
+}
+
+/*
+ * continuar
+ * -----------------------------------------
+ * Escribe 'cantidad' términos más a continuación de los k que ya
+ * hay en destino[0..k). Para k = 2 la ventana se mantiene en
+ * registros y Fibonacci sin módulo se reduce a una suma por término.
+ */
+static void continuar(const Recurrencia *r, uint64_t *destino,
+                      size_t cantidad)
+{
+    const size_t k = (size_t)r->orden;
+    const uint64_t m = r->modulo;
+
+    if (k == 2) {
+        const uint64_t p = r->coeficientes[0];
+        const uint64_t q = r->coeficientes[1];
+        uint64_t anterior = destino[0];
+        uint64_t actual   = destino[1];
+        uint64_t *salida  = destino + 2;
+
+        if (m == 0 && p == 1 && q == 1) {
+            for (size_t i = 0; i < cantidad; ++i) {
+                uint64_t siguiente = actual + anterior;
+                salida[i] = siguiente;
+                anterior  = actual;
+                actual    = siguiente;
+            }
+        } else if (m == 0) {
+            for (size_t i = 0; i < cantidad; ++i) {
+                uint64_t siguiente = p * actual + q * anterior;
+                salida[i] = siguiente;
+                anterior  = actual;
+                actual    = siguiente;
+            }
+        } else {
+            for (size_t i = 0; i < cantidad; ++i) {
+                uint64_t siguiente = mod_sumar(mod_mul(p, actual, m),
+                                               mod_mul(q, anterior, m), m);
+                salida[i] = siguiente;
+                anterior  = actual;
+                actual    = siguiente;
+            }
+        }
+        return;
+    }
+
+    for (size_t i = k; i < k + cantidad; ++i) {
+        uint64_t suma = 0;
+        for (size_t j = 1; j <= k; ++j) {
+            suma = mod_sumar(suma, mod_mul(r->coeficientes[j - 1],
+                                           destino[i - j], m), m);
+        }
+        destino[i] = suma;
+    }
+}
+
+static void *hilo_bloque(void *argumento)
+{
+    TareaBloque *tarea = (TareaBloque *)argumento;
+
+    rec_llenar(tarea->recurrencia, tarea->inicio, tarea->destino,
+               tarea->cantidad);
+    return NULL;
+}
@@ -0,0 +1,74 @@
+/*
+ * recurrencia.h
+ * -----------------------------------------
+ * Recurrencias lineales homogéneas de orden k con coeficientes
+ * constantes:
+ *
+ *   a(i) = c1 a(i-1) + c2 a(i-2) + ... + ck a(i-k),   i >= k
+ *
+ * con semillas a(0) .. a(k-1). Fibonacci, Lucas, Pell, tribonacci,
+ * etc. son casos particulares (ver rec_predefinida).
+ *
+ * Aritmética: módulo 'modulo', o módulo 2^64 si modulo == 0 (el
+ * mismo desborde silencioso de unsigned long long que usa la
+ * secuencia original de fibonacci.c). Los coeficientes y semillas
+ * negativos se representan por su clase módulo 'modulo'.
+ *
+ * Saltos: a(n) se obtiene sin recorrer la secuencia calculando
+ * x^n mod P(x), con P(x) = x^k - c1 x^(k-1) - ... - ck (método de
+ * Kitamasa), en O(k^2 log n). Para k = 2 se usan fórmulas
+ * especializadas.
+ *
+ * Convención de errores: las funciones que pueden fallar retornan
+ * 0 si tuvieron éxito y -1 en caso contrario.
+ */
+
+#ifndef RECURRENCIA_H
+#define RECURRENCIA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RECURRENCIA_ORDEN_MAX 16
+
+typedef struct {
+    int      orden;
+    uint64_t coeficientes[RECURRENCIA_ORDEN_MAX];  /* c1 .. ck */
+    uint64_t semillas[RECURRENCIA_ORDEN_MAX];      /* a(0) .. a(k-1) */
+    uint64_t modulo;
+} Recurrencia;
+
+/*
+ * Definición.
+ *  - rec_definir: a partir de listas separadas por comas, p.ej.
+ *    coeficientes "1,1" y semillas "2,1" (Lucas). Ambas listas deben
+ *    tener la misma longitud, entre 1 y RECURRENCIA_ORDEN_MAX.
+ *  - rec_predefinida: fibonacci, lucas, pell, pell-lucas, jacobsthal,
+ *    tribonacci, tetranacci o padovan.
+ */
+int rec_definir(Recurrencia *r, const char *coeficientes,
+                const char *semillas, uint64_t modulo);
+int rec_predefinida(Recurrencia *r, const char *nombre, uint64_t modulo);
+
+/* Nombres aceptados por rec_predefinida, separados por espacios */
+const char *rec_nombres_predefinidos(void);
+
+/* a(n) por salto directo */
+uint64_t rec_termino(const Recurrencia *r, uint64_t n);
+
+/* ventana[0..k) = a(n) .. a(n + k - 1) */
+void rec_estado(const Recurrencia *r, uint64_t n, uint64_t *ventana);
+
+/*
+ * Generación de a(inicio) .. a(inicio + cantidad - 1) en 'destino'.
+ *  - rec_llenar: salta a 'inicio' y continúa secuencialmente.
+ *  - rec_llenar_paralelo: reparte el rango en 'hilos' bloques
+ *    contiguos; cada hilo salta al comienzo de su bloque y lo llena
+ *    de forma independiente.
+ */
+void rec_llenar(const Recurrencia *r, uint64_t inicio,
+                uint64_t *destino, size_t cantidad);
+int  rec_llenar_paralelo(const Recurrencia *r, uint64_t inicio,
+                         uint64_t *destino, size_t cantidad, int hilos);
+
+#endif /* RECURRENCIA_H */
@@ -0,0 +1,184 @@
+/*
+ * reloj.c
+ * -----------------------------------------
+ * Implementación de las marcas de tiempo declaradas en reloj.h.
+ *
+ * La conversión es ns = (ciclos * multiplicador) >> 32, con el
+ * producto en 128 bits para que no desborde en ejecuciones largas.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "reloj.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define RELOJ_X86 1
+#endif
+
+/* Frecuencias fuera de este rango indican una calibración fallida */
+#define GHZ_MINIMO 0.1
+#define GHZ_MAXIMO 10.0
+
+static FuenteReloj fuente = RELOJ_MONOTONIC;
+static uint64_t    multiplicador = 1ULL << 32;   /* ns por ciclo, 32.32 */
+static uint64_t    origen;                       /* en unidades crudas */
+static double      ghz = 1.0;
+
+/* Prototipos de funciones internas */
+static uint64_t monotonic_ns(void);
+#ifdef RELOJ_X86
+static int      tsc_invariante(void);
+static uint64_t leer_tsc(void);
+static void     par_simultaneo(uint64_t *ciclos, uint64_t *ns);
+#endif
+
+int reloj_iniciar(void)
+{
+    const char *forzada = getenv("RELOJ");
+
+    fuente        = RELOJ_MONOTONIC;
+    multiplicador = 1ULL << 32;
+    ghz           = 1.0;
+
+#ifdef RELOJ_X86
+    if ((forzada == NULL || strcmp(forzada, "monotonic") != 0) &&
+        tsc_invariante()) {
+        uint64_t c0, n0, c1, n1;
+        struct timespec espera = { 0, (long)RELOJ_CALIBRACION_NS };
+
+        par_simultaneo(&c0, &n0);
+        nanosleep(&espera, NULL);
+        par_simultaneo(&c1, &n1);
+
+        double frecuencia = (double)(c1 - c0) / (double)(n1 - n0);
+        if (c1 > c0 && n1 > n0 &&
+            frecuencia >= GHZ_MINIMO && frecuencia <= GHZ_MAXIMO) {
+            fuente        = RELOJ_TSC;
+            ghz           = frecuencia;
+            multiplicador = (uint64_t)(((unsigned __int128)(n1 - n0) << 32) /
+                                       (c1 - c0));
+        }
+    }
+#else
+    (void)forzada;
+#endif
+
+    origen = reloj_ciclos();
+    return 0;
+}
+
+FuenteReloj reloj_fuente(void)
+{
+    return fuente;
+}
+
+const char *reloj_nombre_fuente(void)
+{
+    return (fuente == RELOJ_TSC) ? "tsc" : "monotonic";
+}
+
+double reloj_ghz(void)
+{
+    return ghz;
+}
+
+uint64_t reloj_ciclos(void)
+{
+#ifdef RELOJ_X86
+    if (fuente == RELOJ_TSC) {
+        return leer_tsc();
+    }
+#endif
+    return monotonic_ns();
+}
+
+uint64_t reloj_ns(void)
+{
+    return reloj_ciclos_a_ns(reloj_ciclos() - origen);
+}
+
+uint64_t reloj_ciclos_a_ns(uint64_t ciclos)
+{
+    if (fuente != RELOJ_TSC) {
+        return ciclos;
+    }
+    return (uint64_t)(((unsigned __int128)ciclos * multiplicador) >> 32);
+}
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec instante;
+
+    clock_gettime(CLOCK_MONOTONIC, &instante);
+    return (uint64_t)instante.tv_sec * 1000000000ULL + (uint64_t)instante.tv_nsec;
+}
+
+#ifdef RELOJ_X86
+/*
+ * tsc_invariante
+ * -----------------------------------------
+ * 1 si cpuid anuncia rdtscp (0x80000001 EDX[27]) y TSC invariante
+ * (0x80000007 EDX[8]). Algunos hipervisores no exponen el segundo
+ * bit aunque el TSC sea estable; en ese caso se usa CLOCK_MONOTONIC.
+ */
+static int tsc_invariante(void)
+{
+    unsigned int a, b, c, d;
+
+    if (__get_cpuid_max(0x80000000, NULL) < 0x80000007) {
+        return 0;
+    }
+    __cpuid(0x80000001, a, b, c, d);
+    if (!(d & (1u << 27))) {
+        return 0;
+    }
+    __cpuid(0x80000007, a, b, c, d);
+    return (d & (1u << 8)) != 0;
+}
+
+/*
+ * leer_tsc
+ * -----------------------------------------
+ * rdtscp espera a que terminen las instrucciones anteriores; el
+ * lfence posterior impide que las siguientes empiecen antes de la
+ * lectura.
+ */
+static uint64_t leer_tsc(void)
+{
+    unsigned int procesador;
+    uint64_t     ciclos = __rdtscp(&procesador);
+
+    _mm_lfence();
+    return ciclos;
+}
+
+/*
+ * par_simultaneo
+ * -----------------------------------------
+ * Lee CLOCK_MONOTONIC entre dos lecturas del TSC y toma el punto
+ * medio; de varios intentos se queda con el más ajustado, para que
+ * una interrupción no desvíe la calibración.
+ */
+static void par_simultaneo(uint64_t *ciclos, uint64_t *ns)
+{
+    uint64_t mejor = UINT64_MAX;
+
+    for (int intento = 0; intento < 16; ++intento) {
+        uint64_t antes = leer_tsc();
+        uint64_t medio = monotonic_ns();
+        uint64_t despues = leer_tsc();
+
+        if (despues - antes < mejor) {
+            mejor   = despues - antes;
+            *ciclos = antes + (despues - antes) / 2;
+            *ns     = medio;
+        }
+    }
+}
+#endif
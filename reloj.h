@@ -0,0 +1,57 @@
+/*
+ * reloj.h
+ * -----------------------------------------
+ * Marcas de tiempo enteras para medir tramos cortos (un bloque, un
+ * hilo) sin el costo ni el redondeo de pasar CLOCK_MONOTONIC a
+ * double en cada lectura.
+ *
+ * Si el procesador tiene TSC invariante (frecuencia constante e
+ * independiente de los estados de energía, cpuid 0x80000007 EDX[8])
+ * y la instrucción rdtscp, las lecturas usan el contador de ciclos:
+ * rdtscp seguido de lfence, para que ni las instrucciones anteriores
+ * ni las siguientes se cuelen dentro del tramo medido. reloj_iniciar
+ * calibra los ciclos contra CLOCK_MONOTONIC durante
+ * RELOJ_CALIBRACION_NS y guarda la conversión como un multiplicador
+ * de punto fijo, así que pasar de ciclos a nanosegundos es una
+ * multiplicación y un desplazamiento.
+ *
+ * Sin TSC invariante (o con RELOJ=monotonic en el entorno) todo se
+ * mide con CLOCK_MONOTONIC y un "ciclo" es un nanosegundo.
+ *
+ * reloj_iniciar debe llamarse una vez, antes de crear hilos; después
+ * las lecturas son seguras desde cualquier hilo.
+ */
+
+#ifndef RELOJ_H
+#define RELOJ_H
+
+#include <stdint.h>
+
+/* Duración de la calibración contra CLOCK_MONOTONIC */
+#define RELOJ_CALIBRACION_NS 20000000ULL
+
+typedef enum {
+    RELOJ_MONOTONIC = 0,
+    RELOJ_TSC
+} FuenteReloj;
+
+/* Elige la fuente y calibra; retorna 0 (también si quedó en
+ * CLOCK_MONOTONIC) */
+int reloj_iniciar(void);
+
+FuenteReloj reloj_fuente(void);
+const char *reloj_nombre_fuente(void);
+
+/* Ciclos del TSC por nanosegundo según la calibración (1 sin TSC) */
+double reloj_ghz(void);
+
+/* Lectura cruda: ciclos del TSC o, sin él, nanosegundos */
+uint64_t reloj_ciclos(void);
+
+/* Nanosegundos desde reloj_iniciar */
+uint64_t reloj_ns(void);
+
+/* Convierte una diferencia de reloj_ciclos a nanosegundos */
+uint64_t reloj_ciclos_a_ns(uint64_t ciclos);
+
+#endif /* RELOJ_H */
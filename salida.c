@@ -0,0 +1,450 @@
+/*
+ * salida.c
+ * -----------------------------------------
+ * Implementación del escritor con búfer declarado en salida.h.
+ *
+ * En modo vmsplice los búferes se obtienen con mmap y se liberan con
+ * munmap: la tubería (o cualquier otra a la que el lector las haya
+ * pasado con splice) guarda referencias a las páginas, no a las
+ * direcciones, así que lo entregado y aún no leído sigue intacto
+ * después del munmap y de salida_cerrar (incluso si el proceso
+ * termina). Con malloc/free, o reutilizando el búfer, esas páginas
+ * se sobrescribirían.
+ *
+ * En modo io_uring los búferes pertenecen al AnilloEscritura y, como
+ * con vmsplice, miden 2 * capacidad: se entrega exactamente
+ * 'capacidad' bytes por escritura, lo que mantiene los
+ * desplazamientos alineados para O_DIRECT.
+ *
+ * Cada entrega al descriptor dispara las sondas USDT
+ * salida:entrega_inicio(bytes, modo) y salida:entrega_fin(bytes,
+ * modo) (ver sondas.h); 'modo' es el valor de ModoSalida. Si la
+ * entrega falla, entrega_fin no se dispara.
+ */
+
+#define _GNU_SOURCE
+
+#include "salida.h"
+#include "sondas.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/* Prototipos de funciones internas */
+static int  escribir_todo(int descriptor, const char *datos, size_t longitud);
+static int  empalmar_todo(int descriptor, const char *datos, size_t longitud,
+                          size_t *entregados);
+static int  empalmar_lleno(Salida *s);
+static int  enviar_lleno(Salida *s);
+static int  escribir_directo(Salida *s, const char *datos, size_t longitud);
+static ModoSalida elegir_modo(int descriptor);
+static int  preparar_tuberia(Salida *s);
+static char *mapear_bufer(size_t capacidad);
+static void liberar_buferes(Salida *s);
+
+int salida_abrir(Salida *s, int descriptor, size_t capacidad)
+{
+    return salida_abrir_con(s, descriptor, capacidad, SALIDA_AUTOMATICA);
+}
+
+int salida_abrir_con(Salida *s, int descriptor, size_t capacidad,
+                     ModoSalida modo)
+{
+    s->descriptor = descriptor;
+    s->capacidad  = (capacidad > 0) ? capacidad : SALIDA_TAM_BUFER;
+    s->usados     = 0;
+    s->total      = 0;
+    s->error      = 0;
+    s->propio     = NULL;
+    s->mapeado    = 0;
+    s->anillo     = NULL;
+    s->modo       = (modo == SALIDA_AUTOMATICA) ? elegir_modo(descriptor) : modo;
+
+    if (s->modo == SALIDA_VMSPLICE && preparar_tuberia(s) != 0) {
+        s->modo = SALIDA_WRITE;
+    }
+    if (s->modo == SALIDA_IO_URING || s->modo == SALIDA_IO_URING_DIRECTO) {
+        size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+        s->capacidad  = (s->capacidad + pagina - 1) / pagina * pagina;
+        s->anillo = anillo_crear(descriptor, 2 * s->capacidad,
+                                 SALIDA_BUFERES_ANILLO,
+                                 s->modo == SALIDA_IO_URING_DIRECTO);
+        s->bufer = (s->anillo != NULL) ? anillo_obtener(s->anillo) : NULL;
+        if (s->bufer != NULL) {
+            return 0;
+        }
+        if (s->anillo != NULL) {
+            anillo_destruir(s->anillo);
+            s->anillo = NULL;
+        }
+        s->modo = SALIDA_WRITE;
+    }
+    if (s->modo == SALIDA_WRITE) {
+        s->propio = (char *)malloc(s->capacidad);
+    }
+
+    s->bufer = s->propio;
+    return (s->bufer != NULL) ? 0 : -1;
+}
+
+int salida_cerrar(Salida *s)
+{
+    int codigo = salida_vaciar(s);
+
+    if (s->anillo != NULL && anillo_destruir(s->anillo) != 0) {
+        s->error = 1;
+        codigo   = -1;
+    }
+    s->anillo = NULL;
+    liberar_buferes(s);
+    s->bufer     = NULL;
+    s->capacidad = 0;
+    return codigo;
+}
+
+/*
+ * salida_vaciar
+ * -----------------------------------------
+ * Entrega todo lo pendiente: en modo vmsplice o io_uring, los
+ * primeros 'capacidad' bytes si el búfer está lleno; el resto (o
+ * todo, en modo write) con una escritura bloqueante.
+ */
+int salida_vaciar(Salida *s)
+{
+    if (s->error) {
+        return -1;
+    }
+    if (s->modo == SALIDA_VMSPLICE && s->usados >= s->capacidad &&
+        empalmar_lleno(s) != 0) {
+        return -1;
+    }
+    if (s->anillo != NULL && s->usados >= s->capacidad &&
+        enviar_lleno(s) != 0) {
+        return -1;
+    }
+    if (s->usados == 0) {
+        return 0;
+    }
+
+    if (escribir_directo(s, s->bufer, s->usados) != 0) {
+        return -1;
+    }
+    s->total  += s->usados;
+    s->usados  = 0;
+    return 0;
+}
+
+/*
+ * salida_reservar
+ * -----------------------------------------
+ * En modo vmsplice cada búfer mide 2 * capacidad: se formatea hasta
+ * pasar 'capacidad' y recién entonces se entrega exactamente esa
+ * cantidad, de modo que cada vmsplice llena la tubería completa.
+ * Con io_uring es igual, con una escritura asíncrona por entrega.
+ */
+char *salida_reservar(Salida *s, size_t maximo)
+{
+    if (s->anillo != NULL) {
+        if (s->usados >= s->capacidad && enviar_lleno(s) != 0) {
+            return NULL;
+        }
+        return s->bufer + s->usados;
+    }
+
+    if (s->modo == SALIDA_VMSPLICE) {
+        if (s->usados >= s->capacidad && empalmar_lleno(s) != 0) {
+            return NULL;
+        }
+        /* empalmar_lleno pudo pasar a modo write */
+        if (s->modo == SALIDA_VMSPLICE) {
+            return s->bufer + s->usados;
+        }
+    }
+
+    if (s->capacidad - s->usados < maximo && salida_vaciar(s) != 0) {
+        return NULL;
+    }
+    return s->bufer + s->usados;
+}
+
+void salida_confirmar(Salida *s, size_t usados)
+{
+    s->usados += usados;
+}
+
+int salida_escribir(Salida *s, const char *datos, size_t longitud)
+{
+    /* Bloques grandes: directo al descriptor, sin copiar */
+    if (longitud >= s->capacidad) {
+        if (salida_vaciar(s) != 0 ||
+            escribir_directo(s, datos, longitud) != 0) {
+            return -1;
+        }
+        s->total += longitud;
+        return 0;
+    }
+
+    char *destino = salida_reservar(s, longitud);
+    if (destino == NULL) {
+        return -1;
+    }
+    memcpy(destino, datos, longitud);
+    s->usados += longitud;
+    return 0;
+}
+
+const char *salida_nombre_modo(const Salida *s)
+{
+    switch (s->modo) {
+    case SALIDA_VMSPLICE:
+        return "vmsplice";
+    case SALIDA_IO_URING:
+        return "io_uring";
+    case SALIDA_IO_URING_DIRECTO:
+        return "directo";
+    default:
+        return "write";
+    }
+}
+
+/*
+ * elegir_modo
+ * -----------------------------------------
+ * SALIDA_MODO manda; si no está definida, se decide por el tipo de
+ * descriptor (ver salida.h).
+ */
+static ModoSalida elegir_modo(int descriptor)
+{
+    static const char *const NOMBRES[] = {
+        "write", "vmsplice", "io_uring", "directo"
+    };
+    static const ModoSalida MODOS[] = {
+        SALIDA_WRITE, SALIDA_VMSPLICE, SALIDA_IO_URING, SALIDA_IO_URING_DIRECTO
+    };
+    const char *forzado = getenv("SALIDA_MODO");
+    struct stat info;
+
+    if (forzado != NULL) {
+        for (size_t m = 0; m < sizeof(MODOS) / sizeof(MODOS[0]); ++m) {
+            if (strcmp(forzado, NOMBRES[m]) == 0) {
+                return MODOS[m];
+            }
+        }
+    }
+
+    /* Las tuberías usan write: vmsplice con páginas nuevas en cada
+     * entrega no le gana (ver bench_fibonacci tuberia) y queda a
+     * pedido con SALIDA_MODO=vmsplice */
+    if (fstat(descriptor, &info) != 0) {
+        return SALIDA_WRITE;
+    }
+    if (S_ISREG(info.st_mode) && !(fcntl(descriptor, F_GETFL) & O_APPEND)) {
+        return SALIDA_IO_URING;
+    }
+    return SALIDA_WRITE;
+}
+
+/*
+ * enviar_lleno
+ * -----------------------------------------
+ * Entrega los primeros 'capacidad' bytes a io_uring sin esperar y
+ * continúa en un búfer libre, copiando lo que sobró. El kernel solo
+ * lee el búfer enviado, así que copiar su cola es seguro.
+ */
+static int enviar_lleno(Salida *s)
+{
+    SONDA2(salida, entrega_inicio, s->capacidad, s->modo);
+    if (anillo_enviar(s->anillo, s->bufer, s->capacidad) != 0) {
+        s->error = 1;
+        return -1;
+    }
+
+    char *otro = anillo_obtener(s->anillo);
+    if (otro == NULL) {
+        s->error = 1;
+        return -1;
+    }
+    s->total  += s->capacidad;
+    s->usados -= s->capacidad;
+    memcpy(otro, s->bufer + s->capacidad, s->usados);
+    s->bufer = otro;
+    SONDA2(salida, entrega_fin, s->capacidad, s->modo);
+    return 0;
+}
+
+/*
+ * escribir_directo
+ * -----------------------------------------
+ * Escritura bloqueante fuera del búfer: con io_uring debe respetar
+ * el desplazamiento que lleva el anillo, porque la posición del
+ * descriptor no avanza con las escrituras asíncronas.
+ */
+static int escribir_directo(Salida *s, const char *datos, size_t longitud)
+{
+    SONDA2(salida, entrega_inicio, longitud, s->modo);
+    int codigo = (s->anillo != NULL)
+                     ? anillo_escribir(s->anillo, datos, longitud)
+                     : escribir_todo(s->descriptor, datos, longitud);
+    if (codigo != 0) {
+        s->error = 1;
+        return codigo;
+    }
+    SONDA2(salida, entrega_fin, longitud, s->modo);
+    return codigo;
+}
+
+/*
+ * empalmar_lleno
+ * -----------------------------------------
+ * Entrega los primeros 'capacidad' bytes del búfer con vmsplice y
+ * pasa a llenar un búfer recién mapeado, copiando al comienzo lo que
+ * sobró; el entregado se desmapea sin volver a tocarlo. Si vmsplice
+ * no está disponible se sigue en modo write, también en un búfer
+ * nuevo: las páginas ya entregadas pueden seguir en la tubería.
+ */
+static int empalmar_lleno(Salida *s)
+{
+    size_t entregados = 0;
+    size_t bytes      = s->capacidad;
+    char  *otro       = mapear_bufer(s->capacidad);
+
+    if (otro == NULL) {
+        s->error = 1;
+        return -1;
+    }
+    SONDA2(salida, entrega_inicio, bytes, s->modo);
+    if (empalmar_todo(s->descriptor, s->bufer, s->capacidad,
+                      &entregados) != 0) {
+        if (errno == EPIPE ||
+            escribir_todo(s->descriptor, s->bufer + entregados,
+                          s->usados - entregados) != 0) {
+            munmap(otro, 2 * s->capacidad);
+            s->error = 1;
+            return -1;
+        }
+        s->modo   = SALIDA_WRITE;
+        s->total += s->usados;
+        bytes     = s->usados;
+        s->usados = 0;
+    } else {
+        s->total  += s->capacidad;
+        s->usados -= s->capacidad;
+        memcpy(otro, s->bufer + s->capacidad, s->usados);
+    }
+
+    munmap(s->propio, 2 * s->capacidad);
+    s->propio = otro;
+    s->bufer  = otro;
+    SONDA2(salida, entrega_fin, bytes, s->modo);
+    return 0;
+}
+
+/*
+ * escribir_todo
+ * -----------------------------------------
+ * write(2) puede escribir menos de lo pedido (tuberías, señales);
+ * se repite hasta entregar todo.
+ */
+static int escribir_todo(int descriptor, const char *datos, size_t longitud)
+{
+    while (longitud > 0) {
+        ssize_t escritos = write(descriptor, datos, longitud);
+        if (escritos < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        datos    += escritos;
+        longitud -= (size_t)escritos;
+    }
+    return 0;
+}
+
+/*
+ * empalmar_todo
+ * -----------------------------------------
+ * Como escribir_todo, con vmsplice(2). En 'entregados' queda lo que
+ * alcanzó a entrar a la tubería antes de un error.
+ */
+static int empalmar_todo(int descriptor, const char *datos, size_t longitud,
+                         size_t *entregados)
+{
+    *entregados = 0;
+    while (*entregados < longitud) {
+        struct iovec vector = {
+            .iov_base = (void *)(datos + *entregados),
+            .iov_len  = longitud - *entregados
+        };
+        ssize_t escritos = vmsplice(descriptor, &vector, 1, SPLICE_F_GIFT);
+        if (escritos < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        *entregados += (size_t)escritos;
+    }
+    return 0;
+}
+
+/*
+ * preparar_tuberia
+ * -----------------------------------------
+ * Ajusta la capacidad de la tubería a la del búfer (redondeada a
+ * páginas) y mapea el primer búfer, de 2 * capacidad.
+ * Si la tubería no se puede achicar, el búfer crece hasta su
+ * tamaño: lo que importa es que un búfer completo ocupe toda la
+ * tubería.
+ */
+static int preparar_tuberia(Salida *s)
+{
+    size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    size_t tam    = (s->capacidad + pagina - 1) / pagina * pagina;
+
+    fcntl(s->descriptor, F_SETPIPE_SZ, (int)tam);
+    int tam_tuberia = fcntl(s->descriptor, F_GETPIPE_SZ);
+    if (tam_tuberia < 0) {
+        return -1;
+    }
+    if ((size_t)tam_tuberia > tam) {
+        tam = (size_t)tam_tuberia;
+    }
+
+    s->propio = mapear_bufer(tam);
+    if (s->propio == NULL) {
+        return -1;
+    }
+    s->mapeado   = 1;
+    s->capacidad = tam;
+    return 0;
+}
+
+/* Búfer de 2 * capacidad en páginas nuevas, ya tocadas (NULL si
+ * falla el mmap) */
+static char *mapear_bufer(size_t capacidad)
+{
+    void *bufer = mmap(NULL, 2 * capacidad, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    return (bufer == MAP_FAILED) ? NULL : (char *)bufer;
+}
+
+/* Solo el modo vmsplice mapea su búfer */
+static void liberar_buferes(Salida *s)
+{
+    if (s->propio == NULL) {
+        return;
+    }
+    if (s->mapeado) {
+        munmap(s->propio, 2 * s->capacidad);
+    } else {
+        free(s->propio);
+    }
+    s->propio = NULL;
+}
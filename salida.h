@@ -0,0 +1,96 @@
+/*
+ * salida.h
+ * -----------------------------------------
+ * Escritor con búfer propio para volcar grandes volúmenes de texto
+ * a un descriptor de archivo sin pasar por stdio.
+ *
+ * El texto se formatea directamente dentro del búfer:
+ *
+ *   char *p = salida_reservar(&s, maximo);   // espacio para 'maximo'
+ *   size_t n = formatear(p, ...);             // n <= maximo
+ *   salida_confirmar(&s, n);
+ *
+ * Cuando el búfer se llena se entrega completo al descriptor. Hay
+ * dos formas de hacerlo:
+ *  - SALIDA_WRITE: write(2), reintentando escrituras parciales e
+ *    interrupciones. Sirve para cualquier descriptor.
+ *  - SALIDA_VMSPLICE: solo para tuberías. Las páginas del búfer se
+ *    entregan a la tubería con vmsplice(2) (SPLICE_F_GIFT), sin
+ *    copiarlas al kernel. Que la tubería se haya vaciado no implica
+ *    que nadie las use: si el lector las pasa con splice(2) a otra
+ *    tubería (como pv), esa sigue apuntando a ellas. Por eso una
+ *    página entregada no se vuelve a escribir nunca: tras cada
+ *    entrega se continúa en páginas nuevas (mmap) y las entregadas
+ *    se desmapean, de modo que el kernel las libera cuando suelta
+ *    la última referencia. La capacidad de la tubería se ajusta al
+ *    búfer (F_SETPIPE_SZ) para que cada entrega la llene completa.
+ *    Los vaciados parciales (búfer no lleno) usan write(2), que
+ *    copia y no deja páginas en vuelo.
+ *  - SALIDA_IO_URING: para archivos. Cada búfer lleno se entrega a
+ *    io_uring y se sigue formateando en otro del conjunto mientras
+ *    el disco lo escribe (ver anillo.h). SALIDA_IO_URING_DIRECTO
+ *    agrega O_DIRECT.
+ * SALIDA_AUTOMATICA elige io_uring si el descriptor es un archivo
+ * regular sin O_APPEND y write en otro caso (tuberías, terminales):
+ * vmsplice solo se usa a pedido, porque mapear páginas nuevas en
+ * cada entrega cuesta más que la copia que ahorra. La variable de entorno SALIDA_MODO ("write",
+ * "vmsplice", "io_uring" o "directo") fuerza la elección. Si el
+ * modo elegido no está disponible, se sigue con write.
+ *
+ * Convención de errores: las funciones que escriben retornan 0 si
+ * tuvieron éxito y -1 si la escritura falló (errno queda con la
+ * causa).
+ */
+
+#ifndef SALIDA_H
+#define SALIDA_H
+
+#include <stddef.h>
+
+#include "anillo.h"
+
+typedef enum {
+    SALIDA_AUTOMATICA,
+    SALIDA_WRITE,
+    SALIDA_VMSPLICE,
+    SALIDA_IO_URING,
+    SALIDA_IO_URING_DIRECTO
+} ModoSalida;
+
+typedef struct {
+    int              descriptor;
+    char            *bufer;      /* búfer que se está llenando */
+    size_t           capacidad;
+    size_t           usados;
+    size_t           total;      /* bytes entregados al descriptor */
+    int              error;
+    ModoSalida       modo;       /* ya resuelto: nunca AUTOMATICA */
+    char            *propio;     /* búfer reservado aquí (malloc, o
+                                  * mmap de 2 * capacidad) */
+    int              mapeado;    /* 'propio' viene de mmap */
+    AnilloEscritura *anillo;     /* con io_uring, dueño de los búferes */
+} Salida;
+
+/* Tamaño de búfer por defecto: 1 MiB */
+#define SALIDA_TAM_BUFER (1u << 20)
+
+/* Búferes del conjunto de io_uring (de 2 * capacidad cada uno) */
+#define SALIDA_BUFERES_ANILLO 4
+
+int   salida_abrir(Salida *s, int descriptor, size_t capacidad);
+int   salida_abrir_con(Salida *s, int descriptor, size_t capacidad,
+                       ModoSalida modo);
+int   salida_cerrar(Salida *s);      /* vacía el búfer y lo libera */
+int   salida_vaciar(Salida *s);
+
+/* Puntero a al menos 'maximo' bytes libres (maximo <= capacidad), o
+ * NULL si hubo que vaciar el búfer y la escritura falló */
+char *salida_reservar(Salida *s, size_t maximo);
+void  salida_confirmar(Salida *s, size_t usados);
+
+int   salida_escribir(Salida *s, const char *datos, size_t longitud);
+
+/* "write", "vmsplice", "io_uring" o "directo" */
+const char *salida_nombre_modo(const Salida *s);
+
+#endif /* SALIDA_H */
@@ -0,0 +1,110 @@
+/*
+ * sondas.h
+ * -----------------------------------------
+ * Sondas estáticas USDT (User-level Statically Defined Tracing),
+ * compatibles con SystemTap, para engancharse con bpftrace o perf
+ * sin recompilar:
+ *
+ *      bpftrace -e 'usdt:./pi_p:pi_p:hilo_fin { @[arg0] = count(); }'
+ *      perf buildid-cache --add ./pi_p && perf list 'sdt_pi_p:*'
+ *
+ * Cada sonda es una sola instrucción nop en el código más una nota
+ * ELF (.note.stapsdt) que indica su dirección, su nombre y dónde
+ * están sus argumentos (registros o constantes). Sin un trazador
+ * enganchado no se ejecuta nada más que el nop; al engancharse, el
+ * kernel lo reemplaza por una trampa. No se usan semáforos, así que
+ * los argumentos se calculan siempre: deben ser expresiones baratas
+ * (variables ya disponibles).
+ *
+ * Si está <sys/sdt.h> (paquete systemtap-sdt-dev) se usa ese
+ * encabezado. Si no, en x86-64 con GCC o Clang se emite la misma nota
+ * directamente; en otras plataformas las sondas no generan código.
+ * No hay dependencia en tiempo de ejecución en ningún caso.
+ *
+ * Los argumentos se convierten a int64_t (los punteros, con
+ * intptr_t), de modo que en bpftrace arg0..arg2 son enteros con
+ * signo de 64 bits.
+ */
+
+#ifndef SONDAS_H
+#define SONDAS_H
+
+#include <stdint.h>
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define SONDAS_SDT 1
+#endif
+#endif
+
+#if defined(SONDAS_SDT)
+
+#include <sys/sdt.h>
+
+#define SONDA0(proveedor, nombre) DTRACE_PROBE(proveedor, nombre)
+#define SONDA1(proveedor, nombre, a1) \
+    DTRACE_PROBE1(proveedor, nombre, (int64_t)(a1))
+#define SONDA2(proveedor, nombre, a1, a2) \
+    DTRACE_PROBE2(proveedor, nombre, (int64_t)(a1), (int64_t)(a2))
+#define SONDA3(proveedor, nombre, a1, a2, a3)                          \
+    DTRACE_PROBE3(proveedor, nombre, (int64_t)(a1), (int64_t)(a2),     \
+                  (int64_t)(a3))
+
+#elif defined(__x86_64__) && defined(__GNUC__)
+
+/*
+ * Misma nota que genera <sys/sdt.h> (versión 3 del formato): la
+ * dirección del nop, la de _.stapsdt.base (para corregir el
+ * desplazamiento si el binario se reubica), un semáforo nulo y las
+ * cadenas proveedor, nombre y argumentos ("-8@%rax -8@$5": tamaño 8
+ * con signo y su ubicación).
+ */
+#define SONDA_NOTA_(proveedor, nombre, argumentos)                       \
+    "990: nop\n"                                                         \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                        \
+    ".balign 4\n"                                                        \
+    ".4byte 992f-991f, 994f-993f, 3\n"                                   \
+    "991: .asciz \"stapsdt\"\n"                                          \
+    "992: .balign 4\n"                                                   \
+    "993: .8byte 990b\n"                                                 \
+    ".8byte _.stapsdt.base\n"                                            \
+    ".8byte 0\n"                                                         \
+    ".asciz \"" #proveedor "\"\n"                                        \
+    ".asciz \"" #nombre "\"\n"                                           \
+    ".asciz \"" argumentos "\"\n"                                        \
+    "994: .balign 4\n"                                                   \
+    ".popsection\n"                                                      \
+    ".ifndef _.stapsdt.base\n"                                           \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+    ".weak _.stapsdt.base\n"                                             \
+    ".hidden _.stapsdt.base\n"                                           \
+    "_.stapsdt.base: .space 1\n"                                         \
+    ".size _.stapsdt.base, 1\n"                                          \
+    ".popsection\n"                                                      \
+    ".endif\n"
+
+#define SONDA0(proveedor, nombre)                                        \
+    __asm__ __volatile__(SONDA_NOTA_(proveedor, nombre, ""))
+#define SONDA1(proveedor, nombre, a1)                                    \
+    __asm__ __volatile__(SONDA_NOTA_(proveedor, nombre, "-8@%0")         \
+                         :: "nor"((int64_t)(a1)))
+#define SONDA2(proveedor, nombre, a1, a2)                                \
+    __asm__ __volatile__(SONDA_NOTA_(proveedor, nombre, "-8@%0 -8@%1")   \
+                         :: "nor"((int64_t)(a1)), "nor"((int64_t)(a2)))
+#define SONDA3(proveedor, nombre, a1, a2, a3)                            \
+    __asm__ __volatile__(SONDA_NOTA_(proveedor, nombre,                  \
+                                     "-8@%0 -8@%1 -8@%2")                \
+                         :: "nor"((int64_t)(a1)), "nor"((int64_t)(a2)),  \
+                            "nor"((int64_t)(a3)))
+
+#else
+
+#define SONDA0(proveedor, nombre)                 ((void)0)
+#define SONDA1(proveedor, nombre, a1)             ((void)(a1))
+#define SONDA2(proveedor, nombre, a1, a2)         ((void)(a1), (void)(a2))
+#define SONDA3(proveedor, nombre, a1, a2, a3)                           \
+    ((void)(a1), (void)(a2), (void)(a3))
+
+#endif
+
+#endif /* SONDAS_H */
@@ -0,0 +1,292 @@
+/*
+ * techo.c
+ * -----------------------------------------
+ * Implementación de los micronúcleos declarados en techo.h.
+ *
+ * Los núcleos se generan con DEFINIR_NUCLEO: 12 acumuladores en
+ * variables locales (para que vivan en registros) y una operación
+ * por acumulador y vuelta. Se compilan sin vectorización automática,
+ * para que los escalares no se conviertan en vectoriales, y sin
+ * reasociar (no se usa -ffast-math), así que el compilador no puede
+ * resumir las vueltas.
+ */
+
+#define _GNU_SOURCE
+
+#include "techo.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "reloj.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define TECHO_X86 1
+#endif
+
+#define ACUMULADORES 12
+
+typedef double v2d __attribute__((vector_size(16)));
+
+typedef double (*NucleoTecho)(uint64_t vueltas, double x);
+
+/*
+ * Arranque
+ * -----------------------------------------
+ * Señal de salida común: los hilos esperan con 'estado' en 0 hasta
+ * que el hilo que mide lo pone en 1 (arrancar) o -1 (no se pudieron
+ * crear todos; terminar sin medir).
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cambio;
+    int             estado;
+} Arranque;
+
+/*
+ * TareaTecho
+ * -----------------------------------------
+ * Un hilo de la medición: ejecuta 'nucleo' 'vueltas' veces después
+ * de la señal de salida y deja su duración en 'ns'.
+ */
+typedef struct {
+    NucleoTecho nucleo;
+    uint64_t    vueltas;
+    uint64_t    ns;
+    Arranque   *arranque;
+} TareaTecho;
+
+/* Operando opaco para el compilador; cercano a 1 para que ni los
+ * productos ni las divisiones desborden ni caigan en subnormales */
+static volatile double operando = 0.999999999;
+static volatile double sumidero;
+
+/* Operaciones por acumulador */
+#define OP_SUMA(a)      a = a + b;
+#define OP_PRODUCTO(a)  a = a * b;
+#define OP_DIVISION(a)  a = b / a;
+#define OP_FMA(a)       a = __builtin_fma(a, b, c);
+#ifdef TECHO_X86
+#define OP_FMA_256(a)   a = _mm256_fmadd_pd(a, b, c);
+#endif
+
+#define DEFINIR_NUCLEO(nombre, tipo, atributos, operacion)                  \
+    __attribute__((noinline, optimize("no-tree-vectorize"))) atributos      \
+    static double nombre(uint64_t vueltas, double x)                        \
+    {                                                                       \
+        tipo b = (tipo){0} + x, c = (tipo){0} + 0.5 * x;                    \
+        tipo a0 = b + 0.01, a1 = b + 0.02, a2 = b + 0.03, a3 = b + 0.04;    \
+        tipo a4 = b + 0.05, a5 = b + 0.06, a6 = b + 0.07, a7 = b + 0.08;    \
+        tipo a8 = b + 0.09, a9 = b + 0.10, a10 = b + 0.11, a11 = b + 0.12;  \
+        (void)c;                                                            \
+        for (uint64_t v = 0; v < vueltas; ++v) {                            \
+            operacion(a0) operacion(a1) operacion(a2) operacion(a3)         \
+            operacion(a4) operacion(a5) operacion(a6) operacion(a7)         \
+            operacion(a8) operacion(a9) operacion(a10) operacion(a11)       \
+        }                                                                   \
+        tipo s = ((a0 + a1) + (a2 + a3)) + ((a4 + a5) + (a6 + a7)) +        \
+                 ((a8 + a9) + (a10 + a11));                                 \
+        double total = 0.0;                                                 \
+        for (size_t i = 0; i < sizeof(tipo) / sizeof(double); ++i) {       \
+            total += ((double *)&s)[i];                                     \
+        }                                                                   \
+        return total;                                                       \
+    }
+
+/* Escalares y SSE2 (base de x86-64; en otras arquitecturas, lo que
+ * el compilador haga con vectores de 16 bytes) */
+DEFINIR_NUCLEO(suma_escalar,     double, , OP_SUMA)
+DEFINIR_NUCLEO(producto_escalar, double, , OP_PRODUCTO)
+DEFINIR_NUCLEO(division_escalar, double, , OP_DIVISION)
+DEFINIR_NUCLEO(suma_v2,          v2d,    , OP_SUMA)
+DEFINIR_NUCLEO(producto_v2,      v2d,    , OP_PRODUCTO)
+DEFINIR_NUCLEO(division_v2,      v2d,    , OP_DIVISION)
+
+#ifdef TECHO_X86
+/* AVX2 + FMA, solo si el procesador los tiene */
+DEFINIR_NUCLEO(fma_escalar,      double,  __attribute__((target("fma"))), OP_FMA)
+DEFINIR_NUCLEO(suma_v4,          __m256d, __attribute__((target("avx2"))), OP_SUMA)
+DEFINIR_NUCLEO(producto_v4,      __m256d, __attribute__((target("avx2"))), OP_PRODUCTO)
+DEFINIR_NUCLEO(division_v4,      __m256d, __attribute__((target("avx2"))), OP_DIVISION)
+DEFINIR_NUCLEO(fma_v4,           __m256d, __attribute__((target("avx2,fma"))), OP_FMA_256)
+#elif defined(__FP_FAST_FMA)
+DEFINIR_NUCLEO(fma_escalar,      double, , OP_FMA)
+#endif
+
+/* Prototipos de funciones internas */
+static double   medir_nucleo(NucleoTecho nucleo, int hilos, double operaciones);
+static uint64_t calibrar_vueltas(NucleoTecho nucleo);
+static void    *ejecutar_tarea(void *argumento);
+
+int techo_medir(PicosTecho *picos, int hilos)
+{
+    NucleoTecho escalares[TECHO_NUM_OPERACIONES] = {
+        suma_escalar, producto_escalar, NULL, division_escalar
+    };
+    NucleoTecho vectoriales[TECHO_NUM_OPERACIONES] = {
+        suma_v2, producto_v2, NULL, division_v2
+    };
+
+    picos->hilos = (hilos < 1) ? 1 : hilos;
+    picos->ancho = 2;
+
+#ifdef TECHO_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("fma")) {
+        escalares[TECHO_FMA] = fma_escalar;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        vectoriales[TECHO_SUMA]     = suma_v4;
+        vectoriales[TECHO_PRODUCTO] = producto_v4;
+        vectoriales[TECHO_FMA]      = fma_v4;
+        vectoriales[TECHO_DIVISION] = division_v4;
+        picos->ancho = 4;
+    }
+#elif defined(__FP_FAST_FMA)
+    escalares[TECHO_FMA] = fma_escalar;
+#endif
+
+    for (int op = 0; op < TECHO_NUM_OPERACIONES; ++op) {
+        /* FLOP por elemento y operación: 2 en la FMA */
+        double flop = (op == TECHO_FMA) ? 2.0 : 1.0;
+
+        picos->escalar[op]   = 0.0;
+        picos->vectorial[op] = 0.0;
+        if (escalares[op] != NULL) {
+            picos->escalar[op] = medir_nucleo(escalares[op], picos->hilos, flop);
+            if (picos->escalar[op] < 0.0) {
+                return -1;
+            }
+        }
+        if (vectoriales[op] != NULL) {
+            picos->vectorial[op] = medir_nucleo(vectoriales[op], picos->hilos,
+                                                flop * picos->ancho);
+            if (picos->vectorial[op] < 0.0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+const char *techo_nombre_operacion(OperacionTecho operacion)
+{
+    switch (operacion) {
+    case TECHO_SUMA:
+        return "suma";
+    case TECHO_PRODUCTO:
+        return "producto";
+    case TECHO_FMA:
+        return "fma";
+    case TECHO_DIVISION:
+        return "division";
+    default:
+        return "?";
+    }
+}
+
+/*
+ * medir_nucleo
+ * -----------------------------------------
+ * Ejecuta 'nucleo' en 'hilos' hilos a la vez y retorna operaciones
+ * por segundo en total ('operaciones' por acumulador y vuelta), o -1
+ * si falló la creación de hilos.
+ */
+static double medir_nucleo(NucleoTecho nucleo, int hilos, double operaciones)
+{
+    uint64_t    vueltas = calibrar_vueltas(nucleo);
+    Arranque    arranque = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0 };
+    pthread_t  *ids    = (pthread_t *)malloc(sizeof(pthread_t) * (size_t)hilos);
+    TareaTecho *tareas = (TareaTecho *)malloc(sizeof(TareaTecho) * (size_t)hilos);
+    int         creados = 0;
+
+    if (ids == NULL || tareas == NULL) {
+        free(ids);
+        free(tareas);
+        return -1.0;
+    }
+
+    for (int t = 0; t < hilos; ++t) {
+        tareas[t].nucleo   = nucleo;
+        tareas[t].vueltas  = vueltas;
+        tareas[t].ns       = 0;
+        tareas[t].arranque = &arranque;
+    }
+    /* El hilo que llama es el hilo 0 */
+    for (int t = 1; t < hilos; ++t) {
+        if (pthread_create(&ids[t], NULL, ejecutar_tarea, &tareas[t]) != 0) {
+            break;
+        }
+        creados++;
+    }
+
+    pthread_mutex_lock(&arranque.mutex);
+    arranque.estado = (creados == hilos - 1) ? 1 : -1;
+    pthread_cond_broadcast(&arranque.cambio);
+    pthread_mutex_unlock(&arranque.mutex);
+
+    if (creados == hilos - 1) {
+        ejecutar_tarea(&tareas[0]);
+    }
+    for (int t = 1; t <= creados; ++t) {
+        pthread_join(ids[t], NULL);
+    }
+
+    uint64_t maximo = 0;
+    for (int t = 0; t < hilos; ++t) {
+        maximo = (tareas[t].ns > maximo) ? tareas[t].ns : maximo;
+    }
+    free(ids);
+    free(tareas);
+    if (creados != hilos - 1 || maximo == 0) {
+        return -1.0;
+    }
+    return (double)hilos * (double)vueltas * ACUMULADORES * operaciones /
+           ((double)maximo * 1e-9);
+}
+
+/*
+ * calibrar_vueltas
+ * -----------------------------------------
+ * Duplica las vueltas hasta que el núcleo tarde al menos una cuarta
+ * parte de TECHO_DURACION_NS y escala a la duración completa.
+ */
+static uint64_t calibrar_vueltas(NucleoTecho nucleo)
+{
+    uint64_t vueltas = 1024;
+
+    for (;;) {
+        uint64_t inicio = reloj_ns();
+        sumidero = nucleo(vueltas, operando);
+        uint64_t ns = reloj_ns() - inicio;
+        if (ns >= TECHO_DURACION_NS / 4) {
+            return (uint64_t)((double)vueltas * (double)TECHO_DURACION_NS /
+                              (double)ns) + 1;
+        }
+        vueltas *= 2;
+    }
+}
+
+static void *ejecutar_tarea(void *argumento)
+{
+    TareaTecho *tarea    = (TareaTecho *)argumento;
+    Arranque   *arranque = tarea->arranque;
+
+    pthread_mutex_lock(&arranque->mutex);
+    while (arranque->estado == 0) {
+        pthread_cond_wait(&arranque->cambio, &arranque->mutex);
+    }
+    int estado = arranque->estado;
+    pthread_mutex_unlock(&arranque->mutex);
+    if (estado < 0) {
+        return NULL;
+    }
+
+    uint64_t inicio = reloj_ns();
+    double resultado = tarea->nucleo(tarea->vueltas, operando);
+    tarea->ns = reloj_ns() - inicio;
+    sumidero = resultado;
+    return NULL;
+}
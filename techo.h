@@ -0,0 +1,51 @@
+/*
+ * techo.h
+ * -----------------------------------------
+ * Rendimiento máximo de punto flotante de la máquina, medido con
+ * micronúcleos, para comparar con él lo que logra un cálculo (modelo
+ * roofline, de ahí el nombre).
+ *
+ * Cada micronúcleo repite una sola operación de doble precisión
+ * (suma, producto, FMA o división) sobre 12 cadenas independientes,
+ * suficientes para cubrir la latencia de la operación en todas las
+ * unidades que la ejecutan, de modo que lo que se mide es el
+ * rendimiento y no la latencia. Se mide en escalar y con el vector
+ * más ancho disponible: 4 doubles (AVX2 + FMA, elegido en tiempo de
+ * ejecución) o 2 (SSE2). Sin FMA en el procesador, esa fila queda
+ * en 0.
+ *
+ * Con varios hilos, todos arrancan juntos y el rendimiento
+ * es el total sobre el hilo más lento, de modo que incluye la bajada
+ * de frecuencia al activar más núcleos.
+ *
+ * Unidades: FLOP/s, contando 2 por FMA; la división, en divisiones
+ * por segundo. reloj_iniciar debe haberse llamado antes.
+ */
+
+#ifndef TECHO_H
+#define TECHO_H
+
+typedef enum {
+    TECHO_SUMA = 0,
+    TECHO_PRODUCTO,
+    TECHO_FMA,
+    TECHO_DIVISION,
+    TECHO_NUM_OPERACIONES
+} OperacionTecho;
+
+/* Duración aproximada de cada medición */
+#define TECHO_DURACION_NS 50000000ULL
+
+typedef struct {
+    int    hilos;
+    int    ancho;                                 /* doubles por vector */
+    double escalar[TECHO_NUM_OPERACIONES];
+    double vectorial[TECHO_NUM_OPERACIONES];
+} PicosTecho;
+
+/* Retorna 0, o -1 si no se pudieron crear los hilos */
+int techo_medir(PicosTecho *picos, int hilos);
+
+const char *techo_nombre_operacion(OperacionTecho operacion);
+
+#endif /* TECHO_H */
@@ -0,0 +1,300 @@
+/*
+ * traza.c
+ * -----------------------------------------
+ * Implementación del registro de eventos declarado en traza.h.
+ */
+
+#define _GNU_SOURCE
+
+#include "traza.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * EventoTraza
+ * -----------------------------------------
+ * Un evento tal como se registró; se convierte a JSON solo al
+ * escribir el archivo.
+ */
+typedef struct {
+    uint64_t    ns;
+    uint64_t    duracion;       /* solo en los tramos "X" */
+    const char *nombre;
+    const char *claves[2];
+    int64_t     valores[2];
+    int         cpu;
+    char        fase;
+} EventoTraza;
+
+/*
+ * BuferTraza
+ * -----------------------------------------
+ * Eventos de un hilo. Solo su dueño escribe en él.
+ */
+typedef struct {
+    EventoTraza *eventos;
+    int          cantidad;
+    long         tid;
+    const char  *nombre;
+    int          indice;
+    uint64_t     perdidos;
+} BuferTraza;
+
+static int         activa;
+static const char *ruta;
+static uint64_t    origen;
+static BuferTraza  buferes[TRAZA_MAX_HILOS];
+static atomic_int  num_buferes;
+static atomic_long sin_ranura;          /* eventos de hilos sin búfer */
+
+static __thread BuferTraza *propio;
+static __thread int         rechazado;
+
+/* Prototipos de funciones internas */
+static BuferTraza  *bufer_propio(void);
+static EventoTraza *nuevo_evento(char fase, const char *nombre);
+static uint64_t     reloj_ns(void);
+static void         escribir_traza(void);
+
+int traza_iniciar(void)
+{
+    ruta = getenv("TRAZA");
+    if (ruta == NULL || ruta[0] == '\0') {
+        return 0;
+    }
+
+    origen = reloj_ns();
+    activa = 1;
+    if (atexit(escribir_traza) != 0) {
+        activa = 0;
+        return -1;
+    }
+    return 0;
+}
+
+int traza_activa(void)
+{
+    return activa;
+}
+
+void traza_nombrar_hilo(const char *nombre, int indice)
+{
+    BuferTraza *b = activa ? bufer_propio() : NULL;
+
+    if (b != NULL) {
+        b->nombre = nombre;
+        b->indice = indice;
+    }
+}
+
+uint64_t traza_ahora(void)
+{
+    return activa ? reloj_ns() - origen : 0;
+}
+
+void traza_comenzar(const char *nombre, const char *clave1, int64_t valor1,
+                    const char *clave2, int64_t valor2)
+{
+    EventoTraza *e = activa ? nuevo_evento('B', nombre) : NULL;
+
+    if (e != NULL) {
+        e->claves[0]  = clave1;
+        e->valores[0] = valor1;
+        e->claves[1]  = clave2;
+        e->valores[1] = valor2;
+    }
+}
+
+void traza_terminar(const char *nombre)
+{
+    if (activa) {
+        nuevo_evento('E', nombre);
+    }
+}
+
+void traza_completo(const char *nombre, uint64_t desde,
+                    const char *clave1, int64_t valor1)
+{
+    EventoTraza *e = activa ? nuevo_evento('X', nombre) : NULL;
+
+    if (e != NULL) {
+        e->duracion   = (e->ns > desde) ? e->ns - desde : 0;
+        e->ns         = desde;
+        e->claves[0]  = clave1;
+        e->valores[0] = valor1;
+    }
+}
+
+void traza_instante(const char *nombre, const char *clave1, int64_t valor1)
+{
+    EventoTraza *e = activa ? nuevo_evento('i', nombre) : NULL;
+
+    if (e != NULL) {
+        e->claves[0]  = clave1;
+        e->valores[0] = valor1;
+    }
+}
+
+/*
+ * bufer_propio
+ * -----------------------------------------
+ * Búfer del hilo que llama; en su primer uso toma la siguiente
+ * ranura libre y reserva los eventos. NULL si no quedan ranuras o
+ * faltó memoria (el hilo ya no registra nada).
+ */
+static BuferTraza *bufer_propio(void)
+{
+    if (propio != NULL || rechazado) {
+        return propio;
+    }
+
+    int ranura = atomic_fetch_add_explicit(&num_buferes, 1,
+                                           memory_order_relaxed);
+    if (ranura >= TRAZA_MAX_HILOS) {
+        rechazado = 1;
+        return NULL;
+    }
+
+    BuferTraza *b = &buferes[ranura];
+    b->eventos = (EventoTraza *)malloc(sizeof(EventoTraza) *
+                                       TRAZA_EVENTOS_POR_HILO);
+    b->tid     = (long)syscall(SYS_gettid);
+    b->indice  = -1;
+    if (b->eventos == NULL) {
+        rechazado = 1;
+        return NULL;
+    }
+    propio = b;
+    return b;
+}
+
+static EventoTraza *nuevo_evento(char fase, const char *nombre)
+{
+    BuferTraza *b = bufer_propio();
+
+    if (b == NULL) {
+        atomic_fetch_add_explicit(&sin_ranura, 1, memory_order_relaxed);
+        return NULL;
+    }
+    if (b->cantidad == TRAZA_EVENTOS_POR_HILO) {
+        b->perdidos++;
+        return NULL;
+    }
+
+    EventoTraza *e = &b->eventos[b->cantidad++];
+    e->ns        = reloj_ns() - origen;
+    e->duracion  = 0;
+    e->nombre    = nombre;
+    e->claves[0] = NULL;
+    e->claves[1] = NULL;
+    e->cpu       = sched_getcpu();
+    e->fase      = fase;
+    return e;
+}
+
+static uint64_t reloj_ns(void)
+{
+    struct timespec instante;
+
+    clock_gettime(CLOCK_MONOTONIC, &instante);
+    return (uint64_t)instante.tv_sec * 1000000000ULL + (uint64_t)instante.tv_nsec;
+}
+
+/*
+ * escribir_traza
+ * -----------------------------------------
+ * Registrada con atexit. Escribe los metadatos (nombre del proceso
+ * y de cada hilo, en el orden de sus ranuras) y luego los eventos;
+ * las marcas van en microsegundos con decimales, como exige el
+ * formato.
+ */
+static void escribir_traza(void)
+{
+    FILE *archivo = fopen(ruta, "w");
+    int   hilos   = atomic_load(&num_buferes);
+    long  pid     = (long)getpid();
+    uint64_t descartados = (uint64_t)atomic_load(&sin_ranura);
+
+    if (hilos > TRAZA_MAX_HILOS) {
+        hilos = TRAZA_MAX_HILOS;
+    }
+    if (archivo == NULL) {
+        fprintf(stderr, "Error al abrir la traza %s: %s\n", ruta,
+                strerror(errno));
+        return;
+    }
+
+    fprintf(archivo, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    fprintf(archivo, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %ld, "
+                     "\"args\": {\"name\": \"%s\"}}",
+            pid, program_invocation_short_name);
+
+    for (int h = 0; h < hilos; ++h) {
+        const BuferTraza *b = &buferes[h];
+        if (b->eventos == NULL) {
+            continue;
+        }
+        char nombre[64];
+        if (b->nombre == NULL) {
+            snprintf(nombre, sizeof(nombre), "hilo %ld", b->tid);
+        } else if (b->indice >= 0) {
+            snprintf(nombre, sizeof(nombre), "%s %d", b->nombre, b->indice);
+        } else {
+            snprintf(nombre, sizeof(nombre), "%s", b->nombre);
+        }
+        fprintf(archivo,
+                ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %ld, "
+                "\"tid\": %ld, \"args\": {\"name\": \"%s\"}}"
+                ",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", "
+                "\"pid\": %ld, \"tid\": %ld, \"args\": {\"sort_index\": %d}}",
+                pid, b->tid, nombre, pid, b->tid, h);
+        descartados += b->perdidos;
+    }
+
+    for (int h = 0; h < hilos; ++h) {
+        const BuferTraza *b = &buferes[h];
+        for (int k = 0; b->eventos != NULL && k < b->cantidad; ++k) {
+            const EventoTraza *e = &b->eventos[k];
+            fprintf(archivo,
+                    ",\n{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %llu.%03u, "
+                    "\"pid\": %ld, \"tid\": %ld",
+                    e->nombre, e->fase,
+                    (unsigned long long)(e->ns / 1000), (unsigned)(e->ns % 1000),
+                    pid, b->tid);
+            if (e->fase == 'X') {
+                fprintf(archivo, ", \"dur\": %llu.%03u",
+                        (unsigned long long)(e->duracion / 1000),
+                        (unsigned)(e->duracion % 1000));
+            } else if (e->fase == 'i') {
+                fprintf(archivo, ", \"s\": \"t\"");
+            }
+            fprintf(archivo, ", \"args\": {\"cpu\": %d", e->cpu);
+            for (int a = 0; a < 2; ++a) {
+                if (e->claves[a] != NULL) {
+                    fprintf(archivo, ", \"%s\": %lld", e->claves[a],
+                            (long long)e->valores[a]);
+                }
+            }
+            fprintf(archivo, "}}");
+        }
+    }
+
+    fprintf(archivo, "\n], \"otherData\": {\"eventos_descartados\": %llu}}\n",
+            (unsigned long long)descartados);
+    if (fclose(archivo) != 0) {
+        fprintf(stderr, "Error al escribir la traza %s\n", ruta);
+    }
+
+    for (int h = 0; h < hilos; ++h) {
+        free(buferes[h].eventos);
+        buferes[h].eventos = NULL;
+    }
+}
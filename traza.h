@@ -0,0 +1,58 @@
+/*
+ * traza.h
+ * -----------------------------------------
+ * Registro de la vida de los hilos en formato Chrome trace-event
+ * (JSON), que se abre directamente en Perfetto (ui.perfetto.dev) o
+ * en chrome://tracing.
+ *
+ * Se activa con la variable de entorno TRAZA=RUTA: traza_iniciar
+ * prepara el registro y, al terminar el proceso (atexit), escribe
+ * el archivo RUTA. Sin TRAZA, cada llamada solo consulta una
+ * bandera.
+ *
+ * Cada hilo escribe en su propio búfer de eventos, que reserva en
+ * su primer evento tomando una ranura con un incremento atómico; no
+ * hay bloqueos ni datos compartidos al registrar. Por eso los
+ * eventos de un hilo deben terminar de registrarse antes de que se
+ * escriba el archivo (pthread_join antes de salir). Si el búfer se
+ * llena, los eventos siguientes se descartan y se informa cuántos.
+ *
+ * Cada evento lleva una marca de tiempo de CLOCK_MONOTONIC (en ns
+ * desde traza_iniciar) y la CPU en que se registró (sched_getcpu).
+ * Tipos de evento:
+ *  - traza_comenzar / traza_terminar: un tramo ("B"/"E") del hilo
+ *    que llama; deben anidarse correctamente.
+ *  - traza_completo: un tramo ya medido ("X"), desde una marca
+ *    tomada con traza_ahora hasta el momento de la llamada.
+ *  - traza_instante: un evento puntual ("i").
+ * Los nombres y claves deben ser cadenas constantes: se guarda el
+ * puntero. Cada evento admite hasta dos argumentos enteros (clave
+ * NULL si no se usa).
+ */
+
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <stdint.h>
+
+/* Ranuras de hilos y eventos por hilo */
+#define TRAZA_MAX_HILOS        256
+#define TRAZA_EVENTOS_POR_HILO 4096
+
+/* Lee TRAZA; retorna 0 (con o sin traza) o -1 si faltó memoria */
+int  traza_iniciar(void);
+int  traza_activa(void);
+
+/* Nombre del hilo que llama en la línea de tiempo ("principal",
+ * "hilo %d" con 'indice' >= 0) */
+void traza_nombrar_hilo(const char *nombre, int indice);
+
+uint64_t traza_ahora(void);
+void traza_comenzar(const char *nombre, const char *clave1, int64_t valor1,
+                    const char *clave2, int64_t valor2);
+void traza_terminar(const char *nombre);
+void traza_completo(const char *nombre, uint64_t desde,
+                    const char *clave1, int64_t valor1);
+void traza_instante(const char *nombre, const char *clave1, int64_t valor1);
+
+#endif /* TRAZA_H */
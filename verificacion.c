@@ -0,0 +1,658 @@
+/*
+ * verificacion.c
+ * -----------------------------------------
+ * Implementación de la verificación declarada en verificacion.h.
+ *
+ * El recorrido completo guarda cuántos espacios hay en cada bloque
+ * de BLOQUE_CONTEO bytes; con sus sumas prefijas, ubicar el término
+ * k cuesta una búsqueda binaria y el recorrido de un solo bloque,
+ * así que las ventanas se eligen por índice (uniformes) y no por
+ * posición en el texto.
+ */
+
+#define _GNU_SOURCE
+
+#include "verificacion.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BLOQUE_CONTEO ((size_t)1 << 16)
+
+#define MAX_HILOS_VERIFICACION 64
+
+/* Dígitos que se acumulan en una palabra antes de reducir */
+#define DIGITOS_POR_TRAMO 18
+
+/* Primos menores que 2^62: los productos caben en 128 bits */
+static const uint64_t PRIMOS[VF_MAX_PRIMOS] = {
+    4611686018427387847ULL, 4611686018427387817ULL,
+    4611686018427387787ULL, 4611686018427387761ULL
+};
+
+/*
+ * ContextoVerificacion
+ * -----------------------------------------
+ * Datos compartidos (solo lectura) por los hilos de las ventanas.
+ * Un módulo 0 representa 2^64.
+ */
+typedef struct {
+    const char *texto;
+    size_t      tam;            /* sin el salto de línea final, si lo hay */
+    uint64_t   *prefijo;        /* espacios antes de cada bloque */
+    size_t      num_bloques;
+    uint64_t    terminos;
+    uint64_t    desde;
+    int         reducido;
+    uint64_t    modulos[VF_MAX_PRIMOS];
+    int         num_modulos;
+} ContextoVerificacion;
+
+/*
+ * TareaConteo
+ * -----------------------------------------
+ * Bloques [desde, hasta) del recorrido completo. 'primer_invalido'
+ * es la posición del primer carácter que no es dígito ni espacio
+ * (SIZE_MAX si no hay).
+ */
+typedef struct {
+    const char *texto;
+    size_t      tam;
+    size_t      desde;
+    size_t      hasta;
+    uint64_t   *espacios;       /* uno por bloque */
+    size_t      primer_invalido;
+} TareaConteo;
+
+/*
+ * TareaVentanas
+ * -----------------------------------------
+ * Ventanas que verifica un hilo: las de posición primera, primera +
+ * paso, ... en 'inicios'. El resultado es el menor índice incorrecto
+ * encontrado (UINT64_MAX si ninguno).
+ */
+typedef struct {
+    const ContextoVerificacion *contexto;
+    const uint64_t             *inicios;
+    int                         num_ventanas;
+    int                         primera;
+    int                         paso;
+    uint64_t                    longitud;
+    uint64_t                    verificados;
+    uint64_t                    indice_error;
+    const char                 *motivo;
+} TareaVentanas;
+
+/* Prototipos de funciones internas */
+static void    *contar_bloques(void *argumento);
+static void    *verificar_ventanas(void *argumento);
+static int      verificar_ventana(const ContextoVerificacion *c, uint64_t k,
+                                  uint64_t longitud, uint64_t *indice_error,
+                                  const char **motivo);
+static size_t   ubicar_termino(const ContextoVerificacion *c, uint64_t k);
+static uint64_t contar_espacios(const char *texto, size_t desde, size_t hasta);
+static const char *residuos(const ContextoVerificacion *c, const char *p,
+                            size_t n, uint64_t *r);
+static void     fibonacci_modular(uint64_t n, uint64_t m, uint64_t *f,
+                                  uint64_t *f1);
+static uint64_t sumar_mod(uint64_t a, uint64_t b, uint64_t m);
+static uint64_t restar_mod(uint64_t a, uint64_t b, uint64_t m);
+static uint64_t multiplicar_mod(uint64_t a, uint64_t b, uint64_t m);
+static uint64_t siguiente_aleatorio(uint64_t *estado);
+static uint64_t semilla_nueva(void);
+
+void vf_opciones_por_defecto(OpcionesVerificacion *o)
+{
+    o->desde    = 0;
+    o->reducido = 0;
+    o->modulo   = 0;
+    o->hilos    = 1;
+    o->muestras = 64;
+    o->ventana  = 16;
+    o->primos   = 2;
+    o->semilla  = semilla_nueva();
+}
+
+int vf_verificar_texto(const char *texto, size_t tam,
+                       const OpcionesVerificacion *opciones,
+                       ResultadoVerificacion *resultado)
+{
+    resultado->correcta     = 1;
+    resultado->terminos     = 0;
+    resultado->ventanas     = 0;
+    resultado->verificados  = 0;
+    resultado->indice_error = 0;
+    resultado->motivo       = NULL;
+
+    /* El salto de línea final es opcional; sin términos (N = 0, con
+     * o sin el salto) la sucesión vacía es válida */
+    if (tam > 0 && texto[tam - 1] == '\n') {
+        tam--;
+    }
+    if (tam == 0) {
+        return 0;
+    }
+
+    int hilos = opciones->hilos;
+    if (hilos < 1) {
+        hilos = 1;
+    }
+    if (hilos > MAX_HILOS_VERIFICACION) {
+        hilos = MAX_HILOS_VERIFICACION;
+    }
+
+    /* 1. Recorrido completo: espacios por bloque y formato */
+    ContextoVerificacion c;
+    c.texto       = texto;
+    c.tam         = tam;
+    c.num_bloques = (tam + BLOQUE_CONTEO - 1) / BLOQUE_CONTEO;
+    c.prefijo     = (uint64_t *)malloc(sizeof(uint64_t) * (c.num_bloques + 1));
+    if (c.prefijo == NULL) {
+        return -1;
+    }
+
+    int hilos_conteo = ((size_t)hilos > c.num_bloques) ? (int)c.num_bloques
+                                                        : hilos;
+    TareaConteo tareas_conteo[MAX_HILOS_VERIFICACION];
+    pthread_t   ids[MAX_HILOS_VERIFICACION];
+    int         creado[MAX_HILOS_VERIFICACION];
+    for (int t = 0; t < hilos_conteo; ++t) {
+        tareas_conteo[t].texto    = texto;
+        tareas_conteo[t].tam      = tam;
+        tareas_conteo[t].desde    = c.num_bloques * (size_t)t / (size_t)hilos_conteo;
+        tareas_conteo[t].hasta    = c.num_bloques * (size_t)(t + 1) / (size_t)hilos_conteo;
+        tareas_conteo[t].espacios = c.prefijo + 1;
+        creado[t] = (t > 0 && pthread_create(&ids[t], NULL, contar_bloques,
+                                             &tareas_conteo[t]) == 0);
+    }
+    for (int t = 0; t < hilos_conteo; ++t) {
+        if (!creado[t]) {
+            contar_bloques(&tareas_conteo[t]);
+        }
+    }
+    for (int t = 0; t < hilos_conteo; ++t) {
+        if (creado[t]) {
+            pthread_join(ids[t], NULL);
+        }
+    }
+
+    c.prefijo[0] = 0;
+    for (size_t b = 0; b < c.num_bloques; ++b) {
+        c.prefijo[b + 1] += c.prefijo[b];
+    }
+    c.terminos          = c.prefijo[c.num_bloques] + 1;
+    resultado->terminos = c.terminos;
+
+    for (int t = 0; t < hilos_conteo; ++t) {
+        size_t invalido = tareas_conteo[t].primer_invalido;
+        if (invalido != SIZE_MAX) {
+            size_t b = invalido / BLOQUE_CONTEO;
+            resultado->correcta     = 0;
+            resultado->motivo       = "carácter inválido";
+            resultado->indice_error = opciones->desde + c.prefijo[b] +
+                contar_espacios(texto, b * BLOQUE_CONTEO, invalido);
+            free(c.prefijo);
+            return 0;
+        }
+    }
+
+    /* 2. Ventanas: la primera, la última y 'muestras' al azar */
+    c.desde    = opciones->desde;
+    c.reducido = opciones->reducido;
+    if (c.reducido) {
+        c.modulos[0]  = opciones->modulo;
+        c.num_modulos = 1;
+    } else {
+        c.num_modulos = opciones->primos;
+        if (c.num_modulos < 1) {
+            c.num_modulos = 1;
+        }
+        if (c.num_modulos > VF_MAX_PRIMOS) {
+            c.num_modulos = VF_MAX_PRIMOS;
+        }
+        memcpy(c.modulos, PRIMOS, sizeof(PRIMOS));
+    }
+
+    uint64_t longitud = (opciones->ventana < 3) ? 3 : (uint64_t)opciones->ventana;
+    if (longitud > c.terminos) {
+        longitud = c.terminos;
+    }
+    int num_ventanas = 2 + ((opciones->muestras > 0) ? opciones->muestras : 0);
+    uint64_t *inicios = (uint64_t *)malloc(sizeof(uint64_t) * (size_t)num_ventanas);
+    if (inicios == NULL) {
+        free(c.prefijo);
+        return -1;
+    }
+    uint64_t estado = opciones->semilla;
+    uint64_t posibles = c.terminos - longitud + 1;
+    inicios[0] = 0;
+    inicios[1] = posibles - 1;
+    for (int v = 2; v < num_ventanas; ++v) {
+        inicios[v] = siguiente_aleatorio(&estado) % posibles;
+    }
+
+    int hilos_ventanas = (hilos > num_ventanas) ? num_ventanas : hilos;
+    TareaVentanas tareas[MAX_HILOS_VERIFICACION];
+    for (int t = 0; t < hilos_ventanas; ++t) {
+        tareas[t].contexto     = &c;
+        tareas[t].inicios      = inicios;
+        tareas[t].num_ventanas = num_ventanas;
+        tareas[t].primera      = t;
+        tareas[t].paso         = hilos_ventanas;
+        tareas[t].longitud     = longitud;
+        creado[t] = (t > 0 && pthread_create(&ids[t], NULL, verificar_ventanas,
+                                             &tareas[t]) == 0);
+    }
+    for (int t = 0; t < hilos_ventanas; ++t) {
+        if (!creado[t]) {
+            verificar_ventanas(&tareas[t]);
+        }
+    }
+    for (int t = 0; t < hilos_ventanas; ++t) {
+        if (creado[t]) {
+            pthread_join(ids[t], NULL);
+        }
+        resultado->verificados += tareas[t].verificados;
+        if (tareas[t].motivo != NULL &&
+            (resultado->correcta ||
+             tareas[t].indice_error < resultado->indice_error)) {
+            resultado->correcta     = 0;
+            resultado->indice_error = tareas[t].indice_error;
+            resultado->motivo       = tareas[t].motivo;
+        }
+    }
+    resultado->ventanas = num_ventanas;
+
+    free(inicios);
+    free(c.prefijo);
+    return 0;
+}
+
+int vf_verificar_archivo(const char *ruta,
+                         const OpcionesVerificacion *opciones,
+                         ResultadoVerificacion *resultado)
+{
+    int descriptor = STDIN_FILENO;
+    struct stat info;
+
+    if (ruta != NULL && strcmp(ruta, "-") != 0) {
+        descriptor = open(ruta, O_RDONLY);
+        if (descriptor < 0) {
+            perror("Error al abrir la sucesión a verificar");
+            return -1;
+        }
+    }
+
+    /* Archivo regular: se proyecta en memoria */
+    if (fstat(descriptor, &info) == 0 && S_ISREG(info.st_mode) &&
+        info.st_size > 0) {
+        size_t tam  = (size_t)info.st_size;
+        void  *mapa = mmap(NULL, tam, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapa != MAP_FAILED) {
+            int codigo = vf_verificar_texto((const char *)mapa, tam, opciones,
+                                            resultado);
+            munmap(mapa, tam);
+            if (descriptor != STDIN_FILENO) {
+                close(descriptor);
+            }
+            return codigo;
+        }
+    }
+
+    /* Tuberías y otros: se lee todo */
+    size_t capacidad = (size_t)1 << 20, tam = 0;
+    char  *texto = (char *)malloc(capacidad);
+    int    codigo = (texto != NULL) ? 0 : -1;
+    while (codigo == 0) {
+        if (tam == capacidad) {
+            char *nuevo = (char *)realloc(texto, 2 * capacidad);
+            if (nuevo == NULL) {
+                codigo = -1;
+                break;
+            }
+            texto     = nuevo;
+            capacidad = 2 * capacidad;
+        }
+        ssize_t leidos = read(descriptor, texto + tam, capacidad - tam);
+        if (leidos < 0 && errno == EINTR) {
+            continue;
+        }
+        if (leidos < 0) {
+            perror("Error al leer la sucesión a verificar");
+            codigo = -1;
+        } else if (leidos == 0) {
+            break;
+        } else {
+            tam += (size_t)leidos;
+        }
+    }
+    if (codigo == 0) {
+        codigo = vf_verificar_texto(texto, tam, opciones, resultado);
+    }
+
+    free(texto);
+    if (descriptor != STDIN_FILENO) {
+        close(descriptor);
+    }
+    return codigo;
+}
+
+/*
+ * contar_bloques
+ * -----------------------------------------
+ * Hilo del recorrido completo. El ciclo no tiene saltos y el
+ * compilador lo vectoriza.
+ */
+static void *contar_bloques(void *argumento)
+{
+    TareaConteo *tarea = (TareaConteo *)argumento;
+    const unsigned char *texto = (const unsigned char *)tarea->texto;
+
+    tarea->primer_invalido = SIZE_MAX;
+    for (size_t b = tarea->desde; b < tarea->hasta; ++b) {
+        size_t   inicio = b * BLOQUE_CONTEO;
+        size_t   fin    = (inicio + BLOQUE_CONTEO < tarea->tam)
+                              ? inicio + BLOQUE_CONTEO : tarea->tam;
+        uint64_t espacios = 0;
+        int      malos    = 0;
+        for (size_t x = inicio; x < fin; ++x) {
+            unsigned char caracter = texto[x];
+            espacios += (caracter == ' ');
+            malos    |= ((unsigned char)(caracter - '0') > 9) & (caracter != ' ');
+        }
+        tarea->espacios[b] = espacios;
+
+        if (malos && tarea->primer_invalido == SIZE_MAX) {
+            for (size_t x = inicio; x < fin; ++x) {
+                if ((unsigned char)(texto[x] - '0') > 9 && texto[x] != ' ') {
+                    tarea->primer_invalido = x;
+                    break;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * verificar_ventanas
+ * -----------------------------------------
+ * Hilo de las ventanas: recorre todas las asignadas (no se detiene
+ * en el primer error, para reportar el menor índice encontrado).
+ */
+static void *verificar_ventanas(void *argumento)
+{
+    TareaVentanas *tarea = (TareaVentanas *)argumento;
+
+    tarea->verificados  = 0;
+    tarea->indice_error = UINT64_MAX;
+    tarea->motivo       = NULL;
+    for (int v = tarea->primera; v < tarea->num_ventanas; v += tarea->paso) {
+        uint64_t    indice = 0;
+        const char *motivo = NULL;
+        if (verificar_ventana(tarea->contexto, tarea->inicios[v],
+                              tarea->longitud, &indice, &motivo) != 0 &&
+            indice < tarea->indice_error) {
+            tarea->indice_error = indice;
+            tarea->motivo       = motivo;
+        }
+        tarea->verificados += tarea->longitud;
+    }
+    return NULL;
+}
+
+/*
+ * verificar_ventana
+ * -----------------------------------------
+ * Términos k .. k + longitud - 1 (índices relativos al texto).
+ * Guarda los residuos de los tres últimos términos de cada módulo.
+ * Retorna 0 si todo coincide; si no, -1 con el índice absoluto del
+ * primer término incorrecto y el motivo.
+ */
+static int verificar_ventana(const ContextoVerificacion *c, uint64_t k,
+                             uint64_t longitud, uint64_t *indice_error,
+                             const char **motivo)
+{
+    uint64_t previo_2[VF_MAX_PRIMOS], previo_1[VF_MAX_PRIMOS];
+    uint64_t actual[VF_MAX_PRIMOS], esperado_1[VF_MAX_PRIMOS];
+    size_t   pos = ubicar_termino(c, k);
+
+    for (uint64_t j = 0; j < longitud; ++j) {
+        const uint64_t i = c->desde + k + j;
+        const char *fin = (const char *)memchr(c->texto + pos, ' ', c->tam - pos);
+        size_t      n   = (fin != NULL) ? (size_t)(fin - c->texto) - pos
+                                        : c->tam - pos;
+
+        *indice_error = i;
+        *motivo = residuos(c, c->texto + pos, n, actual);
+        if (*motivo != NULL) {
+            return -1;
+        }
+
+        for (int p = 0; p < c->num_modulos; ++p) {
+            const uint64_t m = c->modulos[p];
+            if (j == 0) {
+                uint64_t esperado;
+                fibonacci_modular(i, m, &esperado, &esperado_1[p]);
+                if (actual[p] != esperado) {
+                    *motivo = "no coincide con la duplicación rápida";
+                    return -1;
+                }
+            } else if (j == 1) {
+                if (actual[p] != esperado_1[p]) {
+                    *motivo = "no coincide con la duplicación rápida";
+                    return -1;
+                }
+            } else {
+                if (actual[p] != sumar_mod(previo_1[p], previo_2[p], m)) {
+                    *motivo = "no cumple F(i) = F(i-1) + F(i-2)";
+                    return -1;
+                }
+                /* Cassini en i - 1 */
+                uint64_t izquierda = restar_mod(
+                    multiplicar_mod(previo_2[p], actual[p], m),
+                    multiplicar_mod(previo_1[p], previo_1[p], m), m);
+                uint64_t derecha = ((i - 1) % 2 == 0) ? 1 : restar_mod(0, 1, m);
+                if (izquierda != derecha) {
+                    *indice_error = i - 1;
+                    *motivo = "no cumple la identidad de Cassini";
+                    return -1;
+                }
+            }
+            previo_2[p] = previo_1[p];
+            previo_1[p] = actual[p];
+        }
+        pos += n + 1;
+    }
+    return 0;
+}
+
+/*
+ * ubicar_termino
+ * -----------------------------------------
+ * Posición del comienzo del término k: justo después del k-ésimo
+ * espacio, que está en el último bloque con menos de k espacios
+ * antes de él.
+ */
+static size_t ubicar_termino(const ContextoVerificacion *c, uint64_t k)
+{
+    if (k == 0) {
+        return 0;
+    }
+
+    size_t bajo = 0, alto = c->num_bloques - 1;
+    while (bajo < alto) {
+        size_t medio = (bajo + alto + 1) / 2;
+        if (c->prefijo[medio] < k) {
+            bajo = medio;
+        } else {
+            alto = medio - 1;
+        }
+    }
+
+    uint64_t    faltan = k - c->prefijo[bajo];
+    const char *p      = c->texto + bajo * BLOQUE_CONTEO;
+    for (;;) {
+        p = (const char *)memchr(p, ' ', (size_t)(c->texto + c->tam - p));
+        if (--faltan == 0) {
+            return (size_t)(p - c->texto) + 1;
+        }
+        p++;
+    }
+}
+
+/* Espacios en texto[desde, hasta) */
+static uint64_t contar_espacios(const char *texto, size_t desde, size_t hasta)
+{
+    uint64_t espacios = 0;
+
+    for (size_t x = desde; x < hasta; ++x) {
+        espacios += (texto[x] == ' ');
+    }
+    return espacios;
+}
+
+/*
+ * residuos
+ * -----------------------------------------
+ * Reduce el término de 'n' dígitos en p módulo cada módulo del
+ * contexto, de a DIGITOS_POR_TRAMO dígitos. Con valores reducidos el
+ * término se lee exacto y debe ser menor que el módulo. Retorna NULL
+ * si el término es válido, o el motivo del rechazo.
+ */
+static const char *residuos(const ContextoVerificacion *c, const char *p,
+                            size_t n, uint64_t *r)
+{
+    if (n == 0) {
+        return "término vacío";
+    }
+    if (n > 1 && p[0] == '0') {
+        return "cero a la izquierda";
+    }
+
+    if (c->reducido) {
+        uint64_t valor = 0;
+        for (size_t x = 0; x < n; ++x) {
+            if (__builtin_mul_overflow(valor, 10, &valor) ||
+                __builtin_add_overflow(valor, (uint64_t)(p[x] - '0'), &valor)) {
+                return "valor mayor que el módulo";
+            }
+        }
+        if (c->modulos[0] != 0 && valor >= c->modulos[0]) {
+            return "valor mayor que el módulo";
+        }
+        r[0] = valor;
+        return NULL;
+    }
+
+    for (int m = 0; m < c->num_modulos; ++m) {
+        r[m] = 0;
+    }
+    size_t tramo = n % DIGITOS_POR_TRAMO;
+    if (tramo == 0) {
+        tramo = DIGITOS_POR_TRAMO;
+    }
+    for (size_t x = 0; x < n; x += tramo, tramo = DIGITOS_POR_TRAMO) {
+        uint64_t valor = 0, escala = 1;
+        for (size_t d = 0; d < tramo; ++d) {
+            valor  = valor * 10 + (uint64_t)(p[x + d] - '0');
+            escala = escala * 10;
+        }
+        for (int m = 0; m < c->num_modulos; ++m) {
+            unsigned __int128 t = (unsigned __int128)r[m] * escala + valor;
+            r[m] = (uint64_t)(t % c->modulos[m]);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * fibonacci_modular
+ * -----------------------------------------
+ * (F(n), F(n+1)) mod m por duplicación rápida:
+ *   F(2k)   = F(k) (2 F(k+1) - F(k))
+ *   F(2k+1) = F(k)^2 + F(k+1)^2
+ */
+static void fibonacci_modular(uint64_t n, uint64_t m, uint64_t *f,
+                              uint64_t *f1)
+{
+    uint64_t a = 0, b = (m == 1) ? 0 : 1;
+
+    for (int bit = 63; bit >= 0; --bit) {
+        uint64_t c = multiplicar_mod(a, restar_mod(sumar_mod(b, b, m), a, m), m);
+        uint64_t d = sumar_mod(multiplicar_mod(a, a, m),
+                               multiplicar_mod(b, b, m), m);
+        if ((n >> bit) & 1) {
+            a = d;
+            b = sumar_mod(c, d, m);
+        } else {
+            a = c;
+            b = d;
+        }
+    }
+    *f  = a;
+    *f1 = b;
+}
+
+/* Aritmética módulo m, con m = 0 como 2^64 */
+static uint64_t sumar_mod(uint64_t a, uint64_t b, uint64_t m)
+{
+    if (m == 0) {
+        return a + b;
+    }
+    return (uint64_t)(((unsigned __int128)a + b) % m);
+}
+
+static uint64_t restar_mod(uint64_t a, uint64_t b, uint64_t m)
+{
+    if (m == 0) {
+        return a - b;
+    }
+    return (a >= b) ? a - b : a + (m - b);
+}
+
+static uint64_t multiplicar_mod(uint64_t a, uint64_t b, uint64_t m)
+{
+    if (m == 0) {
+        return a * b;
+    }
+    return (uint64_t)((unsigned __int128)a * b % m);
+}
+
+/* splitmix64 */
+static uint64_t siguiente_aleatorio(uint64_t *estado)
+{
+    uint64_t z = (*estado += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133cbaebULL;
+    return z ^ (z >> 31);
+}
+
+/*
+ * semilla_nueva
+ * -----------------------------------------
+ * 64 bits del generador del sistema; si getrandom(2) falla, la hora
+ * en nanosegundos mezclada con el PID.
+ */
+static uint64_t semilla_nueva(void)
+{
+    uint64_t semilla;
+    if (getrandom(&semilla, sizeof semilla, GRND_NONBLOCK) ==
+        (ssize_t)sizeof semilla) {
+        return semilla;
+    }
+    struct timespec ahora;
+    clock_gettime(CLOCK_REALTIME, &ahora);
+    semilla = (uint64_t)ahora.tv_sec * 1000000000ULL + (uint64_t)ahora.tv_nsec;
+    semilla ^= (uint64_t)getpid() << 32;
+    return siguiente_aleatorio(&semilla);
+}
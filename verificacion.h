@@ -0,0 +1,85 @@
+/*
+ * verificacion.h
+ * -----------------------------------------
+ * Verificación en paralelo de una sucesión de Fibonacci ya impresa
+ * (términos en decimal separados por un espacio y un salto de línea
+ * final, como la escriben ./fibonacci N, --archivo, --flujo o
+ * --sucesion fibonacci), sin volver a generarla. El salto final es
+ * opcional, y un texto sin términos (N = 0) es una sucesión válida.
+ *
+ * En lugar de recalcular todo se comprueban identidades baratas:
+ *  1. Un recorrido de todo el texto, repartido entre los hilos, que
+ *     cuenta los términos y rechaza caracteres inválidos.
+ *  2. Ventanas de W términos consecutivos (la primera, la última y
+ *     S al azar), reducidos módulo varios primos de 62 bits. En cada
+ *     ventana:
+ *      - los dos primeros términos se comparan con F(k) y F(k+1)
+ *        calculados por duplicación rápida (módulo p), lo que ata
+ *        los valores a su índice;
+ *      - se comprueba F(i) = F(i-1) + F(i-2) en toda la ventana;
+ *      - se comprueba la identidad de Cassini,
+ *        F(i-1) F(i+1) - F(i)^2 = (-1)^i.
+ * Un término alterado pasa la comparación módulo un primo p con
+ * probabilidad ~1/p, así que con dos o más primos un error dentro de
+ * una ventana no pasa inadvertido. Lo que queda fuera de las ventanas
+ * solo se verifica en su formato, de modo que el costo es el de leer
+ * el texto una vez más una fracción S * W / N de la conversión.
+ *
+ * Si los valores se imprimieron módulo M (--modulo, o 2^64 por
+ * defecto en --flujo y --sucesion), las mismas comprobaciones se
+ * hacen módulo M sobre el valor exacto.
+ */
+
+#ifndef VERIFICACION_H
+#define VERIFICACION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Primos disponibles para los valores completos */
+#define VF_MAX_PRIMOS 4
+
+typedef struct {
+    uint64_t desde;       /* índice del primer término (--desde) */
+    int      reducido;    /* 0: valores completos; 1: módulo 'modulo' */
+    uint64_t modulo;      /* con reducido: M, o 0 para 2^64 */
+    int      hilos;
+    int      muestras;    /* ventanas al azar, además de los extremos */
+    int      ventana;     /* términos por ventana (al menos 3) */
+    int      primos;      /* 1 a VF_MAX_PRIMOS */
+    uint64_t semilla;     /* elige las ventanas al azar */
+} OpcionesVerificacion;
+
+typedef struct {
+    int         correcta;
+    uint64_t    terminos;        /* términos encontrados en el texto */
+    int         ventanas;
+    uint64_t    verificados;     /* términos comprobados en ventanas */
+    uint64_t    indice_error;    /* si no es correcta: primer índice */
+    const char *motivo;          /* si no es correcta */
+} ResultadoVerificacion;
+
+/*
+ * 1 hilo, 64 ventanas de 16 términos, 2 primos y una semilla nueva
+ * en cada llamada (getrandom(2), o la hora si no está disponible),
+ * para que ejecuciones sucesivas no revisen siempre las mismas
+ * ventanas. Quien necesite repetir una verificación fija 'semilla'.
+ */
+void vf_opciones_por_defecto(OpcionesVerificacion *o);
+
+/*
+ * vf_verificar_texto: verifica 'tam' bytes de 'texto'.
+ * vf_verificar_archivo: lo mismo sobre un archivo (proyectado en
+ * memoria) o, con ruta NULL o "-", sobre la entrada estándar.
+ *
+ * Retornan 0 si la verificación pudo hacerse (el veredicto queda en
+ * 'resultado') y -1 ante un error de E/S o falta de memoria.
+ */
+int vf_verificar_texto(const char *texto, size_t tam,
+                       const OpcionesVerificacion *opciones,
+                       ResultadoVerificacion *resultado);
+int vf_verificar_archivo(const char *ruta,
+                         const OpcionesVerificacion *opciones,
+                         ResultadoVerificacion *resultado);
+
+#endif /* VERIFICACION_H */